@@ -0,0 +1,208 @@
+/************************************************************************
+* Programmer:              SURAKANTI SRISHANTH REDDY                    *
+* Class:                   CPTS 223                                     *
+* Programming Assignment:  PA 3                                         *
+* Date:                    OCTOBER 24, 2025                             *
+*                                                                       *
+* Description: 			   COUNT / SUM / MIN / MAX / AVG OVER ONE TYPED *
+*                          COLUMN AND ITS NULL BITMAP, OVERALL OR PER   *
+*                          GROUP (CATEGORY, MANUFACTURER). ROWS ARE     *
+*                          SCANNED 64 AT A TIME FROM THE BITMAP WORDS,  *
+*                          RANGES OF WORDS RUN ON SEVERAL THREADS.      *
+*                                                                       *
+************************************************************************/
+#pragma once
+#ifndef AGGREGATION_H
+#define AGGREGATION_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+#include "ThreadPool.h"
+
+class Aggregation {
+public:
+    enum Function { COUNT, SUM, MIN, MAX, AVG };
+
+    struct Group {
+        uint32_t id;
+        uint64_t count;
+        double sum;
+        double min;
+        double max;
+
+        double value(Function function) const {
+            switch (function) {
+            case COUNT: return static_cast<double>(count);
+            case SUM: return sum;
+            case MIN: return min;
+            case MAX: return max;
+            default: return count ? sum / static_cast<double>(count) : 0.0;
+            }
+        }
+    };
+
+    // THE GROUP I.D.s OF EVERY ROW: ROW r IS IN ids[offsets[r] .. offsets[r + 1]),
+    // OR WITH offsets EMPTY IN EXACTLY ONE GROUP, ids[r]
+    struct RowGroups {
+        std::vector<uint64_t> offsets;
+        std::vector<uint32_t> ids;
+        uint32_t count = 0;             // DISTINCT GROUP I.D.s, ALL BELOW count
+        bool ready = false;
+    };
+
+    // ROWS A THREAD SHOULD HAVE BEFORE ANOTHER ONE IS WORTH STARTING
+    static const size_t ROWS_PER_THREAD = 1 << 18;
+
+private:
+    static Group emptyGroup(uint32_t id) {
+        return Group{ id, 0, 0.0, std::numeric_limits<double>::infinity(), -std::numeric_limits<double>::infinity() };
+    }
+
+    static void add(Group& group, double x) {
+        group.count++;
+        group.sum += x;
+        group.min = x < group.min ? x : group.min;
+        group.max = x > group.max ? x : group.max;
+    }
+
+    static void merge(Group& into, const Group& from) {
+        into.count += from.count;
+        into.sum += from.sum;
+        into.min = from.min < into.min ? from.min : into.min;
+        into.max = from.max > into.max ? from.max : into.max;
+    }
+
+    // maskTable()[b * 8 + l] IS BIT l OF THE BYTE b AS 1.0 OR 0.0
+    static const double* maskTable() {
+        static const std::vector<double> table = [] {
+            std::vector<double> masks(256 * 8);
+            for (size_t b = 0; b < 256; b++) {
+                for (size_t l = 0; l < 8; l++) {
+                    masks[b * 8 + l] = static_cast<double>((b >> l) & 1);
+                }
+            }
+            return masks;
+        }();
+        return table.data();
+    }
+
+    // THE ROWS OF ONE BITMAP WORD IN AN UNGROUPED SCAN. ALL 64 VALUES ARE READ
+    // AND THE NULL ONES MASKED OUT BY A BYTE OF masks AT A TIME INSTEAD OF
+    // BRANCHED AROUND, IN EIGHT INDEPENDENT LANES, SO THE LOOP HAS NO BRANCH OR
+    // CARRIED DEPENDENCY AND THE COMPILER CAN KEEP IT IN VECTOR REGISTERS
+    template<typename T>
+    static void addWord(const T* values, uint64_t bits, const double* masks, Group& group) {
+        const size_t LANES = 8;
+        const double inf = std::numeric_limits<double>::infinity();
+        double sum[LANES], lo[LANES], hi[LANES];
+        for (size_t l = 0; l < LANES; l++) {
+            sum[l] = 0.0;
+            lo[l] = inf;
+            hi[l] = -inf;
+        }
+        for (size_t i = 0; i < 64; i += LANES) {
+            const double* on = masks + ((bits >> i) & 0xFF) * LANES;
+            for (size_t l = 0; l < LANES; l++) {
+                double x = static_cast<double>(values[i + l]);
+                double low = on[l] != 0.0 ? x : inf;
+                double high = on[l] != 0.0 ? x : -inf;
+                sum[l] += x * on[l];
+                lo[l] = low < lo[l] ? low : lo[l];
+                hi[l] = high > hi[l] ? high : hi[l];
+            }
+        }
+        for (size_t l = 0; l < LANES; l++) {
+            group.sum += sum[l];
+            group.min = lo[l] < group.min ? lo[l] : group.min;
+            group.max = hi[l] > group.max ? hi[l] : group.max;
+        }
+        group.count += static_cast<uint64_t>(__builtin_popcountll(bits));
+    }
+
+    // ROWS OF WORDS [firstWord, lastWord) INTO acc, ONE Group PER GROUP I.D.
+    template<typename T>
+    static void scan(const T* values, const uint64_t* valid, size_t rows, const RowGroups* groups,
+        size_t firstWord, size_t lastWord, std::vector<Group>& acc) {
+        const uint64_t* offsets = groups && !groups->offsets.empty() ? groups->offsets.data() : nullptr;
+        const uint32_t* ids = groups ? groups->ids.data() : nullptr;
+        const double* masks = maskTable();
+        for (size_t w = firstWord; w < lastWord; w++) {
+            size_t base = w * 64;
+            uint64_t bits = valid ? valid[w] : ~0ULL;
+            if (rows - base < 64) {
+                bits &= (1ULL << (rows - base)) - 1;
+            }
+            // A WHOLE WORD OF ROWS, SO NOTHING PAST THE COLUMN'S END IS READ
+            if (!groups && values && rows - base >= 64) {
+                addWord(values + base, bits, masks, acc[0]);
+                continue;
+            }
+            while (bits) {
+                size_t row = base + static_cast<size_t>(__builtin_ctzll(bits));
+                bits &= bits - 1;
+                double x = values ? static_cast<double>(values[row]) : 0.0;
+                if (!groups) {
+                    add(acc[0], x);
+                }
+                else if (!offsets) {
+                    add(acc[ids[row]], x);
+                }
+                else {
+                    for (uint64_t k = offsets[row]; k < offsets[row + 1]; k++) {
+                        add(acc[ids[k]], x);
+                    }
+                }
+            }
+        }
+    }
+
+public:
+    // AGGREGATES values[0 .. rows) OVER THE ROWS WHOSE valid BIT IS SET (EVERY
+    // ROW WHEN valid IS NULL, values MAY THEN BE NULL TOO FOR A PLAIN COUNT),
+    // PER GROUP OF groups OR, WITH groups NULL, AS ONE GROUP WITH I.D. 0. UP TO
+    // threads THREADS EACH SCAN A RANGE OF WHOLE BITMAP WORDS INTO THEIR OWN
+    // ACCUMULATORS, MERGED AFTERWARDS. GROUPS WITH NO ROWS ARE LEFT OUT. THE
+    // SLOT OF A NULL ROW MUST HOLD A FINITE VALUE (THE STORE WRITES 0), IT IS
+    // MULTIPLIED BY 0 RATHER THAN SKIPPED
+    template<typename T>
+    static std::vector<Group> run(const T* values, const uint64_t* valid, size_t rows,
+        const RowGroups* groups, size_t threads) {
+        size_t groupCount = groups ? groups->count : 1;
+        size_t words = (rows + 63) / 64;
+        size_t chunks = std::max<size_t>(1, std::min(threads, rows / ROWS_PER_THREAD));
+
+        std::vector<std::vector<Group>> partial(chunks);
+        auto work = [&](size_t c) {
+            std::vector<Group>& acc = partial[c];
+            acc.reserve(groupCount);
+            for (size_t g = 0; g < groupCount; g++) {
+                acc.push_back(emptyGroup(static_cast<uint32_t>(g)));
+            }
+            scan(values, valid, rows, groups, words * c / chunks, words * (c + 1) / chunks, acc);
+        };
+        if (chunks == 1) {
+            work(0);
+        }
+        else {
+            ThreadPool pool(chunks);
+            pool.parallelFor(chunks, work);
+        }
+
+        std::vector<Group> result;
+        for (size_t g = 0; g < groupCount; g++) {
+            Group total = partial[0][g];
+            for (size_t c = 1; c < chunks; c++) {
+                merge(total, partial[c][g]);
+            }
+            if (total.count > 0) {
+                result.push_back(total);
+            }
+        }
+        return result;
+    }
+};
+
+#endif // AGGREGATION_H
@@ -0,0 +1,127 @@
+/************************************************************************
+* Programmer:              SURAKANTI SRISHANTH REDDY                    *
+* Class:                   CPTS 223                                     *
+* Programming Assignment:  PA 3                                         *
+* Date:                    OCTOBER 24, 2025                             *
+*                                                                       *
+* Description: 			   BUMP ALLOCATOR OVER LARGE SLABS. OBJECTS ARE *
+*                          NEVER FREED ONE BY ONE, THE WHOLE ARENA IS   *
+*                          RELEASED AT ONCE, SO MILLIONS OF SMALL       *
+*                          RECORDS COST ONE malloc PER SLAB AND TEAR    *
+*                          DOWN IN TIME PROPORTIONAL TO THE SLAB COUNT. *
+*                                                                       *
+************************************************************************/
+#pragma once
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+class Arena {
+private:
+    std::vector<char*> slabs;
+    char* cursor;
+    char* limit;
+    size_t slabSize;
+    size_t bytesUsed;
+    size_t bytesReserved;
+
+    char* newSlab(size_t bytes) {
+        char* slab = static_cast<char*>(std::malloc(bytes));
+        if (!slab) {
+            throw std::bad_alloc();
+        }
+        slabs.push_back(slab);
+        bytesReserved += bytes;
+        return slab;
+    }
+
+public:
+    explicit Arena(size_t slab = 1 << 20)
+        : cursor(nullptr), limit(nullptr), slabSize(slab), bytesUsed(0), bytesReserved(0) {}
+
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    ~Arena() {
+        release();
+    }
+
+    void* allocate(size_t bytes, size_t align = alignof(std::max_align_t)) {
+        uintptr_t p = (reinterpret_cast<uintptr_t>(cursor) + (align - 1)) & ~static_cast<uintptr_t>(align - 1);
+        if (cursor && p + bytes <= reinterpret_cast<uintptr_t>(limit)) {
+            cursor = reinterpret_cast<char*>(p + bytes);
+            bytesUsed += bytes;
+            return reinterpret_cast<void*>(p);
+        }
+
+        // BIG REQUESTS GET A SLAB OF THEIR OWN SO THE CURRENT ONE KEEPS FILLING
+        if (bytes + align > slabSize / 4) {
+            bytesUsed += bytes;
+            char* slab = newSlab(bytes + align);
+            p = (reinterpret_cast<uintptr_t>(slab) + (align - 1)) & ~static_cast<uintptr_t>(align - 1);
+            return reinterpret_cast<void*>(p);
+        }
+
+        cursor = newSlab(slabSize);
+        limit = cursor + slabSize;
+        return allocate(bytes, align);
+    }
+
+    // CONSTRUCTS A T INSIDE THE ARENA. ITS DESTRUCTOR IS NEVER RUN BY THE ARENA
+    template<typename T, typename... Args>
+    T* create(Args&&... args) {
+        return new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+    }
+
+    template<typename T>
+    T* allocateArray(size_t count) {
+        return static_cast<T*>(allocate(sizeof(T) * count, alignof(T)));
+    }
+
+    // COPIES THE BYTES INTO THE ARENA AND RETURNS A VIEW OF THE COPY
+    std::string_view copyString(std::string_view s) {
+        if (s.empty()) {
+            return std::string_view();
+        }
+        char* dst = static_cast<char*>(allocate(s.size(), 1));
+        std::memcpy(dst, s.data(), s.size());
+        return std::string_view(dst, s.size());
+    }
+
+    // TAKES OVER ALL OF other'S SLABS (USED TO MERGE PER THREAD ARENAS)
+    void adopt(Arena& other) {
+        slabs.insert(slabs.end(), other.slabs.begin(), other.slabs.end());
+        bytesUsed += other.bytesUsed;
+        bytesReserved += other.bytesReserved;
+        other.slabs.clear();
+        other.cursor = nullptr;
+        other.limit = nullptr;
+        other.bytesUsed = 0;
+        other.bytesReserved = 0;
+    }
+
+    void release() {
+        for (char* slab : slabs) {
+            std::free(slab);
+        }
+        slabs.clear();
+        cursor = nullptr;
+        limit = nullptr;
+        bytesUsed = 0;
+        bytesReserved = 0;
+    }
+
+    size_t bytesAllocated() const { return bytesUsed; }
+    size_t bytesInSlabs() const { return bytesReserved; }
+    size_t slabCount() const { return slabs.size(); }
+};
+
+#endif // ARENA_H
@@ -0,0 +1,345 @@
+/************************************************************************
+* Programmer:              SURAKANTI SRISHANTH REDDY                    *
+* Class:                   CPTS 223                                     *
+* Programming Assignment:  PA 3                                         *
+* Date:                    OCTOBER 24, 2025                             *
+*                                                                       *
+* Description: 			   ZERO COPY CSV INPUT. MappedFile MAPS THE     *
+*                          WHOLE FILE INTO MEMORY AND CSVScanner SPLITS *
+*                          IT INTO RECORDS OF string_view FIELDS THAT   *
+*                          POINT STRAIGHT INTO THE MAPPING. QUOTED      *
+*                          FIELDS MAY HOLD COMMAS, DOUBLED QUOTES ("")  *
+*                          AND NEWLINES. FIELD BOUNDARIES COME FROM     *
+*                          CSVStructural'S BIT MASKS WHEN THE CPU HAS   *
+*                          SIMD, ELSE FROM A BYTE AT A TIME LOOP.       *
+*                                                                       *
+************************************************************************/
+#pragma once
+#ifndef CSVREADER_H
+#define CSVREADER_H
+
+#include <algorithm>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "CSVStructural.h"
+#include "ThreadPool.h"
+
+class MappedFile {
+private:
+    const char* bytes;
+    size_t length;
+    bool mapped;
+    std::string fallback;   // USED WHEN mmap IS NOT POSSIBLE (PIPES, EMPTY FILES)
+
+public:
+    MappedFile() : bytes(nullptr), length(0), mapped(false) {}
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    ~MappedFile() {
+        close();
+    }
+
+    // sequential TELLS THE KERNEL THE FILE IS READ ONCE, FRONT TO BACK
+    bool open(const std::string& path, bool sequential = true) {
+        close();
+
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return false;
+        }
+
+        struct stat st;
+        if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+            void* addr = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+            if (addr != MAP_FAILED) {
+                if (sequential) {
+                    madvise(addr, static_cast<size_t>(st.st_size), MADV_SEQUENTIAL);
+                }
+                bytes = static_cast<const char*>(addr);
+                length = static_cast<size_t>(st.st_size);
+                mapped = true;
+                ::close(fd);
+                return true;
+            }
+        }
+
+        // COULD NOT MAP, READ IT INTO MEMORY INSTEAD
+        char buf[1 << 16];
+        ssize_t n;
+        while ((n = ::read(fd, buf, sizeof(buf))) > 0) {
+            fallback.append(buf, static_cast<size_t>(n));
+        }
+        ::close(fd);
+        if (n < 0) {
+            fallback.clear();
+            return false;
+        }
+        bytes = fallback.data();
+        length = fallback.size();
+        return true;
+    }
+
+    void close() {
+        if (mapped) {
+            munmap(const_cast<char*>(bytes), length);
+        }
+        bytes = nullptr;
+        length = 0;
+        mapped = false;
+        fallback.clear();
+    }
+
+    const char* data() const { return bytes; }
+    size_t size() const { return length; }
+};
+
+class CSVScanner {
+private:
+    const char* pos;
+    const char* end;
+    size_t line;            // PHYSICAL LINE OF THE NEXT RECORD
+    size_t startLine;       // PHYSICAL LINE WHERE THE LAST RECORD STARTED
+
+    // SIMD STATE, UNUSED WHEN kernel IS NULL. bits ARE THE NOT YET CONSUMED
+    // STRUCTURAL BYTES OF THE BLOCK AT base + blockStart
+    const char* base;
+    size_t length;
+    CSVStructural::Kernel kernel;
+    size_t blockStart;
+    uint64_t bits;
+    uint64_t quotedBits;
+    uint64_t carry;
+
+    static bool isSpace(char c) {
+        return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+    }
+
+    static std::string_view trimSpaces(std::string_view s) {
+        size_t start = 0;
+        size_t stop = s.size();
+        while (start < stop && isSpace(s[start])) start++;
+        while (stop > start && isSpace(s[stop - 1])) stop--;
+        return s.substr(start, stop - start);
+    }
+
+    void loadBlock() {
+        CSVStructural::Block block;
+        if (length - blockStart >= CSVStructural::BLOCK) {
+            kernel(base + blockStart, carry, block);
+        }
+        else {
+            CSVStructural::partialBlock(kernel, base + blockStart, length - blockStart, carry, block);
+        }
+        bits = block.structural;
+        quotedBits = block.quoted;
+    }
+
+    // OFFSET OF THE NEXT UNCONSUMED COMMA OR NEWLINE, length IF THERE IS NONE
+    size_t nextStructural() {
+        while (bits == 0) {
+            blockStart += CSVStructural::BLOCK;
+            if (blockStart >= length) {
+                return length;
+            }
+            loadBlock();
+        }
+        return blockStart + static_cast<size_t>(__builtin_ctzll(bits));
+    }
+
+    void nextRecordScalar(std::vector<std::string_view>& fields) {
+        const char* fieldStart = pos;
+        bool inQuotes = false;
+
+        for (; pos < end; pos++) {
+            char c = *pos;
+            if (c == '"') {
+                inQuotes = !inQuotes;
+            }
+            else if (c == ',' && !inQuotes) {
+                fields.push_back(cleanField(std::string_view(fieldStart, pos - fieldStart)));
+                fieldStart = pos + 1;
+            }
+            else if (c == '\n') {
+                line++;
+                if (!inQuotes) {
+                    break;
+                }
+            }
+        }
+
+        fields.push_back(cleanField(std::string_view(fieldStart, pos - fieldStart)));
+    }
+
+    // SAME BOUNDARIES AS nextRecordScalar, BUT ONLY VISITS COMMAS AND NEWLINES.
+    // THE QUOTE PARITY CARRIED BETWEEN BLOCKS IS EVEN AT EVERY RECORD START
+    // BECAUSE RECORDS ONLY END ON UNQUOTED NEWLINES
+    void nextRecordSimd(std::vector<std::string_view>& fields) {
+        const char* fieldStart = pos;
+        while (true) {
+            size_t at = nextStructural();
+            if (at >= length) {
+                pos = end;
+                break;
+            }
+            bool quotedNewline = (quotedBits >> (at - blockStart)) & 1;
+            bits &= bits - 1;
+
+            if (base[at] == ',') {
+                fields.push_back(cleanField(std::string_view(fieldStart, base + at - fieldStart)));
+                fieldStart = base + at + 1;
+                continue;
+            }
+            line++;
+            if (!quotedNewline) {
+                pos = base + at;
+                break;
+            }
+        }
+
+        fields.push_back(cleanField(std::string_view(fieldStart, pos - fieldStart)));
+    }
+
+public:
+    // level PICKS THE STRUCTURE SEARCH (DEFAULT: THE BEST THE CPU HAS), EVERY LEVEL
+    // YIELDS THE SAME FIELDS
+    CSVScanner(const char* data, size_t size, size_t firstLine = 1,
+        CSVStructural::Level level = CSVStructural::detect())
+        : pos(data), end(data + size), line(firstLine), startLine(firstLine),
+        base(data), length(size), kernel(CSVStructural::kernel(level)),
+        blockStart(0), bits(0), quotedBits(0), carry(0) {
+        if (kernel && size > 0) {
+            loadBlock();
+        }
+    }
+
+    // TRIMS WHITESPACE AND ONE PAIR OF SURROUNDING QUOTES, DOUBLED QUOTES ARE LEFT
+    // IN PLACE FOR unescape() SO THE RESULT IS STILL A VIEW INTO THE INPUT
+    static std::string_view cleanField(std::string_view raw) {
+        std::string_view s = trimSpaces(raw);
+        if (s.size() >= 2 && s.front() == '"' && s.back() == '"') {
+            s = trimSpaces(s.substr(1, s.size() - 2));
+        }
+        else if (s.size() == 1 && s[0] == '"') {
+            s = std::string_view();
+        }
+        return s;
+    }
+
+    // COPIES A CLEANED FIELD OUT OF THE BUFFER, TURNING "" BACK INTO "
+    static std::string unescape(std::string_view field) {
+        std::string out;
+        if (field.find("\"\"") == std::string_view::npos) {
+            out.assign(field.data(), field.size());
+            return out;
+        }
+        out.reserve(field.size());
+        for (size_t i = 0; i < field.size(); i++) {
+            out += field[i];
+            if (field[i] == '"' && i + 1 < field.size() && field[i + 1] == '"') {
+                i++;
+            }
+        }
+        return out;
+    }
+
+    bool atEnd() const {
+        return pos >= end;
+    }
+
+    size_t recordLine() const {
+        return startLine;
+    }
+
+    // PHYSICAL LINE THE NEXT RECORD STARTS ON
+    size_t currentLine() const {
+        return line;
+    }
+
+    // CUTS [data, data + size) INTO ABOUT chunks PIECES THAT EACH START AT A RECORD
+    // BOUNDARY. A NEWLINE IS ONLY A BOUNDARY WHEN AN EVEN NUMBER OF QUOTES PRECEDE
+    // IT, SO THE QUOTES IN EVERY RAW PIECE ARE COUNTED FIRST (IN PARALLEL) AND THE
+    // PREFIX PARITY TELLS EACH PIECE WHETHER IT STARTS INSIDE A QUOTED FIELD.
+    // RETURNS chunks + 1 OFFSETS, CHUNK i IS [offsets[i], offsets[i + 1])
+    static std::vector<size_t> splitRecords(const char* data, size_t size, size_t chunks, ThreadPool& pool) {
+        if (chunks == 0) {
+            chunks = 1;
+        }
+        std::vector<size_t> rawStart(chunks + 1);
+        for (size_t i = 0; i <= chunks; i++) {
+            rawStart[i] = size / chunks * i;
+        }
+        rawStart[chunks] = size;
+
+        std::vector<size_t> quotes(chunks);
+        pool.parallelFor(chunks, [&](size_t i) {
+            quotes[i] = static_cast<size_t>(std::count(data + rawStart[i], data + rawStart[i + 1], '"'));
+        });
+
+        std::vector<size_t> offsets(chunks + 1);
+        offsets[0] = 0;
+        offsets[chunks] = size;
+
+        std::vector<bool> startsInQuotes(chunks);
+        size_t parity = 0;
+        for (size_t i = 0; i < chunks; i++) {
+            startsInQuotes[i] = (parity & 1) != 0;
+            parity += quotes[i];
+        }
+
+        pool.parallelFor(chunks - 1, [&](size_t k) {
+            size_t i = k + 1;
+            bool inQuotes = startsInQuotes[i];
+            size_t p = rawStart[i];
+            if (p == 0) {
+                offsets[i] = 0;
+                return;
+            }
+            // THE BYTE BEFORE THE RAW START MAY ALREADY BE A BOUNDARY NEWLINE
+            if (!inQuotes && data[p - 1] == '\n') {
+                offsets[i] = p;
+                return;
+            }
+            for (; p < size; p++) {
+                if (data[p] == '"') {
+                    inQuotes = !inQuotes;
+                }
+                else if (data[p] == '\n' && !inQuotes) {
+                    p++;
+                    break;
+                }
+            }
+            offsets[i] = p;
+        });
+        return offsets;
+    }
+
+    // SPLITS THE NEXT RECORD INTO CLEANED FIELDS, A NEWLINE ONLY ENDS THE RECORD
+    // OUTSIDE QUOTES. RETURNS FALSE WHEN THE INPUT IS EXHAUSTED
+    bool nextRecord(std::vector<std::string_view>& fields) {
+        fields.clear();
+        if (pos >= end) {
+            return false;
+        }
+
+        startLine = line;
+        if (kernel) {
+            nextRecordSimd(fields);
+        }
+        else {
+            nextRecordScalar(fields);
+        }
+        if (pos < end) {
+            pos++;  // SKIPS THE NEWLINE
+        }
+        return true;
+    }
+};
+
+#endif // CSVREADER_H
@@ -0,0 +1,146 @@
+/************************************************************************
+* Programmer:              SURAKANTI SRISHANTH REDDY                    *
+* Class:                   CPTS 223                                     *
+* Programming Assignment:  PA 3                                         *
+* Date:                    OCTOBER 24, 2025                             *
+*                                                                       *
+* Description: 			   VECTORIZED CSV STRUCTURE SEARCH. EACH 64     *
+*                          BYTE BLOCK BECOMES BIT MASKS OF ITS QUOTES,  *
+*                          COMMAS AND NEWLINES (AVX2 OR SSE4.2, PICKED  *
+*                          AT RUN TIME) AND A CARRY-LESS PREFIX XOR OF  *
+*                          THE QUOTE MASK MARKS THE QUOTED BYTES.       *
+*                                                                       *
+************************************************************************/
+#pragma once
+#ifndef CSVSTRUCTURAL_H
+#define CSVSTRUCTURAL_H
+
+#include <cstdint>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define CSV_STRUCTURAL_X86 1
+#endif
+
+class CSVStructural {
+public:
+    static const size_t BLOCK = 64;
+
+    enum Level { SCALAR, SSE42, AVX2 };
+
+    // ONE BLOCK'S RESULT. BIT i DESCRIBES BYTE i OF THE BLOCK
+    struct Block {
+        uint64_t structural;    // UNQUOTED COMMAS AND EVERY NEWLINE
+        uint64_t quoted;        // BYTES INSIDE A QUOTED FIELD (A NEWLINE HERE IS DATA)
+    };
+
+    // carry IS ALL ONES WHEN THE PREVIOUS BLOCK ENDED INSIDE QUOTES, UPDATED FOR THE NEXT ONE
+    typedef void (*Kernel)(const char* block, uint64_t& carry, Block& out);
+
+private:
+    // inside HOLDS THE QUOTE PARITY OF EACH BYTE WITHIN THE BLOCK
+    static void finish(uint64_t commas, uint64_t newlines, uint64_t inside, uint64_t& carry, Block& out) {
+        inside ^= carry;
+        out.quoted = inside;
+        out.structural = (commas & ~inside) | newlines;
+        carry = static_cast<uint64_t>(static_cast<int64_t>(inside) >> 63);
+    }
+
+#ifdef CSV_STRUCTURAL_X86
+    // BIT i OF THE RESULT IS THE XOR OF BITS 0..i. A CARRY-LESS MULTIPLY BY ALL
+    // ONES XORs EVERY LOWER BIT INTO EACH BIT
+    __attribute__((target("sse4.2,pclmul")))
+    static uint64_t prefixXor(uint64_t x) {
+        __m128i product = _mm_clmulepi64_si128(_mm_set_epi64x(0, static_cast<long long>(x)),
+            _mm_set1_epi8(static_cast<char>(0xFF)), 0);
+        return static_cast<uint64_t>(_mm_cvtsi128_si64(product));
+    }
+
+    __attribute__((target("sse4.2,pclmul")))
+    static uint64_t match16(const char* p, __m128i needle) {
+        return static_cast<uint32_t>(_mm_movemask_epi8(
+            _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)), needle))) & 0xFFFF;
+    }
+
+    __attribute__((target("sse4.2,pclmul")))
+    static void sse42Kernel(const char* block, uint64_t& carry, Block& out) {
+        const __m128i quote = _mm_set1_epi8('"');
+        const __m128i comma = _mm_set1_epi8(',');
+        const __m128i newline = _mm_set1_epi8('\n');
+        uint64_t quotes = 0;
+        uint64_t commas = 0;
+        uint64_t newlines = 0;
+        for (size_t i = 0; i < BLOCK; i += 16) {
+            quotes |= match16(block + i, quote) << i;
+            commas |= match16(block + i, comma) << i;
+            newlines |= match16(block + i, newline) << i;
+        }
+        finish(commas, newlines, prefixXor(quotes), carry, out);
+    }
+
+    __attribute__((target("avx2,pclmul")))
+    static uint64_t match32(const char* p, __m256i needle) {
+        return static_cast<uint32_t>(_mm256_movemask_epi8(
+            _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)), needle)));
+    }
+
+    __attribute__((target("avx2,pclmul")))
+    static void avx2Kernel(const char* block, uint64_t& carry, Block& out) {
+        const __m256i quote = _mm256_set1_epi8('"');
+        const __m256i comma = _mm256_set1_epi8(',');
+        const __m256i newline = _mm256_set1_epi8('\n');
+        uint64_t quotes = match32(block, quote) | (match32(block + 32, quote) << 32);
+        uint64_t commas = match32(block, comma) | (match32(block + 32, comma) << 32);
+        uint64_t newlines = match32(block, newline) | (match32(block + 32, newline) << 32);
+        finish(commas, newlines, prefixXor(quotes), carry, out);
+    }
+#endif
+
+public:
+    // BEST LEVEL THIS CPU SUPPORTS, CHECKED ONCE
+    static Level detect() {
+#ifdef CSV_STRUCTURAL_X86
+        static const Level level = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("pclmul") ? AVX2
+            : __builtin_cpu_supports("sse4.2") && __builtin_cpu_supports("pclmul") ? SSE42
+            : SCALAR;
+        return level;
+#else
+        return SCALAR;
+#endif
+    }
+
+    static bool supported(Level level) {
+        return level <= detect();
+    }
+
+    // KERNEL FOR level (DOWNGRADED TO WHAT THE CPU HAS), NULL FOR SCALAR, WHICH
+    // KEEPS THE BYTE AT A TIME LOOP
+    static Kernel kernel(Level level) {
+        if (!supported(level)) {
+            level = detect();
+        }
+#ifdef CSV_STRUCTURAL_X86
+        if (level == AVX2) return &avx2Kernel;
+        if (level == SSE42) return &sse42Kernel;
+#endif
+        return nullptr;
+    }
+
+    static const char* name(Level level) {
+        switch (level) {
+        case AVX2: return "AVX2";
+        case SSE42: return "SSE4.2";
+        default: return "SCALAR";
+        }
+    }
+
+    // RUNS kernel OVER THE LAST, SHORT BLOCK BY PADDING IT WITH ZERO BYTES
+    static void partialBlock(Kernel kernel, const char* data, size_t size, uint64_t& carry, Block& out) {
+        char padded[BLOCK] = {};
+        std::memcpy(padded, data, size);
+        kernel(padded, carry, out);
+    }
+};
+
+#endif // CSVSTRUCTURAL_H
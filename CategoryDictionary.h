@@ -0,0 +1,64 @@
+/************************************************************************
+* Programmer:              SURAKANTI SRISHANTH REDDY                    *
+* Class:                   CPTS 223                                     *
+* Programming Assignment:  PA 3                                         *
+* Date:                    OCTOBER 24, 2025                             *
+*                                                                       *
+* Description: 			   INTERN TABLE FOR CATEGORY NAMES. EVERY       *
+*                          DISTINCT NAME GETS A DENSE uint32_t I.D. IN  *
+*                          ORDER OF FIRST APPEARANCE, SO PRODUCTS KEEP  *
+*                          4 BYTE I.D.s AND PER CATEGORY DATA CAN LIVE  *
+*                          IN PLAIN ARRAYS INDEXED BY I.D.              *
+*                                                                       *
+************************************************************************/
+#pragma once
+#ifndef CATEGORYDICTIONARY_H
+#define CATEGORYDICTIONARY_H
+
+#include <cstdint>
+#include <string_view>
+#include <vector>
+#include "Arena.h"
+#include "HashTable.h"
+
+class CategoryDictionary {
+private:
+    HashTable<std::string_view, uint32_t> ids;
+    std::vector<std::string_view> names;     // I.D. -> NAME
+
+public:
+    CategoryDictionary() : ids(1024) {}
+
+    // NODES COME FROM arena, WHICH MUST OUTLIVE THE DICTIONARY
+    explicit CategoryDictionary(Arena* arena) : ids(1024) {
+        ids.useArena(arena);
+    }
+
+    // RETURNS THE I.D. OF name, ASSIGNING THE NEXT ONE IF IT IS NEW.
+    // ONLY THE VIEW IS STORED, THE CALLER KEEPS THE BYTES ALIVE
+    uint32_t intern(std::string_view name) {
+        std::pair<uint32_t*, bool> slot = ids.tryEmplace(name, static_cast<uint32_t>(names.size()));
+        if (slot.second) {
+            names.push_back(name);
+        }
+        return *slot.first;
+    }
+
+    bool find(std::string_view name, uint32_t& id) const {
+        return ids.find(name, id);
+    }
+
+    bool contains(std::string_view name) const {
+        return ids.contains(name);
+    }
+
+    std::string_view name(uint32_t id) const {
+        return names[id];
+    }
+
+    size_t size() const {
+        return names.size();
+    }
+};
+
+#endif // CATEGORYDICTIONARY_H
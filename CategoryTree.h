@@ -0,0 +1,509 @@
+/************************************************************************
+* Programmer:              SURAKANTI SRISHANTH REDDY                    *
+* Class:                   CPTS 223                                     *
+* Programming Assignment:  PA 3                                         *
+* Date:                    OCTOBER 24, 2025                             *
+*                                                                       *
+* Description: 			   CATEGORY TREE BUILT FROM EVERY PRODUCT'S     *
+*                          "A | B | C" PATH. NODES ARE NUMBERED IN      *
+*                          PRE-ORDER, SO A SUBTREE IS AN INTERVAL OF    *
+*                          NODE I.D.s, AND ROWS ARE LAID OUT IN THAT    *
+*                          ORDER, SO ITS PRODUCTS ARE ONE CONTIGUOUS    *
+*                          RANGE AND ITS COUNT IS A SUBTRACTION. ROWS   *
+*                          CHANGED SINCE THE BUILD ADJUST PER NODE      *
+*                          COUNTS AND ARE MERGED IN WHEN LISTED.        *
+*                          A SNAPSHOT CARRIES THE NODES AND ROWS.       *
+*                                                                       *
+************************************************************************/
+#pragma once
+#ifndef CATEGORYTREE_H
+#define CATEGORYTREE_H
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "CategoryDictionary.h"
+#include "FlatHashTable.h"
+#include "Snapshot.h"
+
+class CategoryTree {
+public:
+    static const uint32_t ROOT = 0;                 // UNNAMED, PARENT OF THE TOP LEVEL
+    static const uint32_t NO_NAME = UINT32_MAX;
+
+private:
+    // A NODE'S I.D. IS ITS PRE-ORDER POSITION, ITS SUBTREE IS I.D.s [I.D., end)
+    struct Node {
+        uint32_t name;          // CATEGORY I.D., NO_NAME FOR THE ROOT
+        uint32_t parent;
+        uint32_t depth;         // 0 FOR THE ROOT, 1 FOR A TOP LEVEL CATEGORY
+        uint32_t end;
+    };
+
+    SectionArray<Node> nodes;
+    SectionArray<uint32_t> rows;            // EVERY ROW ONCE, BY NODE, ROW ORDER WITHIN ONE
+    SectionArray<uint32_t> rowStart;        // NODE n's OWN ROWS ARE rows[rowStart[n] .. rowStart[n + 1])
+    FlatHashTable<uint64_t, uint32_t> childIds;     // (PARENT << 32) | NAME -> CHILD
+
+    static const uint32_t NO_NODE = UINT32_MAX;
+
+    // CHANGES SINCE THE LAST build(). A REMOVED ROW STAYS IN rows BUT IS SKIPPED,
+    // AN ADDED ONE IS A (LEAF, ROW) PAIR IN added (addedAt FINDS IT BY ROW). A
+    // PATH NO BUILT NODE HAS GETS NODES APPENDED AFTER THE builtNodes PRE-ORDERED
+    // ONES, LINKED TO THEIR PARENT THROUGH firstAdded / nextAdded. THE COUNT
+    // CHANGES KEEP ownCount() AND subtreeCount() EXACT, changedBelow[n] IS
+    // NONZERO ONCE ANY ROW UNDER n CHANGED
+    uint32_t builtNodes;
+    std::vector<uint64_t> removedRows;
+    size_t removedCount;
+    std::vector<std::pair<uint32_t, uint32_t>> added;
+    FlatHashTable<uint32_t, uint32_t> addedAt;
+    std::vector<uint32_t> firstAdded;
+    std::vector<uint32_t> nextAdded;
+    std::vector<int32_t> ownChange;
+    std::vector<int32_t> subtreeChange;
+    std::vector<uint32_t> changedBelow;
+    const CategoryDictionary* names;        // ORDERS APPENDED SIBLINGS
+
+    static uint64_t edge(uint32_t parent, uint32_t name) {
+        return (static_cast<uint64_t>(parent) << 32) | name;
+    }
+
+    static std::string_view trim(std::string_view s) {
+        size_t start = s.find_first_not_of(" \t\r\n");
+        size_t end = s.find_last_not_of(" \t\r\n");
+        if (start == std::string_view::npos || end == std::string_view::npos) {
+            return std::string_view();
+        }
+        return s.substr(start, end - start + 1);
+    }
+
+    bool removed(uint32_t row) const {
+        return (row >> 6) < removedRows.size() && ((removedRows[row >> 6] >> (row & 63)) & 1);
+    }
+
+    size_t builtOwn(uint32_t node) const {
+        return node < builtNodes ? rowStart[node + 1] - rowStart[node] : 0;
+    }
+
+    size_t builtSubtree(uint32_t node) const {
+        return node < builtNodes ? rowStart[nodes[node].end] - rowStart[node] : 0;
+    }
+
+    // THE NODE OF A PATH OF CATEGORY I.D.s, APPENDING MISSING ONES IF create IS
+    // SET AND GIVING NO_NODE OTHERWISE
+    uint32_t walk(const uint32_t* path, size_t length, bool create) {
+        uint32_t node = ROOT;
+        for (size_t i = 0; i < length; i++) {
+            uint32_t child;
+            if (!childIds.find(edge(node, path[i]), child)) {
+                if (!create) {
+                    return NO_NODE;
+                }
+                child = static_cast<uint32_t>(nodes.size());
+                std::vector<Node>& grown = nodes.edit();
+                grown.push_back(Node{ path[i], node, grown[node].depth + 1, child + 1 });
+                childIds.insert(edge(node, path[i]), child);
+                firstAdded.push_back(uint32_t(NO_NODE));
+                nextAdded.push_back(firstAdded[node]);
+                firstAdded[node] = child;
+                ownChange.push_back(0);
+                subtreeChange.push_back(0);
+                changedBelow.push_back(0);
+            }
+            node = child;
+        }
+        return node;
+    }
+
+    // ONE ROW MORE (+1) OR LESS (-1) AT leaf, COUNTED UP TO THE ROOT
+    void adjust(uint32_t leaf, int32_t by) {
+        ownChange[leaf] += by;
+        for (uint32_t n = leaf;; n = nodes[n].parent) {
+            subtreeChange[n] += by;
+            changedBelow[n]++;
+            if (n == ROOT) {
+                break;
+            }
+        }
+    }
+
+    bool inSubtree(uint32_t n, uint32_t node) const {
+        if (n < builtNodes && node < builtNodes) {
+            return node <= n && n < nodes[node].end;
+        }
+        while (nodes[n].depth > nodes[node].depth) {
+            n = nodes[n].parent;
+        }
+        return n == node;
+    }
+
+    void dropChanges(size_t count) {
+        builtNodes = static_cast<uint32_t>(count);
+        std::vector<uint64_t>().swap(removedRows);
+        removedCount = 0;
+        std::vector<std::pair<uint32_t, uint32_t>>().swap(added);
+        addedAt.clear();
+        firstAdded.assign(count, uint32_t(NO_NODE));
+        nextAdded.assign(count, uint32_t(NO_NODE));
+        ownChange.assign(count, 0);
+        subtreeChange.assign(count, 0);
+        changedBelow.assign(count, 0);
+    }
+
+public:
+    CategoryTree() : nodes(1, Node{ NO_NAME, ROOT, 0, 1 }), rowStart(2, 0), names(nullptr) {
+        dropChanges(1);
+    }
+
+    CategoryTree(const CategoryTree&) = delete;
+    CategoryTree& operator=(const CategoryTree&) = delete;
+
+    // REPLACES THE TREE WITH ONE OVER ROWS 0 .. rowCount - 1. pathOf(row) GIVES
+    // THE ROW'S CATEGORY I.D.s FROM THE TOP DOWN (ANYTHING WITH ids() AND
+    // size(), LIKE Product::CategoryList). SIBLINGS ARE ORDERED BY NAME
+    template<typename PathOf>
+    void build(uint32_t rowCount, PathOf pathOf, const CategoryDictionary& dictionary) {
+        // INSERTION ORDER FIRST, EVERY ROW ENDS AT THE NODE OF ITS FULL PATH
+        std::vector<Node> built(1, Node{ NO_NAME, ROOT, 0, 0 });
+        std::vector<uint32_t> leaf(rowCount);
+        FlatHashTable<uint64_t, uint32_t> edges(1024);
+        const uint32_t* lastPath = nullptr;
+        size_t lastLength = 0;
+        uint32_t lastLeaf = ROOT;
+        for (uint32_t row = 0; row < rowCount; row++) {
+            auto path = pathOf(row);
+            // NEIGHBOURING ROWS OFTEN SHARE A PATH, THEN NO EDGE IS LOOKED UP
+            if (lastPath && path.size() == lastLength && std::equal(path.ids(), path.ids() + lastLength, lastPath)) {
+                leaf[row] = lastLeaf;
+                continue;
+            }
+            uint32_t node = ROOT;
+            for (size_t i = 0; i < path.size(); i++) {
+                uint32_t name = path.ids()[i];
+                uint32_t child;
+                if (!edges.find(edge(node, name), child)) {
+                    child = static_cast<uint32_t>(built.size());
+                    built.push_back(Node{ name, node, built[node].depth + 1, 0 });
+                    edges.insert(edge(node, name), child);
+                }
+                node = child;
+            }
+            leaf[row] = node;
+            lastPath = path.ids();
+            lastLength = path.size();
+            lastLeaf = node;
+        }
+
+        // CHILD LISTS (CSR), EACH SORTED BY NAME
+        size_t count = built.size();
+        std::vector<uint32_t> childStart(count + 1, 0);
+        for (size_t n = 1; n < count; n++) {
+            childStart[built[n].parent + 1]++;
+        }
+        for (size_t n = 0; n < count; n++) {
+            childStart[n + 1] += childStart[n];
+        }
+        std::vector<uint32_t> children(count > 0 ? count - 1 : 0);
+        std::vector<uint32_t> fill(childStart.begin(), childStart.end() - 1);
+        for (size_t n = 1; n < count; n++) {
+            children[fill[built[n].parent]++] = static_cast<uint32_t>(n);
+        }
+        for (size_t n = 0; n < count; n++) {
+            std::sort(children.begin() + childStart[n], children.begin() + childStart[n + 1], [&](uint32_t a, uint32_t b) {
+                return dictionary.name(built[a].name) < dictionary.name(built[b].name);
+            });
+        }
+
+        // PRE-ORDER NUMBERING, THEN SUBTREE SIZES BOTTOM UP (REVERSE PRE-ORDER)
+        std::vector<uint32_t> preorder(count);
+        std::vector<uint32_t> order;
+        order.reserve(count);
+        std::vector<uint32_t> stack(1, uint32_t(ROOT));
+        while (!stack.empty()) {
+            uint32_t n = stack.back();
+            stack.pop_back();
+            preorder[n] = static_cast<uint32_t>(order.size());
+            order.push_back(n);
+            for (uint32_t c = childStart[n + 1]; c > childStart[n]; c--) {
+                stack.push_back(children[c - 1]);
+            }
+        }
+        std::vector<uint32_t> size(count, 1);
+        for (size_t i = count; i-- > 1;) {
+            size[built[order[i]].parent] += size[order[i]];
+        }
+
+        std::vector<Node> numbered(count);
+        childIds.clear();
+        for (size_t i = 0; i < count; i++) {
+            const Node& from = built[order[i]];
+            numbered[i] = Node{ from.name, i == 0 ? uint32_t(ROOT) : preorder[from.parent], from.depth,
+                static_cast<uint32_t>(i) + size[order[i]] };
+            if (i > 0) {
+                childIds.insert(edge(numbered[i].parent, from.name), static_cast<uint32_t>(i));
+            }
+        }
+
+        // ROWS BY NODE, A COUNTING SORT SO EACH NODE KEEPS ITS ROWS IN ROW ORDER
+        std::vector<uint32_t> starts(count + 1, 0);
+        for (uint32_t row = 0; row < rowCount; row++) {
+            starts[preorder[leaf[row]] + 1]++;
+        }
+        for (size_t n = 0; n < count; n++) {
+            starts[n + 1] += starts[n];
+        }
+        std::vector<uint32_t> byNode(rowCount);
+        std::vector<uint32_t> next(starts.begin(), starts.end() - 1);
+        for (uint32_t row = 0; row < rowCount; row++) {
+            byNode[next[preorder[leaf[row]]]++] = row;
+        }
+        nodes.assign(std::move(numbered));
+        rowStart.assign(std::move(starts));
+        rows.assign(std::move(byNode));
+        names = &dictionary;
+        dropChanges(count);
+    }
+
+    // ADDS nodes, rows AND rowStart AS SNAPSHOT SECTIONS. THE TREE HAS NO
+    // MERGE, SO WITH CHANGES PENDING THE SECTIONS COME FROM A REBUILD (build()'S
+    // ARGUMENTS) THE WRITER KEEPS
+    template<typename PathOf>
+    void save(SnapshotWriter& writer, uint32_t rowCount, PathOf pathOf, const CategoryDictionary& dictionary) const {
+        if (pending() > 0) {
+            CategoryTree& fresh = writer.keep<CategoryTree>();
+            fresh.build(rowCount, pathOf, dictionary);
+            fresh.save(writer, rowCount, pathOf, dictionary);
+            return;
+        }
+        writer.addVector(nodes);
+        writer.addVector(rows);
+        writer.addVector(rowStart);
+    }
+
+    // USES WHAT save() WROTE IN PLACE FROM THE MAPPING (WHICH MUST OUTLIVE THE
+    // TREE) AS THE TREE OF rowCount ROWS UNDER dictionary's I.D.s. ONLY THE
+    // CHILD LOOKUP IS REBUILT, ONE ENTRY PER NODE. NOTHING CHANGES IF A SECTION
+    // DOES NOT FIT
+    bool attach(SnapshotReader& reader, uint32_t rowCount, const CategoryDictionary& dictionary) {
+        size_t count, rowEntries, startCount;
+        const Node* nodeData = reader.next<Node>(count);
+        const uint32_t* rowData = reader.next<uint32_t>(rowEntries);
+        const uint32_t* startData = reader.next<uint32_t>(startCount);
+        bool ok = nodeData && rowData && startData && count > 0 && count < NO_NODE && rowEntries == rowCount
+            && startCount == count + 1 && nodeData[0].name == NO_NAME && nodeData[0].depth == 0
+            && nodeData[0].end == count && startData[0] == 0 && startData[count] == rowEntries;
+        for (size_t n = 1; ok && n < count; n++) {
+            const Node& node = nodeData[n];
+            ok = node.parent < n && node.name < dictionary.size() && node.depth == nodeData[node.parent].depth + 1
+                && node.end > n && node.end <= nodeData[node.parent].end;
+        }
+        for (size_t n = 0; ok && n < count; n++) {
+            ok = startData[n] <= startData[n + 1];
+        }
+        for (size_t r = 0; ok && r < rowEntries; r++) {
+            ok = rowData[r] < rowCount;
+        }
+        if (!ok) {
+            return false;
+        }
+        nodes.attach(nodeData, count);
+        rows.attach(rowData, rowEntries);
+        rowStart.attach(startData, startCount);
+        childIds.clear();
+        for (uint32_t n = 1; n < count; n++) {
+            childIds.insert(edge(nodes[n].parent, nodes[n].name), n);
+        }
+        names = &dictionary;
+        dropChanges(count);
+        return true;
+    }
+
+    // TAKES row OUT OF THE TREE. path IS THE ONE IT WAS ADDED WITH
+    template<typename Path>
+    void removeRow(uint32_t row, const Path& path) {
+        uint32_t leaf = walk(path.ids(), path.size(), false);
+        if (leaf == NO_NODE) {
+            return;
+        }
+        uint32_t at;
+        if (addedAt.find(row, at)) {
+            added[at] = added.back();
+            addedAt.insert(added[at].second, at);
+            added.pop_back();
+            addedAt.remove(row);
+        }
+        else {
+            if ((row >> 6) >= removedRows.size()) {
+                removedRows.resize((row >> 6) + 1, 0);
+            }
+            removedRows[row >> 6] |= uint64_t(1) << (row & 63);
+            removedCount++;
+        }
+        adjust(leaf, -1);
+    }
+
+    // PUTS row UNDER path (ANYTHING WITH ids() AND size()). THE ROW MUST NOT BE
+    // IN THE TREE (removeRow() IT FIRST)
+    template<typename Path>
+    void addRow(uint32_t row, const Path& path) {
+        uint32_t leaf = walk(path.ids(), path.size(), true);
+        addedAt.insert(row, static_cast<uint32_t>(added.size()));
+        added.push_back(std::make_pair(leaf, row));
+        adjust(leaf, 1);
+    }
+
+    // ROWS AND NODES CHANGED SINCE THE LAST build()
+    size_t pending() const {
+        return removedCount + added.size() + (nodes.size() - builtNodes);
+    }
+
+    // TRUE WHILE NO CHANGE REACHED node's SUBTREE: ITS ROWS ARE STILL THE ONE
+    // RUN rowData()[subtreeFirst(node) ..]
+    bool unchanged(uint32_t node) const {
+        return node < builtNodes && changedBelow[node] == 0;
+    }
+
+    // EVERY ROW IN node's SUBTREE IN TREE ORDER WITH THE PENDING CHANGES MERGED
+    // IN: EACH NODE'S BUILT ROWS MINUS THE REMOVED ONES AND PLUS ITS ADDED ONES
+    // IN ROW ORDER, THEN ITS CHILDREN BY NAME
+    void subtreeRows(uint32_t node, std::vector<uint32_t>& out) const {
+        out.clear();
+        out.reserve(subtreeCount(node));
+        std::vector<std::pair<uint32_t, uint32_t>> below;
+        for (const std::pair<uint32_t, uint32_t>& entry : added) {
+            if (inSubtree(entry.first, node)) {
+                below.push_back(entry);
+            }
+        }
+        std::sort(below.begin(), below.end());
+
+        std::vector<uint32_t> stack(1, node);
+        while (!stack.empty()) {
+            uint32_t n = stack.back();
+            stack.pop_back();
+            std::vector<std::pair<uint32_t, uint32_t>>::const_iterator from = std::lower_bound(below.begin(), below.end(),
+                std::make_pair(n, uint32_t(0)));
+            std::vector<std::pair<uint32_t, uint32_t>>::const_iterator to = from;
+            while (to != below.end() && to->first == n) {
+                ++to;
+            }
+            const uint32_t* r = n < builtNodes ? rows.data() + rowStart[n] : nullptr;
+            const uint32_t* rEnd = n < builtNodes ? rows.data() + rowStart[n + 1] : nullptr;
+            while (r != rEnd || from != to) {
+                if (from == to || (r != rEnd && *r < from->second)) {
+                    if (!removed(*r)) {
+                        out.push_back(*r);
+                    }
+                    ++r;
+                }
+                else {
+                    out.push_back(from->second);
+                    ++from;
+                }
+            }
+            std::vector<uint32_t> next = children(n);
+            for (size_t i = next.size(); i-- > 0;) {
+                stack.push_back(next[i]);
+            }
+        }
+    }
+
+    // THE NODE FOR "A | B | C" (SPACES AROUND THE '|' DO NOT MATTER, AN EMPTY
+    // PATH IS THE ROOT). FALSE IF ANY STEP IS NOT A CHILD OF THE ONE BEFORE OR
+    // THE NODE HAS NO ROWS LEFT
+    bool findPath(std::string_view path, const CategoryDictionary& dictionary, uint32_t& node) const {
+        node = ROOT;
+        size_t start = 0;
+        while (start <= path.size()) {
+            size_t bar = path.find('|', start);
+            if (bar == std::string_view::npos) {
+                bar = path.size();
+            }
+            std::string_view segment = trim(path.substr(start, bar - start));
+            if (!segment.empty()) {
+                uint32_t name;
+                if (!dictionary.find(segment, name) || !childIds.find(edge(node, name), node)) {
+                    return false;
+                }
+            }
+            start = bar + 1;
+        }
+        return node == ROOT || subtreeCount(node) > 0;
+    }
+
+    bool findChild(uint32_t parent, uint32_t name, uint32_t& child) const {
+        return childIds.find(edge(parent, name), child) && subtreeCount(child) > 0;
+    }
+
+    // CHILDREN WITH ROWS, IN NAME ORDER: THE FIRST BUILT ONE IS node + 1, EACH
+    // NEXT ONE STARTS WHERE THE SUBTREE BEFORE IT ENDS. APPENDED ONES ARE
+    // SORTED IN
+    std::vector<uint32_t> children(uint32_t node) const {
+        std::vector<uint32_t> result;
+        for (uint32_t child = node + 1; child < nodes[node].end; child = nodes[child].end) {
+            if (subtreeCount(child) > 0) {
+                result.push_back(child);
+            }
+        }
+        bool appended = false;
+        for (uint32_t child = firstAdded[node]; child != NO_NODE; child = nextAdded[child]) {
+            if (subtreeCount(child) > 0) {
+                result.push_back(child);
+                appended = true;
+            }
+        }
+        if (appended) {
+            std::sort(result.begin(), result.end(), [&](uint32_t a, uint32_t b) {
+                return names->name(nodes[a].name) < names->name(nodes[b].name);
+            });
+        }
+        return result;
+    }
+
+    // "A | B | C" FOR A NODE, EMPTY FOR THE ROOT
+    std::string pathName(uint32_t node, const CategoryDictionary& dictionary) const {
+        std::vector<uint32_t> steps;
+        for (uint32_t n = node; n != ROOT; n = nodes[n].parent) {
+            steps.push_back(n);
+        }
+        std::string path;
+        for (size_t i = steps.size(); i-- > 0;) {
+            path += dictionary.name(nodes[steps[i]].name);
+            if (i > 0) {
+                path += " | ";
+            }
+        }
+        return path;
+    }
+
+    size_t size() const { return nodes.size(); }
+    uint32_t name(uint32_t node) const { return nodes[node].name; }
+    uint32_t parent(uint32_t node) const { return nodes[node].parent; }
+    uint32_t depth(uint32_t node) const { return nodes[node].depth; }
+    uint32_t subtreeEnd(uint32_t node) const { return nodes[node].end; }
+
+    // ROWS WHOSE PATH ENDS AT node ITSELF, AND ALL ROWS IN ITS SUBTREE
+    size_t ownCount(uint32_t node) const { return static_cast<size_t>(static_cast<int64_t>(builtOwn(node)) + ownChange[node]); }
+    size_t subtreeCount(uint32_t node) const {
+        return static_cast<size_t>(static_cast<int64_t>(builtSubtree(node)) + subtreeChange[node]);
+    }
+
+    // WHILE unchanged(node), THE SUBTREE'S ROWS ARE
+    // rowData()[subtreeFirst(node) .. subtreeFirst(node) + subtreeCount(node))
+    size_t subtreeFirst(uint32_t node) const { return rowStart[node]; }
+    const uint32_t* rowData() const { return rows.data(); }
+
+    size_t memoryUsage() const {
+        return nodes.capacity() * sizeof(Node) + rows.capacity() * sizeof(uint32_t)
+            + rowStart.capacity() * sizeof(uint32_t) + childIds.bucketCount() * (sizeof(uint64_t) + sizeof(uint32_t) + 1)
+            + removedRows.capacity() * sizeof(uint64_t) + added.capacity() * sizeof(std::pair<uint32_t, uint32_t>)
+            + addedAt.bucketCount() * (2 * sizeof(uint32_t) + 1)
+            + (firstAdded.capacity() + nextAdded.capacity() + changedBelow.capacity()) * sizeof(uint32_t)
+            + (ownChange.capacity() + subtreeChange.capacity()) * sizeof(int32_t);
+    }
+};
+
+#endif // CATEGORYTREE_H
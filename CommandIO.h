@@ -0,0 +1,253 @@
+/************************************************************************
+* Programmer:              SURAKANTI SRISHANTH REDDY                    *
+* Class:                   CPTS 223                                     *
+* Programming Assignment:  PA 3                                         *
+* Date:                    OCTOBER 24, 2025                             *
+*                                                                       *
+* Description: 			   COMMAND INPUT AND OUTPUT FOR SCRIPTED RUNS.  *
+*                          CommandReader READS A FILE DESCRIPTOR IN     *
+*                          LARGE BLOCKS AND HANDS OUT EACH LINE AS A    *
+*                          string_view INTO ITS BUFFER. BufferedWriter  *
+*                          IS A streambuf THAT ONLY CALLS write() WHEN  *
+*                          ITS BUFFER FILLS OR IT IS FLUSHED, AND       *
+*                          StringWriter APPENDS TO A std::string.       *
+*                                                                       *
+************************************************************************/
+#pragma once
+#ifndef COMMANDIO_H
+#define COMMANDIO_H
+
+#include <cerrno>
+#include <cstring>
+#include <ostream>
+#include <streambuf>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+
+class CommandReader {
+public:
+    static const size_t DEFAULT_BLOCK = size_t(1) << 20;
+
+private:
+    int fd;
+    bool ownsFd;
+    std::ostream* tie;          // FLUSHED BEFORE EVERY read(), LIKE cin's TIE TO cout
+    std::vector<char> buffer;
+    size_t begin;               // FIRST BYTE NOT HANDED OUT YET
+    size_t end;                 // ONE PAST THE LAST BYTE READ
+    bool eof;
+
+    // MOVES THE UNREAD TAIL TO THE FRONT (GROWING THE BUFFER WHEN ONE LINE
+    // FILLS ALL OF IT) AND READS MORE BEHIND IT. FALSE AT END OF INPUT
+    bool refill() {
+        if (eof) {
+            return false;
+        }
+        if (begin > 0) {
+            std::memmove(buffer.data(), buffer.data() + begin, end - begin);
+            end -= begin;
+            begin = 0;
+        }
+        if (end == buffer.size()) {
+            buffer.resize(buffer.size() * 2);
+        }
+        if (tie) {
+            tie->flush();
+        }
+
+        ssize_t n;
+        do {
+            n = ::read(fd, buffer.data() + end, buffer.size() - end);
+        } while (n < 0 && errno == EINTR);
+        if (n <= 0) {
+            eof = true;
+            return false;
+        }
+        end += static_cast<size_t>(n);
+        return true;
+    }
+
+public:
+    explicit CommandReader(int fd, size_t blockSize = DEFAULT_BLOCK, std::ostream* tie = nullptr)
+        : fd(fd), ownsFd(false), tie(tie), buffer(blockSize > 0 ? blockSize : 1), begin(0), end(0), eof(fd < 0) {}
+
+    CommandReader(const CommandReader&) = delete;
+    CommandReader& operator=(const CommandReader&) = delete;
+
+    ~CommandReader() {
+        if (ownsFd) {
+            ::close(fd);
+        }
+    }
+
+    // READS FROM path INSTEAD, FALSE IF IT CANNOT BE OPENED
+    bool open(const std::string& path) {
+        int opened = ::open(path.c_str(), O_RDONLY);
+        if (opened < 0) {
+            return false;
+        }
+        if (ownsFd) {
+            ::close(fd);
+        }
+        fd = opened;
+        ownsFd = true;
+        begin = end = 0;
+        eof = false;
+        return true;
+    }
+
+    // THE NEXT LINE WITHOUT ITS '\n' (OR "\r\n"). THE VIEW IS GOOD UNTIL THE NEXT
+    // CALL. A LAST LINE WITH NO NEWLINE STILL COUNTS, FALSE ONCE INPUT RUNS OUT
+    bool nextLine(std::string_view& line) {
+        size_t scanned = begin;
+        while (true) {
+            const char* start = buffer.data() + begin;
+            const char* newline = static_cast<const char*>(std::memchr(buffer.data() + scanned, '\n', end - scanned));
+            if (newline) {
+                size_t length = static_cast<size_t>(newline - start);
+                begin += length + 1;
+                if (length > 0 && start[length - 1] == '\r') {
+                    length--;
+                }
+                line = std::string_view(start, length);
+                return true;
+            }
+
+            scanned = end - begin;      // WHERE THE SEARCH RESUMES AFTER refill() MOVES THE TAIL
+            if (!refill()) {
+                if (begin == end) {
+                    return false;
+                }
+                size_t length = end - begin;
+                const char* last = buffer.data() + begin;
+                begin = end;
+                if (last[length - 1] == '\r') {
+                    length--;
+                }
+                line = std::string_view(last, length);
+                return true;
+            }
+        }
+    }
+};
+
+class BufferedWriter : public std::streambuf {
+public:
+    static const size_t DEFAULT_BUFFER = size_t(1) << 20;
+
+private:
+    int fd;
+    std::vector<char> buffer;
+    bool failed;
+
+    bool writeAll(const char* data, size_t left) {
+        while (left > 0 && !failed) {
+            ssize_t n = ::write(fd, data, left);
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n <= 0) {
+                failed = true;
+                break;
+            }
+            data += n;
+            left -= static_cast<size_t>(n);
+        }
+        return !failed;
+    }
+
+    bool drain() {
+        bool ok = writeAll(pbase(), static_cast<size_t>(pptr() - pbase()));
+        setp(buffer.data(), buffer.data() + buffer.size());
+        return ok;
+    }
+
+protected:
+    int_type overflow(int_type ch) override {
+        if (!drain()) {
+            return traits_type::eof();
+        }
+        if (!traits_type::eq_int_type(ch, traits_type::eof())) {
+            *pptr() = traits_type::to_char_type(ch);
+            pbump(1);
+        }
+        return traits_type::not_eof(ch);
+    }
+
+    // PIECES BIGGER THAN THE WHOLE BUFFER SKIP IT
+    std::streamsize xsputn(const char* s, std::streamsize count) override {
+        size_t n = static_cast<size_t>(count);
+        if (n <= static_cast<size_t>(epptr() - pptr())) {
+            std::memcpy(pptr(), s, n);
+            pbump(static_cast<int>(n));
+            return count;
+        }
+        if (n < buffer.size()) {
+            size_t room = static_cast<size_t>(epptr() - pptr());
+            std::memcpy(pptr(), s, room);
+            pbump(static_cast<int>(room));
+            if (!drain()) {
+                return static_cast<std::streamsize>(room);
+            }
+            std::memcpy(pptr(), s + room, n - room);
+            pbump(static_cast<int>(n - room));
+            return count;
+        }
+        if (!drain() || !writeAll(s, n)) {
+            return 0;
+        }
+        return count;
+    }
+
+    int sync() override {
+        return drain() ? 0 : -1;
+    }
+
+public:
+    explicit BufferedWriter(int fd, size_t bufferSize = DEFAULT_BUFFER)
+        : fd(fd), buffer(bufferSize > 0 ? bufferSize : 1), failed(false) {
+        setp(buffer.data(), buffer.data() + buffer.size());
+    }
+
+    BufferedWriter(const BufferedWriter&) = delete;
+    BufferedWriter& operator=(const BufferedWriter&) = delete;
+
+    ~BufferedWriter() override {
+        drain();
+    }
+
+    // TRUE ONCE A write() HAS FAILED (E.G. THE READING END OF A PIPE CLOSED)
+    bool hasFailed() const {
+        return failed;
+    }
+};
+
+// A streambuf THAT APPENDS EVERYTHING TO text, FOR BUILDING A REPLY IN MEMORY
+class StringWriter : public std::streambuf {
+private:
+    std::string& text;
+
+protected:
+    int_type overflow(int_type ch) override {
+        if (!traits_type::eq_int_type(ch, traits_type::eof())) {
+            text.push_back(traits_type::to_char_type(ch));
+        }
+        return traits_type::not_eof(ch);
+    }
+
+    std::streamsize xsputn(const char* s, std::streamsize count) override {
+        text.append(s, static_cast<size_t>(count));
+        return count;
+    }
+
+public:
+    explicit StringWriter(std::string& text) : text(text) {}
+
+    StringWriter(const StringWriter&) = delete;
+    StringWriter& operator=(const StringWriter&) = delete;
+};
+
+#endif // COMMANDIO_H
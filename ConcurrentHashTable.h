@@ -0,0 +1,258 @@
+/************************************************************************
+* Programmer:              SURAKANTI SRISHANTH REDDY                    *
+* Class:                   CPTS 223                                     *
+* Programming Assignment:  PA 3                                         *
+* Date:                    OCTOBER 24, 2025                             *
+*                                                                       *
+* Description: 			   READ MOSTLY CONCURRENT HASH TABLE. LOOKUPS   *
+*                          TAKE NO LOCK, THEY PIN AN EPOCH AND WALK     *
+*                          CHAINS WHOSE NODES ARE NEVER CHANGED IN      *
+*                          PLACE. WRITERS LOCK ONE OF 64 STRIPES, SWAP  *
+*                          IN NEW NODES AND RETIRE THE OLD ONES.        *
+*                                                                       *
+************************************************************************/
+#pragma once
+#ifndef CONCURRENTHASHTABLE_H
+#define CONCURRENTHASHTABLE_H
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "EpochManager.h"
+
+template<typename K, typename V>
+class ConcurrentHashTable {
+private:
+    static const size_t STRIPES = 64;
+
+    // KEY AND VALUE NEVER CHANGE AFTER PUBLICATION, AN UPDATE REPLACES THE NODE
+    struct Node {
+        const K key;
+        const V value;
+        const size_t hash;
+        std::atomic<Node*> next;
+
+        Node(const K& k, const V& v, size_t h, Node* n) : key(k), value(v), hash(h), next(n) {}
+    };
+
+    // BUCKET COUNT IS A POWER OF TWO AND AT LEAST STRIPES, SO A BUCKET'S STRIPE
+    // (hash & (STRIPES - 1)) DOES NOT DEPEND ON THE TABLE SIZE
+    struct Table {
+        size_t mask;
+        std::unique_ptr<std::atomic<Node*>[]> buckets;
+
+        explicit Table(size_t size) : mask(size - 1), buckets(new std::atomic<Node*>[size]) {
+            for (size_t i = 0; i < size; i++) {
+                buckets[i].store(nullptr, std::memory_order_relaxed);
+            }
+        }
+    };
+
+    struct alignas(64) Stripe {
+        std::mutex mutex;
+    };
+
+    std::atomic<Table*> table;
+    Stripe stripes[STRIPES];
+    std::atomic<size_t> numElements;
+    std::hash<K> hashFunc;
+    mutable EpochManager epochs;
+
+    size_t hashOf(const K& key) const {
+        uint64_t h = static_cast<uint64_t>(hashFunc(key));
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdULL;
+        h ^= h >> 33;
+        return static_cast<size_t>(h);
+    }
+
+    static size_t roundUp(size_t n) {
+        size_t size = STRIPES;
+        while (size < n) {
+            size <<= 1;
+        }
+        return size;
+    }
+
+    static void deleteChains(Table* t) {
+        for (size_t i = 0; i <= t->mask; i++) {
+            Node* node = t->buckets[i].load();
+            while (node) {
+                Node* next = node->next.load();
+                delete node;
+                node = next;
+            }
+        }
+    }
+
+    // CALLER HOLDS NO STRIPE. LOCKS ALL OF THEM (IN ORDER), SO NO WRITER IS
+    // INSIDE A CHAIN, AND PUBLISHES A COPY WITH newSize BUCKETS. READERS STILL ON
+    // THE OLD TABLE FINISH THERE, IT IS FREED THROUGH THE EPOCH MANAGER
+    void resizeTo(size_t newSize, bool onlyIfCrowded) {
+        std::unique_lock<std::mutex> locks[STRIPES];
+        for (size_t i = 0; i < STRIPES; i++) {
+            locks[i] = std::unique_lock<std::mutex>(stripes[i].mutex);
+        }
+
+        Table* old = table.load();
+        if (onlyIfCrowded && numElements.load() <= (old->mask + 1) / 4 * 3) {
+            return;     // ANOTHER WRITER ALREADY GREW IT
+        }
+        if (newSize <= old->mask + 1) {
+            return;
+        }
+
+        Table* grown = new Table(newSize);
+        for (size_t i = 0; i <= old->mask; i++) {
+            for (Node* node = old->buckets[i].load(); node; node = node->next.load()) {
+                std::atomic<Node*>& head = grown->buckets[node->hash & grown->mask];
+                head.store(new Node(node->key, node->value, node->hash, head.load()));
+            }
+        }
+        table.store(grown);
+        epochs.retire([old] {
+            deleteChains(old);
+            delete old;
+        });
+    }
+
+public:
+    explicit ConcurrentHashTable(size_t size = 1024)
+        : table(new Table(roundUp(size))), numElements(0) {}
+
+    ConcurrentHashTable(const ConcurrentHashTable&) = delete;
+    ConcurrentHashTable& operator=(const ConcurrentHashTable&) = delete;
+
+    // NO THREAD MAY STILL BE USING THE TABLE
+    ~ConcurrentHashTable() {
+        Table* t = table.load();
+        deleteChains(t);
+        delete t;
+    }
+
+    // LOCK FREE. COPIES THE VALUE OUT WHILE THE NODE IS PINNED
+    bool find(const K& key, V& value) const {
+        size_t h = hashOf(key);
+        EpochManager::Guard guard(epochs);
+        Table* t = table.load();
+        for (Node* node = t->buckets[h & t->mask].load(); node; node = node->next.load()) {
+            if (node->hash == h && node->key == key) {
+                value = node->value;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool contains(const K& key) const {
+        V ignored;
+        return find(key, ignored);
+    }
+
+    // LOCK FREE. CALLS visit(value) WHILE THE NODE IS PINNED, FOR VALUES TOO BIG
+    // TO COPY. visit MUST NOT KEEP A REFERENCE PAST ITS RETURN
+    template<typename Visit>
+    bool read(const K& key, Visit&& visit) const {
+        size_t h = hashOf(key);
+        EpochManager::Guard guard(epochs);
+        Table* t = table.load();
+        for (Node* node = t->buckets[h & t->mask].load(); node; node = node->next.load()) {
+            if (node->hash == h && node->key == key) {
+                visit(node->value);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // INSERTS OR REPLACES. RETURNS TRUE IF THE KEY WAS NEW. A REPLACED VALUE IS
+    // SWAPPED IN AS A NEW NODE, SO A CONCURRENT READER SEES THE OLD OR THE NEW
+    // VALUE, NEVER A MIX
+    bool insert(const K& key, const V& value) {
+        size_t h = hashOf(key);
+        bool added = false;
+        size_t buckets;
+        {
+            std::lock_guard<std::mutex> lock(stripes[h & (STRIPES - 1)].mutex);
+            Table* t = table.load();
+            buckets = t->mask + 1;
+            std::atomic<Node*>& head = t->buckets[h & t->mask];
+
+            std::atomic<Node*>* link = &head;
+            Node* node = link->load();
+            while (node && !(node->hash == h && node->key == key)) {
+                link = &node->next;
+                node = link->load();
+            }
+
+            if (node) {
+                link->store(new Node(key, value, h, node->next.load()));
+                epochs.retire([node] { delete node; });
+            }
+            else {
+                head.store(new Node(key, value, h, head.load()));
+                numElements.fetch_add(1);
+                added = true;
+            }
+        }
+
+        // GROW AT LOAD 0.75, OUTSIDE THE STRIPE LOCK. THE TABLE IS NOT TOUCHED
+        // HERE, ANOTHER WRITER MAY ALREADY HAVE REPLACED AND RETIRED IT
+        if (added && numElements.load() > buckets / 4 * 3) {
+            resizeTo(buckets * 2, true);
+        }
+        return added;
+    }
+
+    // RETURNS TRUE IF THE KEY WAS THERE. READERS ALREADY ON THE NODE CAN STILL
+    // FOLLOW ITS next, THE NODE IS FREED ONCE THEY ARE GONE
+    bool remove(const K& key) {
+        size_t h = hashOf(key);
+        std::lock_guard<std::mutex> lock(stripes[h & (STRIPES - 1)].mutex);
+        Table* t = table.load();
+
+        std::atomic<Node*>* link = &t->buckets[h & t->mask];
+        Node* node = link->load();
+        while (node && !(node->hash == h && node->key == key)) {
+            link = &node->next;
+            node = link->load();
+        }
+        if (!node) {
+            return false;
+        }
+
+        link->store(node->next.load());
+        numElements.fetch_sub(1);
+        epochs.retire([node] { delete node; });
+        return true;
+    }
+
+    // PRE-SIZES FOR n KEYS AT LOAD 0.75
+    void reserve(size_t n) {
+        resizeTo(roundUp(n / 3 * 4 + 1), false);
+    }
+
+    // COUNT OF COMPLETED INSERTS MINUS COMPLETED REMOVES, EACH COUNTED AT THE
+    // MOMENT ITS NODE IS LINKED OR UNLINKED
+    size_t size() const {
+        return numElements.load();
+    }
+
+    bool empty() const {
+        return size() == 0;
+    }
+
+    size_t bucketCount() const {
+        return table.load()->mask + 1;
+    }
+
+    // NODES WAITING FOR READERS TO LEAVE BEFORE THEY CAN BE FREED
+    size_t pendingReclaim() const {
+        return epochs.pending();
+    }
+};
+
+#endif // CONCURRENTHASHTABLE_H
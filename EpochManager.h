@@ -0,0 +1,171 @@
+/************************************************************************
+* Programmer:              SURAKANTI SRISHANTH REDDY                    *
+* Class:                   CPTS 223                                     *
+* Programming Assignment:  PA 3                                         *
+* Date:                    OCTOBER 24, 2025                             *
+*                                                                       *
+* Description: 			   EPOCH BASED RECLAMATION. READERS PIN THE     *
+*                          CURRENT EPOCH WHILE THEY WALK SHARED NODES,  *
+*                          WRITERS retire() WHAT THEY UNLINK AND IT IS  *
+*                          ONLY FREED ONCE EVERY READER THAT COULD      *
+*                          STILL SEE IT HAS LEFT.                       *
+*                                                                       *
+************************************************************************/
+#pragma once
+#ifndef EPOCHMANAGER_H
+#define EPOCHMANAGER_H
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+class EpochManager {
+public:
+    static const size_t MAX_THREADS = 256;
+
+private:
+    static const uint64_t IDLE = UINT64_MAX;
+    static const size_t RECLAIM_BATCH = 64;
+
+    // ONE CACHE LINE PER THREAD SO PINNING NEVER CONTENDS
+    struct alignas(64) Slot {
+        std::atomic<uint64_t> epoch{ IDLE };
+    };
+
+    struct Retired {
+        uint64_t epoch;
+        std::function<void()> free;
+    };
+
+    Slot slots[MAX_THREADS];
+    std::atomic<uint64_t> globalEpoch{ 1 };
+    std::mutex retireMutex;
+    std::vector<Retired> retired;
+
+    // EVERY LIVE THREAD OWNS ONE SLOT INDEX, SHARED BY ALL MANAGERS AND HANDED
+    // BACK WHEN THE THREAD EXITS
+    static std::mutex& registryMutex() {
+        static std::mutex mutex;
+        return mutex;
+    }
+
+    static std::vector<bool>& registry() {
+        static std::vector<bool> used(MAX_THREADS, false);
+        return used;
+    }
+
+    struct Registration {
+        size_t index;
+        Registration() : index(MAX_THREADS) {
+            std::lock_guard<std::mutex> lock(registryMutex());
+            std::vector<bool>& used = registry();
+            for (size_t i = 0; i < MAX_THREADS; i++) {
+                if (!used[i]) {
+                    used[i] = true;
+                    index = i;
+                    return;
+                }
+            }
+            throw std::runtime_error("EpochManager: MORE THAN MAX_THREADS THREADS");
+        }
+        ~Registration() {
+            std::lock_guard<std::mutex> lock(registryMutex());
+            registry()[index] = false;
+        }
+    };
+
+    static size_t threadIndex() {
+        thread_local Registration registration;
+        return registration.index;
+    }
+
+    // FREES EVERYTHING RETIRED BEFORE THE OLDEST PINNED EPOCH, CALLER HOLDS retireMutex
+    size_t reclaimLocked() {
+        globalEpoch.fetch_add(1);
+        uint64_t oldest = IDLE;
+        for (size_t i = 0; i < MAX_THREADS; i++) {
+            uint64_t pinned = slots[i].epoch.load();
+            if (pinned < oldest) {
+                oldest = pinned;
+            }
+        }
+
+        size_t kept = 0;
+        size_t freed = 0;
+        for (size_t i = 0; i < retired.size(); i++) {
+            if (retired[i].epoch < oldest) {
+                retired[i].free();
+                freed++;
+            }
+            else {
+                retired[kept++] = std::move(retired[i]);
+            }
+        }
+        retired.resize(kept);
+        return freed;
+    }
+
+public:
+    EpochManager() {}
+
+    EpochManager(const EpochManager&) = delete;
+    EpochManager& operator=(const EpochManager&) = delete;
+
+    // NO READERS MAY BE LEFT WHEN THE MANAGER DIES
+    ~EpochManager() {
+        for (Retired& item : retired) {
+            item.free();
+        }
+    }
+
+    // PINS THE CURRENT EPOCH FOR ITS LIFETIME. NESTED GUARDS ON ONE THREAD KEEP
+    // THE OUTERMOST PIN
+    class Guard {
+    private:
+        std::atomic<uint64_t>* slot;
+
+    public:
+        explicit Guard(EpochManager& manager) : slot(&manager.slots[threadIndex()].epoch) {
+            if (slot->load(std::memory_order_relaxed) != IDLE) {
+                slot = nullptr;
+                return;
+            }
+            // SEQ_CST SO THE PIN IS VISIBLE BEFORE ANY SHARED POINTER IS LOADED
+            slot->store(manager.globalEpoch.load());
+        }
+
+        ~Guard() {
+            if (slot) {
+                slot->store(IDLE, std::memory_order_release);
+            }
+        }
+
+        Guard(const Guard&) = delete;
+        Guard& operator=(const Guard&) = delete;
+    };
+
+    // free RUNS ONCE NO READER CAN STILL HOLD WHAT WAS UNLINKED. CALL AFTER THE
+    // OBJECT IS UNREACHABLE FROM THE SHARED STRUCTURE
+    void retire(std::function<void()> free) {
+        std::lock_guard<std::mutex> lock(retireMutex);
+        retired.push_back(Retired{ globalEpoch.load(), std::move(free) });
+        if (retired.size() >= RECLAIM_BATCH) {
+            reclaimLocked();
+        }
+    }
+
+    size_t reclaim() {
+        std::lock_guard<std::mutex> lock(retireMutex);
+        return reclaimLocked();
+    }
+
+    size_t pending() {
+        std::lock_guard<std::mutex> lock(retireMutex);
+        return retired.size();
+    }
+};
+
+#endif // EPOCHMANAGER_H
@@ -0,0 +1,368 @@
+/************************************************************************
+* Programmer:              SURAKANTI SRISHANTH REDDY                    *
+* Class:                   CPTS 223                                     *
+* Programming Assignment:  PA 3                                         *
+* Date:                    OCTOBER 24, 2025                             *
+*                                                                       *
+* Description: 			   OPEN ADDRESSING HASH TABLE WITH THE SAME API *
+*                          AS HashTable. KEYS AND VALUES LIVE IN ONE    *
+*                          CONTIGUOUS SLOT ARRAY AND EVERY SLOT HAS A   *
+*                          ONE BYTE CONTROL CODE (SWISSTABLE STYLE) SO  *
+*                          A PROBE SCANS 16 CONTROL BYTES AT A TIME     *
+*                          INSTEAD OF CHASING Node* POINTERS.           *
+*                                                                       *
+************************************************************************/
+#pragma once
+#ifndef FLATHASHTABLE_H
+#define FLATHASHTABLE_H
+
+#include <cstdint>
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <new>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// Hash IS ANY FUNCTOR FROM const K& TO size_t, KEYS ARE COMPARED WITH ==
+template<typename K, typename V, typename Hash = std::hash<K>>
+class FlatHashTable {
+private:
+    struct Slot {
+        K key;
+        V value;
+    };
+
+    // CONTROL BYTES: NEGATIVE = FREE (EMPTY OR TOMBSTONE), 0..127 = FULL (LOW 7 HASH BITS)
+    enum : int8_t { EMPTY = -128, DELETED = -2 };
+    enum : size_t { GROUP = 16 };
+
+    std::vector<int8_t> ctrl;   // capacity + GROUP BYTES, THE TAIL MIRRORS THE FIRST GROUP
+    Slot* slots;
+    size_t capacity;            // ALWAYS A POWER OF TWO >= GROUP
+    size_t numElements;
+    size_t numDeleted;
+    double maxLoadFactor;
+    Hash hashFunc;
+
+    // std::hash IS THE IDENTITY FOR INTEGERS, SO MIX THE BITS BEFORE SPLITTING
+    size_t hash(const K& key) const {
+        uint64_t h = static_cast<uint64_t>(hashFunc(key));
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdULL;
+        h ^= h >> 33;
+        return static_cast<size_t>(h);
+    }
+
+    static int8_t h2(size_t h) { return static_cast<int8_t>(h & 0x7F); }
+    static size_t h1(size_t h) { return h >> 7; }
+
+    static size_t roundUpPow2(size_t n) {
+        size_t cap = GROUP;
+        while (cap < n) cap <<= 1;
+        return cap;
+    }
+
+    void setCtrl(size_t i, int8_t c) {
+        ctrl[i] = c;
+        if (i < GROUP) {
+            ctrl[capacity + i] = c;
+        }
+    }
+
+    // BIT i SET WHEN ctrl[pos + i] == c
+    uint32_t matchByte(size_t pos, int8_t c) const {
+#if defined(__SSE2__)
+        __m128i group = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&ctrl[pos]));
+        return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(group, _mm_set1_epi8(c))));
+#else
+        uint32_t mask = 0;
+        for (size_t i = 0; i < GROUP; i++) {
+            if (ctrl[pos + i] == c) mask |= (1u << i);
+        }
+        return mask;
+#endif
+    }
+
+    // BIT i SET WHEN ctrl[pos + i] IS EMPTY OR A TOMBSTONE (SIGN BIT SET)
+    uint32_t matchFree(size_t pos) const {
+#if defined(__SSE2__)
+        __m128i group = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&ctrl[pos]));
+        return static_cast<uint32_t>(_mm_movemask_epi8(group));
+#else
+        uint32_t mask = 0;
+        for (size_t i = 0; i < GROUP; i++) {
+            if (ctrl[pos + i] < 0) mask |= (1u << i);
+        }
+        return mask;
+#endif
+    }
+
+    static unsigned lowestBit(uint32_t mask) {
+        return static_cast<unsigned>(__builtin_ctz(mask));
+    }
+
+    // RETURNS THE SLOT INDEX OF key OR capacity IF ABSENT
+    size_t findIndex(const K& key, size_t h) const {
+        const int8_t tag = h2(h);
+        const size_t mask = capacity - 1;
+        size_t pos = h1(h) & mask;
+
+        for (size_t probe = 0; probe <= capacity / GROUP; probe++) {
+            uint32_t hits = matchByte(pos, tag);
+            while (hits) {
+                size_t idx = (pos + lowestBit(hits)) & mask;
+                if (slots[idx].key == key) {
+                    return idx;
+                }
+                hits &= hits - 1;
+            }
+            // AN EMPTY BYTE ENDS THE PROBE SEQUENCE, TOMBSTONES DO NOT
+            if (matchByte(pos, EMPTY)) {
+                return capacity;
+            }
+            pos = (pos + GROUP * (probe + 1)) & mask;
+        }
+        return capacity;
+    }
+
+    // FIRST EMPTY OR DELETED SLOT ON THE PROBE SEQUENCE OF h
+    size_t findFreeIndex(size_t h) const {
+        const size_t mask = capacity - 1;
+        size_t pos = h1(h) & mask;
+
+        for (size_t probe = 0; probe <= capacity / GROUP; probe++) {
+            uint32_t avail = matchFree(pos);
+            if (avail) {
+                return (pos + lowestBit(avail)) & mask;
+            }
+            pos = (pos + GROUP * (probe + 1)) & mask;
+        }
+        throw std::runtime_error("FlatHashTable: NO FREE SLOT");
+    }
+
+    void allocate(size_t cap) {
+        capacity = cap;
+        ctrl.assign(capacity + GROUP, static_cast<int8_t>(EMPTY));
+        slots = static_cast<Slot*>(::operator new(capacity * sizeof(Slot)));
+        numElements = 0;
+        numDeleted = 0;
+    }
+
+    void destroySlots() {
+        for (size_t i = 0; i < capacity; i++) {
+            if (ctrl[i] >= 0) {
+                slots[i].~Slot();
+            }
+        }
+    }
+
+    // MOVES EVERY LIVE SLOT INTO A FRESH ARRAY, DROPPING ALL TOMBSTONES
+    void rehash(size_t newCapacity) {
+        std::vector<int8_t> oldCtrl;
+        oldCtrl.swap(ctrl);
+        Slot* oldSlots = slots;
+        size_t oldCapacity = capacity;
+
+        allocate(newCapacity);
+
+        for (size_t i = 0; i < oldCapacity; i++) {
+            if (oldCtrl[i] >= 0) {
+                size_t h = hash(oldSlots[i].key);
+                size_t idx = findFreeIndex(h);
+                new (&slots[idx]) Slot{ std::move(oldSlots[i].key), std::move(oldSlots[i].value) };
+                setCtrl(idx, h2(h));
+                numElements++;
+                oldSlots[i].~Slot();
+            }
+        }
+        ::operator delete(oldSlots);
+    }
+
+    void growIfNeeded() {
+        if (static_cast<double>(numElements + numDeleted + 1) <= capacity * maxLoadFactor) {
+            return;
+        }
+        // MOSTLY TOMBSTONES: CLEAN UP IN PLACE INSTEAD OF DOUBLING
+        if (numDeleted > numElements) {
+            rehash(capacity);
+        }
+        else {
+            rehash(capacity * 2);
+        }
+    }
+
+public:
+    FlatHashTable(size_t size = 16, double maxLoad = 0.875)
+        : slots(nullptr), capacity(0), numElements(0), numDeleted(0),
+        maxLoadFactor(maxLoad) {
+        if (maxLoad <= 0.0 || maxLoad >= 1.0) {
+            throw std::invalid_argument("FlatHashTable: MAX LOAD FACTOR MUST BE IN (0, 1)");
+        }
+        allocate(roundUpPow2(size));
+    }
+
+    FlatHashTable(const FlatHashTable&) = delete;
+    FlatHashTable& operator=(const FlatHashTable&) = delete;
+
+    ~FlatHashTable() {
+        destroySlots();
+        ::operator delete(slots);
+    }
+
+    void insert(const K& key, const V& value) {
+        size_t h = hash(key);
+        size_t idx = findIndex(key, h);
+
+        // UPDATES IF THE KEY EXISTS
+        if (idx != capacity) {
+            slots[idx].value = value;
+            return;
+        }
+
+        growIfNeeded();
+        idx = findFreeIndex(h);
+        if (ctrl[idx] == DELETED) {
+            numDeleted--;
+        }
+        new (&slots[idx]) Slot{ key, value };
+        setCtrl(idx, h2(h));
+        numElements++;
+    }
+
+    // MOVES THE KEY AND VALUE INTO THE TABLE INSTEAD OF COPYING THEM
+    void insert(K&& key, V&& value) {
+        size_t h = hash(key);
+        size_t idx = findIndex(key, h);
+
+        if (idx != capacity) {
+            slots[idx].value = std::move(value);
+            return;
+        }
+
+        growIfNeeded();
+        idx = findFreeIndex(h);
+        if (ctrl[idx] == DELETED) {
+            numDeleted--;
+        }
+        new (&slots[idx]) Slot{ std::move(key), std::move(value) };
+        setCtrl(idx, h2(h));
+        numElements++;
+    }
+
+    // CONSTRUCTS THE VALUE IN PLACE FROM args ONLY IF THE KEY IS MISSING
+    // THE RETURNED POINTER IS INVALIDATED BY THE NEXT INSERT THAT GROWS THE TABLE
+    template<typename... Args>
+    std::pair<V*, bool> tryEmplace(const K& key, Args&&... args) {
+        size_t h = hash(key);
+        size_t idx = findIndex(key, h);
+
+        if (idx != capacity) {
+            return std::make_pair(&slots[idx].value, false);
+        }
+
+        growIfNeeded();
+        idx = findFreeIndex(h);
+        if (ctrl[idx] == DELETED) {
+            numDeleted--;
+        }
+        new (&slots[idx]) Slot{ key, V(std::forward<Args>(args)...) };
+        setCtrl(idx, h2(h));
+        numElements++;
+        return std::make_pair(&slots[idx].value, true);
+    }
+
+    V& findOrInsert(const K& key) {
+        return *tryEmplace(key).first;
+    }
+
+    V* findPtr(const K& key) {
+        size_t idx = findIndex(key, hash(key));
+        return idx == capacity ? nullptr : &slots[idx].value;
+    }
+
+    const V* findPtr(const K& key) const {
+        size_t idx = findIndex(key, hash(key));
+        return idx == capacity ? nullptr : &slots[idx].value;
+    }
+
+    bool find(const K& key, V& value) const {
+        size_t idx = findIndex(key, hash(key));
+        if (idx == capacity) {
+            return false;
+        }
+        value = slots[idx].value;
+        return true;
+    }
+
+    bool contains(const K& key) const {
+        return findIndex(key, hash(key)) != capacity;
+    }
+
+    // LEAVES A TOMBSTONE SO PROBE SEQUENCES THROUGH THIS SLOT STAY INTACT
+    bool remove(const K& key) {
+        size_t idx = findIndex(key, hash(key));
+        if (idx == capacity) {
+            return false;
+        }
+        slots[idx].~Slot();
+        setCtrl(idx, DELETED);
+        numElements--;
+        numDeleted++;
+        return true;
+    }
+
+    void clear() {
+        destroySlots();
+        std::fill(ctrl.begin(), ctrl.end(), static_cast<int8_t>(EMPTY));
+        numElements = 0;
+        numDeleted = 0;
+    }
+
+    void setMaxLoadFactor(double maxLoad) {
+        if (maxLoad <= 0.0 || maxLoad >= 1.0) {
+            throw std::invalid_argument("FlatHashTable: MAX LOAD FACTOR MUST BE IN (0, 1)");
+        }
+        maxLoadFactor = maxLoad;
+    }
+
+    double loadFactor() const {
+        return static_cast<double>(numElements) / capacity;
+    }
+
+    size_t bucketCount() const {
+        return capacity;
+    }
+
+    size_t size() const {
+        return numElements;
+    }
+
+    bool empty() const {
+        return numElements == 0;
+    }
+
+    // BYTES HELD BY THE SLOT AND CONTROL ARRAYS (NOT WHAT THE KEYS POINT AT)
+    size_t memoryUsage() const {
+        return capacity * sizeof(Slot) + ctrl.capacity();
+    }
+
+    // GETS ALL KEYS
+    std::vector<K> getAllKeys() const {
+        std::vector<K> keys;
+        keys.reserve(numElements);
+        for (size_t i = 0; i < capacity; i++) {
+            if (ctrl[i] >= 0) {
+                keys.push_back(slots[i].key);
+            }
+        }
+        return keys;
+    }
+};
+
+#endif // FLATHASHTABLE_H
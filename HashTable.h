@@ -21,8 +21,15 @@
 #include <functional>
 #include <vector>
 #include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include "Arena.h"
+#include "Stats.h"
 
-template<typename K, typename V>
+// Hash IS ANY FUNCTOR FROM const K& TO size_t, KEYS ARE COMPARED WITH ==
+template<typename K, typename V, typename Hash = std::hash<K>>
 class HashTable {
 private:
     struct Node {
@@ -30,99 +37,230 @@ private:
         V value;
         Node* next;
 
-        Node(const K& k, const V& v) : key(k), value(v), next(nullptr) {}
+        template<typename KK, typename... Args>
+        Node(KK&& k, Args&&... args)
+            : key(std::forward<KK>(k)), value(std::forward<Args>(args)...), next(nullptr) {}
     };
 
     std::vector<Node*> table;
     size_t tableSize;
     size_t numElements;
-    std::hash<K> hashFunc;
+    Hash hashFunc;
 
-    size_t hash(const K& key) const {
-        return hashFunc(key) % tableSize;
-    }
+    // INCREMENTAL REHASH STATE: WHILE oldTable IS NOT EMPTY, ITS BUCKETS FROM
+    // migrateIndex ONWARDS STILL HOLD NODES THAT HAVE NOT MOVED TO table YET
+    std::vector<Node*> oldTable;
+    size_t oldTableSize;
+    size_t migrateIndex;
+    bool incremental;
+    size_t bucketsPerStep;
 
-    void rehash() {
-        std::vector<Node*> oldTable = table;
-        tableSize *= 2;
-        table.clear();
-        table.resize(tableSize, nullptr);
-        numElements = 0;
+    // WHEN SET, NODES ARE CARVED OUT OF THE ARENA AND REMOVED ONES ARE RECYCLED
+    // THROUGH freeNodes INSTEAD OF GOING BACK TO THE HEAP
+    Arena* arena;
+    void* freeNodes;
 
-        for (Node* head : oldTable) {
-            Node* curr = head;
-            while (curr) {
-                insert(curr->key, curr->value);
-                Node* temp = curr;
-                curr = curr->next;
-                delete temp;
-            }
+#ifdef INVENTORY_STATS
+    // PLAIN COUNTERS, A STATS BUILD IS NOT FOR TABLES READ FROM SEVERAL THREADS AT ONCE
+    mutable HashTableStats counters;
+#endif
+
+    static const bool TRIVIAL_NODES =
+        std::is_trivially_destructible<K>::value && std::is_trivially_destructible<V>::value;
+
+    template<typename KK, typename... Args>
+    Node* newNode(KK&& k, Args&&... args) {
+        if (!arena) {
+            return new Node(std::forward<KK>(k), std::forward<Args>(args)...);
         }
+        void* mem = freeNodes;
+        if (mem) {
+            freeNodes = *static_cast<void**>(mem);
+        }
+        else {
+            mem = arena->allocate(sizeof(Node), alignof(Node));
+        }
+        return new (mem) Node(std::forward<KK>(k), std::forward<Args>(args)...);
     }
 
-public:
-    HashTable(size_t size = 101) : tableSize(size), numElements(0) {
-        table.resize(tableSize, nullptr);
+    void freeNode(Node* node) {
+        if (!arena) {
+            delete node;
+            return;
+        }
+        node->~Node();
+        *reinterpret_cast<void**>(node) = freeNodes;
+        freeNodes = node;
     }
 
-    ~HashTable() {
-        clear();
+    size_t hash(const K& key) const {
+        return hashFunc(key) % tableSize;
     }
 
-    void insert(const K& key, const V& value) {
-        if (static_cast<double>(numElements) / tableSize > 0.75) {
-            rehash();
-        }
+    bool overLoaded() const {
+        return static_cast<double>(numElements) / tableSize > 0.75;
+    }
 
-        size_t idx = hash(key);
-        Node* curr = table[idx];
+    bool migrating() const {
+        return !oldTable.empty();
+    }
 
-        // UPDATES IF THE KEY EXISTS
+    static Node* findInChain(Node* curr, const K& key) {
         while (curr) {
             if (curr->key == key) {
-                curr->value = value;
-                return;
+                return curr;
             }
             curr = curr->next;
         }
-
-        // INSERTS NEW NODE IN THE BEGINING
-        Node* newNode = new Node(key, value);
-        newNode->next = table[idx];
-        table[idx] = newNode;
-        numElements++;
+        return nullptr;
     }
 
-    bool find(const K& key, V& value) const {
-        size_t idx = hash(key);
-        Node* curr = table[idx];
-
+#ifdef INVENTORY_STATS
+    // findInChain() THAT ALSO COUNTS THE NODES IT COMPARED
+    static Node* findInChain(Node* curr, const K& key, size_t& probes) {
         while (curr) {
+            probes++;
             if (curr->key == key) {
-                value = curr->value;
-                return true;
+                return curr;
             }
             curr = curr->next;
         }
-        return false;
+        return nullptr;
     }
 
-    bool contains(const K& key) const {
-        size_t idx = hash(key);
-        Node* curr = table[idx];
+    void countFind(size_t probes, bool hit) const {
+        counters.finds++;
+        counters.hits += hit ? 1 : 0;
+        counters.probes.add(probes);
+    }
+#endif
+
+    // WHERE A KEY KEEPS ITS BYTES, SO A BATCH LOOKUP CAN PREFETCH THEM BEFORE
+    // THE COMPARE. NULL FOR KEYS THAT ARE ALL INLINE
+    template<typename T>
+    static const void* keyBytes(const T&) { return nullptr; }
+    static const void* keyBytes(const std::string& key) { return key.data(); }
+    static const void* keyBytes(const std::string_view& key) { return key.data(); }
+
+    Node* findNode(const K& key) const {
+#ifdef INVENTORY_STATS
+        size_t probes = 0;
+        Node* node = findInChain(table[hash(key)], key, probes);
+        if (!node && migrating()) {
+            node = findInChain(oldTable[hashFunc(key) % oldTableSize], key, probes);
+        }
+        countFind(probes, node != nullptr);
+        return node;
+#else
+        Node* node = findInChain(table[hash(key)], key);
+        if (!node && migrating()) {
+            node = findInChain(oldTable[hashFunc(key) % oldTableSize], key);
+        }
+        return node;
+#endif
+    }
+
+    // INSERTS NEW NODE IN THE BEGINING OF ITS BUCKET
+    void linkFront(Node* node) {
+        size_t idx = hash(node->key);
+        node->next = table[idx];
+        table[idx] = node;
+    }
 
+    // RELINKS EVERY NODE OF ONE OLD BUCKET INTO table, NOTHING IS ALLOCATED OR COPIED
+    void migrateBucket(size_t i) {
+        Node* curr = oldTable[i];
+        oldTable[i] = nullptr;
         while (curr) {
-            if (curr->key == key) {
-                return true;
-            }
+            Node* next = curr->next;
+            linkFront(curr);
+            curr = next;
+        }
+    }
+
+    void migrateStep(size_t buckets) {
+        if (!migrating()) {
+            return;
+        }
+        size_t end = migrateIndex + buckets;
+        if (end > oldTableSize) {
+            end = oldTableSize;
+        }
+#ifdef INVENTORY_STATS
+        counters.migratedBuckets += end - migrateIndex;
+#endif
+        for (; migrateIndex < end; migrateIndex++) {
+            migrateBucket(migrateIndex);
+        }
+        if (migrateIndex == oldTableSize) {
+            std::vector<Node*>().swap(oldTable);
+        }
+    }
+
+    void finishMigration() {
+        migrateStep(oldTableSize);
+    }
+
+    void resizeTo(size_t newSize) {
+#ifdef INVENTORY_STATS
+        uint64_t start = Stats::nanosNow();
+#endif
+        finishMigration();
+        oldTable.swap(table);
+        oldTableSize = tableSize;
+        migrateIndex = 0;
+
+        tableSize = newSize;
+        table.assign(tableSize, nullptr);
+
+        // EAGER MODE MOVES EVERYTHING NOW, INCREMENTAL MODE SPREADS IT OVER LATER CALLS
+        if (!incremental) {
+            finishMigration();
+        }
+#ifdef INVENTORY_STATS
+        uint64_t nanos = Stats::nanosNow() - start;
+        counters.rehashes++;
+        counters.rehashNanos += nanos;
+        if (nanos > counters.longestRehashNanos) {
+            counters.longestRehashNanos = nanos;
+        }
+#endif
+    }
+
+    void rehash() {
+        resizeTo(tableSize * 2);
+    }
+
+    // EVERY MUTATION PAYS FOR A FEW BUCKETS OF AN IN PROGRESS REHASH
+    void migrateShare() {
+#ifdef INVENTORY_STATS
+        if (migrating()) {
+            uint64_t start = Stats::nanosNow();
+            migrateStep(bucketsPerStep);
+            counters.rehashNanos += Stats::nanosNow() - start;
+            return;
+        }
+#endif
+        migrateStep(bucketsPerStep);
+    }
+
+    void beforeInsert() {
+        migrateShare();
+        if (overLoaded()) {
+            rehash();
+        }
+    }
+
+    void deleteChain(Node* curr) {
+        while (curr) {
+            Node* temp = curr;
             curr = curr->next;
+            freeNode(temp);
         }
-        return false;
     }
 
-    bool remove(const K& key) {
-        size_t idx = hash(key);
-        Node* curr = table[idx];
+    bool unlink(std::vector<Node*>& buckets, size_t idx, const K& key) {
+        Node* curr = buckets[idx];
         Node* prev = nullptr;
 
         while (curr) {
@@ -131,10 +269,9 @@ public:
                     prev->next = curr->next;
                 }
                 else {
-                    table[idx] = curr->next;
+                    buckets[idx] = curr->next;
                 }
-                delete curr;
-                numElements--;
+                freeNode(curr);
                 return true;
             }
             prev = curr;
@@ -143,20 +280,219 @@ public:
         return false;
     }
 
+public:
+    HashTable(size_t size = 101)
+        : tableSize(size), numElements(0), oldTableSize(0), migrateIndex(0),
+        incremental(false), bucketsPerStep(8), arena(nullptr), freeNodes(nullptr) {
+        table.resize(tableSize, nullptr);
+    }
+
+    HashTable(const HashTable&) = delete;
+    HashTable& operator=(const HashTable&) = delete;
+
+    ~HashTable() {
+        clear();
+    }
+
+    void insert(const K& key, const V& value) {
+        beforeInsert();
+
+        // UPDATES IF THE KEY EXISTS
+        Node* existing = findNode(key);
+        if (existing) {
+            existing->value = value;
+            return;
+        }
+
+        linkFront(newNode(key, value));
+        numElements++;
+    }
+
+    // MOVES THE KEY AND VALUE INTO THE TABLE INSTEAD OF COPYING THEM
+    void insert(K&& key, V&& value) {
+        beforeInsert();
+
+        Node* existing = findNode(key);
+        if (existing) {
+            existing->value = std::move(value);
+            return;
+        }
+
+        linkFront(newNode(std::move(key), std::move(value)));
+        numElements++;
+    }
+
+    // CONSTRUCTS THE VALUE IN PLACE FROM args ONLY IF THE KEY IS MISSING
+    // RETURNS A POINTER TO THE STORED VALUE AND WHETHER IT WAS INSERTED
+    template<typename... Args>
+    std::pair<V*, bool> tryEmplace(const K& key, Args&&... args) {
+        beforeInsert();
+
+        Node* existing = findNode(key);
+        if (existing) {
+            return std::make_pair(&existing->value, false);
+        }
+
+        Node* node = newNode(key, std::forward<Args>(args)...);
+        linkFront(node);
+        numElements++;
+        return std::make_pair(&node->value, true);
+    }
+
+    // RETURNS THE STORED VALUE, DEFAULT CONSTRUCTING IT FIRST IF THE KEY IS MISSING
+    V& findOrInsert(const K& key) {
+        return *tryEmplace(key).first;
+    }
+
+    // POINTER TO THE STORED VALUE OR nullptr, NOTHING IS COPIED
+    // THE POINTER STAYS VALID UNTIL THE KEY IS REMOVED OR THE TABLE IS CLEARED
+    // (REHASHING RELINKS NODES, IT NEVER MOVES THEM)
+    V* findPtr(const K& key) {
+        Node* node = findNode(key);
+        return node ? &node->value : nullptr;
+    }
+
+    const V* findPtr(const K& key) const {
+        Node* node = findNode(key);
+        return node ? &node->value : nullptr;
+    }
+
+    bool find(const K& key, V& value) const {
+        Node* node = findNode(key);
+        if (node) {
+            value = node->value;
+            return true;
+        }
+        return false;
+    }
+
+    bool contains(const K& key) const {
+        return findNode(key) != nullptr;
+    }
+
+    // LOOKS UP keys[0 .. count) AND SETS results[i] TO THE VALUE OF keys[i] OR
+    // nullptr. ALL BUCKETS OF A BLOCK ARE HASHED FIRST, THEN EACH BUCKET SLOT,
+    // CHAIN HEAD AND HEAD KEY IS PREFETCHED A FEW KEYS BEFORE IT IS NEEDED, SO
+    // THE CACHE MISSES OF NEIGHBOURING LOOKUPS OVERLAP INSTEAD OF QUEUEING
+    void findBatch(const K* keys, size_t count, const V** results) const {
+        if (migrating()) {
+            for (size_t i = 0; i < count; i++) {
+                Node* node = findNode(keys[i]);
+                results[i] = node ? &node->value : nullptr;
+            }
+            return;
+        }
+
+        const size_t BLOCK = 64;
+        const size_t NODE_AHEAD = 8;        // KEYS BETWEEN PREFETCHING A HEAD NODE AND USING IT
+        const size_t KEY_AHEAD = 4;         // ... AND ITS KEY BYTES
+        size_t bucket[BLOCK];
+        for (size_t start = 0; start < count; start += BLOCK) {
+            size_t n = count - start < BLOCK ? count - start : BLOCK;
+            const K* block = keys + start;
+
+            for (size_t i = 0; i < n; i++) {
+                bucket[i] = hash(block[i]);
+                __builtin_prefetch(&table[bucket[i]]);
+            }
+            for (size_t i = 0; i < NODE_AHEAD && i < n; i++) {
+                __builtin_prefetch(table[bucket[i]]);
+            }
+
+            for (size_t i = 0; i < n; i++) {
+                if (i + NODE_AHEAD < n) {
+                    __builtin_prefetch(table[bucket[i + NODE_AHEAD]]);
+                }
+                if (i + KEY_AHEAD < n) {
+                    Node* head = table[bucket[i + KEY_AHEAD]];
+                    const void* bytes = head ? keyBytes(head->key) : nullptr;
+                    if (bytes) {
+                        __builtin_prefetch(bytes);
+                    }
+                }
+#ifdef INVENTORY_STATS
+                size_t probes = 0;
+                Node* node = findInChain(table[bucket[i]], block[i], probes);
+                countFind(probes, node != nullptr);
+#else
+                Node* node = findInChain(table[bucket[i]], block[i]);
+#endif
+                results[start + i] = node ? &node->value : nullptr;
+            }
+        }
+    }
+
+    bool remove(const K& key) {
+        migrateShare();
+
+        bool removed = unlink(table, hash(key), key);
+        if (!removed && migrating()) {
+            removed = unlink(oldTable, hashFunc(key) % oldTableSize, key);
+        }
+        if (removed) {
+            numElements--;
+        }
+        return removed;
+    }
+
+    // ARENA NODES WITH TRIVIAL KEYS AND VALUES NEED NO PER NODE WORK, THE ARENA
+    // OWNER RELEASES THEIR MEMORY IN BULK
     void clear() {
-        for (Node* head : table) {
-            Node* curr = head;
-            while (curr) {
-                Node* temp = curr;
-                curr = curr->next;
-                delete temp;
+        if (!arena || !TRIVIAL_NODES) {
+            for (Node* head : table) {
+                deleteChain(head);
+            }
+            for (Node* head : oldTable) {
+                deleteChain(head);
             }
         }
+        freeNodes = nullptr;
+        std::vector<Node*>().swap(oldTable);
         table.clear();
         table.resize(tableSize, nullptr);
         numElements = 0;
     }
 
+    // MAKES ROOM FOR n ELEMENTS WITHOUT CROSSING THE LOAD FACTOR, SO A BULK LOAD
+    // OF n KEYS NEVER REHASHES
+    void reserve(size_t n) {
+        size_t needed = static_cast<size_t>(n / 0.75) + 1;
+        if (needed > tableSize) {
+            bool wasIncremental = incremental;
+            incremental = false;
+            resizeTo(needed);
+            incremental = wasIncremental;
+        }
+    }
+
+    // ALLOCATES ALL FUTURE NODES FROM source, WHICH MUST OUTLIVE THE TABLE.
+    // ONLY ALLOWED WHILE THE TABLE IS EMPTY
+    void useArena(Arena* source) {
+        if (numElements != 0) {
+            throw std::logic_error("HashTable: useArena ON A NON EMPTY TABLE");
+        }
+        arena = source;
+        freeNodes = nullptr;
+    }
+
+    // WHEN ENABLED A REHASH ONLY ALLOCATES THE NEW BUCKET ARRAY, THEN EACH
+    // insert / tryEmplace / remove MIGRATES bucketsPerStep OLD BUCKETS
+    void setIncrementalRehash(bool enabled, size_t buckets = 8) {
+        if (!enabled) {
+            finishMigration();
+        }
+        incremental = enabled;
+        bucketsPerStep = buckets == 0 ? 1 : buckets;
+    }
+
+    bool isRehashing() const {
+        return migrating();
+    }
+
+    size_t bucketCount() const {
+        return tableSize;
+    }
+
     size_t size() const {
         return numElements;
     }
@@ -165,9 +501,44 @@ public:
         return numElements == 0;
     }
 
+    // BUCKET OCCUPANCY FROM A SCAN OF table (BUCKETS STILL WAITING IN AN IN
+    // PROGRESS REHASH ARE LEFT OUT) PLUS, IN STATS BUILDS, THE COUNTERS SINCE
+    // CONSTRUCTION OR THE LAST resetStats()
+    HashTableStats stats() const {
+        HashTableStats result;
+#ifdef INVENTORY_STATS
+        result = counters;
+#endif
+        result.size = numElements;
+        result.buckets = tableSize;
+        result.loadFactor = static_cast<double>(numElements) / tableSize;
+        result.rehashing = migrating();
+        for (Node* head : table) {
+            size_t length = 0;
+            for (Node* curr = head; curr; curr = curr->next) {
+                length++;
+            }
+            result.chainLengths.add(length);
+            if (length == 0) {
+                result.emptyBuckets++;
+            }
+            if (length > result.longestChain) {
+                result.longestChain = length;
+            }
+        }
+        return result;
+    }
+
+    void resetStats() {
+#ifdef INVENTORY_STATS
+        counters = HashTableStats();
+#endif
+    }
+
     // GETS ALL KEYS
     std::vector<K> getAllKeys() const {
         std::vector<K> keys;
+        keys.reserve(numElements);
         for (Node* head : table) {
             Node* curr = head;
             while (curr) {
@@ -175,8 +546,15 @@ public:
                 curr = curr->next;
             }
         }
+        for (Node* head : oldTable) {
+            Node* curr = head;
+            while (curr) {
+                keys.push_back(curr->key);
+                curr = curr->next;
+            }
+        }
         return keys;
     }
 };
 
-#endif // HASHTABLE_H
\ No newline at end of file
+#endif // HASHTABLE_H
@@ -17,214 +17,1721 @@
 #ifndef INVENTORY_H
 #define INVENTORY_H
 
+#include <algorithm>
 #include <string>
 #include <vector>
 #include <sstream>
 #include <fstream>
 #include <iostream>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string_view>
+#include "Aggregation.h"
+#include "Arena.h"
+#include "FlatHashTable.h"
 #include "HashTable.h"
+#include "CategoryDictionary.h"
+#include "CategoryTree.h"
+#include "CSVReader.h"
+#include "EpochManager.h"
+#include "PrefixIndex.h"
+#include "ProductId.h"
+#include "ProductIdTable.h"
+#include "ProductStore.h"
+#include "SortedIndex.h"
+#include "Stats.h"
+#include "TextIndex.h"
+#include "Snapshot.h"
+#include "ThreadPool.h"
 
 class Product {
 private:
-    std::string uniqId;
-    std::string productName;
-    std::string manufacturer;
-    std::string price;
-    std::string numberOfReviews;
-    std::string numberOfAnsweredQuestions;
-    std::string averageReviewRating;
-    std::string amazonCategoryAndSubCategory;
-    std::vector<std::string> categories;
+    // THE FIELDS ARE ROW row OF A COLUMNAR ProductStore
+    const ProductStore* store;
+    uint32_t row;
+
+    // INTERNED CATEGORY I.D.s, NAMES ARE RESOLVED THROUGH dictionary
+    uint32_t* categoryIds;
+    uint32_t categoryCount;
+    bool deleted;
+    const CategoryDictionary* dictionary;
+
+    // postingSlots[i] IS WHERE THE PRODUCT SITS IN THE POSTINGS OF categoryIds[i].
+    // ONLY FILLED ONCE A DELTA NEEDS TO REMOVE PRODUCTS FROM POSTINGS
+    uint32_t* postingSlots;
+
+    // ONLY SET FOR A PRODUCT BUILT ON ITS OWN (NOT BY AN InventoryManager)
+    std::unique_ptr<ProductStore> ownStore;
+    std::unique_ptr<Arena> ownArena;
+    std::unique_ptr<CategoryDictionary> ownDictionary;
+
+    void init(ProductStore& target, Arena& arena, CategoryDictionary& dict, std::string_view id,
+        std::string_view name, std::string_view mfr, std::string_view pr,
+        std::string_view reviews, std::string_view questions,
+        std::string_view rating, std::string_view category) {
+        row = target.appendRow(id, name, mfr, pr, reviews, questions, rating, category);
+        store = &target;
+        parseCategories(arena, dict);
+    }
+
+    std::string_view field(ProductStore::TextColumn column) const {
+        return store->textAt(column, row);
+    }
+
+    // WHAT A DELETED PRODUCT READS: ONE ROW OF EMPTY FIELDS
+    static const ProductStore* emptyRow() {
+        struct EmptyRow {
+            ProductStore store;
+            EmptyRow() { store.appendRow("", "", "", "", "", "", "", ""); }
+        };
+        static const EmptyRow empty;
+        return &empty.store;
+    }
+
+    static std::string_view trimCategory(std::string_view s) {
+        size_t start = s.find_first_not_of(" \t\r\n");
+        size_t end = s.find_last_not_of(" \t\r\n");
+        if (start == std::string_view::npos || end == std::string_view::npos) {
+            return std::string_view();
+        }
+        return s.substr(start, end - start + 1);
+    }
 
 public:
-    Product() {}
+    // READ ONLY VIEW OVER A PRODUCT'S CATEGORIES, YIELDS NAMES FROM THE DICTIONARY
+    class CategoryList {
+    private:
+        const uint32_t* first;
+        size_t count;
+        const CategoryDictionary* dict;
+
+    public:
+        class iterator {
+        private:
+            const uint32_t* at;
+            const CategoryDictionary* dict;
+
+        public:
+            iterator(const uint32_t* p, const CategoryDictionary* d) : at(p), dict(d) {}
+            std::string_view operator*() const { return dict->name(*at); }
+            iterator& operator++() { ++at; return *this; }
+            bool operator!=(const iterator& other) const { return at != other.at; }
+        };
+
+        CategoryList(const uint32_t* data, size_t n, const CategoryDictionary* d)
+            : first(data), count(n), dict(d) {}
+        iterator begin() const { return iterator(first, dict); }
+        iterator end() const { return iterator(first + count, dict); }
+        size_t size() const { return count; }
+        std::string_view operator[](size_t i) const { return dict->name(first[i]); }
+        const uint32_t* ids() const { return first; }
+    };
+
+    Product() : store(nullptr), row(0), categoryIds(nullptr), categoryCount(0), deleted(false), dictionary(nullptr), postingSlots(nullptr),
+        ownStore(new ProductStore()), ownArena(new Arena(1024)), ownDictionary(new CategoryDictionary()) {
+        init(*ownStore, *ownArena, *ownDictionary, "", "", "", "", "", "", "", "");
+    }
 
     Product(const std::string& id, const std::string& name,
         const std::string& mfr, const std::string& pr,
         const std::string& reviews, const std::string& questions,
         const std::string& rating, const std::string& category)
-        : uniqId(id), productName(name), manufacturer(mfr),
-        price(pr), numberOfReviews(reviews),
-        numberOfAnsweredQuestions(questions),
-        averageReviewRating(rating),
-        amazonCategoryAndSubCategory(category) {
-        parseCategories(category);
+        : store(nullptr), row(0), categoryIds(nullptr), categoryCount(0), deleted(false), dictionary(nullptr), postingSlots(nullptr),
+        ownStore(new ProductStore()), ownArena(new Arena(1024)), ownDictionary(new CategoryDictionary()) {
+        init(*ownStore, *ownArena, *ownDictionary, id, name, mfr, pr, reviews, questions, rating, category);
     }
 
-    void parseCategories(const std::string& categoryStr) {
-        if (categoryStr.empty()) {
-            categories.push_back("NA");
-            return;
+    // APPENDS THE FIELDS AS A NEW ROW OF target, KEEPS THE CATEGORY I.D.s IN arena
+    // AND INTERNS THE NAMES IN dict. ALL THREE MUST OUTLIVE THE PRODUCT
+    Product(ProductStore& target, Arena& arena, CategoryDictionary& dict, std::string_view id,
+        std::string_view name, std::string_view mfr, std::string_view pr,
+        std::string_view reviews, std::string_view questions,
+        std::string_view rating, std::string_view category)
+        : store(nullptr), row(0), categoryIds(nullptr), categoryCount(0), deleted(false), dictionary(nullptr), postingSlots(nullptr) {
+        init(target, arena, dict, id, name, mfr, pr, reviews, questions, rating, category);
+    }
+
+    // ATTACHES TO A ROW ALREADY IN target (SNAPSHOT LOAD). ids HOLDS count I.D.s OF
+    // dict, ALL OF THEM MUST OUTLIVE THE PRODUCT
+    Product(const ProductStore& target, uint32_t existingRow, uint32_t* ids, uint32_t count,
+        const CategoryDictionary& dict)
+        : store(&target), row(existingRow), categoryIds(ids), categoryCount(count), deleted(false), dictionary(&dict),
+        postingSlots(nullptr) {}
+
+    Product(const Product&) = delete;
+    Product& operator=(const Product&) = delete;
+
+    // SPLITS THE STORED CATEGORY STRING ON '|' AND INTERNS EACH TRIMMED SLICE,
+    // THE DICTIONARY KEEPS VIEWS INTO THE STORE'S CATEGORY TEXT
+    void parseCategories(Arena& arena, CategoryDictionary& dict) {
+        dictionary = &dict;
+        postingSlots = nullptr;
+        std::string_view categoryStr = field(ProductStore::CATEGORY_TEXT);
+
+        size_t count = 0;
+        size_t start = 0;
+        while (start <= categoryStr.size()) {
+            size_t bar = categoryStr.find('|', start);
+            if (bar == std::string_view::npos) bar = categoryStr.size();
+            if (!trimCategory(categoryStr.substr(start, bar - start)).empty()) count++;
+            start = bar + 1;
         }
 
-        std::stringstream ss(categoryStr);
-        std::string category;
+        if (count == 0) {
+            categoryIds = arena.allocateArray<uint32_t>(1);
+            categoryIds[0] = dict.intern("NA");
+            categoryCount = 1;
+            return;
+        }
 
-        while (std::getline(ss, category, '|')) {
+        categoryIds = arena.allocateArray<uint32_t>(count);
+        size_t n = 0;
+        start = 0;
+        while (start <= categoryStr.size()) {
+            size_t bar = categoryStr.find('|', start);
+            if (bar == std::string_view::npos) bar = categoryStr.size();
             // TRIM WHITE SPACES
-            size_t start = category.find_first_not_of(" \t\r\n");
-            size_t end = category.find_last_not_of(" \t\r\n");
-
-            if (start != std::string::npos && end != std::string::npos) {
-                categories.push_back(category.substr(start, end - start + 1));
+            std::string_view category = trimCategory(categoryStr.substr(start, bar - start));
+            if (!category.empty()) {
+                categoryIds[n++] = dict.intern(category);
             }
+            start = bar + 1;
         }
+        categoryCount = static_cast<uint32_t>(count);
+    }
 
-        if (categories.empty()) {
-            categories.push_back("NA");
+    // SWITCHES TO ANOTHER DICTIONARY, localToGlobal[OLD I.D.] IS THE NEW I.D.
+    void remapCategories(const std::vector<uint32_t>& localToGlobal, const CategoryDictionary* dict) {
+        for (uint32_t i = 0; i < categoryCount; i++) {
+            categoryIds[i] = localToGlobal[categoryIds[i]];
         }
+        dictionary = dict;
+    }
+
+    // MOVES THE PRODUCT TO ANOTHER STORE AFTER ProductStore::adopt() SHIFTED ITS ROW
+    void rebase(const ProductStore* target, uint32_t rowShift) {
+        store = target;
+        row += rowShift;
+    }
+
+    // REUSES A FREED PRODUCT FOR NEW FIELDS, APPENDED AS A NEW ROW OF target
+    void assignNewRow(ProductStore& target, Arena& arena, CategoryDictionary& dict, std::string_view id,
+        std::string_view name, std::string_view mfr, std::string_view pr,
+        std::string_view reviews, std::string_view questions,
+        std::string_view rating, std::string_view category) {
+        deleted = false;
+        init(target, arena, dict, id, name, mfr, pr, reviews, questions, rating, category);
+    }
+
+    // AFTER THE MANAGER DROPPED THE PRODUCT: ITS ROW BELONGS TO ANOTHER PRODUCT
+    // NOW, SO EVERY FIELD READS EMPTY AND IT HAS NO CATEGORIES UNTIL IT IS REUSED
+    void markDeleted() {
+        deleted = true;
+        store = emptyRow();
+        row = 0;
+        categoryCount = 0;
+    }
+
+    bool isDeleted() const { return deleted; }
+
+    // NEW FIELDS FOR THE SAME ROW OF target (THE STORE THE PRODUCT IS ALREADY IN).
+    // THE OLD CATEGORY I.D.s ARE LEFT IN THE ARENA FOR ANY CategoryList STILL HELD
+    void rewriteRow(ProductStore& target, Arena& arena, CategoryDictionary& dict, std::string_view id,
+        std::string_view name, std::string_view mfr, std::string_view pr,
+        std::string_view reviews, std::string_view questions,
+        std::string_view rating, std::string_view category) {
+        target.setRow(row, id, name, mfr, pr, reviews, questions, rating, category);
+        store = &target;
+        parseCategories(arena, dict);
+    }
+
+    // AFTER ProductStore::moveRow() GAVE THE PRODUCT ANOTHER ROW NUMBER
+    void moveToRow(uint32_t newRow) {
+        row = newRow;
+    }
+
+    uint32_t* getPostingSlots() const { return postingSlots; }
+    void setPostingSlots(uint32_t* slots) { postingSlots = slots; }
+
+    // VIEWS INTO THE STORE'S TEXT, GOOD FOR AS LONG AS THE PRODUCT. THE NAME IS
+    // STORED CODED, getProductName() DECODES A COPY AND printName() DECODES
+    // STRAIGHT INTO A STREAM
+    std::string_view getUniqId() const { return field(ProductStore::ID); }
+    std::string getProductName() const {
+        std::string name;
+        store->appendText(ProductStore::NAME, row, name);
+        return name;
     }
+    void printName(std::ostream& out) const {
+        store->visitText(ProductStore::NAME, row, [&out](std::string_view word) { out << word; });
+    }
+    std::string_view getManufacturer() const { return field(ProductStore::MANUFACTURER); }
+    std::string_view getPrice() const { return field(ProductStore::PRICE_TEXT); }
+    std::string_view getNumberOfReviews() const { return field(ProductStore::REVIEWS_TEXT); }
+    std::string_view getNumberOfAnsweredQuestions() const { return field(ProductStore::QUESTIONS_TEXT); }
+    std::string_view getAverageReviewRating() const { return field(ProductStore::RATING_TEXT); }
+    std::string_view getCategoryString() const { return field(ProductStore::CATEGORY_TEXT); }
+    std::string_view idView() const { return field(ProductStore::ID); }
+    CategoryList getCategories() const { return CategoryList(categoryIds, categoryCount, dictionary); }
 
-    std::string getUniqId() const { return uniqId; }
-    std::string getProductName() const { return productName; }
-    std::string getManufacturer() const { return manufacturer; }
-    std::string getPrice() const { return price; }
-    std::string getNumberOfReviews() const { return numberOfReviews; }
-    std::string getNumberOfAnsweredQuestions() const { return numberOfAnsweredQuestions; }
-    std::string getAverageReviewRating() const { return averageReviewRating; }
-    std::string getCategoryString() const { return amazonCategoryAndSubCategory; }
-    const std::vector<std::string>& getCategories() const { return categories; }
+    // PARSED NUMERIC VALUES, CHECK hasPriceValue() / hasRatingValue() FIRST
+    bool hasPriceValue() const { return store->hasFloat(ProductStore::PRICE, row); }
+    float getPriceValue() const { return store->floatAt(ProductStore::PRICE, row); }
+    bool hasRatingValue() const { return store->hasFloat(ProductStore::AVERAGE_RATING, row); }
+    float getRatingValue() const { return store->floatAt(ProductStore::AVERAGE_RATING, row); }
+    uint32_t getRow() const { return row; }
 
-    void print() const {
-        std::cout << "UNIQUE I.D.: " << uniqId << std::endl;
-        std::cout << "PRODUCT NAME: " << productName << std::endl;
-        std::cout << "MANUFACTURER: " << (manufacturer.empty() ? "N/A" : manufacturer) << std::endl;
-        std::cout << "PRICE: " << (price.empty() ? "N/A" : price) << std::endl;
-        std::cout << "NUMBER OF REVIEWS: " << (numberOfReviews.empty() ? "N/A" : numberOfReviews) << std::endl;
-        std::cout << "NUMBER OF ANSWERED QUESTIONS: " << (numberOfAnsweredQuestions.empty() ? "N/A" : numberOfAnsweredQuestions) << std::endl;
-        std::cout << "AVERAGE REVIEW RATING: " << (averageReviewRating.empty() ? "N/A" : averageReviewRating) << std::endl;
-        std::cout << "CATEGORIES: " << (amazonCategoryAndSubCategory.empty() ? "NA" : amazonCategoryAndSubCategory) << std::endl;
+    void print(std::ostream& out = std::cout) const {
+        std::string_view uniqId = field(ProductStore::ID);
+        std::string_view manufacturer = field(ProductStore::MANUFACTURER);
+        std::string_view price = field(ProductStore::PRICE_TEXT);
+        std::string_view numberOfReviews = field(ProductStore::REVIEWS_TEXT);
+        std::string_view numberOfAnsweredQuestions = field(ProductStore::QUESTIONS_TEXT);
+        std::string_view averageReviewRating = field(ProductStore::RATING_TEXT);
+        std::string_view amazonCategoryAndSubCategory = field(ProductStore::CATEGORY_TEXT);
+        out << "UNIQUE I.D.: " << uniqId << '\n';
+        out << "PRODUCT NAME: ";
+        printName(out);
+        out << '\n';
+        out << "MANUFACTURER: " << (manufacturer.empty() ? "N/A" : manufacturer) << '\n';
+        out << "PRICE: " << (price.empty() ? "N/A" : price) << '\n';
+        out << "NUMBER OF REVIEWS: " << (numberOfReviews.empty() ? "N/A" : numberOfReviews) << '\n';
+        out << "NUMBER OF ANSWERED QUESTIONS: " << (numberOfAnsweredQuestions.empty() ? "N/A" : numberOfAnsweredQuestions) << '\n';
+        out << "AVERAGE REVIEW RATING: " << (averageReviewRating.empty() ? "N/A" : averageReviewRating) << '\n';
+        out << "CATEGORIES: " << (amazonCategoryAndSubCategory.empty() ? "NA" : amazonCategoryAndSubCategory) << '\n';
     }
 };
 
+// KEY TEXT FOR THE PREFIX INDEXES: A ROW'S UNIQUE I.D. AND A CATEGORY I.D.'S NAME
+struct ProductIdKeys {
+    const ProductStore* store;
+    std::string_view operator()(uint32_t row) const { return store->textAt(ProductStore::ID, row); }
+};
+
+struct CategoryNameKeys {
+    const CategoryDictionary* dictionary;
+    std::string_view operator()(uint32_t id) const { return dictionary->name(id); }
+};
+
+// WHERE THE LAST loadFromCSV() SPENT ITS TIME. THE PHASE TIMES ARE ONLY TAKEN
+// IN STATS BUILDS (-DINVENTORY_STATS), THE SIZES ALWAYS ARE
+struct LoadStats {
+    bool enabled = Stats::ENABLED;
+    size_t threads = 1;
+    size_t rows = 0;
+    size_t bytes = 0;
+    size_t arenaBytes = 0;          // ARENA BYTES THE LOAD HANDED OUT
+    uint64_t readNanos = 0;         // MAPPING THE FILE
+    uint64_t allocateNanos = 0;     // PRE-SIZING THE TABLES, BUILDING Products AND STORE ROWS
+    uint64_t parseNanos = 0;        // TOKENIZING RECORDS, IN PARALLEL LOADS ALSO THE PER CHUNK PRODUCTS
+    uint64_t indexNanos = 0;        // productById, THE POSTINGS, MERGING CHUNKS AND THE SECONDARY INDEXES
+    uint64_t totalNanos = 0;
+};
+
 class InventoryManager {
 private:
-    HashTable<std::string, Product*> productById;
-    HashTable<std::string, std::vector<Product*>> productsByCategory;
+    // OWNS EVERY Product, ITS TEXT AND THE INDEX NODES. DECLARED FIRST SO IT IS
+    // DESTROYED LAST, AFTER THE TABLES THAT POINT INTO IT
+    Arena arena;
+
+    // THE MAPPED SNAPSHOT, IF ONE WAS LOADED. THE STORE'S TEXT AND THE CATEGORY
+    // NAMES ARE READ IN PLACE FROM IT
+    SnapshotReader snapshot;
+
+    // EVERY PRODUCT'S FIELDS, ONE ROW PER PRODUCT IN allProducts ORDER
+    ProductStore store;
+
+    // AN I.D. OF 32 LOWER CASE HEX DIGITS (ALL OF THE AMAZON EXPORT) IS KEYED
+    // BY ITS 128 BIT VALUE, ANY OTHER I.D. BY A VIEW INTO THE STORE'S I.D. COLUMN
+    HashTable<ProductId, Product*, ProductIdHash> productById;
+    HashTable<std::string_view, Product*> otherIds;
+
+    // AFTER loadSnapshot() THE HEX I.D.s OF THE SNAPSHOT'S ROWS ARE LOOKED UP IN
+    // PLACE IN snapshotIds, WHOSE ROWS INDEX snapshotProducts (allProducts AS IT
+    // WAS LOADED). THE TABLE IS READ ONLY: AN I.D. INSERTED OR REMOVED LATER
+    // NULLS ITS snapshotProducts ENTRY AND FROM THEN ON LIVES IN productById
+    ProductIdTable snapshotIds;
+    std::vector<Product*> snapshotProducts;
+
+    // EVERY DISTINCT CATEGORY NAME HAS A DENSE I.D., ITS PRODUCTS (IN FILE ORDER)
+    // ARE categoryPostings[I.D.]
+    CategoryDictionary categoryDictionary;
+    std::vector<std::vector<Product*>> categoryPostings;
     std::vector<Product*> allProducts;
 
-    std::string trim(const std::string& str) {
-        size_t start = str.find_first_not_of(" \t\r\n\"");
-        size_t end = str.find_last_not_of(" \t\r\n\"");
+    // THE "A | B | C" PATHS AS A TREE, ROWS (allProducts INDEXES) IN TREE ORDER
+    CategoryTree categoryTree;
+
+    // (VALUE, ROW) SORTED INDEXES OVER THE PRICE AND RATING COLUMNS, BUILT AT
+    // THE END OF EVERY LOAD. applyDelta() KEEPS THESE AND THE INDEXES BELOW
+    // UP TO DATE ROW BY ROW (SEE indexRow())
+    SortedIndex sortedIndexes[ProductStore::FLOAT_COLUMNS];
+
+    // TERMS OF EVERY PRODUCT NAME AND MANUFACTURER
+    TextIndex textIndex;
+
+    // SORTED DISTINCT I.D.s AND CATEGORY NAMES (ONLY THOSE WITH PRODUCTS) FOR
+    // complete AND SUGGESTIONS
+    PrefixIndex<ProductIdKeys> idPrefixes;
+    PrefixIndex<CategoryNameKeys> categoryPrefixes;
+
+    // THE GROUP I.D.s OF EVERY ROW FOR aggregate(), BUILT ON FIRST USE AND DROPPED
+    // BY EVERY LOAD OR DELTA. A MANUFACTURER GROUP IS NAMED BY ITS FIRST ROW
+    Aggregation::RowGroups categoryGroups;
+    Aggregation::RowGroups manufacturerGroups;
+    std::vector<uint32_t> manufacturerFirstRow;
+
+    // PRODUCTS A DELTA DELETED, HANDED OUT AGAIN TO THE NEXT INSERTS. A DELETED
+    // PRODUCT IS RETIRED THROUGH readers FIRST AND ONLY LANDS HERE ONCE NO
+    // ReadGuard TAKEN BEFORE THE DELETE IS LEFT (DECLARED AFTER freeProducts
+    // SO ITS LEFTOVER RETIREMENTS STILL HAVE A LIST TO GO TO)
+    std::vector<Product*> freeProducts;
+    mutable EpochManager readers;
+
+    // applyDelta() HOLDS access ALONE, A ReadLock SHARES IT. A WRITER TAKES
+    // writerTurn BEFORE IT WAITS ON access AND READERS PASS THROUGH writerTurn
+    // ON THEIR WAY IN, SO A STEADY STREAM OF READERS CANNOT STARVE A DELTA
+    mutable std::mutex writerTurn;
+    mutable std::shared_mutex access;
+
+    // TRUE WHILE EVERY PRODUCT'S POSTING SLOTS MATCH categoryPostings, A LOAD
+    // APPENDS PRODUCTS WITHOUT THEM
+    bool postingSlotsReady;
+
+    LoadStats lastLoad;
+
+    // ROUGH SIZE OF ONE ROW OF THE AMAZON EXPORT, USED TO PRE-SIZE THE TABLES
+    static const size_t ESTIMATED_BYTES_PER_ROW = 1024;
+
+    // AN INDEX FOLDS ITS PENDING CHANGES IN ONCE THEY PASS MERGE_FLOOR PLUS ONE
+    // PER MERGE_DIVISOR ENTRIES: EACH ONE COSTS QUERIES A LITTLE, A MERGE IS
+    // LINEAR IN THE INDEX
+    static const size_t MERGE_FLOOR = 1024;
+    static const size_t MERGE_DIVISOR = 32;
+
+    // CHUNKS PER THREAD FOR THE PARALLEL LOADER, MORE CHUNKS EVEN OUT SLOW ONES
+    static const size_t CHUNKS_PER_THREAD = 4;
+
+    // WHAT ONE WORKER PRODUCES FROM ITS CHUNK, MERGED IN FILE ORDER AFTERWARDS
+    struct LoadChunk {
+        Arena arena;                                            // ADOPTED BY THE MANAGER ON MERGE
+        ProductStore store;                                     // ROWS APPENDED TO THE MANAGER'S ON MERGE
+        std::vector<Product*> products;
+        CategoryDictionary dictionary;                          // LOCAL I.D.s, FIRST APPEARANCE ORDER
+        std::vector<std::vector<Product*>> postings;            // BY LOCAL I.D.
+        std::vector<std::pair<size_t, size_t>> warnings;        // (RELATIVE LINE, FIELD COUNT)
+        size_t lines = 0;                                       // NEWLINES CONSUMED
+    };
+
+    static void warnShortRecord(size_t line, size_t fieldCount) {
+        std::cerr << "WARNING: LINE " << line << " HAS INSUFFIECIENT FIELDS ("
+            << fieldCount << "), SKIPPING" << std::endl;
+    }
 
-        if (start == std::string::npos || end == std::string::npos) {
-            return "";
+    // FIELD TEXT WITH "" TURNED BACK INTO ", ONLY COPIED WHEN THERE IS SOMETHING TO UNESCAPE
+    static std::string_view fieldText(std::string_view field, std::string& scratch) {
+        if (field.find("\"\"") == std::string_view::npos) {
+            return field;
         }
-        return str.substr(start, end - start + 1);
+        scratch = CSVScanner::unescape(field);
+        return scratch;
     }
 
-    std::vector<std::string> parseCSVLine(const std::string& line) {
-        std::vector<std::string> fields;
-        std::string field;
-        bool inQuotes = false;
+    // CALLS build WITH THE FIELDS A Product KEEPS FROM ONE TOKENIZED RECORD, IN
+    // Product CONSTRUCTOR ORDER
+    template<typename Build>
+    static auto withRecord(const std::vector<std::string_view>& fields, Build build) {
+        std::string scratch[5];
+        return build(
+            fieldText(fields[0], scratch[0]),  // UNIQUE I.D.
+            fieldText(fields[1], scratch[1]),  // PRODUCT NAME
+            fieldText(fields[2], scratch[2]),  // MANUFACTURER
+            fieldText(fields[7], scratch[3]),  // PRICE
+            "",                                // NUMBER OF REVIEWS
+            "",                                // NUMBER OF ANSWERED QUESTIONS
+            "",                                // AVERAGE REVIEW RATING
+            fieldText(fields[4], scratch[4])   // CATEGORIES
+        );
+    }
+
+    // BUILDS A PRODUCT FROM ONE TOKENIZED RECORD IN target, ONLY THE KEPT COLUMNS ARE COPIED
+    static Product* makeProduct(ProductStore& rows, Arena& target, CategoryDictionary& dict,
+        const std::vector<std::string_view>& fields) {
+        return withRecord(fields, [&](auto... values) {
+            return target.create<Product>(rows, target, dict, values...);
+        });
+    }
+
+    static std::vector<Product*>& postingsFor(std::vector<std::vector<Product*>>& postings, uint32_t id) {
+        if (id >= postings.size()) {
+            postings.resize(id + 1);
+        }
+        return postings[id];
+    }
+
+    bool findSnapshotId(const ProductId& key, Product*& product) const {
+        uint32_t row;
+        if (!snapshotIds.find(key, row) || !snapshotProducts[row]) {
+            return false;
+        }
+        product = snapshotProducts[row];
+        return true;
+    }
+
+    void retireSnapshotId(const ProductId& key) {
+        uint32_t row;
+        if (snapshotIds.find(key, row)) {
+            snapshotProducts[row] = nullptr;
+        }
+    }
+
+    void insertId(Product* product) {
+        ProductId key;
+        if (ProductId::parse(product->idView(), key)) {
+            retireSnapshotId(key);
+            productById.insert(key, product);
+        }
+        else {
+            otherIds.insert(product->idView(), product);
+        }
+    }
+
+    void removeId(Product* product) {
+        ProductId key;
+        if (ProductId::parse(product->idView(), key)) {
+            retireSnapshotId(key);
+            productById.remove(key);
+        }
+        else {
+            otherIds.remove(product->idView());
+        }
+    }
 
-        for (size_t i = 0; i < line.length(); i++) {
-            char c = line[i];
+    void indexProduct(Product* product) {
+        allProducts.push_back(product);
 
-            if (c == '"') {
-                inQuotes = !inQuotes;
+        // InNSERT INTO HASH TABLES
+        insertId(product);
+
+        // APPEND TO THE POSTINGS OF EACH CATEGOY I.D.
+        Product::CategoryList categories = product->getCategories();
+        for (size_t i = 0; i < categories.size(); i++) {
+            postingsFor(categoryPostings, categories.ids()[i]).push_back(product);
+        }
+    }
+
+    // PARSES [begin, end) INTO chunk WITHOUT TOUCHING THE SHARED TABLES
+    static void parseChunk(const char* begin, const char* end, bool skipHeader, LoadChunk& chunk) {
+        CSVScanner scanner(begin, end - begin, 0);
+        std::vector<std::string_view> fields;
+
+        if (skipHeader) {
+            scanner.nextRecord(fields);
+        }
+
+        while (scanner.nextRecord(fields)) {
+            if (fields.size() == 1 && fields[0].empty()) continue;
+
+            if (fields.size() < 8) {
+                chunk.warnings.push_back(std::make_pair(scanner.recordLine(), fields.size()));
+                continue;
             }
-            else if (c == ',' && !inQuotes) {
-                fields.push_back(trim(field));
-                field.clear();
+
+            Product* product = makeProduct(chunk.store, chunk.arena, chunk.dictionary, fields);
+            chunk.products.push_back(product);
+            Product::CategoryList categories = product->getCategories();
+            for (size_t i = 0; i < categories.size(); i++) {
+                postingsFor(chunk.postings, categories.ids()[i]).push_back(product);
+            }
+        }
+        chunk.lines = scanner.currentLine();
+    }
+
+    // APPENDS A CHUNK IN FILE ORDER: LATER DUPLICATE IDS WIN, LOCAL CATEGORY I.D.s
+    // ARE INTERNED IN FIRST APPEARANCE ORDER SO THE GLOBAL I.D.s AND EVERY POSTINGS
+    // LIST END UP EXACTLY AS THE SERIAL LOADER WOULD PRODUCE THEM
+    void mergeChunk(LoadChunk& chunk) {
+        arena.adopt(chunk.arena);
+        uint32_t rowShift = store.adopt(chunk.store);
+
+        std::vector<uint32_t> localToGlobal(chunk.dictionary.size());
+        for (uint32_t local = 0; local < chunk.dictionary.size(); local++) {
+            uint32_t global = categoryDictionary.intern(chunk.dictionary.name(local));
+            localToGlobal[local] = global;
+
+            std::vector<Product*>& shared = postingsFor(categoryPostings, global);
+            std::vector<Product*>& mine = chunk.postings[local];
+            if (shared.empty()) {
+                shared.swap(mine);
             }
             else {
-                field += c;
+                shared.insert(shared.end(), mine.begin(), mine.end());
             }
         }
-        fields.push_back(trim(field));
 
-        return fields;
+        for (Product* product : chunk.products) {
+            product->rebase(&store, rowShift);
+            product->remapCategories(localToGlobal, &categoryDictionary);
+            allProducts.push_back(product);
+            insertId(product);
+        }
+    }
+
+    // THE SECONDARY INDEXES, BUILT ONCE ALL ROWS ARE IN THE STORE
+    void buildIndexes(size_t threads) {
+        for (int c = 0; c < ProductStore::FLOAT_COLUMNS; c++) {
+            ProductStore::FloatColumn column = static_cast<ProductStore::FloatColumn>(c);
+            sortedIndexes[c].build(store.floatColumn(column), store.floatValidBits(column), store.size());
+        }
+        textIndex.build(store, threads);
+        categoryTree.build(static_cast<uint32_t>(allProducts.size()),
+            [this](uint32_t row) { return allProducts[row]->getCategories(); }, categoryDictionary);
+        idPrefixes.build(static_cast<uint32_t>(store.size()));
+        categoryPrefixes.build(static_cast<uint32_t>(categoryDictionary.size()),
+            [this](uint32_t id) { return hasProducts(id); });
+        dropGroups();
+    }
+
+    // THE SECTIONS saveSnapshot() WRITES AFTER THE STORE'S: THE I.D. TABLE, THE
+    // ROWS WITH OTHER I.D.s AND EVERY SECONDARY INDEX, ALL USED IN PLACE. FALSE
+    // AS SOON AS ONE DOES NOT FIT
+    bool attachIndexes(size_t rows) {
+        size_t otherCount;
+        if (!snapshotIds.attach(snapshot, rows)) {
+            return false;
+        }
+        const uint32_t* otherRows = snapshot.next<uint32_t>(otherCount);
+        if (!otherRows) {
+            return false;
+        }
+        for (size_t i = 0; i < otherCount; i++) {
+            if (otherRows[i] >= rows) {
+                return false;
+            }
+        }
+        for (SortedIndex& index : sortedIndexes) {
+            if (!index.attach(snapshot, rows)) {
+                return false;
+            }
+        }
+        if (!textIndex.attach(snapshot, rows)
+            || !categoryTree.attach(snapshot, static_cast<uint32_t>(rows), categoryDictionary)
+            || !idPrefixes.attach(snapshot, rows) || !categoryPrefixes.attach(snapshot, categoryDictionary.size())) {
+            return false;
+        }
+        snapshotProducts = allProducts;
+        for (size_t i = 0; i < otherCount; i++) {
+            otherIds.insert(allProducts[otherRows[i]]->idView(), allProducts[otherRows[i]]);
+        }
+        return true;
+    }
+
+    void dropGroups() {
+        categoryGroups = Aggregation::RowGroups();
+        manufacturerGroups = Aggregation::RowGroups();
+        std::vector<uint32_t>().swap(manufacturerFirstRow);
+    }
+
+    static bool mergeDue(size_t pending, size_t size) {
+        return pending > MERGE_FLOOR + size / MERGE_DIVISOR;
+    }
+
+    // TAKES row OUT OF THE SORTED, TEXT, TREE AND I.D. PREFIX INDEXES. CALLED
+    // BEFORE THE ROW CHANGES: WHAT IT WAS INDEXED WITH IS READ FROM THE STORE
+    // AND ITS Product
+    void unindexRow(uint32_t row) {
+        for (int c = 0; c < ProductStore::FLOAT_COLUMNS; c++) {
+            ProductStore::FloatColumn column = static_cast<ProductStore::FloatColumn>(c);
+            if (store.hasFloat(column, row)) {
+                sortedIndexes[c].erase(store.floatAt(column, row), row);
+            }
+        }
+        textIndex.removeRow(row, allProducts[row]->getProductName(), store.textAt(ProductStore::MANUFACTURER, row));
+        categoryTree.removeRow(row, allProducts[row]->getCategories());
+        idPrefixes.erase(row);
+    }
+
+    // PUTS row BACK INTO THOSE INDEXES WITH WHAT IT HOLDS NOW
+    void indexRow(uint32_t row) {
+        for (int c = 0; c < ProductStore::FLOAT_COLUMNS; c++) {
+            ProductStore::FloatColumn column = static_cast<ProductStore::FloatColumn>(c);
+            if (store.hasFloat(column, row)) {
+                sortedIndexes[c].insert(store.floatAt(column, row), row);
+            }
+        }
+        textIndex.addRow(row, allProducts[row]->getProductName(), store.textAt(ProductStore::MANUFACTURER, row));
+        categoryTree.addRow(row, allProducts[row]->getCategories());
+        idPrefixes.insert(row);
+    }
+
+    // FOLDS IN THE CHANGES OF EVERY INDEX THAT HAS COLLECTED ENOUGH OF THEM.
+    // THE TREE HAS NO MERGE, ITS BUILD IS ALREADY ONE PASS OVER THE ROWS
+    void mergeIndexes() {
+        for (SortedIndex& index : sortedIndexes) {
+            if (mergeDue(index.pending(), index.size())) {
+                index.merge();
+            }
+        }
+        if (mergeDue(textIndex.pending(), store.size())) {
+            textIndex.merge();
+        }
+        if (mergeDue(categoryTree.pending(), allProducts.size())) {
+            categoryTree.build(static_cast<uint32_t>(allProducts.size()),
+                [this](uint32_t row) { return allProducts[row]->getCategories(); }, categoryDictionary);
+        }
+        if (mergeDue(idPrefixes.pending(), idPrefixes.size())) {
+            idPrefixes.merge();
+        }
+        if (mergeDue(categoryPrefixes.pending(), categoryPrefixes.size())) {
+            categoryPrefixes.merge();
+        }
+    }
+
+    // EVERY ROW'S CATEGORY I.D.s, COPIED OUT OF THE PRODUCTS INTO ONE ARRAY
+    void buildCategoryGroups() {
+        categoryGroups.offsets.reserve(allProducts.size() + 1);
+        categoryGroups.offsets.push_back(0);
+        for (Product* product : allProducts) {
+            Product::CategoryList categories = product->getCategories();
+            categoryGroups.ids.insert(categoryGroups.ids.end(), categories.ids(), categories.ids() + categories.size());
+            categoryGroups.offsets.push_back(categoryGroups.ids.size());
+        }
+        categoryGroups.count = static_cast<uint32_t>(categoryDictionary.size());
+        categoryGroups.ready = true;
+    }
+
+    // ONE DENSE I.D. PER DISTINCT MANUFACTURER TEXT, IN FIRST APPEARANCE ORDER
+    void buildManufacturerGroups() {
+        FlatHashTable<std::string_view, uint32_t> ids;
+        manufacturerGroups.ids.resize(store.size());
+        for (uint32_t row = 0; row < store.size(); row++) {
+            std::pair<uint32_t*, bool> slot = ids.tryEmplace(store.textAt(ProductStore::MANUFACTURER, row),
+                static_cast<uint32_t>(manufacturerFirstRow.size()));
+            if (slot.second) {
+                manufacturerFirstRow.push_back(row);
+            }
+            manufacturerGroups.ids[row] = *slot.first;
+        }
+        manufacturerGroups.count = static_cast<uint32_t>(manufacturerFirstRow.size());
+        manufacturerGroups.ready = true;
+    }
+
+    // GIVES EVERY PRODUCT ITS POSTING SLOTS, ONE PASS OVER ALL POSTINGS THE FIRST
+    // TIME A DELTA RUNS AFTER A LOAD. A PATH NAMING ONE CATEGORY TWICE IS IN ITS
+    // POSTINGS TWICE, EACH COPY TAKES THE NEXT UNFILLED SLOT
+    void preparePostingSlots() {
+        if (postingSlotsReady) {
+            return;
+        }
+        for (Product* product : allProducts) {
+            size_t count = product->getCategories().size();
+            if (!product->getPostingSlots()) {
+                product->setPostingSlots(arena.allocateArray<uint32_t>(count));
+            }
+            std::fill(product->getPostingSlots(), product->getPostingSlots() + count, UINT32_MAX);
+        }
+        for (uint32_t id = 0; id < categoryPostings.size(); id++) {
+            const std::vector<Product*>& postings = categoryPostings[id];
+            for (size_t at = 0; at < postings.size(); at++) {
+                Product::CategoryList categories = postings[at]->getCategories();
+                uint32_t* slots = postings[at]->getPostingSlots();
+                size_t i = 0;
+                while (categories.ids()[i] != id || slots[i] != UINT32_MAX) {
+                    i++;
+                }
+                slots[i] = static_cast<uint32_t>(at);
+            }
+        }
+        postingSlotsReady = true;
+    }
+
+    // APPENDS product TO THE POSTINGS OF EACH OF ITS CATEGORIES, RECORDING WHERE.
+    // A CATEGORY THAT HAD NO PRODUCTS GOES BACK INTO categoryPrefixes
+    void linkCategories(Product* product) {
+        Product::CategoryList categories = product->getCategories();
+        uint32_t* slots = arena.allocateArray<uint32_t>(categories.size());
+        for (size_t i = 0; i < categories.size(); i++) {
+            std::vector<Product*>& postings = postingsFor(categoryPostings, categories.ids()[i]);
+            if (postings.empty()) {
+                categoryPrefixes.insert(categories.ids()[i]);
+            }
+            slots[i] = static_cast<uint32_t>(postings.size());
+            postings.push_back(product);
+        }
+        product->setPostingSlots(slots);
+    }
+
+    // TAKES product OUT OF ITS CATEGORIES' POSTINGS IN O(1) EACH: THE LAST ENTRY
+    // MOVES INTO ITS SLOT, SO A DELETE REORDERS THE TAIL OF A POSTINGS LIST. A
+    // CATEGORY LEFT WITHOUT PRODUCTS LEAVES categoryPrefixes
+    void unlinkCategories(Product* product) {
+        Product::CategoryList categories = product->getCategories();
+        for (size_t i = 0; i < categories.size(); i++) {
+            uint32_t id = categories.ids()[i];
+            std::vector<Product*>& postings = categoryPostings[id];
+            uint32_t at = product->getPostingSlots()[i];
+            uint32_t last = static_cast<uint32_t>(postings.size() - 1);
+            Product* moved = postings[last];
+            postings[at] = moved;
+            postings.pop_back();
+            if (postings.empty()) {
+                categoryPrefixes.erase(id);
+                continue;
+            }
+
+            // THE MOVED ENTRY'S SLOT IS THE ONE FOR id THAT STILL SAYS last
+            Product::CategoryList movedCategories = moved->getCategories();
+            uint32_t* movedSlots = moved->getPostingSlots();
+            for (size_t j = 0; j < movedCategories.size(); j++) {
+                if (movedCategories.ids()[j] == id && movedSlots[j] == last) {
+                    movedSlots[j] = at;
+                    break;
+                }
+            }
+        }
+    }
+
+    // DROPS product FROM EVERY TABLE AND INDEX. THE LAST ROW MOVES INTO ITS ROW
+    // SO ROWS STAY DENSE (TO THE INDEXES THAT IS ONE MORE ROW OUT AND ONE IN),
+    // THE Product IS MARKED DELETED AND RETIRED
+    void removeProduct(Product* product) {
+        uint32_t row = product->getRow();
+        unindexRow(row);
+        unlinkCategories(product);
+        removeId(product);
+
+        Product* last = allProducts.back();
+        if (last != product) {
+            unindexRow(last->getRow());
+            store.moveRow(last->getRow(), row);
+            last->moveToRow(row);
+            allProducts[row] = last;
+            indexRow(row);
+        }
+        allProducts.pop_back();
+        store.popRow();
+        product->markDeleted();
+        readers.retire([this, product] { freeProducts.push_back(product); });
+    }
+
+    void finishLoadStats(size_t rowsBefore, size_t arenaBefore) {
+        lastLoad.rows = allProducts.size() - rowsBefore;
+        lastLoad.arenaBytes = arena.bytesAllocated() - arenaBefore;
+    }
+
+    // A DELTA CAN DELETE EVERY PRODUCT OF A CATEGORY, ITS NAME STAYS IN THE
+    // DICTIONARY BUT THE CATEGORY NO LONGER EXISTS
+    bool hasProducts(uint32_t id) const {
+        return id < categoryPostings.size() && !categoryPostings[id].empty();
+    }
+
+    static bool inCategory(const Product* product, uint32_t id) {
+        Product::CategoryList categories = product->getCategories();
+        for (size_t i = 0; i < categories.size(); i++) {
+            if (categories.ids()[i] == id) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool loadParallel(const MappedFile& file, size_t threads) {
+        ThreadPool pool(threads);
+        std::vector<size_t> offsets = CSVScanner::splitRecords(file.data(), file.size(),
+            threads * CHUNKS_PER_THREAD, pool);
+
+        size_t chunkCount = offsets.size() - 1;
+        std::vector<LoadChunk> chunks(chunkCount);
+
+        // A FILE SMALLER THAN THE CHUNK COUNT LEAVES THE FIRST CHUNKS EMPTY, THE
+        // HEADER IS IN THE FIRST ONE THAT HAS ANY BYTES
+        size_t headerChunk = 0;
+        while (headerChunk + 1 < chunkCount && offsets[headerChunk] == offsets[headerChunk + 1]) {
+            headerChunk++;
+        }
+#ifdef INVENTORY_STATS
+        uint64_t start = Stats::nanosNow();
+#endif
+        pool.parallelFor(chunkCount, [&](size_t i) {
+            parseChunk(file.data() + offsets[i], file.data() + offsets[i + 1], i == headerChunk, chunks[i]);
+        });
+#ifdef INVENTORY_STATS
+        uint64_t parsed = Stats::nanosNow();
+        lastLoad.parseNanos += parsed - start;
+#endif
+
+        size_t firstLine = 1;
+        for (LoadChunk& chunk : chunks) {
+            for (const std::pair<size_t, size_t>& warning : chunk.warnings) {
+                warnShortRecord(firstLine + warning.first, warning.second);
+            }
+            firstLine += chunk.lines;
+            mergeChunk(chunk);
+        }
+#ifdef INVENTORY_STATS
+        lastLoad.indexNanos += Stats::nanosNow() - parsed;
+#endif
+        return true;
     }
 
 public:
-    InventoryManager() {}
+    // READ ONLY VIEW OVER PRODUCTS THE MANAGER ALREADY HOLDS, NOTHING IS COPIED.
+    // EITHER A RUN OF A POSTINGS ARRAY OR A RUN OF ROWS RESOLVED THROUGH
+    // allProducts (THE CATEGORY TREE'S ORDER). ROWS MERGED FOR A SUBTREE A DELTA
+    // CHANGED ARE OWNED, SHARED BY THE COPIES AND SLICES. GOOD UNTIL THE NEXT
+    // LOAD OR DELTA
+    class ProductList {
+    private:
+        Product* const* direct;     // NULL WHEN THE LIST IS ROWS
+        const uint32_t* rows;
+        size_t count;
+        Product* const* products;
+        std::shared_ptr<const std::vector<uint32_t>> owned;
+
+    public:
+        class iterator {
+        private:
+            Product* const* direct;
+            const uint32_t* rows;
+            Product* const* products;
+
+        public:
+            iterator(Product* const* d, const uint32_t* r, Product* const* all) : direct(d), rows(r), products(all) {}
+            Product* operator*() const { return direct ? *direct : products[*rows]; }
+            iterator& operator++() {
+                if (direct) ++direct; else ++rows;
+                return *this;
+            }
+            bool operator!=(const iterator& other) const { return direct != other.direct || rows != other.rows; }
+        };
+
+        ProductList() : direct(nullptr), rows(nullptr), count(0), products(nullptr) {}
+        ProductList(Product* const* items, size_t n) : direct(items), rows(nullptr), count(n), products(nullptr) {}
+        ProductList(const uint32_t* r, size_t n, Product* const* all) : direct(nullptr), rows(r), count(n), products(all) {}
+        ProductList(std::vector<uint32_t>&& r, Product* const* all)
+            : direct(nullptr), rows(nullptr), count(r.size()), products(all),
+            owned(std::make_shared<const std::vector<uint32_t>>(std::move(r))) {
+            rows = owned->data();
+        }
 
-    ~InventoryManager() {
-        for (Product* p : allProducts) {
-            delete p;
+        iterator begin() const { return iterator(direct, rows, products); }
+        iterator end() const {
+            return direct ? iterator(direct + count, rows, products) : iterator(direct, rows + count, products);
         }
+        size_t size() const { return count; }
+        bool empty() const { return count == 0; }
+        Product* operator[](size_t i) const { return direct ? direct[i] : products[rows[i]]; }
+
+        // AT MOST limit PRODUCTS FROM offset ON, STILL A VIEW. AN offset PAST THE END IS EMPTY
+        ProductList slice(size_t offset, size_t limit) const {
+            size_t first = std::min(offset, count);
+            size_t n = std::min(limit, count - first);
+            if (direct) {
+                return ProductList(direct + first, n);
+            }
+            ProductList part(rows + first, n, products);
+            part.owned = owned;
+            return part;
+        }
+    };
+
+    // HELD BY CODE THAT KEEPS Product POINTERS ACROSS applyDelta(). A PRODUCT A
+    // DELTA DELETES IS NOT HANDED TO ANOTHER I.D. WHILE ANY GUARD TAKEN BEFORE
+    // THE DELETE IS ALIVE, SO THE POINTER KEEPS SAYING isDeleted()
+    class ReadGuard {
+    private:
+        EpochManager::Guard guard;
+
+    public:
+        explicit ReadGuard(const InventoryManager& manager) : guard(manager.readers) {}
+    };
+
+    // HELD BY A THREAD THAT READS THE INVENTORY WHILE ANOTHER ONE MAY CALL
+    // applyDelta() (THE --serve WORKERS), FOR AS LONG AS IT USES WHAT THE
+    // QUERIES RETURNED. MANY READERS SHARE IT, A DELTA WAITS FOR THEM TO
+    // LEAVE AND NEW ONES WAIT FOR THE DELTA. NEVER HELD BY THE THREAD THAT
+    // CALLS applyDelta()
+    class ReadLock {
+    private:
+        std::shared_lock<std::shared_mutex> lock;
+
+        static std::shared_lock<std::shared_mutex> enter(const InventoryManager& manager) {
+            std::lock_guard<std::mutex> turn(manager.writerTurn);
+            return std::shared_lock<std::shared_mutex>(manager.access);
+        }
+
+    public:
+        explicit ReadLock(const InventoryManager& manager) : lock(enter(manager)) {}
+    };
+
+    InventoryManager() : arena(4 << 20), categoryDictionary(&arena),
+        idPrefixes(ProductIdKeys{ &store }), categoryPrefixes(CategoryNameKeys{ &categoryDictionary }),
+        postingSlotsReady(false) {
+        productById.useArena(&arena);
+        otherIds.useArena(&arena);
     }
 
-    bool loadFromCSV(const std::string& filename) {
-        std::ifstream file(filename);
-        if (!file.is_open()) {
+    // PRODUCTS AND productById NODES HOLD ONLY VIEWS AND POINTERS, SO NOTHING IS
+    // DESTROYED ONE BY ONE: THE ARENA HANDS ITS SLABS BACK IN ONE PASS
+    ~InventoryManager() {}
+
+    // SPLITS ONE CSV RECORD INTO TRIMMED, UNQUOTED FIELDS
+    static std::vector<std::string> parseCSVLine(const std::string& line) {
+        std::vector<std::string_view> views;
+        CSVScanner scanner(line.data(), line.size());
+        scanner.nextRecord(views);
+
+        std::vector<std::string> fields;
+        fields.reserve(views.size());
+        for (std::string_view view : views) {
+            fields.push_back(CSVScanner::unescape(view));
+        }
+        return fields;
+    }
+
+    // MAPS THE FILE AND TOKENIZES IT IN PLACE, ONLY THE COLUMNS A Product KEEPS
+    // ARE EVER COPIED OUT OF THE MAPPING. WITH threads > 1 THE FILE IS SPLIT AT
+    // RECORD BOUNDARIES AND PARSED ON A THREAD POOL, THE RESULT IS IDENTICAL
+    bool loadFromCSV(const std::string& filename, size_t threads = 1) {
+        lastLoad = LoadStats();
+        lastLoad.threads = threads;
+        size_t rowsBefore = allProducts.size();
+        size_t arenaBefore = arena.bytesAllocated();
+#ifdef INVENTORY_STATS
+        uint64_t start = Stats::nanosNow();
+        Stats::PhaseClock clock;
+#endif
+        MappedFile file;
+        if (!file.open(filename)) {
             std::cerr << "ERROR CANNOT OPEN THE FILE " << filename << std::endl;
             return false;
         }
+        postingSlotsReady = false;
+        lastLoad.bytes = file.size();
+#ifdef INVENTORY_STATS
+        clock.lap(lastLoad.readNanos);
+#endif
 
-        std::string line;
-        // SKIPS HEADER ROW
-        std::getline(file, line);
+        // PRE-SIZE FROM THE FILE SIZE SO THE BULK LOAD DOES NOT REHASH
+        size_t estimatedRows = file.size() / ESTIMATED_BYTES_PER_ROW;
+        productById.reserve(estimatedRows);
+        allProducts.reserve(estimatedRows);
+        store.reserve(estimatedRows);
+#ifdef INVENTORY_STATS
+        clock.lap(lastLoad.allocateNanos);
+#endif
+
+        if (threads > 1) {
+            loadParallel(file, threads);
+#ifdef INVENTORY_STATS
+            clock.restart();                    // loadParallel() SPLITS ITS OWN TIME
+#endif
+            buildIndexes(threads);
+#ifdef INVENTORY_STATS
+            clock.lap(lastLoad.indexNanos);
+            lastLoad.totalNanos = Stats::nanosNow() - start;
+#endif
+            finishLoadStats(rowsBefore, arenaBefore);
+            std::cout << "LOADED " << allProducts.size() << " PRODUCTS." << std::endl;
+            return true;
+        }
+
+        CSVScanner scanner(file.data(), file.size());
+        std::vector<std::string_view> fields;
 
-        int lineNum = 1;
-        while (std::getline(file, line)) {
-            lineNum++;
-            if (line.empty()) continue;
+        // SKIPS HEADER ROW
+        scanner.nextRecord(fields);
 
-            std::vector<std::string> fields = parseCSVLine(line);
+        while (scanner.nextRecord(fields)) {
+            if (fields.size() == 1 && fields[0].empty()) continue;
 
             // 8 FIELDS ATLEAST
             if (fields.size() < 8) {
-                std::cerr << "WARNING: LINE " << lineNum << " HAS INSUFFIECIENT FIELDS ("
-                    << fields.size() << "), SKIPPING" << std::endl;
+                warnShortRecord(scanner.recordLine(), fields.size());
                 continue;
             }
 
-            Product* product = new Product(
-                fields[0],  // UNIQUE I.D.
-                fields[1],  // PRODUCT NAME
-                fields[2],  // MANUFACTURER
-                fields[7],  // PRICE
-                "",         // NUMBER OF REVIEWS
-                "",         // NUMBER OF ANSWERED QUESTIONS
-                "",         // AVERAGE REVIEW RATING
-                fields[4]   // CATEGORIES
-            );
+#ifdef INVENTORY_STATS
+            clock.lap(lastLoad.parseNanos);
+            Product* product = makeProduct(store, arena, categoryDictionary, fields);
+            clock.lap(lastLoad.allocateNanos);
+            indexProduct(product);
+            clock.lap(lastLoad.indexNanos);
+#else
+            indexProduct(makeProduct(store, arena, categoryDictionary, fields));
+#endif
+        }
+#ifdef INVENTORY_STATS
+        clock.lap(lastLoad.parseNanos);         // THE SCAN THAT FOUND THE END OF THE FILE
+#endif
+        buildIndexes(threads);
+#ifdef INVENTORY_STATS
+        clock.lap(lastLoad.indexNanos);
+        lastLoad.totalNanos = Stats::nanosNow() - start;
+#endif
+        finishLoadStats(rowsBefore, arenaBefore);
 
-            allProducts.push_back(product);
+        std::cout << "LOADED " << allProducts.size() << " PRODUCTS." << std::endl;
+        return true;
+    }
+
+    // WHAT ONE applyDelta() CHANGED
+    struct DeltaCounts {
+        size_t inserted = 0;
+        size_t updated = 0;
+        size_t deleted = 0;
+        size_t missing = 0;         // DELETES OF I.D.s THAT WERE NOT THERE
+        size_t products = 0;        // productCount() RIGHT AFTER THE DELTA
+    };
+
+    // APPLIES A CHANGE FILE TO THE LOADED INVENTORY WITHOUT RELOADING IT. THE
+    // FILE IS A CSV LIKE THE EXPORT (HEADER ROW FIRST): A RECORD WITH A NEW I.D.
+    // IS INSERTED, ONE WITH A KNOWN I.D. REPLACES THAT PRODUCT'S FIELDS, AND A
+    // RECORD WHOSE I.D. STARTS WITH '-' ("-<I.D.>", NO OTHER FIELDS NEEDED)
+    // DELETES IT. productById, THE CATEGORY POSTINGS, allProducts AND EVERY
+    // SECONDARY INDEX ARE CHANGED IN PLACE AT A COST PER RECORD (THE INDEXES
+    // COLLECT CHANGES AND MERGE THEM IN NOW AND THEN, NOTHING IS REBUILT WHEN
+    // A QUERY RUNS). AN UPDATED PRODUCT KEEPS ITS Product (A
+    // POINTER TO IT STAYS GOOD AND SEES THE NEW FIELDS), THE LAST ROW MOVES
+    // INTO A DELETED PRODUCT'S ROW.
+    // POINTERS: ONE TO A PRODUCT THE DELTA DOES NOT DELETE STAYS VALID. ONE TO
+    // A DELETED PRODUCT STAYS SAFE TO READ: isDeleted() IS TRUE AND EVERY FIELD
+    // IS EMPTY. THE Product IS REUSED FOR A LATER INSERT (ANOTHER I.D.), BUT
+    // NOT WHILE A ReadGuard TAKEN BEFORE THE DELETE IS ALIVE, SO HOLD ONE TO
+    // TELL A DELETED PRODUCT FROM A REUSED ONE. THE VECTORS THE
+    // QUERIES RETURNED ARE STALE. OTHER THREADS MAY READ THE INVENTORY UNDER A
+    // ReadLock: THE DELTA WAITS FOR THE ONES INSIDE AND HOLDS OFF NEW ONES
+    // UNTIL IT IS DONE
+    bool applyDelta(const std::string& filename, DeltaCounts& counts) {
+        MappedFile file;
+        if (!file.open(filename)) {
+            std::cerr << "ERROR CANNOT OPEN THE FILE " << filename << std::endl;
+            return false;
+        }
+        std::lock_guard<std::mutex> turn(writerTurn);
+        std::unique_lock<std::shared_mutex> alone(access);
+        preparePostingSlots();
 
-            // InNSERT INTO HASH TABLES
-            productById.insert(product->getUniqId(), product);
+        // PRODUCTS EARLIER DELTAS DELETED THAT NO GUARD CAN STILL SEE GO BACK ON THE FREE LIST
+        readers.reclaim();
 
-            // INSERT INTO HASH TABLE FOR EACH CATEGOY
-            for (const std::string& category : product->getCategories()) {
-                std::vector<Product*> products;
-                if (productsByCategory.find(category, products)) {
-                    products.push_back(product);
-                    productsByCategory.insert(category, products);
+        CSVScanner scanner(file.data(), file.size());
+        std::vector<std::string_view> fields;
+
+        // SKIPS HEADER ROW
+        scanner.nextRecord(fields);
+
+        while (scanner.nextRecord(fields)) {
+            if (fields.size() == 1 && fields[0].empty()) continue;
+
+            if (!fields[0].empty() && fields[0][0] == '-') {
+                Product* product = findProduct(fields[0].substr(1));
+                if (product) {
+                    removeProduct(product);
+                    counts.deleted++;
+                }
+                else {
+                    counts.missing++;
+                }
+                continue;
+            }
+
+            if (fields.size() < 8) {
+                warnShortRecord(scanner.recordLine(), fields.size());
+                continue;
+            }
+
+            std::string scratch;
+            Product* product = findProduct(fieldText(fields[0], scratch));
+            if (product) {
+                unindexRow(product->getRow());
+                unlinkCategories(product);
+                withRecord(fields, [&](auto... values) {
+                    product->rewriteRow(store, arena, categoryDictionary, values...);
+                });
+                counts.updated++;
+            }
+            else {
+                if (freeProducts.empty()) {
+                    product = makeProduct(store, arena, categoryDictionary, fields);
                 }
                 else {
-                    std::vector<Product*> newList;
-                    newList.push_back(product);
-                    productsByCategory.insert(category, newList);
+                    product = freeProducts.back();
+                    freeProducts.pop_back();
+                    withRecord(fields, [&](auto... values) {
+                        product->assignNewRow(store, arena, categoryDictionary, values...);
+                    });
                 }
+                allProducts.push_back(product);
+                insertId(product);
+                counts.inserted++;
             }
+            linkCategories(product);
+            indexRow(product->getRow());
+        }
+        if (counts.inserted + counts.updated + counts.deleted > 0) {
+            mergeIndexes();
+            dropGroups();
         }
+        counts.products = allProducts.size();
+        return true;
+    }
 
-        file.close();
-        std::cout << "LOADED " << allProducts.size() << " PRODUCTS." << std::endl;
+    // WRITES THE WHOLE INVENTORY TO path: THE STORE (POOLS AND COLUMNS), THE
+    // CATEGORY NAMES, EVERY PRODUCT'S CATEGORY I.D.s, THE CATEGORY POSTINGS AS
+    // ROW NUMBERS, AN I.D. TABLE OF ROWS AND EVERY SECONDARY INDEX AS IT IS
+    // LAID OUT IN MEMORY. sourceFile'S SIZE AND MTIME ARE RECORDED FOR loadSnapshot()
+    bool saveSnapshot(const std::string& path, const std::string& sourceFile) const {
+        Snapshot::Header header;
+        Snapshot::initHeader(header);
+        if (!Snapshot::sourceStamp(sourceFile, header.sourceBytes, header.sourceMtime)) {
+            std::cerr << "ERROR CANNOT STAT THE FILE " << sourceFile << std::endl;
+            return false;
+        }
+        header.rows = allProducts.size();
+        header.categories = categoryDictionary.size();
+
+        std::string names;
+        std::vector<uint64_t> nameOffsets(1, 0);
+        for (uint32_t id = 0; id < categoryDictionary.size(); id++) {
+            names += categoryDictionary.name(id);
+            nameOffsets.push_back(names.size());
+        }
+
+        std::vector<uint64_t> categoryOffsets(1, 0);
+        std::vector<uint32_t> categoryIds;
+        for (const Product* product : allProducts) {
+            Product::CategoryList categories = product->getCategories();
+            categoryIds.insert(categoryIds.end(), categories.ids(), categories.ids() + categories.size());
+            categoryOffsets.push_back(categoryIds.size());
+        }
+
+        std::vector<uint64_t> postingOffsets(1, 0);
+        std::vector<uint32_t> postingRows;
+        for (uint32_t id = 0; id < categoryDictionary.size(); id++) {
+            if (id < categoryPostings.size()) {
+                for (const Product* product : categoryPostings[id]) {
+                    postingRows.push_back(product->getRow());
+                }
+            }
+            postingOffsets.push_back(postingRows.size());
+        }
+
+        // ONLY THE PRODUCT AN I.D. FINDS NOW GOES IN, NOT ONE A LATER DUPLICATE HIDES
+        ProductIdTable hexIds;
+        std::vector<uint32_t> otherRows;
+        hexIds.reset(allProducts.size());
+        for (const Product* product : allProducts) {
+            ProductId key;
+            if (findProduct(product->idView()) != product) {
+                continue;
+            }
+            if (ProductId::parse(product->idView(), key)) {
+                hexIds.insert(key, product->getRow());
+            }
+            else {
+                otherRows.push_back(product->getRow());
+            }
+        }
+
+        SnapshotWriter writer;
+        writer.add(names.data(), names.size());
+        writer.addVector(nameOffsets);
+        writer.addVector(categoryOffsets);
+        writer.addVector(categoryIds);
+        writer.addVector(postingOffsets);
+        writer.addVector(postingRows);
+        store.save(writer);
+        hexIds.save(writer);
+        writer.addVector(otherRows);
+        for (const SortedIndex& index : sortedIndexes) {
+            index.save(writer);
+        }
+        textIndex.save(writer);
+        categoryTree.save(writer, static_cast<uint32_t>(allProducts.size()),
+            [this](uint32_t row) { return allProducts[row]->getCategories(); }, categoryDictionary);
+        idPrefixes.save(writer);
+        categoryPrefixes.save(writer);
+        if (!writer.finish(path, header)) {
+            std::cerr << "ERROR CANNOT WRITE THE SNAPSHOT " << path << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    // MAPS A SNAPSHOT FROM saveSnapshot() INTO THIS (EMPTY) MANAGER. TEXT, THE
+    // I.D. TABLE AND THE INDEX ARRAYS STAY IN THE MAPPING AND NOTHING IS PARSED
+    // OR SORTED, ONLY THE PRODUCT RECORDS AND THE SMALL HASH LOOKUPS ARE MADE
+    // FROM THE STORED ROWS. RETURNS FALSE, LEAVING THE MANAGER EMPTY, IF THE FILE
+    // IS MISSING, DAMAGED OR OLDER THAN sourceFile'S SIZE / MTIME
+    bool loadSnapshot(const std::string& path, const std::string& sourceFile, size_t threads = 1) {
+        if (!allProducts.empty()) {
+            std::cerr << "ERROR SNAPSHOT " << path << " NOT USED: INVENTORY ALREADY LOADED" << std::endl;
+            return false;
+        }
+        postingSlotsReady = false;
+        if (!snapshot.open(path)) {
+            std::cerr << "SNAPSHOT " << path << " NOT USED: " << snapshot.lastError() << std::endl;
+            return false;
+        }
+
+        const Snapshot::Header& header = snapshot.getHeader();
+        uint64_t sourceBytes = 0;
+        int64_t sourceMtime = 0;
+        if (!Snapshot::sourceStamp(sourceFile, sourceBytes, sourceMtime)
+            || sourceBytes != header.sourceBytes || sourceMtime != header.sourceMtime) {
+            snapshot.close();
+            std::cerr << "SNAPSHOT " << path << " NOT USED: STALE, " << sourceFile << " CHANGED" << std::endl;
+            return false;
+        }
+        if (!snapshot.verify()) {
+            std::cerr << "SNAPSHOT " << path << " NOT USED: " << snapshot.lastError() << std::endl;
+            return false;
+        }
+
+        size_t rows = static_cast<size_t>(header.rows);
+        size_t categories = static_cast<size_t>(header.categories);
+        size_t nameBytes, nameCount, categoryCount, idCount, postingCount, rowCount;
+        const char* names = snapshot.next<char>(nameBytes);
+        const uint64_t* nameOffsets = snapshot.next<uint64_t>(nameCount);
+        const uint64_t* categoryOffsets = snapshot.next<uint64_t>(categoryCount);
+        const uint32_t* ids = snapshot.next<uint32_t>(idCount);
+        const uint64_t* postingOffsets = snapshot.next<uint64_t>(postingCount);
+        const uint32_t* postingRows = snapshot.next<uint32_t>(rowCount);
+
+        bool ok = names && nameOffsets && categoryOffsets && ids && postingOffsets && postingRows
+            && rows <= UINT32_MAX && nameCount == categories + 1 && categoryCount == rows + 1
+            && postingCount == categories + 1 && nameOffsets[categories] == nameBytes
+            && categoryOffsets[rows] == idCount && postingOffsets[categories] == rowCount;
+        for (size_t i = 0; ok && i < categories; i++) {
+            ok = nameOffsets[i] <= nameOffsets[i + 1] && postingOffsets[i] <= postingOffsets[i + 1];
+        }
+        for (size_t i = 0; ok && i < rows; i++) {
+            ok = categoryOffsets[i] <= categoryOffsets[i + 1];
+        }
+        for (size_t i = 0; ok && i < idCount; i++) {
+            ok = ids[i] < categories;
+        }
+        for (size_t i = 0; ok && i < rowCount; i++) {
+            ok = postingRows[i] < rows;
+        }
+        if (!ok || !store.load(snapshot, static_cast<uint32_t>(rows))) {
+            snapshot.close();
+            std::cerr << "SNAPSHOT " << path << " NOT USED: BAD SECTIONS" << std::endl;
+            return false;
+        }
+
+        // I.D.s COME BACK IN THE SAME ORDER, THE NAMES ARE VIEWS INTO THE MAPPING
+        for (size_t i = 0; i < categories; i++) {
+            categoryDictionary.intern(std::string_view(names + nameOffsets[i],
+                static_cast<size_t>(nameOffsets[i + 1] - nameOffsets[i])));
+        }
+
+        // ONE COPY OF ALL CATEGORY I.D.s, EACH PRODUCT POINTS AT ITS SLICE
+        uint32_t* productIds = arena.allocateArray<uint32_t>(idCount ? idCount : 1);
+        std::copy(ids, ids + idCount, productIds);
+
+        allProducts.reserve(rows);
+        for (size_t r = 0; r < rows; r++) {
+            Product* product = arena.create<Product>(store, static_cast<uint32_t>(r),
+                productIds + categoryOffsets[r],
+                static_cast<uint32_t>(categoryOffsets[r + 1] - categoryOffsets[r]), categoryDictionary);
+            allProducts.push_back(product);
+        }
+
+        categoryPostings.resize(categories);
+        for (size_t i = 0; i < categories; i++) {
+            std::vector<Product*>& postings = categoryPostings[i];
+            postings.reserve(static_cast<size_t>(postingOffsets[i + 1] - postingOffsets[i]));
+            for (uint64_t p = postingOffsets[i]; p < postingOffsets[i + 1]; p++) {
+                postings.push_back(allProducts[postingRows[p]]);
+            }
+        }
+
+        // SHOULD AN INDEX SECTION NOT FIT, THE I.D.s AND INDEXES ARE BUILT FROM THE ROWS
+        if (!attachIndexes(rows)) {
+            std::cerr << "SNAPSHOT " << path << " INDEXES NOT USED: BAD SECTIONS, REBUILDING THEM" << std::endl;
+            snapshotIds.clear();
+            std::vector<Product*>().swap(snapshotProducts);
+            productById.reserve(rows);
+            for (Product* product : allProducts) {
+                insertId(product);
+            }
+            buildIndexes(threads);
+        }
+        std::cout << "LOADED " << allProducts.size() << " PRODUCTS FROM SNAPSHOT." << std::endl;
         return true;
     }
 
-    Product* findProduct(const std::string& uniqId) {
+    size_t productCount() const {
+        return allProducts.size();
+    }
+
+    const std::vector<Product*>& getAllProducts() const {
+        return allProducts;
+    }
+
+    // BYTES HANDED OUT BY THE ARENA AND BYTES IT HOLDS IN SLABS
+    // THE LAST loadFromCSV()'S SIZES AND, IN STATS BUILDS, PHASE TIMES
+    const LoadStats& getLoadStats() const {
+        return lastLoad;
+    }
+
+    // OCCUPANCY OF productById (THE HEX I.D.s) AND, IN STATS BUILDS, ITS PROBE AND REHASH COUNTERS
+    HashTableStats productIdStats() const {
+        return productById.stats();
+    }
+
+    // I.D.s THAT ARE NOT 32 LOWER CASE HEX DIGITS, KEPT AS STRINGS
+    size_t otherIdCount() const {
+        return otherIds.size();
+    }
+
+    // HEX I.D.s LOOKED UP IN PLACE IN THE LOADED SNAPSHOT (SOME MAY HAVE MOVED
+    // TO productById SINCE)
+    size_t snapshotIdCount() const {
+        return snapshotIds.size();
+    }
+
+    void resetStats() {
+        productById.resetStats();
+        otherIds.resetStats();
+    }
+
+    size_t arenaBytesUsed() const {
+        return arena.bytesAllocated();
+    }
+
+    size_t arenaBytesReserved() const {
+        return arena.bytesInSlabs();
+    }
+
+    // COLUMNAR FIELDS, ROW i BELONGS TO getAllProducts()[i]
+    const ProductStore& getStore() const {
+        return store;
+    }
+
+    Product* findProduct(std::string_view uniqId) const {
         Product* product = nullptr;
-        if (productById.find(uniqId, product)) {
-            return product;
+        ProductId key;
+        bool found = ProductId::parse(uniqId, key) ? productById.find(key, product) || findSnapshotId(key, product)
+            : otherIds.find(uniqId, product);
+        return found ? product : nullptr;
+    }
+
+    // LOOKS UP count I.D.s IN ONE PASS, results[i] IS THE PRODUCT FOR ids[i] OR
+    // nullptr. THE TABLE HASHES THE WHOLE BATCH UP FRONT AND PREFETCHES AHEAD,
+    // WHICH IS SEVERAL TIMES FASTER THAN CALLING findProduct() IN A LOOP
+    void findProducts(const std::string_view* ids, size_t count, Product** results) const {
+        const size_t BATCH = 1024;
+        ProductId keys[BATCH];
+        size_t slots[BATCH];            // THE results ENTRY OF EACH PARSED KEY
+        Product* const* found[BATCH];
+        uint32_t rows[BATCH];           // ROWS IN THE SNAPSHOT'S I.D. TABLE
+        for (size_t start = 0; start < count; start += BATCH) {
+            size_t n = count - start < BATCH ? count - start : BATCH;
+            size_t parsed = 0;
+            for (size_t i = 0; i < n; i++) {
+                if (ProductId::parse(ids[start + i], keys[parsed])) {
+                    slots[parsed++] = start + i;
+                }
+                else {
+                    results[start + i] = findProduct(ids[start + i]);
+                }
+            }
+            productById.findBatch(keys, parsed, found);
+            if (snapshotIds.empty()) {
+                for (size_t i = 0; i < parsed; i++) {
+                    results[slots[i]] = found[i] ? *found[i] : nullptr;
+                }
+                continue;
+            }
+            snapshotIds.findBatch(keys, parsed, rows);
+            for (size_t i = 0; i < parsed; i++) {
+                results[slots[i]] = found[i] ? *found[i]
+                    : rows[i] != ProductIdTable::NO_ROW ? snapshotProducts[rows[i]] : nullptr;
+            }
         }
-        return nullptr;
     }
 
-    std::vector<Product*> listInventoryByCategory(const std::string& category) {
-        std::vector<Product*> products;
-        if (productsByCategory.find(category, products)) {
-            return products;
+    std::vector<Product*> findProducts(const std::vector<std::string_view>& ids) const {
+        std::vector<Product*> results(ids.size());
+        findProducts(ids.data(), ids.size(), results.data());
+        return results;
+    }
+
+    // RETURNS THE STORED LIST ITSELF (NO COPY), OR AN EMPTY LIST FOR AN UNKNOWN CATEGORY.
+    // ONE STRING HASH TO GET THE I.D., THEN AN ARRAY INDEX
+    const std::vector<Product*>& listInventoryByCategory(std::string_view category) const {
+        static const std::vector<Product*> noProducts;
+        uint32_t id;
+        if (!categoryDictionary.find(category, id)) {
+            return noProducts;
+        }
+        return categoryPostings[id];
+    }
+
+    const std::vector<Product*>& listInventoryByCategoryId(uint32_t id) const {
+        return categoryPostings[id];
+    }
+
+    // PRODUCTS WITH lo <= column <= hi, IN ASCENDING VALUE ORDER (TIES IN ROW
+    // ORDER). WITH A category ONLY ITS PRODUCTS ARE KEPT: WHICHEVER IS SHORTER,
+    // THE INDEX RANGE OR THE CATEGORY'S POSTINGS, IS WALKED AND EACH ENTRY IS
+    // PROBED AGAINST THE OTHER SIDE, SO NEITHER IS EVER SCANNED IN FULL
+    std::vector<Product*> rangeQuery(ProductStore::FloatColumn column, float lo, float hi,
+        std::string_view category = std::string_view()) const {
+        const SortedIndex& index = sortedIndexes[column];
+        size_t span = index.countUpperBound(lo, hi);
+        std::vector<Product*> result;
+        if (span == 0) {
+            return result;
+        }
+
+        if (category.empty()) {
+            result.reserve(span);
+            index.visitRange(lo, hi, [&](float, uint32_t row) {
+                result.push_back(allProducts[row]);
+                return true;
+            });
+            return result;
+        }
+
+        uint32_t id;
+        if (!categoryDictionary.find(category, id) || id >= categoryPostings.size()) {
+            return result;
+        }
+        const std::vector<Product*>& postings = categoryPostings[id];
+        if (postings.size() < span) {
+            for (Product* product : postings) {
+                uint32_t row = product->getRow();
+                if (store.hasFloat(column, row)) {
+                    float value = store.floatAt(column, row);
+                    if (lo <= value && value <= hi) {
+                        result.push_back(product);
+                    }
+                }
+            }
+            std::sort(result.begin(), result.end(), [&](const Product* a, const Product* b) {
+                float x = store.floatAt(column, a->getRow());
+                float y = store.floatAt(column, b->getRow());
+                return x < y || (x == y && a->getRow() < b->getRow());
+            });
+        }
+        else {
+            index.visitRange(lo, hi, [&](float, uint32_t row) {
+                if (inCategory(allProducts[row], id)) {
+                    result.push_back(allProducts[row]);
+                }
+                return true;
+            });
         }
-        return std::vector<Product*>();
+        return result;
     }
 
-    bool categoryExists(const std::string& category) {
-        return productsByCategory.contains(category);
+    // THE count PRODUCTS WITH THE HIGHEST column VALUES, HIGHEST FIRST (TIES IN
+    // DESCENDING ROW ORDER). WITH A category THE INDEX IS WALKED DOWN FROM THE
+    // TOP UNTIL count OF ITS PRODUCTS TURN UP, UNLESS THAT WALK IS EXPECTED TO
+    // BE LONGER THAN THE CATEGORY ITSELF, THEN ITS POSTINGS ARE PARTIALLY SORTED
+    std::vector<Product*> topQuery(ProductStore::FloatColumn column, size_t count,
+        std::string_view category = std::string_view()) const {
+        const SortedIndex& index = sortedIndexes[column];
+        std::vector<Product*> result;
+
+        if (category.empty()) {
+            index.visitDescending([&](float, uint32_t row) {
+                if (result.size() == count) {
+                    return false;
+                }
+                result.push_back(allProducts[row]);
+                return true;
+            });
+            return result;
+        }
+
+        uint32_t id;
+        if (count == 0 || !categoryDictionary.find(category, id) || id >= categoryPostings.size()) {
+            return result;
+        }
+        const std::vector<Product*>& postings = categoryPostings[id];
+
+        // EXPECTED ENTRIES WALKED: count OUT OF EVERY postings / index ENTRIES MATCH
+        double expectedWalk = static_cast<double>(count) * static_cast<double>(index.size())
+            / static_cast<double>(postings.empty() ? 1 : postings.size());
+        if (expectedWalk > static_cast<double>(postings.size())) {
+            for (Product* product : postings) {
+                if (store.hasFloat(column, product->getRow())) {
+                    result.push_back(product);
+                }
+            }
+            auto higher = [&](const Product* a, const Product* b) {
+                float x = store.floatAt(column, a->getRow());
+                float y = store.floatAt(column, b->getRow());
+                return x > y || (x == y && a->getRow() > b->getRow());
+            };
+            size_t keep = std::min(count, result.size());
+            std::partial_sort(result.begin(), result.begin() + keep, result.end(), higher);
+            result.resize(keep);
+        }
+        else {
+            index.visitDescending([&](float, uint32_t row) {
+                if (inCategory(allProducts[row], id)) {
+                    result.push_back(allProducts[row]);
+                }
+                return result.size() < count;
+            });
+        }
+        return result;
+    }
+
+    const SortedIndex& getSortedIndex(ProductStore::FloatColumn column) const {
+        return sortedIndexes[column];
+    }
+
+    // FULL TEXT SEARCH OF NAMES AND MANUFACTURERS, SEE TextIndex::search(). THE
+    // BEST k PRODUCTS, BEST FIRST; totalMatches GETS THE NUMBER OF ALL MATCHES
+    std::vector<Product*> search(std::string_view query, bool matchAll, size_t k, size_t& totalMatches) const {
+        std::vector<TextIndex::Hit> hits = textIndex.search(query, matchAll, k, totalMatches);
+        std::vector<Product*> result;
+        result.reserve(hits.size());
+        for (const TextIndex::Hit& hit : hits) {
+            result.push_back(allProducts[hit.row]);
+        }
+        return result;
+    }
+
+    const TextIndex& getTextIndex() const {
+        return textIndex;
+    }
+
+    // ONLY A CATEGORY SOME PRODUCT STILL HAS
+    bool categoryExists(std::string_view category) const {
+        uint32_t id;
+        return categoryDictionary.find(category, id) && hasProducts(id);
+    }
+
+    const CategoryDictionary& getCategoryDictionary() const {
+        return categoryDictionary;
+    }
+
+    const CategoryTree& getCategoryTree() const {
+        return categoryTree;
+    }
+
+    // THE COLUMNS aggregate() READS AND WHAT IT GROUPS THEM BY
+    enum AggregateField { AGGREGATE_PRICE, AGGREGATE_RATING, AGGREGATE_REVIEWS, AGGREGATE_QUESTIONS, AGGREGATE_ROWS };
+    enum AggregateDimension { BY_NOTHING, BY_CATEGORY, BY_MANUFACTURER };
+
+    // ONE Group PER CATEGORY / MANUFACTURER (OR ONE FOR EVERYTHING) HOLDING THE
+    // COUNT, SUM, MIN AND MAX OF field OVER ITS PRODUCTS THAT HAVE A VALUE.
+    // AGGREGATE_ROWS COUNTS PRODUCTS. A PRODUCT COUNTS ONCE IN EACH OF ITS
+    // CATEGORIES. threads 0 USES EVERY CORE
+    std::vector<Aggregation::Group> aggregate(AggregateField field, AggregateDimension by, size_t threads = 0) const {
+        if (threads == 0) {
+            threads = std::max(1u, std::thread::hardware_concurrency());
+        }
+        const Aggregation::RowGroups* groups = nullptr;
+        if (by != BY_NOTHING) {
+            // BUILT ON FIRST USE THROUGH const, ONLY THE CACHE CHANGES
+            InventoryManager* self = const_cast<InventoryManager*>(this);
+            Aggregation::RowGroups& cached = by == BY_CATEGORY ? self->categoryGroups : self->manufacturerGroups;
+            if (!cached.ready) {
+                if (by == BY_CATEGORY) {
+                    self->buildCategoryGroups();
+                }
+                else {
+                    self->buildManufacturerGroups();
+                }
+            }
+            groups = &cached;
+        }
+
+        size_t rows = store.size();
+        switch (field) {
+        case AGGREGATE_PRICE:
+        case AGGREGATE_RATING: {
+            ProductStore::FloatColumn column = field == AGGREGATE_PRICE ? ProductStore::PRICE : ProductStore::AVERAGE_RATING;
+            return Aggregation::run(store.floatColumn(column), store.floatValidBits(column), rows, groups, threads);
+        }
+        case AGGREGATE_REVIEWS:
+        case AGGREGATE_QUESTIONS: {
+            ProductStore::CountColumn column = field == AGGREGATE_REVIEWS ? ProductStore::REVIEW_COUNT : ProductStore::ANSWERED_QUESTIONS;
+            return Aggregation::run(store.countColumn(column), store.countValidBits(column), rows, groups, threads);
+        }
+        default:
+            return Aggregation::run<float>(nullptr, nullptr, rows, groups, threads);
+        }
+    }
+
+    // THE CATEGORY NAME OR MANUFACTURER OF A GROUP FROM aggregate(by)
+    std::string_view groupName(AggregateDimension by, uint32_t id) const {
+        if (by == BY_CATEGORY) {
+            return categoryDictionary.name(id);
+        }
+        if (by == BY_MANUFACTURER) {
+            return store.textAt(ProductStore::MANUFACTURER, manufacturerFirstRow[id]);
+        }
+        return std::string_view();
+    }
+
+    // THE TREE NODE OF A "A | B | C" PATH, SEE CategoryTree::findPath()
+    bool findCategoryNode(std::string_view path, uint32_t& node) const {
+        return categoryTree.findPath(path, categoryDictionary, node);
+    }
+
+    std::string categoryPath(uint32_t node) const {
+        return categoryTree.pathName(node, categoryDictionary);
+    }
+
+    // THE PRODUCTS OF A CATEGORY AS listInventory SEES IT: A TOP LEVEL NAME OR AN
+    // "A | B" PATH IS ITS SUBTREE, ANY OTHER NAME EVERY PRODUCT WITH IT AT ANY
+    // LEVEL. FALSE IF THERE IS NO SUCH CATEGORY
+    bool findCategoryProducts(std::string_view category, ProductList& products) const {
+        uint32_t node;
+        if (findCategoryNode(category, node) && node != CategoryTree::ROOT) {
+            products = listInventoryBySubtree(node);
+            return true;
+        }
+        uint32_t id;
+        if (!categoryDictionary.find(category, id) || !hasProducts(id)) {
+            return false;
+        }
+        products = ProductList(categoryPostings[id].data(), categoryPostings[id].size());
+        return true;
+    }
+
+    // EVERY PRODUCT IN node's SUBTREE WITH NO DUPLICATES, GROUPED BY SUBCATEGORY
+    // (SIBLINGS BY NAME) AND IN ROW ORDER WITHIN ONE. ONE CONTIGUOUS RANGE OF
+    // THE TREE UNLESS A DELTA CHANGED A ROW UNDER node SINCE IT WAS LAST BUILT,
+    // THEN THE ROWS ARE MERGED INTO A LIST THE RESULT OWNS
+    ProductList listInventoryBySubtree(uint32_t node) const {
+        if (categoryTree.unchanged(node)) {
+            return ProductList(categoryTree.rowData() + categoryTree.subtreeFirst(node),
+                categoryTree.subtreeCount(node), allProducts.data());
+        }
+        std::vector<uint32_t> rows;
+        categoryTree.subtreeRows(node, rows);
+        return ProductList(std::move(rows), allProducts.data());
+    }
+
+    const PrefixIndex<ProductIdKeys>& getIdPrefixes() const {
+        return idPrefixes;
+    }
+
+    const PrefixIndex<CategoryNameKeys>& getCategoryPrefixes() const {
+        return categoryPrefixes;
+    }
+
+    // UP TO limit CATEGORIES FOR A NAME THAT DOES NOT EXIST: THOSE SHARING THE
+    // LONGEST PREFIX OF name THAT ANY CATEGORY STARTS WITH. NONE WHEN NOT EVEN
+    // THE FIRST CHARACTER MATCHES
+    std::vector<std::string_view> suggestCategories(std::string_view name, size_t limit) const {
+        size_t matched = categoryPrefixes.longestMatch(name);
+        if (matched == 0) {
+            return std::vector<std::string_view>();
+        }
+        return categoryPrefixes.matches(name.substr(0, matched), limit).keys;
     }
 };
 
@@ -0,0 +1,532 @@
+/************************************************************************
+* Programmer:              SURAKANTI SRISHANTH REDDY                    *
+* Class:                   CPTS 223                                     *
+* Programming Assignment:  PA 3                                         *
+* Date:                    OCTOBER 24, 2025                             *
+*                                                                       *
+* Description: 			   PREFIX INDEX FOR AUTOCOMPLETE. THE DISTINCT  *
+*                          KEYS ARE A SORTED ARRAY OF REFERENCES, WITH  *
+*                          EACH KEY'S FIRST 8 BYTES AS AN INTEGER       *
+*                          SEARCHED THROUGH FENCES AND ONE BYTE HOLDING *
+*                          ITS COMMON PREFIX WITH THE KEY BEFORE, SO    *
+*                          ALL KEYS WITH A PREFIX ARE ONE SEARCH AND A  *
+*                          WALK OVER THOSE BYTES AWAY. KEYS ADDED OR    *
+*                          REMOVED SINCE THE LAST BUILD WAIT IN A SMALL *
+*                          SORTED SIDE ARRAY AND A TOMBSTONE TABLE.     *
+*                          A SNAPSHOT CARRIES THE ARRAYS AS THEY ARE.   *
+*                                                                       *
+************************************************************************/
+#pragma once
+#ifndef PREFIXINDEX_H
+#define PREFIXINDEX_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <vector>
+#include "FlatHashTable.h"
+#include "Snapshot.h"
+
+// Keys IS A CALLABLE MAPPING A REFERENCE (A ROW, A CATEGORY I.D.) TO ITS KEY
+// TEXT. THE TEXT IS NEVER COPIED, IT MUST OUTLIVE THE INDEX
+template<typename Keys>
+class PrefixIndex {
+public:
+    // POSITIONS [first, last) OF THE SORTED KEYS
+    struct Range {
+        size_t first;
+        size_t last;
+
+        size_t size() const { return last - first; }
+        bool empty() const { return last == first; }
+    };
+
+    // WHAT matches() FOUND
+    struct Matches {
+        std::vector<std::string_view> keys;     // THE FIRST limit, IN ORDER
+        size_t count = 0;                       // ALL OF THEM
+        std::string_view common;                // THE PREFIX EVERY ONE STARTS WITH
+    };
+
+    static const size_t MAX_LCP = 255;      // LONGER COMMON PREFIXES ARE STORED AS 255
+    static const size_t FENCE = 64;
+
+private:
+    Keys keys;
+    SectionArray<uint32_t> refs;    // IN KEY ORDER
+    SectionArray<uint64_t> heads;   // heads[i] = headOf(KEY i), NON DECREASING
+    SectionArray<uint64_t> fences;  // fences[b] == heads[b * FENCE]
+    SectionArray<uint8_t> lcp;      // lcp[i] = COMMON PREFIX OF KEYS i - 1 AND i, lcp[0] = 0
+
+    // CHANGES SINCE THE LAST build() / merge(). A REMOVED REFERENCE KEEPS THE
+    // KEY IT HAD, SO THE SORTED ORDER ABOVE STAYS SEARCHABLE; ADDED ONES ARE
+    // IN (KEY, REFERENCE) ORDER
+    FlatHashTable<uint32_t, std::string_view> removed;
+    std::vector<uint32_t> added;
+
+    static const unsigned RADIX_BITS = 11;
+
+    struct Entry {
+        uint64_t head;      // FIRST 8 BYTES, BIG ENDIAN AND ZERO PADDED, SO THEY SORT LIKE THE TEXT
+        uint32_t ref;
+        uint32_t length;
+    };
+
+    static uint64_t headOf(std::string_view key) {
+        uint64_t head = 0;
+        for (size_t i = 0; i < 8; i++) {
+            head = (head << 8) | (i < key.size() ? static_cast<unsigned char>(key[i]) : 0);
+        }
+        return head;
+    }
+
+    static size_t commonPrefix(std::string_view a, std::string_view b, size_t from) {
+        size_t n = std::min(a.size(), b.size());
+        while (from < n && a[from] == b[from]) {
+            from++;
+        }
+        return from;
+    }
+
+    // COMMON PREFIX OF TWO SORTED NEIGHBOURS, FROM THE HEADS WHEN THEY DIFFER
+    size_t entryPrefix(const Entry& a, const Entry& b) const {
+        size_t shortest = std::min(a.length, b.length);
+        if (a.head != b.head) {
+            size_t same = static_cast<size_t>(__builtin_clzll(a.head ^ b.head)) / 8;
+            return std::min(same, shortest);
+        }
+        if (shortest <= 8) {
+            return shortest;
+        }
+        return commonPrefix(keys(a.ref), keys(b.ref), 8);
+    }
+
+    // FIRST POSITION WITH A HEAD >= head: THE CACHE RESIDENT FENCES FIRST, THEN ONE BLOCK
+    size_t headBound(uint64_t head) const {
+        size_t block = static_cast<size_t>(std::partition_point(fences.begin(), fences.end(),
+            [&](uint64_t fence) { return fence < head; }) - fences.begin());
+        if (block == 0) {
+            return 0;
+        }
+        size_t first = (block - 1) * FENCE;
+        size_t last = std::min(first + FENCE, heads.size());
+        return static_cast<size_t>(std::partition_point(heads.begin() + first, heads.begin() + last,
+            [&](uint64_t h) { return h < head; }) - heads.begin());
+    }
+
+    bool liveAt(size_t i) const {
+        return removed.empty() || !removed.contains(refs[i]);
+    }
+
+    // FIRST ADDED POSITION NOT BEFORE (key, ref)
+    size_t addedBound(std::string_view key, uint32_t ref) const {
+        return static_cast<size_t>(std::partition_point(added.begin(), added.end(), [&](uint32_t other) {
+            std::string_view text = keys(other);
+            return text < key || (text == key && other < ref);
+        }) - added.begin());
+    }
+
+    static bool startsWith(std::string_view key, std::string_view prefix) {
+        return key.substr(0, prefix.size()) == prefix;
+    }
+
+    template<typename Heads>
+    static std::vector<uint64_t> fencesOf(const Heads& sorted) {
+        std::vector<uint64_t> made;
+        made.reserve((sorted.size() + FENCE - 1) / FENCE);
+        for (size_t i = 0; i < sorted.size(); i += FENCE) {
+            made.push_back(sorted[i]);
+        }
+        return made;
+    }
+
+    void makeFences() {
+        fences.assign(fencesOf(heads));
+    }
+
+    // THE SORTED ARRAYS WITH THE PENDING CHANGES FOLDED IN
+    struct Merged {
+        std::vector<uint32_t> refs;
+        std::vector<uint64_t> heads;
+        std::vector<uint64_t> fences;
+        std::vector<uint8_t> lcp;
+    };
+
+    // ONE MERGE OF TWO SORTED RUNS, WHAT merge() INSTALLS AND save() WRITES
+    void mergeInto(Merged& out) const {
+        std::vector<uint32_t>& merged = out.refs;
+        merged.reserve(size());
+        size_t b = 0;
+        size_t a = 0;
+        while (true) {
+            while (b < refs.size() && !liveAt(b)) {
+                b++;
+            }
+            if (b == refs.size() && a == added.size()) {
+                break;
+            }
+            uint32_t ref = (a < added.size() && (b == refs.size() || keys(added[a]) < keys(refs[b]))) ? added[a++] : refs[b++];
+            if (!merged.empty() && keys(merged.back()) == keys(ref)) {
+                merged.back() = std::min(merged.back(), ref);     // A KEY KEEPS ITS LOWEST REFERENCE
+                continue;
+            }
+            merged.push_back(ref);
+        }
+        out.heads.resize(merged.size());
+        out.lcp.resize(merged.size());
+        for (size_t i = 0; i < merged.size(); i++) {
+            std::string_view key = keys(merged[i]);
+            size_t common = i > 0 ? commonPrefix(keys(merged[i - 1]), key, 0) : 0;
+            out.heads[i] = headOf(key);
+            out.lcp[i] = static_cast<uint8_t>(common < MAX_LCP ? common : MAX_LCP);
+        }
+        out.fences = fencesOf(out.heads);
+    }
+
+public:
+    explicit PrefixIndex(Keys keys = Keys()) : keys(keys) {}
+
+    // INDEXES THE KEYS OF REFERENCES 0 .. count - 1. A KEY SEEN MORE THAN ONCE
+    // KEEPS ITS LOWEST REFERENCE. AN LSD RADIX SORT ON THE 8 BYTE HEADS (LIKE
+    // SortedIndex) ORDERS ALMOST EVERYTHING, ONLY RUNS OF EQUAL HEADS ARE
+    // COMPARED AS TEXT
+    void build(uint32_t count) {
+        build(count, [](uint32_t) { return true; });
+    }
+
+    // THE SAME, LEAVING OUT EVERY REFERENCE FOR WHICH keep(ref) IS FALSE
+    template<typename Keep>
+    void build(uint32_t count, Keep keep) {
+        std::vector<Entry> entries;
+        entries.reserve(count);
+        for (uint32_t ref = 0; ref < count; ref++) {
+            if (keep(ref)) {
+                std::string_view key = keys(ref);
+                entries.push_back(Entry{ headOf(key), ref, static_cast<uint32_t>(key.size()) });
+            }
+        }
+        size_t kept = entries.size();
+
+        std::vector<Entry> sorted(kept);
+        std::vector<size_t> histogram(size_t(1) << RADIX_BITS);
+        for (unsigned shift = 0; shift < 64; shift += RADIX_BITS) {
+            const uint64_t mask = (uint64_t(1) << RADIX_BITS) - 1;
+            std::fill(histogram.begin(), histogram.end(), 0);
+            for (const Entry& entry : entries) {
+                histogram[(entry.head >> shift) & mask]++;
+            }
+            if (kept == 0 || histogram[(entries[0].head >> shift) & mask] == kept) {
+                continue;       // EVERY HEAD HAS THE SAME DIGIT, THE PASS WOULD NOT MOVE ANYTHING
+            }
+            size_t sum = 0;
+            for (size_t& slot : histogram) {
+                size_t c = slot;
+                slot = sum;
+                sum += c;
+            }
+            for (const Entry& entry : entries) {
+                sorted[histogram[(entry.head >> shift) & mask]++] = entry;
+            }
+            entries.swap(sorted);
+        }
+        std::vector<Entry>().swap(sorted);
+
+        // EQUAL HEADS: ORDER BY THE WHOLE TEXT, STABLE SO DUPLICATES STAY IN REFERENCE ORDER
+        for (size_t i = 0; i < entries.size();) {
+            size_t j = i + 1;
+            while (j < entries.size() && entries[j].head == entries[i].head) {
+                j++;
+            }
+            if (j - i > 1) {
+                std::stable_sort(entries.begin() + i, entries.begin() + j, [&](const Entry& a, const Entry& b) {
+                    return keys(a.ref) < keys(b.ref);
+                });
+            }
+            i = j;
+        }
+
+        clear();
+        std::vector<uint32_t> builtRefs;
+        std::vector<uint64_t> builtHeads;
+        std::vector<uint8_t> builtLcp;
+        builtRefs.reserve(kept);
+        builtHeads.reserve(kept);
+        builtLcp.reserve(kept);
+        for (size_t i = 0; i < entries.size(); i++) {
+            size_t common = i > 0 ? entryPrefix(entries[i - 1], entries[i]) : 0;
+            if (i > 0 && common == entries[i].length && common == entries[i - 1].length) {
+                continue;       // SAME KEY AS THE ONE BEFORE
+            }
+            builtRefs.push_back(entries[i].ref);
+            builtHeads.push_back(entries[i].head);
+            builtLcp.push_back(static_cast<uint8_t>(common < MAX_LCP ? common : MAX_LCP));
+        }
+        builtRefs.shrink_to_fit();
+        builtHeads.shrink_to_fit();
+        builtLcp.shrink_to_fit();
+        refs.assign(std::move(builtRefs));
+        heads.assign(std::move(builtHeads));
+        lcp.assign(std::move(builtLcp));
+        makeFences();
+    }
+
+    void clear() {
+        refs.clear();
+        heads.clear();
+        fences.clear();
+        lcp.clear();
+        removed.clear();
+        std::vector<uint32_t>().swap(added);
+    }
+
+    // ADDS ref UNDER ITS CURRENT KEY
+    void insert(uint32_t ref) {
+        std::string_view key = keys(ref);
+        std::string_view old;
+        if (removed.find(ref, old) && old == key) {
+            removed.remove(ref);        // BACK UNDER THE KEY IT HAD, ITS ENTRY ABOVE IS GOOD AGAIN
+            return;
+        }
+        added.insert(added.begin() + addedBound(key, ref), ref);
+    }
+
+    // DROPS ref, WHOSE KEY MUST STILL BE THE ONE IT WAS ADDED UNDER
+    void erase(uint32_t ref) {
+        std::string_view key = keys(ref);
+        size_t a = addedBound(key, ref);
+        if (a < added.size() && added[a] == ref) {
+            added.erase(added.begin() + a);
+            return;
+        }
+        // THE KEYS ABOVE ARE DISTINCT, ref IS THERE ONLY IF IT HOLDS THE ONE ENTRY FOR key
+        size_t i = lowerBound(key);
+        if (i < refs.size() && refs[i] == ref && liveAt(i)) {
+            removed.insert(ref, key);
+        }
+    }
+
+    // REFERENCES ADDED OR REMOVED SINCE THE LAST build() / merge()
+    size_t pending() const { return removed.size() + added.size(); }
+
+    // FOLDS THE PENDING CHANGES INTO THE SORTED ARRAYS
+    void merge() {
+        if (pending() == 0) {
+            return;
+        }
+        Merged merged;
+        mergeInto(merged);
+        refs.assign(std::move(merged.refs));
+        heads.assign(std::move(merged.heads));
+        fences.assign(std::move(merged.fences));
+        lcp.assign(std::move(merged.lcp));
+        removed.clear();
+        std::vector<uint32_t>().swap(added);
+    }
+
+    // ADDS refs, heads, fences AND lcp AS SNAPSHOT SECTIONS, PENDING CHANGES
+    // MERGED INTO ARRAYS THE WRITER KEEPS. THE KEY TEXT IS NOT SAVED, IT IS
+    // WHEREVER Keys READS IT FROM
+    void save(SnapshotWriter& writer) const {
+        if (pending() > 0) {
+            Merged& merged = writer.keep<Merged>();
+            mergeInto(merged);
+            writer.addVector(merged.refs);
+            writer.addVector(merged.heads);
+            writer.addVector(merged.fences);
+            writer.addVector(merged.lcp);
+            return;
+        }
+        writer.addVector(refs);
+        writer.addVector(heads);
+        writer.addVector(fences);
+        writer.addVector(lcp);
+    }
+
+    // USES WHAT save() WROTE IN PLACE FROM THE MAPPING (WHICH MUST OUTLIVE THE
+    // INDEX) IF EVERY REFERENCE IS BELOW refCount, WITH THE SAME KEYS AS WHEN IT
+    // WAS SAVED. NOTHING CHANGES IF A SECTION DOES NOT FIT
+    bool attach(SnapshotReader& reader, size_t refCount) {
+        size_t count, headCount, fenceCount, lcpCount;
+        const uint32_t* refData = reader.next<uint32_t>(count);
+        const uint64_t* headData = reader.next<uint64_t>(headCount);
+        const uint64_t* fenceData = reader.next<uint64_t>(fenceCount);
+        const uint8_t* lcpData = reader.next<uint8_t>(lcpCount);
+        if (!refData || !headData || !fenceData || !lcpData || headCount != count || lcpCount != count
+            || fenceCount != (count + FENCE - 1) / FENCE) {
+            return false;
+        }
+        for (size_t i = 0; i < count; i++) {
+            if (refData[i] >= refCount) {
+                return false;
+            }
+        }
+        clear();
+        refs.attach(refData, count);
+        heads.attach(headData, count);
+        fences.attach(fenceData, fenceCount);
+        lcp.attach(lcpData, count);
+        return true;
+    }
+
+    // FIRST POSITION WHOSE KEY IS NOT BEFORE text. A SMALLER HEAD MEANS A
+    // SMALLER KEY, SO THE SEARCH RUNS ON THE HEADS AND ONLY KEYS WHOSE HEAD
+    // EQUALS text's (THE SAME FIRST 8 BYTES) ARE COMPARED AS TEXT
+    size_t lowerBound(std::string_view text) const {
+        uint64_t head = headOf(text);
+        size_t low = headBound(head);
+        size_t high = low;
+        while (high < heads.size() && heads[high] == head) {
+            high++;
+        }
+        while (low < high) {
+            size_t mid = low + (high - low) / 2;
+            if (keyAt(mid) < text) {
+                low = mid + 1;
+            }
+            else {
+                high = mid;
+            }
+        }
+        return low;
+    }
+
+    // LENGTH OF THE LONGEST PREFIX OF text THAT STARTS ANY KEY, PENDING CHANGES
+    // INCLUDED. THE LIVE KEYS AROUND text's POSITION SHARE THE MOST WITH IT
+    size_t longestMatch(std::string_view text) const {
+        size_t low = lowerBound(text);
+        size_t matched = 0;
+        for (size_t i = low; i > 0; i--) {
+            if (liveAt(i - 1)) {
+                matched = commonPrefix(text, keyAt(i - 1), 0);
+                break;
+            }
+        }
+        for (size_t i = low; i < refs.size(); i++) {
+            if (liveAt(i)) {
+                matched = std::max(matched, commonPrefix(text, keyAt(i), 0));
+                break;
+            }
+        }
+        size_t a = addedBound(text, 0);
+        if (a > 0) {
+            matched = std::max(matched, commonPrefix(text, keys(added[a - 1]), 0));
+        }
+        if (a < added.size()) {
+            matched = std::max(matched, commonPrefix(text, keys(added[a]), 0));
+        }
+        return matched;
+    }
+
+    // EVERY KEY STARTING WITH prefix, PENDING CHANGES INCLUDED: HOW MANY, THE
+    // FIRST limit IN ORDER AND WHAT THEY ALL START WITH. WITH NOTHING PENDING IT
+    // IS prefixRange(), OTHERWISE THE RANGE IS MERGED WITH THE SIDE ARRAY
+    Matches matches(std::string_view prefix, size_t limit) const {
+        Matches result;
+        Range range = prefixRange(prefix);
+        if (pending() == 0) {
+            result.count = range.size();
+            for (size_t i = range.first; i < range.last && result.keys.size() < limit; i++) {
+                result.keys.push_back(keyAt(i));
+            }
+            result.common = commonPrefix(range);
+            return result;
+        }
+        size_t b = range.first;
+        size_t a = addedBound(prefix, 0);
+        std::string_view first;
+        std::string_view previous;
+        while (true) {
+            while (b < range.last && !liveAt(b)) {
+                b++;
+            }
+            bool base = b < range.last;
+            bool side = a < added.size() && startsWith(keys(added[a]), prefix);
+            if (!base && !side) {
+                break;
+            }
+            std::string_view key = (side && (!base || keys(added[a]) < keyAt(b))) ? keys(added[a++]) : keyAt(b++);
+            if (result.count > 0 && key == previous) {
+                continue;       // THE SAME KEY UNDER ANOTHER REFERENCE
+            }
+            if (result.count == 0) {
+                first = key;
+            }
+            previous = key;
+            result.count++;
+            if (result.keys.size() < limit) {
+                result.keys.push_back(key);
+            }
+        }
+        result.common = first.substr(0, commonPrefix(first, previous, 0));
+        return result;
+    }
+
+    // EVERY KEY STARTING WITH prefix: O(|prefix| + log n) TO FIND THE FIRST
+    // AND ONE LCP BYTE PER MATCH TO FIND THE END
+    Range prefixRange(std::string_view prefix) const {
+        size_t first = lowerBound(prefix);
+        if (first == refs.size()) {
+            return Range{ first, first };
+        }
+        // A PREFIX OF UP TO 8 BYTES IS CHECKED ON THE HEAD WITHOUT TOUCHING THE TEXT
+        bool starts;
+        if (prefix.size() <= 8) {
+            uint64_t mask = prefix.empty() ? 0 : ~uint64_t(0) << (64 - 8 * prefix.size());
+            starts = (heads[first] & mask) == headOf(prefix);
+        }
+        else {
+            starts = startsWith(keyAt(first), prefix);
+        }
+        if (!starts) {
+            return Range{ first, first };
+        }
+        size_t last = first + 1;
+        if (prefix.size() < MAX_LCP) {
+            while (last < refs.size() && lcp[last] >= prefix.size()) {
+                last++;
+            }
+        }
+        else {
+            while (last < refs.size() && lcp[last] == MAX_LCP && startsWith(keyAt(last), prefix)) {
+                last++;
+            }
+        }
+        return Range{ first, last };
+    }
+
+    // THE LONGEST PREFIX SHARED BY EVERY KEY IN range (WHAT TAB COMPLETION
+    // WOULD FILL IN). FOR SORTED KEYS IT IS THAT OF THE FIRST AND THE LAST
+    std::string_view commonPrefix(Range range) const {
+        if (range.empty()) {
+            return std::string_view();
+        }
+        std::string_view first = keyAt(range.first);
+        std::string_view last = keyAt(range.last - 1);
+        return first.substr(0, commonPrefix(first, last, 0));
+    }
+
+    // KEYS, PENDING CHANGES INCLUDED
+    size_t size() const { return refs.size() - removed.size() + added.size(); }
+    bool empty() const { return size() == 0; }
+
+    // POSITIONS ARE INTO THE SORTED ARRAYS (prefixRange(), lowerBound()). A
+    // REMOVED REFERENCE STILL READS AS THE KEY IT HAD UNTIL THE NEXT merge()
+    std::string_view keyAt(size_t i) const {
+        std::string_view key;
+        if (!removed.empty() && removed.find(refs[i], key)) {
+            return key;
+        }
+        return keys(refs[i]);
+    }
+    uint32_t refAt(size_t i) const { return refs[i]; }
+
+    size_t memoryUsage() const {
+        return refs.capacity() * sizeof(uint32_t) + heads.capacity() * sizeof(uint64_t)
+            + fences.capacity() * sizeof(uint64_t) + lcp.capacity()
+            + removed.bucketCount() * (sizeof(std::pair<uint32_t, std::string_view>) + 1)
+            + added.capacity() * sizeof(uint32_t);
+    }
+};
+
+#endif // PREFIXINDEX_H
@@ -0,0 +1,72 @@
+/************************************************************************
+* Programmer:              SURAKANTI SRISHANTH REDDY                    *
+* Class:                   CPTS 223                                     *
+* Programming Assignment:  PA 3                                         *
+* Date:                    OCTOBER 24, 2025                             *
+*                                                                       *
+* Description: 			   A uniqId (32 LOWER CASE HEX DIGITS, AN MD5)  *
+*                          AS ONE 128 BIT KEY: PARSED ONCE, HASHED WITH *
+*                          TWO MULTIPLY-XOR STEPS AND COMPARED WITH TWO *
+*                          64 BIT COMPARES. ANY OTHER I.D. DOES NOT     *
+*                          PARSE AND STAYS A STRING KEY.                *
+*                                                                       *
+************************************************************************/
+#pragma once
+#ifndef PRODUCTID_H
+#define PRODUCTID_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+struct ProductId {
+    uint64_t high;      // FIRST 16 HEX DIGITS
+    uint64_t low;       // LAST 16
+
+    static const size_t DIGITS = 32;
+
+    bool operator==(const ProductId& other) const {
+        return high == other.high && low == other.low;
+    }
+
+    bool operator!=(const ProductId& other) const {
+        return !(*this == other);
+    }
+
+    // FALSE UNLESS text IS EXACTLY 32 OF 0-9 / a-f. UPPER CASE IS REFUSED SO
+    // TWO I.D.s ARE EQUAL AS KEYS ONLY WHEN THEY ARE EQUAL AS TEXT
+    static bool parse(std::string_view text, ProductId& id) {
+        if (text.size() != DIGITS) {
+            return false;
+        }
+        uint64_t halves[2] = { 0, 0 };
+        unsigned bad = 0;
+        for (size_t i = 0; i < DIGITS; i++) {
+            unsigned c = static_cast<unsigned char>(text[i]);
+            unsigned digit = c - '0';
+            unsigned letter = c - 'a';
+            bad |= static_cast<unsigned>(digit > 9) & static_cast<unsigned>(letter > 5);
+            halves[i / 16] = halves[i / 16] << 4 | (digit <= 9 ? digit : letter + 10);
+        }
+        if (bad) {
+            return false;
+        }
+        id.high = halves[0];
+        id.low = halves[1];
+        return true;
+    }
+};
+
+// THE HASHER TO GIVE HashTable / FlatHashTable FOR ProductId KEYS. AN MD5 IS
+// ALREADY UNIFORM, THE MIX ONLY FOLDS BOTH HALVES INTO THE LOW BITS
+struct ProductIdHash {
+    size_t operator()(const ProductId& id) const {
+        uint64_t h = id.low ^ (id.high * 0x9e3779b97f4a7c15ULL);
+        h ^= h >> 32;
+        h *= 0xd6e8feb86659fd93ULL;
+        h ^= h >> 32;
+        return static_cast<size_t>(h);
+    }
+};
+
+#endif // PRODUCTID_H
@@ -0,0 +1,146 @@
+/************************************************************************
+* Programmer:              SURAKANTI SRISHANTH REDDY                    *
+* Class:                   CPTS 223                                     *
+* Programming Assignment:  PA 3                                         *
+* Date:                    OCTOBER 24, 2025                             *
+*                                                                       *
+* Description: 			   READ ONLY ProductId -> ROW TABLE FOR         *
+*                          SNAPSHOTS. LINEAR PROBING OVER ONE ARRAY OF  *
+*                          PLAIN (KEY, ROW) SLOTS WITH NO POINTERS IN   *
+*                          IT, SO IT IS SAVED AS ONE SECTION AND THE    *
+*                          LOOKUPS RUN STRAIGHT ON THE MAPPED FILE.     *
+*                                                                       *
+************************************************************************/
+#pragma once
+#ifndef PRODUCTIDTABLE_H
+#define PRODUCTIDTABLE_H
+
+#include <cstdint>
+#include <vector>
+#include "ProductId.h"
+#include "Snapshot.h"
+
+class ProductIdTable {
+public:
+    static const uint32_t NO_ROW = UINT32_MAX;
+
+private:
+    struct Slot {
+        uint64_t high;
+        uint64_t low;
+        uint64_t row;           // NO_ROW FOR AN EMPTY SLOT. 64 BITS SO THE SLOT HAS NO PADDING
+    };
+
+    SectionArray<Slot> slots;   // A POWER OF TWO, AT MOST 3 / 4 FULL
+    size_t count;
+
+    size_t home(const ProductId& key) const {
+        return ProductIdHash()(key) & (slots.size() - 1);
+    }
+
+public:
+    ProductIdTable() : count(0) {}
+
+    // EMPTY SLOTS FOR AT LEAST expected KEYS
+    void reset(size_t expected) {
+        size_t capacity = 16;
+        while (capacity * 3 / 4 < expected) {
+            capacity *= 2;
+        }
+        slots.assign(std::vector<Slot>(capacity, Slot{ 0, 0, NO_ROW }));
+        count = 0;
+    }
+
+    // MAPS key TO row, REPLACING WHAT key HAD. ONLY BEFORE save(), NEVER ON AN
+    // ATTACHED TABLE
+    void insert(const ProductId& key, uint32_t row) {
+        std::vector<Slot>& all = slots.edit();
+        size_t mask = all.size() - 1;
+        for (size_t i = home(key);; i = (i + 1) & mask) {
+            if (all[i].row == NO_ROW || (all[i].high == key.high && all[i].low == key.low)) {
+                count += all[i].row == NO_ROW;
+                all[i] = Slot{ key.high, key.low, row };
+                return;
+            }
+        }
+    }
+
+    bool find(const ProductId& key, uint32_t& row) const {
+        if (count == 0) {
+            return false;
+        }
+        size_t mask = slots.size() - 1;
+        for (size_t i = home(key);; i = (i + 1) & mask) {
+            const Slot& slot = slots[i];
+            if (slot.row == NO_ROW) {
+                return false;
+            }
+            if (slot.high == key.high && slot.low == key.low) {
+                row = static_cast<uint32_t>(slot.row);
+                return true;
+            }
+        }
+    }
+
+    // rows[i] IS THE ROW OF keys[i] OR NO_ROW. EVERY HOME SLOT OF A BLOCK IS
+    // PREFETCHED BEFORE THE FIRST PROBE, LIKE HashTable::findBatch()
+    void findBatch(const ProductId* keys, size_t n, uint32_t* rows) const {
+        const size_t BLOCK = 64;
+        size_t at[BLOCK];
+        for (size_t start = 0; start < n; start += BLOCK) {
+            size_t m = n - start < BLOCK ? n - start : BLOCK;
+            for (size_t i = 0; count > 0 && i < m; i++) {
+                at[i] = home(keys[start + i]);
+                __builtin_prefetch(&slots[at[i]]);
+            }
+            for (size_t i = 0; i < m; i++) {
+                uint32_t row;
+                rows[start + i] = find(keys[start + i], row) ? row : uint32_t(NO_ROW);
+            }
+        }
+    }
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+
+    void clear() {
+        slots.clear();
+        count = 0;
+    }
+
+    void save(SnapshotWriter& writer) const {
+        writer.addVector(slots);
+    }
+
+    // USES WHAT save() WROTE IN PLACE FROM THE MAPPING (WHICH MUST OUTLIVE THE
+    // TABLE) IF EVERY ROW IS BELOW rowCount. NOTHING CHANGES IF IT DOES NOT FIT
+    bool attach(SnapshotReader& reader, size_t rowCount) {
+        size_t capacity;
+        const Slot* data = reader.next<Slot>(capacity);
+        if (!data || capacity < 16 || (capacity & (capacity - 1)) != 0) {
+            return false;
+        }
+        size_t used = 0;
+        for (size_t i = 0; i < capacity; i++) {
+            if (data[i].row != NO_ROW) {
+                if (data[i].row >= rowCount) {
+                    return false;
+                }
+                used++;
+            }
+        }
+        if (used > capacity * 3 / 4) {
+            return false;
+        }
+        slots.attach(data, capacity);
+        count = used;
+        return true;
+    }
+
+    // HEAP BYTES, NONE WHILE ATTACHED
+    size_t memoryUsage() const {
+        return slots.capacity() * sizeof(Slot);
+    }
+};
+
+#endif // PRODUCTIDTABLE_H
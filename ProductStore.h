@@ -0,0 +1,744 @@
+/************************************************************************
+* Programmer:              SURAKANTI SRISHANTH REDDY                    *
+* Class:                   CPTS 223                                     *
+* Programming Assignment:  PA 3                                         *
+* Date:                    OCTOBER 24, 2025                             *
+*                                                                       *
+* Description: 			   COLUMNAR (STRUCT OF ARRAYS) PRODUCT STORAGE. *
+*                          EACH ROW IS ONE PRODUCT. PRICE, RATING AND   *
+*                          THE REVIEW / QUESTION COUNTS ARE PARSED ONCE *
+*                          INTO TYPED ARRAYS WITH A NULL BITMAP, AND    *
+*                          THE TEXT LIVES IN OFFSET INDEXED POOLS. THE  *
+*                          REPETITIVE TEXT COLUMNS ARE DICTIONARY CODED *
+*                          (ONE COPY OF EACH DISTINCT VALUE) AND THE    *
+*                          NAME IS CODED AS A LIST OF SHARED WORDS.     *
+*                                                                       *
+************************************************************************/
+#pragma once
+#ifndef PRODUCTSTORE_H
+#define PRODUCTSTORE_H
+
+#include <algorithm>
+#include <charconv>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "FlatHashTable.h"
+#include "Snapshot.h"
+#include "StringPool.h"
+
+class ProductStore {
+public:
+    enum TextColumn {
+        ID, NAME, MANUFACTURER, PRICE_TEXT, REVIEWS_TEXT,
+        QUESTIONS_TEXT, RATING_TEXT, CATEGORY_TEXT, TEXT_COLUMNS
+    };
+    enum FloatColumn { PRICE, AVERAGE_RATING, FLOAT_COLUMNS };
+    enum CountColumn { REVIEW_COUNT, ANSWERED_QUESTIONS, COUNT_COLUMNS };
+
+    // BYTES ONE TEXT COLUMN TAKES, plainBytes IS WHAT IT WOULD TAKE WITHOUT A
+    // DICTIONARY (EVERY ROW'S TEXT PLUS A 12 BYTE OFFSET / LENGTH PER ROW)
+    struct TextUsage {
+        size_t values;          // DISTINCT ENTRIES (WORDS FOR NAME), OR ROWS FOR A PLAIN COLUMN
+        size_t plainBytes;
+        size_t storedBytes;
+    };
+
+private:
+    // ROW i OF A PLAIN TEXT COLUMN IS pool.view(offsets[i], lengths[i]). A
+    // DICTIONARY COLUMN HOLDS EACH DISTINCT VALUE ONCE, offsets / lengths ARE
+    // PER ENTRY AND ROW i IS ENTRY codes[i]
+    struct Text {
+        std::vector<uint64_t> offsets;
+        std::vector<uint32_t> lengths;
+        std::vector<uint32_t> codes;
+    };
+
+    // NAME, MANUFACTURER AND CATEGORY EACH GET A POOL, THE SHORT COLUMNS SHARE ONE
+    StringPool namePool;
+    StringPool manufacturerPool;
+    StringPool categoryPool;
+    StringPool shortPool;
+    Text text[TEXT_COLUMNS];
+    FlatHashTable<std::string_view, uint32_t> entryCodes[TEXT_COLUMNS];   // KEYS VIEW THE POOL
+
+    // NAME IS A PLAIN COLUMN OF CODED BYTES: A NAME IS CUT AFTER EVERY SPACE
+    // ("Red ", "Toy ", "Car"), EACH DISTINCT WORD IS KEPT ONCE IN wordPool AS
+    // ENTRY words.offsets / lengths[CODE], AND namePool HOLDS THE ROW'S CODES
+    // AS VARINTS. THE WORDS OF A CATALOG REPEAT FAR MORE THAN WHOLE NAMES DO
+    StringPool wordPool;
+    Text words;
+    FlatHashTable<std::string_view, uint32_t> wordCodes;     // KEYS VIEW wordPool
+    std::string coded;                                      // SCRATCH FOR encodeName()
+
+    std::vector<float> floats[FLOAT_COLUMNS];
+    std::vector<uint32_t> counts[COUNT_COLUMNS];
+    std::vector<uint64_t> floatValid[FLOAT_COLUMNS];   // BIT SET = VALUE PRESENT
+    std::vector<uint64_t> countValid[COUNT_COLUMNS];
+    uint32_t rows;
+
+    StringPool& poolFor(TextColumn column) {
+        switch (column) {
+        case NAME: return namePool;
+        case MANUFACTURER: return manufacturerPool;
+        case CATEGORY_TEXT: return categoryPool;
+        default: return shortPool;
+        }
+    }
+
+    const StringPool& poolFor(TextColumn column) const {
+        return const_cast<ProductStore*>(this)->poolFor(column);
+    }
+
+    // THE ENTRY FOR value, APPENDED TO THE POOL THE FIRST TIME IT IS SEEN
+    uint32_t intern(TextColumn column, std::string_view value) {
+        const uint32_t* found = entryCodes[column].findPtr(value);
+        if (found) {
+            return *found;
+        }
+        return addEntry(column, poolFor(column).append(value), static_cast<uint32_t>(value.size()));
+    }
+
+    // THE BYTES MUST ALREADY BE IN THE POOL AND NOT BE AN ENTRY YET
+    uint32_t addEntry(TextColumn column, uint64_t offset, uint32_t length) {
+        Text& t = text[column];
+        uint32_t code = static_cast<uint32_t>(t.offsets.size());
+        t.offsets.push_back(offset);
+        t.lengths.push_back(length);
+        entryCodes[column].insert(poolFor(column).view(offset, length), code);
+        return code;
+    }
+
+    uint32_t internWord(std::string_view word) {
+        const uint32_t* found = wordCodes.findPtr(word);
+        if (found) {
+            return *found;
+        }
+        uint32_t code = static_cast<uint32_t>(words.offsets.size());
+        words.offsets.push_back(wordPool.append(word));
+        words.lengths.push_back(static_cast<uint32_t>(word.size()));
+        wordCodes.insert(wordPool.view(words.offsets.back(), words.lengths.back()), code);
+        return code;
+    }
+
+    static void putCode(std::string& out, uint32_t code) {
+        while (code >= 0x80) {
+            out += static_cast<char>(code | 0x80);
+            code >>= 7;
+        }
+        out += static_cast<char>(code);
+    }
+
+    static uint32_t getCode(const unsigned char*& p) {
+        uint32_t code = 0;
+        unsigned shift = 0;
+        while (*p & 0x80) {
+            code |= static_cast<uint32_t>(*p++ & 0x7F) << shift;
+            shift += 7;
+        }
+        return code | (static_cast<uint32_t>(*p++) << shift);
+    }
+
+    // name'S WORD CODES INTO coded, NEW WORDS ARE INTERNED
+    std::string_view encodeName(std::string_view name) {
+        coded.clear();
+        size_t start = 0;
+        while (start < name.size()) {
+            size_t space = name.find(' ', start);
+            size_t end = space == std::string_view::npos ? name.size() : space + 1;
+            putCode(coded, internWord(name.substr(start, end - start)));
+            start = end;
+        }
+        return coded;
+    }
+
+    // TRUE IF bytes ARE WHOLE VARINTS, EACH A CODE BELOW wordCount
+    static bool validCodes(std::string_view bytes, size_t wordCount) {
+        const unsigned char* p = reinterpret_cast<const unsigned char*>(bytes.data());
+        const unsigned char* end = p + bytes.size();
+        while (p < end) {
+            uint64_t code = 0;
+            unsigned shift = 0;
+            while (p < end && (*p & 0x80) && shift < 28) {
+                code |= static_cast<uint64_t>(*p++ & 0x7F) << shift;
+                shift += 7;
+            }
+            if (p == end || (*p & 0x80)) {
+                return false;
+            }
+            code |= static_cast<uint64_t>(*p++) << shift;
+            if (code >= wordCount) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // THE STORED BYTES FOR value: NAME IS CODED, EVERY OTHER PLAIN COLUMN AS IS
+    std::string_view stored(TextColumn column, std::string_view value) {
+        return column == NAME ? encodeName(value) : value;
+    }
+
+    template<typename T>
+    static const T* take(SnapshotReader& reader, size_t expected) {
+        size_t count;
+        const T* data = reader.next<T>(count);
+        return data && count == expected ? data : nullptr;
+    }
+
+    static void setBit(std::vector<uint64_t>& bits, uint32_t row, bool value) {
+        if ((row >> 6) >= bits.size()) {
+            bits.resize((row >> 6) + 1, 0);
+        }
+        if (value) {
+            bits[row >> 6] |= uint64_t(1) << (row & 63);
+        }
+        else {
+            bits[row >> 6] &= ~(uint64_t(1) << (row & 63));
+        }
+    }
+
+    static bool getBit(const std::vector<uint64_t>& bits, uint32_t row) {
+        return (row >> 6) < bits.size() && ((bits[row >> 6] >> (row & 63)) & 1);
+    }
+
+    // KEEPS DIGITS, ONE DOT AND A LEADING MINUS FROM THE FIRST NUMBER IN s
+    // ("$1,299.99", "4.5 out of 5 stars", "$12.99 - $15.99" -> 12.99)
+    static size_t firstNumber(std::string_view s, char* buf, size_t cap) {
+        size_t i = 0;
+        while (i < s.size() && !(s[i] >= '0' && s[i] <= '9') && s[i] != '.') i++;
+        size_t n = 0;
+        bool dot = false;
+        for (; i < s.size() && n + 1 < cap; i++) {
+            char c = s[i];
+            if (c >= '0' && c <= '9') {
+                buf[n++] = c;
+            }
+            else if (c == '.' && !dot) {
+                dot = true;
+                buf[n++] = c;
+            }
+            else if (c != ',') {
+                break;
+            }
+        }
+        return n;
+    }
+
+public:
+    ProductStore() : rows(0) {}
+
+    ProductStore(const ProductStore&) = delete;
+    ProductStore& operator=(const ProductStore&) = delete;
+
+    // THE I.D. AND THE NAME ARE NEARLY ALWAYS UNIQUE, THE OTHER COLUMNS REPEAT
+    // A FEW THOUSAND VALUES (MANUFACTURERS, CATEGORY PATHS, "4.5 out of 5 stars")
+    static bool isDictionary(TextColumn column) {
+        return column != ID && column != NAME;
+    }
+
+    static bool parseFloat(std::string_view s, float& out) {
+        char buf[32];
+        size_t n = firstNumber(s, buf, sizeof(buf));
+        if (n == 0) {
+            return false;
+        }
+        std::from_chars_result r = std::from_chars(buf, buf + n, out);
+        return r.ec == std::errc();
+    }
+
+    static bool parseCount(std::string_view s, uint32_t& out) {
+        char buf[16];
+        size_t n = firstNumber(s, buf, sizeof(buf));
+        if (n == 0) {
+            return false;
+        }
+        std::from_chars_result r = std::from_chars(buf, buf + n, out);
+        return r.ec == std::errc() || r.ptr != buf;
+    }
+
+    // COPIES ONE PRODUCT'S TEXT INTO THE POOLS (DICTIONARY COLUMNS ONLY WHEN THE
+    // VALUE IS NEW, THE NAME AS WORD CODES), PARSES THE NUMERIC COLUMNS AND RETURNS THE NEW ROW NUMBER
+    uint32_t appendRow(std::string_view id, std::string_view name,
+        std::string_view mfr, std::string_view pr,
+        std::string_view reviews, std::string_view questions,
+        std::string_view rating, std::string_view category) {
+        std::string_view values[TEXT_COLUMNS] = { id, name, mfr, pr, reviews, questions, rating, category };
+        for (int c = 0; c < TEXT_COLUMNS; c++) {
+            TextColumn column = static_cast<TextColumn>(c);
+            if (isDictionary(column)) {
+                text[c].codes.push_back(intern(column, values[c]));
+                continue;
+            }
+            std::string_view bytes = stored(column, values[c]);
+            text[c].offsets.push_back(poolFor(column).append(bytes));
+            text[c].lengths.push_back(static_cast<uint32_t>(bytes.size()));
+        }
+
+        uint32_t row = rows++;
+        float f = 0.0f;
+        bool ok = parseFloat(pr, f);
+        floats[PRICE].push_back(ok ? f : 0.0f);
+        setBit(floatValid[PRICE], row, ok);
+
+        f = 0.0f;
+        ok = parseFloat(rating, f);
+        floats[AVERAGE_RATING].push_back(ok ? f : 0.0f);
+        setBit(floatValid[AVERAGE_RATING], row, ok);
+
+        uint32_t n = 0;
+        ok = parseCount(reviews, n);
+        counts[REVIEW_COUNT].push_back(ok ? n : 0);
+        setBit(countValid[REVIEW_COUNT], row, ok);
+
+        n = 0;
+        ok = parseCount(questions, n);
+        counts[ANSWERED_QUESTIONS].push_back(ok ? n : 0);
+        setBit(countValid[ANSWERED_QUESTIONS], row, ok);
+        return row;
+    }
+
+    // REPLACES AN EXISTING ROW'S FIELDS. THE NEW TEXT IS APPENDED TO THE POOLS,
+    // THE OLD BYTES ARE LEFT WHERE THEY WERE SO VIEWS HANDED OUT EARLIER STAY GOOD
+    void setRow(uint32_t row, std::string_view id, std::string_view name,
+        std::string_view mfr, std::string_view pr,
+        std::string_view reviews, std::string_view questions,
+        std::string_view rating, std::string_view category) {
+        std::string_view values[TEXT_COLUMNS] = { id, name, mfr, pr, reviews, questions, rating, category };
+        for (int c = 0; c < TEXT_COLUMNS; c++) {
+            TextColumn column = static_cast<TextColumn>(c);
+            if (isDictionary(column)) {
+                text[c].codes[row] = intern(column, values[c]);
+                continue;
+            }
+            std::string_view bytes = stored(column, values[c]);
+            text[c].offsets[row] = poolFor(column).append(bytes);
+            text[c].lengths[row] = static_cast<uint32_t>(bytes.size());
+        }
+
+        float f = 0.0f;
+        bool ok = parseFloat(pr, f);
+        floats[PRICE][row] = ok ? f : 0.0f;
+        setBit(floatValid[PRICE], row, ok);
+
+        f = 0.0f;
+        ok = parseFloat(rating, f);
+        floats[AVERAGE_RATING][row] = ok ? f : 0.0f;
+        setBit(floatValid[AVERAGE_RATING], row, ok);
+
+        uint32_t n = 0;
+        ok = parseCount(reviews, n);
+        counts[REVIEW_COUNT][row] = ok ? n : 0;
+        setBit(countValid[REVIEW_COUNT], row, ok);
+
+        n = 0;
+        ok = parseCount(questions, n);
+        counts[ANSWERED_QUESTIONS][row] = ok ? n : 0;
+        setBit(countValid[ANSWERED_QUESTIONS], row, ok);
+    }
+
+    // COPIES ROW from OVER ROW to (NO TEXT IS COPIED, ONLY ITS OFFSET OR CODE)
+    void moveRow(uint32_t from, uint32_t to) {
+        for (int c = 0; c < TEXT_COLUMNS; c++) {
+            if (isDictionary(static_cast<TextColumn>(c))) {
+                text[c].codes[to] = text[c].codes[from];
+                continue;
+            }
+            text[c].offsets[to] = text[c].offsets[from];
+            text[c].lengths[to] = text[c].lengths[from];
+        }
+        for (int c = 0; c < FLOAT_COLUMNS; c++) {
+            floats[c][to] = floats[c][from];
+            setBit(floatValid[c], to, getBit(floatValid[c], from));
+        }
+        for (int c = 0; c < COUNT_COLUMNS; c++) {
+            counts[c][to] = counts[c][from];
+            setBit(countValid[c], to, getBit(countValid[c], from));
+        }
+    }
+
+    // DROPS THE LAST ROW, ITS TEXT STAYS IN THE POOLS. THE VALID BITS SHRINK
+    // WITH THE ROWS, save() WRITES ONE WORD PER 64 ROWS
+    void popRow() {
+        uint32_t row = --rows;
+        for (int c = 0; c < TEXT_COLUMNS; c++) {
+            if (isDictionary(static_cast<TextColumn>(c))) {
+                text[c].codes.pop_back();
+                continue;
+            }
+            text[c].offsets.pop_back();
+            text[c].lengths.pop_back();
+        }
+        for (int c = 0; c < FLOAT_COLUMNS; c++) {
+            floats[c].pop_back();
+            setBit(floatValid[c], row, false);
+            floatValid[c].resize((static_cast<size_t>(rows) + 63) / 64);
+        }
+        for (int c = 0; c < COUNT_COLUMNS; c++) {
+            counts[c].pop_back();
+            setBit(countValid[c], row, false);
+            countValid[c].resize((static_cast<size_t>(rows) + 63) / 64);
+        }
+    }
+
+    // MOVES other'S ROWS TO THE END OF THIS STORE, POOL CHUNKS ARE ADOPTED NOT
+    // COPIED. other'S DICTIONARY ENTRIES ARE MERGED INTO OURS (AN ENTRY WE
+    // ALREADY HAVE KEEPS ITS CODE, ITS ADOPTED BYTES ARE JUST NOT REFERENCED).
+    // THE NAMES ARE THE EXCEPTION: THEIR WORD CODES ARE other'S, SO EACH NAME
+    // IS CODED AGAIN WITH OURS (ONLY THE CODES ARE COPIED, NOT THE TEXT).
+    // RETURNS THE ROW NUMBER other'S ROW 0 NOW HAS
+    uint32_t adopt(ProductStore& other) {
+        uint32_t base = rows;
+        uint64_t shifts[TEXT_COLUMNS];
+        uint64_t manufacturerShift = manufacturerPool.adopt(other.manufacturerPool);
+        uint64_t categoryShift = categoryPool.adopt(other.categoryPool);
+        uint64_t shortShift = shortPool.adopt(other.shortPool);
+        for (int c = 0; c < TEXT_COLUMNS; c++) {
+            shifts[c] = c == MANUFACTURER ? manufacturerShift : c == CATEGORY_TEXT ? categoryShift : shortShift;
+        }
+
+        std::vector<uint32_t> remap(other.words.offsets.size());
+        for (size_t w = 0; w < remap.size(); w++) {
+            remap[w] = internWord(other.wordPool.view(other.words.offsets[w], other.words.lengths[w]));
+        }
+        for (uint32_t r = 0; r < other.rows; r++) {
+            std::string_view theirs = other.textAt(NAME, r);
+            const unsigned char* p = reinterpret_cast<const unsigned char*>(theirs.data());
+            const unsigned char* end = p + theirs.size();
+            coded.clear();
+            while (p < end) {
+                putCode(coded, remap[getCode(p)]);
+            }
+            text[NAME].offsets.push_back(namePool.append(coded));
+            text[NAME].lengths.push_back(static_cast<uint32_t>(coded.size()));
+        }
+
+        for (int c = 0; c < TEXT_COLUMNS; c++) {
+            TextColumn column = static_cast<TextColumn>(c);
+            if (column == NAME) {
+                continue;
+            }
+            if (isDictionary(column)) {
+                const Text& theirs = other.text[c];
+                remap.resize(theirs.offsets.size());
+                for (size_t e = 0; e < theirs.offsets.size(); e++) {
+                    uint64_t offset = theirs.offsets[e] + shifts[c];
+                    const uint32_t* found = entryCodes[c].findPtr(poolFor(column).view(offset, theirs.lengths[e]));
+                    remap[e] = found ? *found : addEntry(column, offset, theirs.lengths[e]);
+                }
+                for (uint32_t code : theirs.codes) {
+                    text[c].codes.push_back(remap[code]);
+                }
+                continue;
+            }
+            for (uint64_t offset : other.text[c].offsets) {
+                text[c].offsets.push_back(offset + shifts[c]);
+            }
+            text[c].lengths.insert(text[c].lengths.end(), other.text[c].lengths.begin(), other.text[c].lengths.end());
+        }
+        for (int c = 0; c < FLOAT_COLUMNS; c++) {
+            floats[c].insert(floats[c].end(), other.floats[c].begin(), other.floats[c].end());
+            for (uint32_t r = 0; r < other.rows; r++) {
+                setBit(floatValid[c], base + r, getBit(other.floatValid[c], r));
+            }
+        }
+        for (int c = 0; c < COUNT_COLUMNS; c++) {
+            counts[c].insert(counts[c].end(), other.counts[c].begin(), other.counts[c].end());
+            for (uint32_t r = 0; r < other.rows; r++) {
+                setBit(countValid[c], base + r, getBit(other.countValid[c], r));
+            }
+        }
+        rows += other.rows;
+        other.clearRows();
+        return base;
+    }
+
+    // ALSO FORGETS THE DICTIONARY ENTRIES AND THE NAME WORDS, THE POOL BYTES STAY
+    void clearRows() {
+        for (int c = 0; c < TEXT_COLUMNS; c++) {
+            text[c].offsets.clear();
+            text[c].lengths.clear();
+            text[c].codes.clear();
+            entryCodes[c].clear();
+        }
+        words.offsets.clear();
+        words.lengths.clear();
+        wordCodes.clear();
+        for (int c = 0; c < FLOAT_COLUMNS; c++) {
+            floats[c].clear();
+            floatValid[c].clear();
+        }
+        for (int c = 0; c < COUNT_COLUMNS; c++) {
+            counts[c].clear();
+            countValid[c].clear();
+        }
+        rows = 0;
+    }
+
+    void reserve(size_t n) {
+        for (int c = 0; c < TEXT_COLUMNS; c++) {
+            if (isDictionary(static_cast<TextColumn>(c))) {
+                text[c].codes.reserve(n);
+                continue;
+            }
+            text[c].offsets.reserve(n);
+            text[c].lengths.reserve(n);
+        }
+        for (int c = 0; c < FLOAT_COLUMNS; c++) {
+            floats[c].reserve(n);
+            floatValid[c].reserve(n / 64 + 1);
+        }
+        for (int c = 0; c < COUNT_COLUMNS; c++) {
+            counts[c].reserve(n);
+            countValid[c].reserve(n / 64 + 1);
+        }
+    }
+
+    // ADDS THE POOLS, EVERY COLUMN AND THE NAME WORDS AS SNAPSHOT SECTIONS. THE
+    // STORE MUST NOT CHANGE UNTIL writer.finish()
+    void save(SnapshotWriter& writer) const {
+        const StringPool* pools[] = { &namePool, &manufacturerPool, &categoryPool, &shortPool, &wordPool };
+        for (const StringPool* pool : pools) {
+            writer.add(nullptr, 0);
+            for (size_t i = 0; i < pool->chunkCount(); i++) {
+                writer.append(pool->chunkData(i), pool->chunkBytes(i));
+                writer.append(StringPool::zeros(), pool->chunkGap(i));
+            }
+        }
+        for (int c = 0; c < TEXT_COLUMNS; c++) {
+            writer.addVector(text[c].offsets);
+            writer.addVector(text[c].lengths);
+            writer.addVector(text[c].codes);
+        }
+        writer.addVector(words.offsets);
+        writer.addVector(words.lengths);
+        for (int c = 0; c < FLOAT_COLUMNS; c++) {
+            writer.addVector(floats[c]);
+            writer.addVector(floatValid[c]);
+        }
+        for (int c = 0; c < COUNT_COLUMNS; c++) {
+            writer.addVector(counts[c]);
+            writer.addVector(countValid[c]);
+        }
+    }
+
+    // READS WHAT save() WROTE FOR rowCount ROWS INTO AN EMPTY STORE. THE POOLS ARE
+    // USED IN PLACE FROM THE MAPPING (WHICH MUST OUTLIVE THE STORE), THE FIXED
+    // WIDTH COLUMNS ARE COPIED AND THE DICTIONARY AND WORD LOOKUPS ARE REBUILT.
+    // NOTHING CHANGES IF A SECTION DOES NOT FIT
+    bool load(SnapshotReader& reader, uint32_t rowCount) {
+        StringPool* pools[] = { &namePool, &manufacturerPool, &categoryPool, &shortPool, &wordPool };
+        const char* poolData[5];
+        size_t poolBytes[5];
+        for (int p = 0; p < 5; p++) {
+            poolData[p] = reader.next<char>(poolBytes[p]);
+            if (!poolData[p]) {
+                return false;
+            }
+        }
+
+        size_t bitWords = (static_cast<size_t>(rowCount) + 63) / 64;
+        const uint64_t* offsets[TEXT_COLUMNS];
+        const uint32_t* lengths[TEXT_COLUMNS];
+        const uint32_t* codes[TEXT_COLUMNS];
+        size_t entries[TEXT_COLUMNS];
+        for (int c = 0; c < TEXT_COLUMNS; c++) {
+            TextColumn column = static_cast<TextColumn>(c);
+            offsets[c] = reader.next<uint64_t>(entries[c]);
+            lengths[c] = take<uint32_t>(reader, entries[c]);
+            codes[c] = take<uint32_t>(reader, isDictionary(column) ? rowCount : 0);
+            if (!offsets[c] || !lengths[c] || !codes[c] || (!isDictionary(column) && entries[c] != rowCount)) {
+                return false;
+            }
+            StringPool* pool = &poolFor(column);
+            size_t limit = poolBytes[std::find(pools, pools + 5, pool) - pools];
+            for (size_t e = 0; e < entries[c]; e++) {
+                if (offsets[c][e] > limit || lengths[c][e] > limit - offsets[c][e]) {
+                    return false;
+                }
+            }
+            for (uint32_t r = 0; r < (isDictionary(column) ? rowCount : 0); r++) {
+                if (codes[c][r] >= entries[c]) {
+                    return false;
+                }
+            }
+        }
+        size_t wordCount;
+        const uint64_t* wordOffsets = reader.next<uint64_t>(wordCount);
+        const uint32_t* wordLengths = take<uint32_t>(reader, wordCount);
+        if (!wordOffsets || !wordLengths) {
+            return false;
+        }
+        for (size_t w = 0; w < wordCount; w++) {
+            if (wordOffsets[w] > poolBytes[4] || wordLengths[w] > poolBytes[4] - wordOffsets[w]) {
+                return false;
+            }
+        }
+        for (uint32_t r = 0; r < rowCount; r++) {
+            if (!validCodes(std::string_view(poolData[0] + offsets[NAME][r], lengths[NAME][r]), wordCount)) {
+                return false;
+            }
+        }
+        const float* floatData[FLOAT_COLUMNS];
+        const uint64_t* floatBits[FLOAT_COLUMNS];
+        for (int c = 0; c < FLOAT_COLUMNS; c++) {
+            floatData[c] = take<float>(reader, rowCount);
+            floatBits[c] = take<uint64_t>(reader, bitWords);
+            if (!floatData[c] || !floatBits[c]) {
+                return false;
+            }
+        }
+        const uint32_t* countData[COUNT_COLUMNS];
+        const uint64_t* countBits[COUNT_COLUMNS];
+        for (int c = 0; c < COUNT_COLUMNS; c++) {
+            countData[c] = take<uint32_t>(reader, rowCount);
+            countBits[c] = take<uint64_t>(reader, bitWords);
+            if (!countData[c] || !countBits[c]) {
+                return false;
+            }
+        }
+
+        for (int p = 0; p < 5; p++) {
+            pools[p]->attach(poolData[p], poolBytes[p]);
+        }
+        for (int c = 0; c < TEXT_COLUMNS; c++) {
+            text[c].offsets.assign(offsets[c], offsets[c] + entries[c]);
+            text[c].lengths.assign(lengths[c], lengths[c] + entries[c]);
+            if (!isDictionary(static_cast<TextColumn>(c))) {
+                continue;
+            }
+            text[c].codes.assign(codes[c], codes[c] + rowCount);
+            for (size_t e = 0; e < entries[c]; e++) {
+                entryCodes[c].insert(poolFor(static_cast<TextColumn>(c)).view(text[c].offsets[e], text[c].lengths[e]),
+                    static_cast<uint32_t>(e));
+            }
+        }
+        words.offsets.assign(wordOffsets, wordOffsets + wordCount);
+        words.lengths.assign(wordLengths, wordLengths + wordCount);
+        for (size_t w = 0; w < wordCount; w++) {
+            wordCodes.insert(wordPool.view(words.offsets[w], words.lengths[w]), static_cast<uint32_t>(w));
+        }
+        for (int c = 0; c < FLOAT_COLUMNS; c++) {
+            floats[c].assign(floatData[c], floatData[c] + rowCount);
+            floatValid[c].assign(floatBits[c], floatBits[c] + bitWords);
+        }
+        for (int c = 0; c < COUNT_COLUMNS; c++) {
+            counts[c].assign(countData[c], countData[c] + rowCount);
+            countValid[c].assign(countBits[c], countBits[c] + bitWords);
+        }
+        rows = rowCount;
+        return true;
+    }
+
+    // A DICTIONARY COLUMN COSTS ONE MORE LOAD (THE ROW'S CODE) THAN A PLAIN ONE.
+    // FOR NAME THIS IS THE CODED BYTES, THE TEXT COMES FROM visitText()
+    std::string_view textAt(TextColumn column, uint32_t row) const {
+        const Text& t = text[column];
+        uint32_t i = isDictionary(column) ? t.codes[row] : row;
+        return poolFor(column).view(t.offsets[i], t.lengths[i]);
+    }
+
+    // CALLS visit(PIECE) FOR THE ROW'S TEXT IN ORDER: THE WHOLE VALUE IN ONE
+    // PIECE, OR ONE WORD AT A TIME FOR NAME. NOTHING IS COPIED, SO A PRINT
+    // DECODES STRAIGHT INTO ITS STREAM
+    template<typename Visit>
+    void visitText(TextColumn column, uint32_t row, Visit&& visit) const {
+        std::string_view bytes = textAt(column, row);
+        if (column != NAME) {
+            visit(bytes);
+            return;
+        }
+        const unsigned char* p = reinterpret_cast<const unsigned char*>(bytes.data());
+        const unsigned char* end = p + bytes.size();
+        while (p < end) {
+            uint32_t code = getCode(p);
+            visit(wordPool.view(words.offsets[code], words.lengths[code]));
+        }
+    }
+
+    // THE ROW'S TEXT ADDED TO THE END OF out (A BUFFER THE CALLER REUSES)
+    void appendText(TextColumn column, uint32_t row, std::string& out) const {
+        visitText(column, row, [&out](std::string_view piece) { out.append(piece.data(), piece.size()); });
+    }
+
+    bool hasFloat(FloatColumn column, uint32_t row) const {
+        return getBit(floatValid[column], row);
+    }
+
+    float floatAt(FloatColumn column, uint32_t row) const {
+        return floats[column][row];
+    }
+
+    bool hasCount(CountColumn column, uint32_t row) const {
+        return getBit(countValid[column], row);
+    }
+
+    uint32_t countAt(CountColumn column, uint32_t row) const {
+        return counts[column][row];
+    }
+
+    // RAW COLUMNS FOR SCANS, NULL ROWS HOLD 0 AND HAVE THEIR VALID BIT CLEAR
+    const float* floatColumn(FloatColumn column) const { return floats[column].data(); }
+    const uint32_t* countColumn(CountColumn column) const { return counts[column].data(); }
+    const uint64_t* floatValidBits(FloatColumn column) const { return floatValid[column].data(); }
+    const uint64_t* countValidBits(CountColumn column) const { return countValid[column].data(); }
+
+    size_t size() const {
+        return rows;
+    }
+
+    size_t memoryUsage() const {
+        size_t total = namePool.bytesReserved() + manufacturerPool.bytesReserved()
+            + categoryPool.bytesReserved() + shortPool.bytesReserved() + wordPool.bytesReserved()
+            + words.offsets.capacity() * sizeof(uint64_t) + words.lengths.capacity() * sizeof(uint32_t)
+            + wordCodes.memoryUsage() + coded.capacity();
+        for (int c = 0; c < TEXT_COLUMNS; c++) {
+            total += text[c].offsets.capacity() * sizeof(uint64_t) + text[c].lengths.capacity() * sizeof(uint32_t)
+                + text[c].codes.capacity() * sizeof(uint32_t) + entryCodes[c].memoryUsage();
+        }
+        for (int c = 0; c < FLOAT_COLUMNS; c++) {
+            total += floats[c].capacity() * sizeof(float) + floatValid[c].capacity() * sizeof(uint64_t);
+        }
+        for (int c = 0; c < COUNT_COLUMNS; c++) {
+            total += counts[c].capacity() * sizeof(uint32_t) + countValid[c].capacity() * sizeof(uint64_t);
+        }
+        return total;
+    }
+
+    TextUsage textUsage(TextColumn column) const {
+        const Text& t = text[column];
+        TextUsage usage = { t.offsets.size(), 0, 0 };
+        size_t entryBytes = 0;
+        for (uint32_t length : t.lengths) {
+            entryBytes += length;
+        }
+        if (column == NAME) {
+            size_t wordBytes = 0;
+            for (uint32_t length : words.lengths) {
+                wordBytes += length;
+            }
+            for (uint32_t row = 0; row < rows; row++) {
+                visitText(NAME, row, [&usage](std::string_view word) { usage.plainBytes += word.size(); });
+            }
+            usage.values = words.offsets.size();
+            usage.plainBytes += rows * (sizeof(uint64_t) + sizeof(uint32_t));
+            usage.storedBytes = entryBytes + rows * (sizeof(uint64_t) + sizeof(uint32_t)) + wordBytes
+                + words.offsets.size() * (sizeof(uint64_t) + sizeof(uint32_t)) + wordCodes.memoryUsage();
+            return usage;
+        }
+        if (!isDictionary(column)) {
+            usage.plainBytes = usage.storedBytes = entryBytes + rows * (sizeof(uint64_t) + sizeof(uint32_t));
+            return usage;
+        }
+        for (uint32_t code : t.codes) {
+            usage.plainBytes += t.lengths[code];
+        }
+        usage.plainBytes += rows * (sizeof(uint64_t) + sizeof(uint32_t));
+        usage.storedBytes = entryBytes + t.offsets.size() * (sizeof(uint64_t) + sizeof(uint32_t))
+            + rows * sizeof(uint32_t) + entryCodes[column].memoryUsage();
+        return usage;
+    }
+};
+
+#endif // PRODUCTSTORE_H
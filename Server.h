@@ -0,0 +1,527 @@
+/************************************************************************
+* Programmer:              SURAKANTI SRISHANTH REDDY                    *
+* Class:                   CPTS 223                                     *
+* Programming Assignment:  PA 3                                         *
+* Date:                    OCTOBER 24, 2025                             *
+*                                                                       *
+* Description: 			   QUERY SERVER OVER A UNIX DOMAIN SOCKET. ONE  *
+*                          THREAD RUNS AN epoll LOOP THAT ACCEPTS,      *
+*                          READS NEWLINE DELIMITED REQUESTS AND WRITES  *
+*                          THE REPLIES, A FIXED ThreadPool RUNS THE     *
+*                          HANDLER. A REPLY IS ITS BYTE COUNT ON ONE    *
+*                          LINE FOLLOWED BY THAT MANY BYTES.            *
+*                          QueryClient IS THE BLOCKING CLIENT SIDE.     *
+*                                                                       *
+************************************************************************/
+#pragma once
+#ifndef SERVER_H
+#define SERVER_H
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include "CommandIO.h"
+#include "ThreadPool.h"
+
+class QueryServer {
+public:
+    // WRITES THE REPLY TO ONE REQUEST LINE. IT RUNS ON THE WORKER THREADS, SO IT
+    // MAY ONLY READ WHAT IS SHARED
+    typedef std::function<void(std::string_view request, std::ostream& out)> Handler;
+
+    static const size_t MAX_LINE = size_t(1) << 20;             // A LONGER REQUEST CLOSES THE CONNECTION
+    static const size_t MAX_BATCH = 64;                         // REQUEST LINES PER WORKER TASK
+    static const size_t MAX_UNSENT = size_t(4) << 20;           // NO NEW TASK OR READ WHILE MORE REPLY BYTES WAIT
+
+private:
+    // A CONNECTION HAS AT MOST ONE TASK ON THE POOL, SO REPLIES COME BACK IN
+    // REQUEST ORDER. ITS fd IS ONLY CLOSED WHEN NO TASK HOLDS IT, SO A FINISHED
+    // TASK NEVER FINDS ITS fd REUSED BY ANOTHER CONNECTION
+    struct Connection {
+        int fd;
+        std::string input;
+        size_t consumed;            // BYTES OF input ALREADY HANDED TO A WORKER
+        std::string output;
+        size_t sent;                // BYTES OF output ALREADY WRITTEN
+        bool busy;                  // A WORKER HAS A BATCH OF ITS REQUESTS
+        bool readClosed;            // THE PEER IS DONE SENDING (OR THE SOCKET FAILED)
+        bool writing;               // A WRITE IS WAITING FOR EPOLLOUT
+        uint32_t armed;             // THE EVENTS REGISTERED WITH epoll, 0 WHEN NOT REGISTERED
+    };
+
+    struct Finished {
+        int fd;
+        size_t requests;
+        std::string reply;
+    };
+
+    Handler handler;
+    int listenFd;
+    int epollFd;
+    int wakeFd;                     // eventfd: A TASK FINISHED OR stop() WAS CALLED
+    std::string socketPath;
+    std::vector<std::unique_ptr<Connection>> connections;      // BY FILE DESCRIPTOR
+    std::mutex finishedMutex;
+    std::vector<Finished> finished;
+    std::atomic<bool> stopping;
+    uint64_t requests;
+    uint64_t accepted;
+    ThreadPool workers;             // LAST, SO ITS THREADS ARE JOINED BEFORE THE REST GOES
+
+    void watch(int op, int fd, uint32_t events) {
+        epoll_event event;
+        std::memset(&event, 0, sizeof(event));
+        event.events = events;
+        event.data.fd = fd;
+        epoll_ctl(epollFd, op, fd, &event);
+    }
+
+    // MORE INPUT IS READ ONLY WHILE LESS THAN MAX_LINE OF IT WAITS AND LESS THAN
+    // MAX_UNSENT OF OUTPUT DOES, SO A PEER THAT SENDS FASTER THAN IT READS IS HELD
+    // BACK BY ITS OWN SOCKET BUFFER INSTEAD OF GROWING OURS
+    bool wantsInput(const Connection& c) const {
+        return !c.readClosed && c.input.size() - c.consumed <= MAX_LINE && c.output.size() - c.sent <= MAX_UNSENT;
+    }
+
+    // EPOLLIN WHILE wantsInput, EPOLLOUT WHILE A WRITE WAITS. WITH NEITHER THE fd
+    // LEAVES epoll, WHICH WOULD OTHERWISE KEEP REPORTING THE HANG UP. ONLY A
+    // CHANGE COSTS A SYSTEM CALL, SO IT IS CALLED AFTER ANYTHING THAT MAY CHANGE IT
+    void rearm(Connection& c) {
+        uint32_t events = (wantsInput(c) ? EPOLLIN | EPOLLRDHUP : 0u) | (c.writing ? EPOLLOUT : 0u);
+        if (events == c.armed) {
+            return;
+        }
+        if (events != 0) {
+            watch(c.armed != 0 ? EPOLL_CTL_MOD : EPOLL_CTL_ADD, c.fd, events);
+        }
+        else {
+            epoll_ctl(epollFd, EPOLL_CTL_DEL, c.fd, nullptr);
+        }
+        c.armed = events;
+    }
+
+    void wake() {
+        uint64_t one = 1;
+        ssize_t n = ::write(wakeFd, &one, sizeof(one));
+        (void)n;
+    }
+
+    void acceptAll() {
+        while (true) {
+            int fd = accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if (fd < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                return;                 // EAGAIN, OR OUT OF FILE DESCRIPTORS UNTIL ONE CLOSES
+            }
+            if (static_cast<size_t>(fd) >= connections.size()) {
+                connections.resize(static_cast<size_t>(fd) + 1);
+            }
+            connections[fd].reset(new Connection{ fd, std::string(), 0, std::string(), 0, false, false, false, 0 });
+            rearm(*connections[fd]);
+            accepted++;
+        }
+    }
+
+    void closeConnection(Connection& c) {
+        if (c.armed != 0) {
+            epoll_ctl(epollFd, EPOLL_CTL_DEL, c.fd, nullptr);
+        }
+        ::close(c.fd);
+        connections[c.fd].reset();
+    }
+
+    // THE HANDED OUT FRONT OF input IS ONLY DROPPED ONCE IT IS AT LEAST HALF OF
+    // IT, SO EVERY BYTE IS MOVED AT MOST ONCE ON AVERAGE
+    void readFrom(Connection& c) {
+        char block[65536];
+        while (wantsInput(c)) {
+            ssize_t n = ::read(c.fd, block, sizeof(block));
+            if (n > 0) {
+                if (c.consumed > 0 && c.consumed >= c.input.size() / 2) {
+                    c.input.erase(0, c.consumed);
+                    c.consumed = 0;
+                }
+                c.input.append(block, static_cast<size_t>(n));
+                continue;
+            }
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                break;
+            }
+            c.readClosed = true;
+        }
+        dispatch(c);
+    }
+
+    // WRITES AS MUCH OF THE OUTPUT AS THE SOCKET TAKES, ARMING EPOLLOUT FOR THE
+    // REST. A PEER THAT STOPPED READING LOSES ITS OUTPUT AND ITS PENDING INPUT
+    void flush(Connection& c) {
+        while (c.sent < c.output.size()) {
+            ssize_t n = ::send(c.fd, c.output.data() + c.sent, c.output.size() - c.sent, MSG_NOSIGNAL);
+            if (n > 0) {
+                c.sent += static_cast<size_t>(n);
+                continue;
+            }
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                if (!c.writing) {
+                    c.writing = true;
+                    rearm(c);
+                }
+                return;
+            }
+            c.readClosed = true;
+            c.input.clear();
+            c.consumed = 0;
+            break;
+        }
+        c.output.clear();
+        c.sent = 0;
+        c.writing = false;
+        rearm(c);
+    }
+
+    // HANDS THE NEXT COMPLETE LINES TO A WORKER, OR CLOSES A CONNECTION THAT HAS
+    // NOTHING LEFT TO SEND OR RECEIVE. MAY FREE c
+    void dispatch(Connection& c) {
+        if (c.busy || c.output.size() - c.sent > MAX_UNSENT) {
+            rearm(c);
+            return;
+        }
+        size_t end = c.consumed;
+        size_t lines = 0;
+        while (lines < MAX_BATCH) {
+            size_t newline = c.input.find('\n', end);
+            if (newline == std::string::npos) {
+                break;
+            }
+            end = newline + 1;
+            lines++;
+        }
+        // A LAST LINE WITH NO NEWLINE STILL COUNTS ONCE THE PEER STOPS SENDING
+        if (lines < MAX_BATCH && c.readClosed && end < c.input.size()) {
+            c.input += '\n';
+            end = c.input.size();
+            lines++;
+        }
+
+        if (lines == 0) {
+            if (c.input.size() - c.consumed > MAX_LINE) {
+                c.readClosed = true;
+                c.input.clear();
+                c.consumed = 0;
+            }
+            if (c.readClosed && c.output.empty()) {
+                closeConnection(c);
+                return;
+            }
+            rearm(c);
+            return;
+        }
+
+        std::string batch = c.input.substr(c.consumed, end - c.consumed);
+        c.consumed = end;
+        if (c.consumed == c.input.size()) {
+            c.input.clear();
+            c.consumed = 0;
+        }
+        c.busy = true;
+        rearm(c);
+        int fd = c.fd;
+        workers.submit([this, fd, lines, batch = std::move(batch)] {
+            Finished done = { fd, lines, std::string() };
+            std::string body;
+            StringWriter writer(body);
+            std::ostream out(&writer);
+            for (size_t at = 0; at < batch.size(); ) {
+                size_t newline = batch.find('\n', at);
+                std::string_view line(batch.data() + at, newline - at);
+                at = newline + 1;
+                if (!line.empty() && line.back() == '\r') {
+                    line.remove_suffix(1);
+                }
+                body.clear();
+                try {
+                    handler(line, out);
+                }
+                catch (const std::exception& e) {
+                    body = std::string("ERROR: ") + e.what() + "\n";
+                }
+                done.reply += std::to_string(body.size());
+                done.reply += '\n';
+                done.reply += body;
+            }
+            {
+                std::lock_guard<std::mutex> lock(finishedMutex);
+                finished.push_back(std::move(done));
+            }
+            wake();
+        });
+    }
+
+    void collectFinished() {
+        uint64_t count;
+        ssize_t n = ::read(wakeFd, &count, sizeof(count));
+        (void)n;
+        std::vector<Finished> batch;
+        {
+            std::lock_guard<std::mutex> lock(finishedMutex);
+            batch.swap(finished);
+        }
+        for (Finished& done : batch) {
+            Connection& c = *connections[done.fd];
+            c.busy = false;
+            requests += done.requests;
+            c.output += done.reply;
+            flush(c);
+            dispatch(c);
+        }
+    }
+
+public:
+    QueryServer(Handler handler, size_t threads)
+        : handler(std::move(handler)), listenFd(-1), epollFd(-1), wakeFd(-1), stopping(false),
+        requests(0), accepted(0), workers(threads) {}
+
+    QueryServer(const QueryServer&) = delete;
+    QueryServer& operator=(const QueryServer&) = delete;
+
+    ~QueryServer() {
+        workers.wait();
+        for (std::unique_ptr<Connection>& c : connections) {
+            if (c) {
+                ::close(c->fd);
+            }
+        }
+        if (listenFd >= 0) {
+            ::close(listenFd);
+            ::unlink(socketPath.c_str());
+        }
+        if (epollFd >= 0) {
+            ::close(epollFd);
+        }
+        if (wakeFd >= 0) {
+            ::close(wakeFd);
+        }
+    }
+
+    // BINDS path, REPLACING A STALE SOCKET FILE BUT NEVER ANY OTHER KIND OF FILE.
+    // FALSE WITH error SET WHEN IT CANNOT
+    bool listen(const std::string& path, std::string& error) {
+        sockaddr_un address;
+        std::memset(&address, 0, sizeof(address));
+        address.sun_family = AF_UNIX;
+        if (path.empty() || path.size() >= sizeof(address.sun_path)) {
+            error = "SOCKET PATH MUST BE 1 TO " + std::to_string(sizeof(address.sun_path) - 1) + " BYTES";
+            return false;
+        }
+        std::memcpy(address.sun_path, path.data(), path.size());
+
+        struct stat info;
+        if (::stat(path.c_str(), &info) == 0) {
+            if (!S_ISSOCK(info.st_mode)) {
+                error = "A FILE THAT IS NOT A SOCKET IS IN THE WAY";
+                return false;
+            }
+            ::unlink(path.c_str());
+        }
+
+        listenFd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        epollFd = epoll_create1(EPOLL_CLOEXEC);
+        wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (listenFd < 0 || epollFd < 0 || wakeFd < 0
+            || bind(listenFd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+            error = std::strerror(errno);
+            return false;
+        }
+        socketPath = path;
+        if (::listen(listenFd, SOMAXCONN) != 0) {
+            error = std::strerror(errno);
+            return false;
+        }
+        watch(EPOLL_CTL_ADD, listenFd, EPOLLIN);
+        watch(EPOLL_CTL_ADD, wakeFd, EPOLLIN);
+        return true;
+    }
+
+    // SERVES UNTIL stop(), THEN WAITS FOR THE TASKS STILL ON THE POOL
+    void run() {
+        epoll_event events[64];
+        while (!stopping.load(std::memory_order_relaxed)) {
+            int n = epoll_wait(epollFd, events, 64, -1);
+            if (n < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                break;
+            }
+            for (int i = 0; i < n; i++) {
+                int fd = events[i].data.fd;
+                if (fd == listenFd) {
+                    acceptAll();
+                }
+                else if (fd == wakeFd) {
+                    collectFinished();
+                }
+                else if (static_cast<size_t>(fd) < connections.size() && connections[fd]) {
+                    Connection& c = *connections[fd];
+                    if (events[i].events & (EPOLLOUT | EPOLLHUP | EPOLLERR)) {
+                        flush(c);
+                    }
+                    if (events[i].events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR)) {
+                        readFrom(c);                // MAY CLOSE c
+                    }
+                    else {
+                        dispatch(c);
+                    }
+                }
+            }
+        }
+        workers.wait();
+    }
+
+    // SAFE FROM A SIGNAL HANDLER: ONE ATOMIC STORE AND ONE write()
+    void stop() {
+        stopping.store(true, std::memory_order_relaxed);
+        wake();
+    }
+
+    uint64_t requestCount() const { return requests; }
+    uint64_t connectionCount() const { return accepted; }
+};
+
+// BLOCKING CLIENT FOR ONE CONNECTION. send() MAY BE CALLED SEVERAL TIMES BEFORE
+// THE MATCHING receive()S, REPLIES COME BACK IN REQUEST ORDER
+class QueryClient {
+private:
+    int fd;
+    std::string input;
+    size_t begin;                   // FIRST BYTE OF input NOT HANDED OUT YET
+
+    bool fill() {
+        if (begin > 0) {
+            input.erase(0, begin);
+            begin = 0;
+        }
+        char block[65536];
+        ssize_t n;
+        do {
+            n = ::read(fd, block, sizeof(block));
+        } while (n < 0 && errno == EINTR);
+        if (n <= 0) {
+            return false;
+        }
+        input.append(block, static_cast<size_t>(n));
+        return true;
+    }
+
+public:
+    QueryClient() : fd(-1), begin(0) {}
+
+    QueryClient(const QueryClient&) = delete;
+    QueryClient& operator=(const QueryClient&) = delete;
+
+    ~QueryClient() {
+        if (fd >= 0) {
+            ::close(fd);
+        }
+    }
+
+    // RETRIES FOR UP TO waitSeconds WHILE THE SERVER IS NOT LISTENING YET
+    bool connect(const std::string& path, double waitSeconds = 0) {
+        sockaddr_un address;
+        std::memset(&address, 0, sizeof(address));
+        address.sun_family = AF_UNIX;
+        if (path.empty() || path.size() >= sizeof(address.sun_path)) {
+            return false;
+        }
+        std::memcpy(address.sun_path, path.data(), path.size());
+
+        std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now()
+            + std::chrono::milliseconds(static_cast<int64_t>(waitSeconds * 1000));
+        while (true) {
+            fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+            if (fd < 0) {
+                return false;
+            }
+            if (::connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0) {
+                return true;
+            }
+            int failure = errno;
+            ::close(fd);
+            fd = -1;
+            if ((failure != ENOENT && failure != ECONNREFUSED) || std::chrono::steady_clock::now() >= deadline) {
+                return false;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        }
+    }
+
+    // SENDS ONE REQUEST (A '\n' IS ADDED)
+    bool send(std::string_view request) {
+        std::string line(request);
+        line += '\n';
+        for (size_t at = 0; at < line.size(); ) {
+            ssize_t n = ::send(fd, line.data() + at, line.size() - at, MSG_NOSIGNAL);
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n <= 0) {
+                return false;
+            }
+            at += static_cast<size_t>(n);
+        }
+        return true;
+    }
+
+    // THE NEXT REPLY, FALSE IF THE SERVER CLOSED OR SENT SOMETHING MALFORMED
+    bool receive(std::string& reply) {
+        size_t newline;
+        while ((newline = input.find('\n', begin)) == std::string::npos) {
+            if (!fill()) {
+                return false;
+            }
+        }
+        size_t bytes = 0;
+        for (size_t i = begin; i < newline; i++) {
+            if (input[i] < '0' || input[i] > '9') {
+                return false;
+            }
+            bytes = bytes * 10 + static_cast<size_t>(input[i] - '0');
+        }
+        begin = newline + 1;
+        while (input.size() - begin < bytes) {
+            if (!fill()) {
+                return false;
+            }
+        }
+        reply.assign(input, begin, bytes);
+        begin += bytes;
+        return true;
+    }
+};
+
+#endif // SERVER_H
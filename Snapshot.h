@@ -0,0 +1,331 @@
+/************************************************************************
+* Programmer:              SURAKANTI SRISHANTH REDDY                    *
+* Class:                   CPTS 223                                     *
+* Programming Assignment:  PA 3                                         *
+* Date:                    OCTOBER 24, 2025                             *
+*                                                                       *
+* Description: 			   BINARY SNAPSHOT FILES. A FIXED HEADER (MAGIC *
+*                          VERSION, CHECKSUM, SOURCE CSV SIZE / MTIME)  *
+*                          IS FOLLOWED BY A TABLE OF SECTIONS, EACH ONE *
+*                          A RAW, 64 BYTE ALIGNED ARRAY THAT IS READ    *
+*                          IN PLACE FROM THE MAPPED FILE BY OFFSET.     *
+*                          INDEX ARRAYS ARE SectionArrays, WHICH ARE    *
+*                          EITHER OWNED OR ATTACHED TO A SECTION.       *
+*                                                                       *
+************************************************************************/
+#pragma once
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+#include <sys/stat.h>
+#include "CSVReader.h"
+
+class Snapshot {
+public:
+    static const uint32_t VERSION = 4;
+    static const size_t ALIGN = 64;
+
+    struct Section {
+        uint64_t offset;        // FROM THE START OF THE FILE
+        uint64_t bytes;
+    };
+
+    struct Header {
+        char magic[8];          // "INVSNAP\0"
+        uint32_t version;
+        uint32_t sectionCount;
+        uint64_t fileBytes;
+        uint64_t checksum;      // OF EVERY BYTE AFTER THE HEADER
+        uint64_t sourceBytes;
+        int64_t sourceMtime;    // NANOSECONDS
+        uint64_t rows;
+        uint64_t categories;
+        uint64_t reserved;
+    };
+
+    // SIZE AND MODIFICATION TIME OF path, FALSE IF IT CANNOT BE STAT'd
+    static bool sourceStamp(const std::string& path, uint64_t& bytes, int64_t& mtime) {
+        struct stat st;
+        if (stat(path.c_str(), &st) != 0) {
+            return false;
+        }
+        bytes = static_cast<uint64_t>(st.st_size);
+        mtime = static_cast<int64_t>(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
+        return true;
+    }
+
+    // FOUR INDEPENDENT MULTIPLY / XOR LANES SO THE CHECK RUNS AT MEMORY SPEED
+    static uint64_t checksum(const char* data, size_t size) {
+        const uint64_t prime = 0x9E3779B97F4A7C15ULL;
+        uint64_t lane[4] = { 1, 2, 3, 4 };
+        size_t i = 0;
+        for (; i + 32 <= size; i += 32) {
+            for (int k = 0; k < 4; k++) {
+                uint64_t word;
+                std::memcpy(&word, data + i + 8 * k, 8);
+                lane[k] = (lane[k] ^ word) * prime;
+                lane[k] ^= lane[k] >> 29;
+            }
+        }
+        uint64_t h = size;
+        for (int k = 0; k < 4; k++) {
+            h = (h ^ lane[k]) * prime;
+        }
+        for (; i < size; i++) {
+            h = (h ^ static_cast<unsigned char>(data[i])) * prime;
+        }
+        return h ^ (h >> 32);
+    }
+
+    static void initHeader(Header& header) {
+        std::memset(&header, 0, sizeof(header));
+        std::memcpy(header.magic, "INVSNAP", 8);
+        header.version = VERSION;
+    }
+};
+
+// AN ARRAY THAT IS EITHER ITS OWN std::vector OR attach()ED, READ ONLY, TO A
+// SECTION OF A MAPPED SNAPSHOT (WHICH MUST OUTLIVE IT). READS LOOK THE SAME
+// EITHER WAY; A CHANGE GOES THROUGH edit(), WHICH COPIES AN ATTACHED ARRAY OUT
+// FIRST, OR REPLACES THE WHOLE ARRAY WITH assign()
+template<typename T>
+class SectionArray {
+private:
+    std::vector<T> owned;
+    const T* mapped;        // NULL UNLESS ATTACHED
+    size_t mappedCount;
+
+public:
+    SectionArray() : mapped(nullptr), mappedCount(0) {}
+    SectionArray(size_t count, const T& value) : owned(count, value), mapped(nullptr), mappedCount(0) {}
+
+    void attach(const T* data, size_t count) {
+        std::vector<T>().swap(owned);
+        mapped = data;
+        mappedCount = count;
+    }
+
+    bool attached() const { return mapped != nullptr; }
+
+    std::vector<T>& edit() {
+        if (mapped) {
+            owned.assign(mapped, mapped + mappedCount);
+            mapped = nullptr;
+        }
+        return owned;
+    }
+
+    void assign(std::vector<T>&& values) {
+        owned = std::move(values);
+        mapped = nullptr;
+    }
+
+    void clear() {
+        owned.clear();
+        mapped = nullptr;
+    }
+
+    const T* data() const { return mapped ? mapped : owned.data(); }
+    size_t size() const { return mapped ? mappedCount : owned.size(); }
+    bool empty() const { return size() == 0; }
+    const T* begin() const { return data(); }
+    const T* end() const { return data() + size(); }
+    const T& operator[](size_t i) const { return data()[i]; }
+    const T& back() const { return data()[size() - 1]; }
+
+    // HEAP ELEMENTS HELD, NONE WHILE ATTACHED
+    size_t capacity() const { return owned.capacity(); }
+};
+
+// COLLECTS SECTIONS IN MEMORY ORDER AND WRITES THEM WITH finish(). THE FILE IS
+// WRITTEN UNDER A TEMPORARY NAME AND RENAMED, SO A CRASH NEVER LEAVES A TORN ONE
+class SnapshotWriter {
+private:
+    struct Pending {
+        std::vector<const char*> pieces;
+        std::vector<size_t> sizes;
+        uint64_t bytes = 0;
+    };
+    std::vector<Pending> sections;
+    std::vector<std::shared_ptr<void>> kept;
+
+public:
+    // THE BYTES ARE NOT COPIED, THEY MUST STAY ALIVE UNTIL finish()
+    void add(const void* data, size_t bytes) {
+        sections.emplace_back();
+        append(data, bytes);
+    }
+
+    // EXTENDS THE LAST SECTION (E.G. ONE STRING POOL CHUNK AFTER ANOTHER)
+    void append(const void* data, size_t bytes) {
+        if (bytes == 0) {
+            return;
+        }
+        sections.back().pieces.push_back(static_cast<const char*>(data));
+        sections.back().sizes.push_back(bytes);
+        sections.back().bytes += bytes;
+    }
+
+    // A std::vector OR A SectionArray
+    template<typename Array>
+    void addVector(const Array& values) {
+        add(values.data(), values.size() * sizeof(*values.data()));
+    }
+
+    // A T BUILT FROM args THAT LIVES AS LONG AS THE WRITER, FOR SECTIONS THAT
+    // ARE MADE ONLY TO BE SAVED (E.G. AN INDEX WITH ITS PENDING CHANGES MERGED)
+    template<typename T, typename... Args>
+    T& keep(Args&&... args) {
+        std::shared_ptr<T> value = std::make_shared<T>(std::forward<Args>(args)...);
+        kept.push_back(value);
+        return *value;
+    }
+
+    bool finish(const std::string& path, Snapshot::Header header) {
+        std::vector<Snapshot::Section> table(sections.size());
+        uint64_t offset = sizeof(Snapshot::Header) + sections.size() * sizeof(Snapshot::Section);
+        for (size_t i = 0; i < sections.size(); i++) {
+            offset = (offset + Snapshot::ALIGN - 1) / Snapshot::ALIGN * Snapshot::ALIGN;
+            table[i].offset = offset;
+            table[i].bytes = sections[i].bytes;
+            offset += sections[i].bytes;
+        }
+
+        header.sectionCount = static_cast<uint32_t>(sections.size());
+        header.fileBytes = offset;
+        header.checksum = 0;
+
+        std::string temp = path + ".tmp";
+        FILE* out = std::fopen(temp.c_str(), "w+b");
+        if (!out) {
+            return false;
+        }
+        static const char zeros[Snapshot::ALIGN] = {};
+        bool ok = std::fwrite(&header, sizeof(header), 1, out) == 1
+            && std::fwrite(table.data(), sizeof(Snapshot::Section), table.size(), out) == table.size();
+        uint64_t written = sizeof(Snapshot::Header) + table.size() * sizeof(Snapshot::Section);
+        for (size_t i = 0; ok && i < sections.size(); i++) {
+            size_t padding = static_cast<size_t>(table[i].offset - written);
+            ok = std::fwrite(zeros, 1, padding, out) == padding;
+            for (size_t p = 0; ok && p < sections[i].pieces.size(); p++) {
+                ok = std::fwrite(sections[i].pieces[p], 1, sections[i].sizes[p], out) == sections[i].sizes[p];
+            }
+            written = table[i].offset + table[i].bytes;
+        }
+        ok = ok && std::fflush(out) == 0;
+
+        // CHECKSUM WHAT ACTUALLY LANDED IN THE FILE, THEN PATCH THE HEADER
+        if (ok) {
+            MappedFile check;
+            ok = check.open(temp) && check.size() == offset;
+            if (ok) {
+                header.checksum = Snapshot::checksum(check.data() + sizeof(Snapshot::Header),
+                    check.size() - sizeof(Snapshot::Header));
+            }
+        }
+        ok = ok && std::fseek(out, 0, SEEK_SET) == 0 && std::fwrite(&header, sizeof(header), 1, out) == 1;
+        ok = std::fclose(out) == 0 && ok;
+        if (!ok || std::rename(temp.c_str(), path.c_str()) != 0) {
+            std::remove(temp.c_str());
+            return false;
+        }
+        return true;
+    }
+};
+
+// MAPS A SNAPSHOT, CHECKS IT AND HANDS THE SECTIONS OUT IN THE ORDER THEY WERE
+// ADDED. POINTERS STAY VALID WHILE THE READER (ITS MAPPING) IS ALIVE
+class SnapshotReader {
+private:
+    MappedFile file;
+    const Snapshot::Header* header;
+    const Snapshot::Section* table;
+    size_t nextSection;
+    std::string error;
+
+    bool fail(const std::string& why) {
+        error = why;
+        header = nullptr;
+        file.close();
+        return false;
+    }
+
+public:
+    SnapshotReader() : header(nullptr), table(nullptr), nextSection(0) {}
+
+    // MAPS path AND CHECKS THE HEADER AND SECTION TABLE, BUT NOT THE CHECKSUM, SO
+    // A STALE SNAPSHOT CAN BE TURNED DOWN WITHOUT READING ALL OF IT
+    bool open(const std::string& path) {
+        if (!file.open(path, false)) {
+            return fail("CANNOT OPEN " + path);
+        }
+        if (file.size() < sizeof(Snapshot::Header)) {
+            return fail("FILE TOO SMALL");
+        }
+        header = reinterpret_cast<const Snapshot::Header*>(file.data());
+        if (std::memcmp(header->magic, "INVSNAP", 8) != 0) {
+            return fail("NOT A SNAPSHOT");
+        }
+        if (header->version != Snapshot::VERSION) {
+            return fail("UNSUPPORTED VERSION " + std::to_string(header->version));
+        }
+        if (header->fileBytes != file.size()
+            || sizeof(Snapshot::Header) + header->sectionCount * sizeof(Snapshot::Section) > file.size()) {
+            return fail("TRUNCATED");
+        }
+        table = reinterpret_cast<const Snapshot::Section*>(file.data() + sizeof(Snapshot::Header));
+        for (uint32_t i = 0; i < header->sectionCount; i++) {
+            if (table[i].offset % Snapshot::ALIGN != 0 || table[i].offset + table[i].bytes > file.size()) {
+                return fail("BAD SECTION TABLE");
+            }
+        }
+        nextSection = 0;
+        return true;
+    }
+
+    bool verify() {
+        if (!header) {
+            return false;
+        }
+        if (Snapshot::checksum(file.data() + sizeof(Snapshot::Header), file.size() - sizeof(Snapshot::Header))
+            != header->checksum) {
+            return fail("CHECKSUM MISMATCH");
+        }
+        return true;
+    }
+
+    void close() {
+        header = nullptr;
+        table = nullptr;
+        file.close();
+    }
+
+    const Snapshot::Header& getHeader() const {
+        return *header;
+    }
+
+    const std::string& lastError() const {
+        return error;
+    }
+
+    // THE NEXT SECTION AS count ELEMENTS OF T, NULL ONCE THE SECTIONS RUN OUT
+    template<typename T>
+    const T* next(size_t& count) {
+        if (!header || nextSection >= header->sectionCount || table[nextSection].bytes % sizeof(T) != 0) {
+            count = 0;
+            return nullptr;
+        }
+        const Snapshot::Section& section = table[nextSection++];
+        count = static_cast<size_t>(section.bytes / sizeof(T));
+        return reinterpret_cast<const T*>(file.data() + section.offset);
+    }
+};
+
+#endif // SNAPSHOT_H
@@ -0,0 +1,341 @@
+/************************************************************************
+* Programmer:              SURAKANTI SRISHANTH REDDY                    *
+* Class:                   CPTS 223                                     *
+* Programming Assignment:  PA 3                                         *
+* Date:                    OCTOBER 24, 2025                             *
+*                                                                       *
+* Description: 			   SORTED SECONDARY INDEX OVER ONE NUMERIC      *
+*                          COLUMN. (VALUE, ROW) PAIRS ARE KEPT IN TWO   *
+*                          PARALLEL SORTED ARRAYS AND EVERY 64TH KEY IS *
+*                          COPIED INTO A SMALL FENCE ARRAY, SO A SEARCH *
+*                          BISECTS THE CACHE RESIDENT FENCES FIRST AND  *
+*                          THEN ONLY ONE 64 KEY BLOCK. CHANGES LAND IN  *
+*                          A SMALL SORTED SIDE BUFFER AND A BITMAP OF   *
+*                          REMOVED ROWS UNTIL merge() FOLDS THEM IN.    *
+*                          A SNAPSHOT CARRIES THE ARRAYS AS THEY ARE.   *
+*                                                                       *
+************************************************************************/
+#pragma once
+#ifndef SORTEDINDEX_H
+#define SORTEDINDEX_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include "Snapshot.h"
+
+class SortedIndex {
+public:
+    static const size_t FENCE = 64;
+
+private:
+    SectionArray<float> keys;       // ASCENDING, TIES IN ROW ORDER
+    SectionArray<uint32_t> rows;    // rows[i] IS THE ROW WITH keys[i]
+    SectionArray<float> fences;     // fences[b] == keys[b * FENCE]
+
+    // CHANGES SINCE THE LAST build() / merge(): ROWS WHOSE ENTRY ABOVE IS GONE
+    // (ONE BIT PER ROW) AND NEW ENTRIES, SORTED LIKE keys / rows
+    std::vector<uint64_t> removedRows;
+    size_t removedCount;
+    std::vector<float> addedKeys;
+    std::vector<uint32_t> addedRows;
+
+    static const unsigned RADIX_BITS = 11;
+
+    // MAPS A FLOAT TO AN UNSIGNED INTEGER WITH THE SAME ORDER (-0 IS FOLDED INTO 0)
+    static uint32_t orderedBits(float value) {
+        value += 0.0f;
+        uint32_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        return (bits & 0x80000000u) ? ~bits : (bits | 0x80000000u);
+    }
+
+    // FIRST POSITION WHOSE KEY DOES NOT SATISFY before(key, probe)
+    template<typename Before>
+    size_t search(float probe, Before before) const {
+        // THE LAST BLOCK WHOSE FIRST KEY IS STILL BEFORE THE PROBE HOLDS THE ANSWER
+        size_t block = static_cast<size_t>(std::partition_point(fences.begin(), fences.end(),
+            [&](float fence) { return before(fence, probe); }) - fences.begin());
+        if (block == 0) {
+            return 0;
+        }
+        size_t first = (block - 1) * FENCE;
+        size_t last = std::min(first + FENCE, keys.size());
+        return static_cast<size_t>(std::partition_point(keys.begin() + first, keys.begin() + last,
+            [&](float key) { return before(key, probe); }) - keys.begin());
+    }
+
+    bool removed(uint32_t row) const {
+        return (row >> 6) < removedRows.size() && ((removedRows[row >> 6] >> (row & 63)) & 1);
+    }
+
+    // FIRST ADDED POSITION NOT BEFORE (value, row)
+    size_t addedBound(float value, uint32_t row) const {
+        size_t low = 0;
+        size_t high = addedKeys.size();
+        while (low < high) {
+            size_t mid = low + (high - low) / 2;
+            if (addedKeys[mid] < value || (addedKeys[mid] == value && addedRows[mid] < row)) {
+                low = mid + 1;
+            }
+            else {
+                high = mid;
+            }
+        }
+        return low;
+    }
+
+    void makeFences() {
+        std::vector<float> made;
+        made.reserve((keys.size() + FENCE - 1) / FENCE);
+        for (size_t i = 0; i < keys.size(); i += FENCE) {
+            made.push_back(keys[i]);
+        }
+        fences.assign(std::move(made));
+    }
+
+    void dropChanges() {
+        std::vector<uint64_t>().swap(removedRows);
+        removedCount = 0;
+        std::vector<float>().swap(addedKeys);
+        std::vector<uint32_t>().swap(addedRows);
+    }
+
+public:
+    SortedIndex() : removedCount(0) {}
+
+    // INDEXES values[row] FOR EVERY ROW WHOSE BIT IS SET IN valid (ONE BIT PER
+    // ROW, 64 PER WORD). ROWS WITHOUT A VALUE ARE LEFT OUT. THE ROWS ARRIVE IN
+    // ORDER, SO A STABLE LSD RADIX SORT ON THE KEY BITS (THREE 11 BIT PASSES)
+    // LEAVES TIES IN ROW ORDER WITHOUT COMPARING ROWS
+    void build(const float* values, const uint64_t* valid, size_t count) {
+        std::vector<uint32_t> bits;
+        std::vector<uint32_t> order;
+        bits.reserve(count);
+        order.reserve(count);
+        for (size_t row = 0; row < count; row++) {
+            if ((valid[row >> 6] >> (row & 63)) & 1) {
+                bits.push_back(orderedBits(values[row]));
+                order.push_back(static_cast<uint32_t>(row));
+            }
+        }
+
+        size_t n = bits.size();
+        std::vector<uint32_t> bitsOut(n);
+        std::vector<uint32_t> rowsOut(n);
+        std::vector<size_t> histogram(size_t(1) << RADIX_BITS);
+        for (unsigned shift = 0; shift < 32; shift += RADIX_BITS) {
+            const uint32_t mask = (uint32_t(1) << RADIX_BITS) - 1;
+            std::fill(histogram.begin(), histogram.end(), 0);
+            for (size_t i = 0; i < n; i++) {
+                histogram[(bits[i] >> shift) & mask]++;
+            }
+            if (n == 0 || histogram[(bits[0] >> shift) & mask] == n) {
+                continue;       // EVERY KEY HAS THE SAME DIGIT, THE PASS WOULD NOT MOVE ANYTHING
+            }
+            size_t sum = 0;
+            for (size_t& slot : histogram) {
+                size_t c = slot;
+                slot = sum;
+                sum += c;
+            }
+            for (size_t i = 0; i < n; i++) {
+                size_t to = histogram[(bits[i] >> shift) & mask]++;
+                bitsOut[to] = bits[i];
+                rowsOut[to] = order[i];
+            }
+            bits.swap(bitsOut);
+            order.swap(rowsOut);
+        }
+
+        std::vector<float> sorted(n);
+        for (size_t i = 0; i < n; i++) {
+            sorted[i] = values[order[i]] + 0.0f;
+        }
+        order.shrink_to_fit();
+        keys.assign(std::move(sorted));
+        rows.assign(std::move(order));
+        makeFences();
+        dropChanges();
+    }
+
+    void clear() {
+        keys.clear();
+        rows.clear();
+        fences.clear();
+        dropChanges();
+    }
+
+    // ADDS AN ENTRY FOR row, WHICH MUST NOT HAVE ONE
+    void insert(float value, uint32_t row) {
+        value += 0.0f;
+        size_t at = addedBound(value, row);
+        addedKeys.insert(addedKeys.begin() + at, value);
+        addedRows.insert(addedRows.begin() + at, row);
+    }
+
+    // DROPS row's ENTRY, value IS THE KEY IT WAS ADDED WITH
+    void erase(float value, uint32_t row) {
+        value += 0.0f;
+        size_t at = addedBound(value, row);
+        if (at < addedKeys.size() && addedKeys[at] == value && addedRows[at] == row) {
+            addedKeys.erase(addedKeys.begin() + at);
+            addedRows.erase(addedRows.begin() + at);
+            return;
+        }
+        if ((row >> 6) >= removedRows.size()) {
+            removedRows.resize((row >> 6) + 1, 0);
+        }
+        removedRows[row >> 6] |= uint64_t(1) << (row & 63);
+        removedCount++;
+    }
+
+    // CHANGES NOT FOLDED INTO THE SORTED ARRAYS YET
+    size_t pending() const { return removedCount + addedKeys.size(); }
+
+    // FOLDS THE PENDING CHANGES INTO THE SORTED ARRAYS, ONE LINEAR MERGE
+    void merge() {
+        if (pending() == 0) {
+            return;
+        }
+        std::vector<float> mergedKeys;
+        std::vector<uint32_t> mergedRows;
+        mergedKeys.reserve(size());
+        mergedRows.reserve(size());
+        visitRange(-HUGE_VALF, HUGE_VALF, [&](float key, uint32_t row) {
+            mergedKeys.push_back(key);
+            mergedRows.push_back(row);
+            return true;
+        });
+        keys.assign(std::move(mergedKeys));
+        rows.assign(std::move(mergedRows));
+        makeFences();
+        dropChanges();
+    }
+
+    // ADDS keys, rows AND fences AS SNAPSHOT SECTIONS, PENDING CHANGES MERGED
+    // INTO A COPY THE WRITER KEEPS. THE INDEX MUST NOT CHANGE UNTIL writer.finish()
+    void save(SnapshotWriter& writer) const {
+        if (pending() > 0) {
+            SortedIndex& merged = writer.keep<SortedIndex>(*this);
+            merged.merge();
+            merged.save(writer);
+            return;
+        }
+        writer.addVector(keys);
+        writer.addVector(rows);
+        writer.addVector(fences);
+    }
+
+    // USES WHAT save() WROTE IN PLACE FROM THE MAPPING (WHICH MUST OUTLIVE THE
+    // INDEX) IF EVERY ROW IS BELOW rowCount. NOTHING CHANGES IF A SECTION DOES NOT FIT
+    bool attach(SnapshotReader& reader, size_t rowCount) {
+        size_t count, rowEntries, fenceCount;
+        const float* keyData = reader.next<float>(count);
+        const uint32_t* rowData = reader.next<uint32_t>(rowEntries);
+        const float* fenceData = reader.next<float>(fenceCount);
+        if (!keyData || !rowData || !fenceData || rowEntries != count || fenceCount != (count + FENCE - 1) / FENCE) {
+            return false;
+        }
+        for (size_t i = 0; i < count; i++) {
+            if (rowData[i] >= rowCount) {
+                return false;
+            }
+        }
+        keys.attach(keyData, count);
+        rows.attach(rowData, count);
+        fences.attach(fenceData, fenceCount);
+        dropChanges();
+        return true;
+    }
+
+    // CALLS visit(key, row) FOR EVERY ENTRY WITH lo <= KEY <= hi, PENDING CHANGES
+    // INCLUDED, IN ASCENDING (KEY, ROW) ORDER UNTIL IT RETURNS FALSE
+    template<typename Visit>
+    void visitRange(float lo, float hi, Visit visit) const {
+        size_t b = lowerBound(lo);
+        size_t bEnd = upperBound(hi);
+        size_t a = static_cast<size_t>(std::partition_point(addedKeys.begin(), addedKeys.end(),
+            [&](float key) { return key < lo; }) - addedKeys.begin());
+        size_t aEnd = static_cast<size_t>(std::partition_point(addedKeys.begin(), addedKeys.end(),
+            [&](float key) { return !(hi < key); }) - addedKeys.begin());
+        while (b < bEnd || a < aEnd) {
+            if (a == aEnd || (b < bEnd && (keys[b] < addedKeys[a] || (keys[b] == addedKeys[a] && rows[b] < addedRows[a])))) {
+                if (!(removedCount > 0 && removed(rows[b])) && !visit(keys[b], rows[b])) {
+                    return;
+                }
+                b++;
+            }
+            else {
+                if (!visit(addedKeys[a], addedRows[a])) {
+                    return;
+                }
+                a++;
+            }
+        }
+    }
+
+    // THE SAME OVER EVERY ENTRY, FROM THE HIGHEST KEY DOWN (TIES IN DESCENDING ROW ORDER)
+    template<typename Visit>
+    void visitDescending(Visit visit) const {
+        size_t b = keys.size();
+        size_t a = addedKeys.size();
+        while (b > 0 || a > 0) {
+            if (a == 0 || (b > 0 && (addedKeys[a - 1] < keys[b - 1]
+                || (addedKeys[a - 1] == keys[b - 1] && addedRows[a - 1] < rows[b - 1])))) {
+                b--;
+                if (!(removedCount > 0 && removed(rows[b])) && !visit(keys[b], rows[b])) {
+                    return;
+                }
+            }
+            else {
+                a--;
+                if (!visit(addedKeys[a], addedRows[a])) {
+                    return;
+                }
+            }
+        }
+    }
+
+    // AN UPPER BOUND ON THE ENTRIES WITH lo <= KEY <= hi: REMOVED ROWS STILL
+    // COUNT UNTIL THE NEXT merge()
+    size_t countUpperBound(float lo, float hi) const {
+        size_t first = lowerBound(lo);
+        size_t last = upperBound(hi);
+        size_t base = last > first ? last - first : 0;
+        size_t a = static_cast<size_t>(std::partition_point(addedKeys.begin(), addedKeys.end(),
+            [&](float key) { return key < lo; }) - addedKeys.begin());
+        size_t aEnd = static_cast<size_t>(std::partition_point(addedKeys.begin(), addedKeys.end(),
+            [&](float key) { return !(hi < key); }) - addedKeys.begin());
+        return base + (aEnd > a ? aEnd - a : 0);
+    }
+
+    // POSITIONS BELOW ARE INTO THE SORTED ARRAYS AND DO NOT SEE PENDING
+    // CHANGES, visitRange() AND visitDescending() DO
+
+    // FIRST POSITION WITH A KEY >= value
+    size_t lowerBound(float value) const {
+        return search(value, [](float key, float probe) { return key < probe; });
+    }
+
+    // FIRST POSITION WITH A KEY > value
+    size_t upperBound(float value) const {
+        return search(value, [](float key, float probe) { return !(probe < key); });
+    }
+
+    // ENTRIES, PENDING CHANGES INCLUDED
+    size_t size() const { return keys.size() - removedCount + addedKeys.size(); }
+    bool empty() const { return size() == 0; }
+    float keyAt(size_t i) const { return keys[i]; }
+    uint32_t rowAt(size_t i) const { return rows[i]; }
+
+    size_t memoryUsage() const {
+        return keys.capacity() * sizeof(float) + rows.capacity() * sizeof(uint32_t)
+            + fences.capacity() * sizeof(float) + removedRows.capacity() * sizeof(uint64_t)
+            + addedKeys.capacity() * sizeof(float) + addedRows.capacity() * sizeof(uint32_t);
+    }
+};
+
+#endif // SORTEDINDEX_H
@@ -0,0 +1,95 @@
+/************************************************************************
+* Programmer:              SURAKANTI SRISHANTH REDDY                    *
+* Class:                   CPTS 223                                     *
+* Programming Assignment:  PA 3                                         *
+* Date:                    OCTOBER 24, 2025                             *
+*                                                                       *
+* Description: 			   HOT PATH INSTRUMENTATION. BUILT WITH         *
+*                          -DINVENTORY_STATS (make STATS=1) THE HASH    *
+*                          TABLE COUNTS PROBES AND TIMES REHASHES AND   *
+*                          THE LOADER TIMES ITS PHASES. WITHOUT IT THE  *
+*                          HOOKS ARE NOT COMPILED IN AT ALL.            *
+*                                                                       *
+************************************************************************/
+#pragma once
+#ifndef STATS_H
+#define STATS_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace Stats {
+#ifdef INVENTORY_STATS
+    static const bool ENABLED = true;
+#else
+    static const bool ENABLED = false;
+#endif
+
+    inline uint64_t nanosNow() {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+    // SPLITS A RUN OF WORK INTO PHASES: lap() ADDS THE TIME SINCE THE LAST LAP
+    // (OR restart()) TO ONE PHASE'S TOTAL
+    class PhaseClock {
+    private:
+        uint64_t last;
+
+    public:
+        PhaseClock() : last(nanosNow()) {}
+
+        void lap(uint64_t& total) {
+            uint64_t now = nanosNow();
+            total += now - last;
+            last = now;
+        }
+
+        void restart() {
+            last = nanosNow();
+        }
+    };
+}
+
+// COUNTS OF SMALL VALUES (CHAIN LENGTHS, PROBES), THE LAST BUCKET TAKES
+// EVERYTHING FROM BUCKETS - 1 UP
+struct Histogram {
+    static const size_t BUCKETS = 16;
+    uint64_t counts[BUCKETS] = {};
+    uint64_t samples = 0;
+    uint64_t sum = 0;
+
+    void add(size_t value) {
+        counts[value < BUCKETS ? value : BUCKETS - 1]++;
+        samples++;
+        sum += value;
+    }
+
+    double mean() const {
+        return samples ? static_cast<double>(sum) / static_cast<double>(samples) : 0.0;
+    }
+};
+
+// WHAT HashTable::stats() REPORTS. THE OCCUPANCY FIELDS COME FROM A SCAN OF THE
+// BUCKETS AND ARE ALWAYS THERE, THE COUNTERS STAY ZERO UNLESS Stats::ENABLED
+struct HashTableStats {
+    bool enabled = Stats::ENABLED;
+    size_t size = 0;
+    size_t buckets = 0;
+    double loadFactor = 0.0;
+    size_t emptyBuckets = 0;
+    size_t longestChain = 0;
+    Histogram chainLengths;         // ONE SAMPLE PER BUCKET, ITS NODE COUNT
+    bool rehashing = false;
+
+    uint64_t finds = 0;             // EVERY LOOKUP, INCLUDING THE ONE EACH INSERT MAKES
+    uint64_t hits = 0;
+    Histogram probes;               // NODES COMPARED PER LOOKUP
+    uint64_t rehashes = 0;
+    uint64_t rehashNanos = 0;       // RESIZES PLUS INCREMENTAL MIGRATION STEPS
+    uint64_t longestRehashNanos = 0;
+    uint64_t migratedBuckets = 0;
+};
+
+#endif // STATS_H
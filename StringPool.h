@@ -0,0 +1,157 @@
+/************************************************************************
+* Programmer:              SURAKANTI SRISHANTH REDDY                    *
+* Class:                   CPTS 223                                     *
+* Programming Assignment:  PA 3                                         *
+* Date:                    OCTOBER 24, 2025                             *
+*                                                                       *
+* Description: 			   APPEND ONLY TEXT POOL ADDRESSED BY 64 BIT    *
+*                          OFFSETS. THE LOGICAL BYTE SPACE IS CUT INTO  *
+*                          FIXED SIZE CHUNKS THAT NEVER MOVE, SO VIEWS  *
+*                          STAY VALID WHILE THE POOL GROWS, AND AN      *
+*                          OFFSET RESOLVES WITH ONE SHIFT AND ONE MASK. *
+*                                                                       *
+************************************************************************/
+#pragma once
+#ifndef STRINGPOOL_H
+#define STRINGPOOL_H
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <string_view>
+#include <vector>
+
+class StringPool {
+public:
+    static const unsigned CHUNK_SHIFT = 18;                 // 256 KB CHUNKS
+    static const uint64_t CHUNK_SIZE = uint64_t(1) << CHUNK_SHIFT;
+    static const uint64_t CHUNK_MASK = CHUNK_SIZE - 1;
+
+private:
+    // chunkBase[i] POINTS AT LOGICAL BYTE i * CHUNK_SIZE. A STRING LONGER THAN A
+    // CHUNK GETS ONE BLOCK SPANNING SEVERAL CHUNK SLOTS, SO NO STRING EVER
+    // STRADDLES TWO SEPARATE ALLOCATIONS
+    std::vector<char*> chunkBase;
+    std::vector<char*> blocks;          // WHAT WE malloc'd AND MUST free
+    uint64_t used;                      // NEXT FREE LOGICAL OFFSET
+    uint64_t bytesStored;
+    uint64_t attached;                  // BYTES OF attach()ED DATA AT THE START, ITS LAST CHUNK RUNS PAST IT
+
+    void addBlock(uint64_t chunks) {
+        char* block = static_cast<char*>(std::malloc(chunks * CHUNK_SIZE));
+        if (!block) {
+            throw std::bad_alloc();
+        }
+        blocks.push_back(block);
+        for (uint64_t i = 0; i < chunks; i++) {
+            chunkBase.push_back(block + i * CHUNK_SIZE);
+        }
+    }
+
+    // ZEROES WHAT IS LEFT OF THE LAST CHUNK. attach()ED CHUNKS ARE NEVER WRITTEN,
+    // used IS AT THEIR END ALREADY
+    void padTail() {
+        uint64_t end = chunkBase.size() * CHUNK_SIZE;
+        if (used < end) {
+            std::memset(chunkBase[used >> CHUNK_SHIFT] + (used & CHUNK_MASK), 0, static_cast<size_t>(end - used));
+        }
+    }
+
+public:
+    StringPool() : used(0), bytesStored(0), attached(0) {}
+
+    StringPool(const StringPool&) = delete;
+    StringPool& operator=(const StringPool&) = delete;
+
+    ~StringPool() {
+        for (char* block : blocks) {
+            std::free(block);
+        }
+    }
+
+    // COPIES s INTO THE POOL AND RETURNS ITS OFFSET
+    uint64_t append(std::string_view s) {
+        uint64_t room = chunkBase.size() * CHUNK_SIZE - used;
+        if (s.size() > room) {
+            // START A FRESH CHUNK, THE TAIL OF THE CURRENT ONE IS ZEROED PADDING
+            // SO A SNAPSHOT OF THE POOL NEVER CARRIES STALE HEAP BYTES
+            padTail();
+            used = chunkBase.size() * CHUNK_SIZE;
+            addBlock((s.size() + CHUNK_SIZE - 1) / CHUNK_SIZE);
+        }
+        uint64_t offset = used;
+        if (!s.empty()) {
+            std::memcpy(chunkBase[offset >> CHUNK_SHIFT] + (offset & CHUNK_MASK), s.data(), s.size());
+        }
+        used += s.size();
+        bytesStored += s.size();
+        return offset;
+    }
+
+    std::string_view view(uint64_t offset, uint32_t length) const {
+        if (length == 0) {
+            return std::string_view();
+        }
+        return std::string_view(chunkBase[offset >> CHUNK_SHIFT] + (offset & CHUNK_MASK), length);
+    }
+
+    // MOVES ALL OF other'S CHUNKS TO THE END OF THIS POOL WITHOUT COPYING BYTES.
+    // RETURNS THE AMOUNT TO ADD TO other'S OFFSETS
+    uint64_t adopt(StringPool& other) {
+        if (other.chunkBase.empty()) {
+            return 0;
+        }
+        padTail();
+        uint64_t shift = chunkBase.size() * CHUNK_SIZE;
+        chunkBase.insert(chunkBase.end(), other.chunkBase.begin(), other.chunkBase.end());
+        blocks.insert(blocks.end(), other.blocks.begin(), other.blocks.end());
+        used = shift + other.used;
+        bytesStored += other.bytesStored;
+
+        other.chunkBase.clear();
+        other.blocks.clear();
+        other.used = 0;
+        other.bytesStored = 0;
+        return shift;
+    }
+
+    // MAKES THE FIRST size BYTES OF data THE CONTENTS OF AN EMPTY POOL WITHOUT
+    // COPYING THEM (A MAPPED SNAPSHOT). data IS NEVER WRITTEN OR FREED AND MUST OUTLIVE THE
+    // POOL, NEW STRINGS GO INTO FRESH CHUNKS AFTER IT
+    void attach(const char* data, uint64_t size) {
+        uint64_t chunks = (size + CHUNK_SIZE - 1) / CHUNK_SIZE;
+        for (uint64_t i = 0; i < chunks; i++) {
+            chunkBase.push_back(const_cast<char*>(data) + i * CHUNK_SIZE);
+        }
+        used = chunkBase.size() * CHUNK_SIZE;
+        bytesStored += size;
+        attached = size;
+    }
+
+    // THE LOGICAL BYTE SPACE CHUNK BY CHUNK, E.G. TO WRITE THE POOL OUT: chunkBytes(i)
+    // BYTES AT chunkData(i), THEN chunkGap(i) ZERO BYTES UP TO THE NEXT CHUNK. THE
+    // GAP IS THE PART OF THE LAST attach()ED CHUNK THAT IS NOT THE POOL'S DATA
+    size_t chunkCount() const { return chunkBase.size(); }
+    const char* chunkData(size_t i) const { return chunkBase[i]; }
+    size_t chunkBytes(size_t i) const {
+        uint64_t end = i * CHUNK_SIZE < attached ? attached : used;
+        uint64_t rest = end - i * CHUNK_SIZE;
+        return static_cast<size_t>(rest < CHUNK_SIZE ? rest : CHUNK_SIZE);
+    }
+    size_t chunkGap(size_t i) const {
+        return i + 1 < chunkBase.size() ? static_cast<size_t>(CHUNK_SIZE - chunkBytes(i)) : 0;
+    }
+
+    // CHUNK_SIZE ZERO BYTES TO WRITE A GAP FROM
+    static const char* zeros() {
+        static const char block[CHUNK_SIZE] = {};
+        return block;
+    }
+
+    uint64_t logicalSize() const { return used; }
+    size_t bytes() const { return static_cast<size_t>(bytesStored); }
+    size_t bytesReserved() const { return chunkBase.size() * CHUNK_SIZE; }
+};
+
+#endif // STRINGPOOL_H
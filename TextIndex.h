@@ -0,0 +1,867 @@
+/************************************************************************
+* Programmer:              SURAKANTI SRISHANTH REDDY                    *
+* Class:                   CPTS 223                                     *
+* Programming Assignment:  PA 3                                         *
+* Date:                    OCTOBER 24, 2025                             *
+*                                                                       *
+* Description: 			   FULL TEXT INVERTED INDEX OVER PRODUCT NAMES  *
+*                          AND MANUFACTURERS. EACH LOWER CASED TERM     *
+*                          HAS A POSTINGS LIST OF ROWS, STORED AS DELTA *
+*                          VARINTS IN BLOCKS OF 128 WITH A SKIP ENTRY   *
+*                          PER BLOCK, SO AND QUERIES GALLOP OVER THE    *
+*                          SKIPS INSTEAD OF DECODING WHOLE LISTS. ROWS  *
+*                          CHANGED SINCE THE LAST BUILD ARE MASKED OUT  *
+*                          AND RE-ADDED TO SMALL PLAIN SIDE LISTS.      *
+*                          A SNAPSHOT CARRIES THE LISTS AS THEY ARE.    *
+*                                                                       *
+************************************************************************/
+#pragma once
+#ifndef TEXTINDEX_H
+#define TEXTINDEX_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "FlatHashTable.h"
+#include "ProductStore.h"
+#include "Snapshot.h"
+#include "StringPool.h"
+#include "ThreadPool.h"
+
+class TextIndex {
+public:
+    static const size_t BLOCK = 128;            // POSTINGS PER SKIP ENTRY
+    static const size_t MAX_TERM = 64;          // LONGER RUNS ARE NOT INDEXED
+
+    // WHERE A TERM APPEARED, KEPT IN THE LOW TWO BITS OF EVERY POSTING
+    static const uint32_t IN_NAME = 1;
+    static const uint32_t IN_MANUFACTURER = 2;
+
+    struct Hit {
+        uint32_t row;
+        double score;
+    };
+
+private:
+    // A POSTING IS (row << 2) | FIELD BITS, STRICTLY INCREASING ALONG A LIST
+    struct Term {
+        uint64_t bytes;         // START OF THE TERM'S DELTAS IN postingBytes
+        uint32_t count;
+        uint32_t firstSkip;     // ITS BLOCKS ARE skips[firstSkip ..]
+    };
+
+    struct Skip {
+        uint64_t first;         // THE BLOCK'S FIRST POSTING, NOT IN THE BYTES
+        uint64_t offset;        // ITS OTHER POSTINGS' DELTAS START AT Term::bytes + offset
+    };
+
+    // TERM TEXT -> DENSE I.D. IN FIRST APPEARANCE ORDER. KEYS VIEW text
+    struct Dictionary {
+        FlatHashTable<std::string_view, uint32_t> ids;
+        StringPool text;
+        std::vector<std::string_view> names;
+
+        uint32_t intern(std::string_view term) {
+            uint32_t id;
+            if (!ids.find(term, id)) {
+                // term MAY VIEW A SCRATCH BUFFER, THE KEY MUST VIEW A STABLE COPY
+                std::string_view stable = text.view(text.append(term), static_cast<uint32_t>(term.size()));
+                id = static_cast<uint32_t>(names.size());
+                ids.insert(stable, id);
+                names.push_back(stable);
+            }
+            return id;
+        }
+    };
+
+    // EVERY TERM'S ENCODED LIST, AS build() AND merge() PRODUCE THEM
+    struct Encoded {
+        std::vector<Term> terms;
+        std::vector<Skip> skips;
+        std::vector<uint8_t> bytes;
+        uint64_t postings = 0;
+    };
+
+    std::unique_ptr<Dictionary> dictionary;
+    SectionArray<Term> terms;
+    SectionArray<Skip> skips;
+    SectionArray<uint8_t> postingBytes;
+    uint64_t postingCount;
+    uint32_t rowCount;              // INDEXED ROWS, PENDING CHANGES INCLUDED
+
+    // CHANGES SINCE THE LAST build() / merge(). A REMOVED ROW'S POSTINGS ABOVE
+    // ARE SKIPPED, AN ADDED ROW'S ARE IN addedPostings[addedSlot[TERM]] (EACH
+    // LIST IN ROW ORDER). removedPerTerm KEEPS EVERY TERM'S LIVE COUNT, AND SO
+    // ITS IDF, THE SAME AS A FRESH BUILD'S
+    std::vector<uint64_t> removedRows;
+    std::vector<uint64_t> addedRows;
+    size_t removedCount;
+    size_t addedCount;
+    FlatHashTable<uint32_t, uint32_t> addedSlot;
+    std::vector<std::vector<uint32_t>> addedPostings;
+    FlatHashTable<uint32_t, uint32_t> removedPerTerm;
+
+    // ONE WORKER'S SHARE OF THE ROWS. EACH ENTRY IS (TERM I.D. << 32) | POSTING
+    // IN ROW ORDER, TERM I.D.s ARE THE CHUNK'S OWN UNLESS IT USES THE GLOBAL DICTIONARY
+    struct BuildChunk {
+        std::unique_ptr<Dictionary> local;
+        Dictionary* dict = nullptr;
+        std::vector<uint64_t> entries;
+    };
+
+    static bool termByte(unsigned char c) {
+        return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c >= 0x80;
+    }
+
+    // CALLS emit(term) FOR EVERY LOWER CASED RUN OF LETTERS, DIGITS AND UTF-8 BYTES
+    template<typename Emit>
+    static void tokenize(std::string_view text, Emit&& emit) {
+        char term[MAX_TERM];
+        size_t i = 0;
+        while (i < text.size()) {
+            while (i < text.size() && !termByte(static_cast<unsigned char>(text[i]))) {
+                i++;
+            }
+            size_t start = i;
+            while (i < text.size() && termByte(static_cast<unsigned char>(text[i]))) {
+                i++;
+            }
+            size_t length = i - start;
+            if (length == 0 || length > MAX_TERM) {
+                continue;
+            }
+            for (size_t k = 0; k < length; k++) {
+                char c = text[start + k];
+                term[k] = (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c;
+            }
+            emit(std::string_view(term, length));
+        }
+    }
+
+    static void indexRows(const ProductStore& store, uint32_t first, uint32_t last, BuildChunk& chunk) {
+        size_t rowStart = 0;
+        auto add = [&](uint32_t row, uint32_t field, std::string_view term) {
+            uint64_t id = chunk.dict->intern(term);
+            // A TERM SEEN EARLIER IN THE SAME ROW ONLY GAINS A FIELD BIT
+            for (size_t i = rowStart; i < chunk.entries.size(); i++) {
+                if ((chunk.entries[i] >> 32) == id) {
+                    chunk.entries[i] |= field;
+                    return;
+                }
+            }
+            chunk.entries.push_back((id << 32) | (static_cast<uint64_t>(row) << 2) | field);
+        };
+        std::string name;
+        for (uint32_t row = first; row < last; row++) {
+            rowStart = chunk.entries.size();
+            name.clear();
+            store.appendText(ProductStore::NAME, row, name);
+            tokenize(name, [&](std::string_view term) {
+                add(row, IN_NAME, term);
+            });
+            tokenize(store.textAt(ProductStore::MANUFACTURER, row), [&](std::string_view term) {
+                add(row, IN_MANUFACTURER, term);
+            });
+        }
+    }
+
+    static void putVarint(std::vector<uint8_t>& out, uint64_t value) {
+        while (value >= 0x80) {
+            out.push_back(static_cast<uint8_t>(value | 0x80));
+            value >>= 7;
+        }
+        out.push_back(static_cast<uint8_t>(value));
+    }
+
+    static uint64_t getVarint(const uint8_t*& p) {
+        uint64_t value = 0;
+        unsigned shift = 0;
+        while (*p & 0x80) {
+            value |= static_cast<uint64_t>(*p++ & 0x7F) << shift;
+            shift += 7;
+        }
+        value |= static_cast<uint64_t>(*p++) << shift;
+        return value;
+    }
+
+    static bool hasBit(const std::vector<uint64_t>& bits, uint32_t row) {
+        return (row >> 6) < bits.size() && ((bits[row >> 6] >> (row & 63)) & 1);
+    }
+
+    static void setBit(std::vector<uint64_t>& bits, uint32_t row, bool value) {
+        if ((row >> 6) >= bits.size()) {
+            bits.resize((row >> 6) + 1, 0);
+        }
+        uint64_t mask = uint64_t(1) << (row & 63);
+        bits[row >> 6] = value ? (bits[row >> 6] | mask) : (bits[row >> 6] & ~mask);
+    }
+
+    // ONE ROW'S (TERM I.D., FIELD BITS), EACH TERM ONCE LIKE indexRows(). NEW
+    // TERMS ARE INTERNED IF intern IS SET AND LEFT OUT OTHERWISE
+    void rowTerms(std::string_view name, std::string_view manufacturer, bool intern,
+        std::vector<std::pair<uint32_t, uint32_t>>& out) {
+        out.clear();
+        auto add = [&](uint32_t field, std::string_view term) {
+            uint32_t id;
+            if (intern) {
+                id = dictionary->intern(term);
+            }
+            else if (!dictionary->ids.find(term, id)) {
+                return;
+            }
+            for (std::pair<uint32_t, uint32_t>& entry : out) {
+                if (entry.first == id) {
+                    entry.second |= field;
+                    return;
+                }
+            }
+            out.push_back(std::make_pair(id, field));
+        };
+        tokenize(name, [&](std::string_view term) { add(IN_NAME, term); });
+        tokenize(manufacturer, [&](std::string_view term) { add(IN_MANUFACTURER, term); });
+    }
+
+    const std::vector<uint32_t>* addedList(uint32_t id) const {
+        uint32_t slot;
+        return addedCount > 0 && addedSlot.find(id, slot) ? &addedPostings[slot] : nullptr;
+    }
+
+    // POSTINGS OF id IN THE INDEX AS IT STANDS NOW
+    uint32_t liveCount(uint32_t id) const {
+        uint32_t count = id < terms.size() ? terms[id].count : 0;
+        uint32_t gone;
+        if (removedCount > 0 && removedPerTerm.find(id, gone)) {
+            count -= gone;
+        }
+        const std::vector<uint32_t>* added = addedList(id);
+        return count + (added ? static_cast<uint32_t>(added->size()) : 0);
+    }
+
+    void dropChanges() {
+        std::vector<uint64_t>().swap(removedRows);
+        std::vector<uint64_t>().swap(addedRows);
+        removedCount = 0;
+        addedCount = 0;
+        addedSlot.clear();
+        std::vector<std::vector<uint32_t>>().swap(addedPostings);
+        removedPerTerm.clear();
+    }
+
+    // A TERM FIRST SEEN AFTER THE LAST BUILD HAS NO POSTINGS ABOVE
+    static const Term& noPostings() {
+        static const Term none{ 0, 0, 0 };
+        return none;
+    }
+
+    static void encode(const uint32_t* list, size_t count, Encoded& out) {
+        Term term;
+        term.bytes = out.bytes.size();
+        term.count = static_cast<uint32_t>(count);
+        term.firstSkip = static_cast<uint32_t>(out.skips.size());
+        for (size_t i = 0; i < count; i++) {
+            if (i % BLOCK == 0) {
+                out.skips.push_back(Skip{ list[i], out.bytes.size() - term.bytes });
+            }
+            else {
+                putVarint(out.bytes, list[i] - list[i - 1]);
+            }
+        }
+        out.terms.push_back(term);
+        out.postings += count;
+    }
+
+    void install(Encoded& encoded) {
+        encoded.bytes.shrink_to_fit();
+        encoded.skips.shrink_to_fit();
+        terms.assign(std::move(encoded.terms));
+        skips.assign(std::move(encoded.skips));
+        postingBytes.assign(std::move(encoded.bytes));
+        postingCount = encoded.postings;
+    }
+
+    // EVERY TERM RE-ENCODED WITH ITS REMOVED ROWS DROPPED AND ITS SIDE LIST
+    // MERGED IN, WHAT merge() INSTALLS AND save() WRITES
+    void mergeInto(Encoded& out) const {
+        size_t termTotal = dictionary->names.size();
+        out.terms.reserve(termTotal);
+        out.bytes.reserve(postingBytes.size());
+        std::vector<uint32_t> list;
+        for (uint32_t id = 0; id < termTotal; id++) {
+            list.clear();
+            if (id < terms.size()) {
+                const Term& term = terms[id];
+                const uint8_t* p = nullptr;
+                uint64_t posting = 0;
+                for (size_t i = 0; i < term.count; i++) {
+                    if (i % BLOCK == 0) {
+                        const Skip& skip = skips[term.firstSkip + i / BLOCK];
+                        posting = skip.first;
+                        p = postingBytes.data() + term.bytes + skip.offset;
+                    }
+                    else {
+                        posting += getVarint(p);
+                    }
+                    if (!hasBit(removedRows, static_cast<uint32_t>(posting >> 2))) {
+                        list.push_back(static_cast<uint32_t>(posting));
+                    }
+                }
+            }
+            const std::vector<uint32_t>* added = addedList(id);
+            if (added && !added->empty()) {
+                size_t middle = list.size();
+                list.insert(list.end(), added->begin(), added->end());
+                std::inplace_merge(list.begin(), list.begin() + middle, list.end());
+            }
+            encode(list.data(), list.size(), out);
+        }
+    }
+
+public:
+    // WALKS ONE POSTINGS LIST IN ROW ORDER
+    class Cursor {
+    private:
+        const TextIndex* index;
+        const Term* term;
+        size_t blocks;
+        size_t block;
+        size_t position;        // WITHIN THE WHOLE LIST
+        const uint8_t* p;
+        uint64_t posting;
+        bool done;
+
+        void enterBlock(size_t b) {
+            const Skip& skip = index->skips[term->firstSkip + b];
+            block = b;
+            position = b * BLOCK;
+            posting = skip.first;
+            p = index->postingBytes.data() + term->bytes + skip.offset;
+        }
+
+    public:
+        Cursor(const TextIndex& owner, uint32_t termId)
+            : index(&owner), term(termId < owner.terms.size() ? &owner.terms[termId] : &noPostings()), blocks((term->count + BLOCK - 1) / BLOCK),
+            block(0), position(0), p(nullptr), posting(0), done(term->count == 0) {
+            if (!done) {
+                enterBlock(0);
+            }
+        }
+
+        bool atEnd() const { return done; }
+        uint32_t row() const { return static_cast<uint32_t>(posting >> 2); }
+        uint32_t fields() const { return static_cast<uint32_t>(posting & 3); }
+        uint32_t count() const { return term->count; }
+
+        bool next() {
+            if (done) {
+                return false;
+            }
+            if (position + 1 >= term->count) {
+                done = true;
+                return false;
+            }
+            position++;
+            if (position % BLOCK == 0) {
+                enterBlock(block + 1);
+            }
+            else {
+                posting += getVarint(p);
+            }
+            return true;
+        }
+
+        // MOVES TO THE FIRST ROW >= target. SKIP ENTRIES AHEAD ARE SEARCHED BY
+        // GALLOPING (STEPS OF 1, 2, 4 .. BLOCKS, THEN BISECTING THE LAST STEP),
+        // ONLY THE ONE BLOCK THAT CAN HOLD target IS DECODED
+        bool advanceTo(uint32_t target) {
+            if (done) {
+                return false;
+            }
+            uint64_t goal = static_cast<uint64_t>(target) << 2;
+            if (posting >= goal) {
+                return true;
+            }
+            const Skip* skip = index->skips.data() + term->firstSkip;
+            if (block + 1 < blocks && skip[block + 1].first <= goal) {
+                size_t low = block + 1;             // LAST BLOCK KNOWN TO START AT OR BEFORE goal
+                size_t step = 1;
+                while (low + step < blocks && skip[low + step].first <= goal) {
+                    low += step;
+                    step *= 2;
+                }
+                size_t high = std::min(low + step, blocks);     // FIRST BLOCK THAT MAY START AFTER goal
+                while (high - low > 1) {
+                    size_t mid = low + (high - low) / 2;
+                    if (skip[mid].first <= goal) {
+                        low = mid;
+                    }
+                    else {
+                        high = mid;
+                    }
+                }
+                enterBlock(low);
+            }
+            while (posting < goal) {
+                if (!next()) {
+                    return false;
+                }
+            }
+            return true;
+        }
+    };
+
+    // ROWS FROM MAX_ROWS ON ARE NOT INDEXED, A POSTING KEEPS THE ROW IN 30 BITS
+    static const uint32_t MAX_ROWS = uint32_t(1) << 30;
+
+    TextIndex() : dictionary(new Dictionary()), postingCount(0), rowCount(0), removedCount(0), addedCount(0) {}
+
+    TextIndex(const TextIndex&) = delete;
+    TextIndex& operator=(const TextIndex&) = delete;
+
+    // REPLACES THE INDEX WITH ONE OVER EVERY ROW OF store. WITH threads > 1 THE
+    // ROWS ARE SPLIT INTO RANGES TOKENIZED ON A THREAD POOL, EACH WITH ITS OWN
+    // DICTIONARY, AND THE RANGES ARE MERGED IN ROW ORDER, SO THE RESULT IS
+    // IDENTICAL TO THE SINGLE THREADED BUILD
+    void build(const ProductStore& store, size_t threads = 1) {
+        dictionary.reset(new Dictionary());
+        terms.clear();
+        skips.clear();
+        postingBytes.clear();
+        postingCount = 0;
+        dropChanges();
+        rowCount = static_cast<uint32_t>(std::min<size_t>(store.size(), MAX_ROWS - 1));
+        size_t chunkCount = threads > 1 ? threads * 4 : 1;
+        if (chunkCount > rowCount / 1024 + 1) {
+            chunkCount = rowCount / 1024 + 1;
+        }
+        std::vector<BuildChunk> chunks(chunkCount);
+        for (BuildChunk& chunk : chunks) {
+            if (chunkCount == 1) {
+                chunk.dict = dictionary.get();      // NOTHING TO MERGE, INTERN STRAIGHT INTO OURS
+            }
+            else {
+                chunk.local.reset(new Dictionary());
+                chunk.dict = chunk.local.get();
+            }
+        }
+        auto work = [&](size_t i) {
+            uint32_t first = static_cast<uint32_t>(static_cast<uint64_t>(rowCount) * i / chunkCount);
+            uint32_t last = static_cast<uint32_t>(static_cast<uint64_t>(rowCount) * (i + 1) / chunkCount);
+            indexRows(store, first, last, chunks[i]);
+        };
+        if (chunkCount == 1) {
+            work(0);
+        }
+        else {
+            ThreadPool pool(threads);
+            pool.parallelFor(chunkCount, work);
+        }
+
+        // LOCAL I.D.s BECOME GLOBAL ONES IN CHUNK ORDER, WHICH IS FIRST APPEARANCE ORDER
+        std::vector<std::vector<uint32_t>> localToGlobal(chunkCount);
+        for (size_t c = 0; c < chunkCount; c++) {
+            if (!chunks[c].local) {
+                continue;
+            }
+            for (std::string_view name : chunks[c].local->names) {
+                localToGlobal[c].push_back(dictionary->intern(name));
+            }
+            chunks[c].local.reset();
+        }
+
+        // COUNTING SORT OF ALL ENTRIES BY TERM. IT IS STABLE AND THE CHUNKS ARE
+        // VISITED IN ORDER, SO EVERY TERM'S POSTINGS COME OUT IN ROW ORDER
+        size_t termTotal = dictionary->names.size();
+        std::vector<uint64_t> start(termTotal + 1, 0);
+        for (size_t c = 0; c < chunkCount; c++) {
+            for (uint64_t entry : chunks[c].entries) {
+                uint32_t local = static_cast<uint32_t>(entry >> 32);
+                start[(localToGlobal[c].empty() ? local : localToGlobal[c][local]) + 1]++;
+            }
+        }
+        for (size_t t = 0; t < termTotal; t++) {
+            start[t + 1] += start[t];
+        }
+        std::vector<uint32_t> sorted(start[termTotal]);
+        std::vector<uint64_t> next(start.begin(), start.end() - 1);
+        for (size_t c = 0; c < chunkCount; c++) {
+            for (uint64_t entry : chunks[c].entries) {
+                uint32_t local = static_cast<uint32_t>(entry >> 32);
+                uint32_t id = localToGlobal[c].empty() ? local : localToGlobal[c][local];
+                sorted[next[id]++] = static_cast<uint32_t>(entry);
+            }
+            std::vector<uint64_t>().swap(chunks[c].entries);
+        }
+
+        Encoded encoded;
+        encoded.terms.reserve(termTotal);
+        encoded.bytes.reserve(sorted.size() + sorted.size() / 4);
+        for (size_t t = 0; t < termTotal; t++) {
+            encode(sorted.data() + start[t], static_cast<size_t>(start[t + 1] - start[t]), encoded);
+        }
+        install(encoded);
+    }
+
+    // TAKES row OUT OF THE INDEX. name AND manufacturer ARE THE TEXT IT WAS
+    // INDEXED WITH, THE STORE MAY ALREADY HOLD SOMETHING ELSE
+    void removeRow(uint32_t row, std::string_view name, std::string_view manufacturer) {
+        if (row >= MAX_ROWS - 1) {
+            return;
+        }
+        std::vector<std::pair<uint32_t, uint32_t>> found;
+        rowTerms(name, manufacturer, false, found);
+        if (hasBit(addedRows, row)) {
+            for (const std::pair<uint32_t, uint32_t>& entry : found) {
+                uint32_t slot;
+                if (addedSlot.find(entry.first, slot)) {
+                    std::vector<uint32_t>& list = addedPostings[slot];
+                    std::vector<uint32_t>::iterator at = std::lower_bound(list.begin(), list.end(), row << 2);
+                    if (at != list.end() && (*at >> 2) == row) {
+                        list.erase(at);
+                    }
+                }
+            }
+            setBit(addedRows, row, false);
+            addedCount--;
+        }
+        else {
+            for (const std::pair<uint32_t, uint32_t>& entry : found) {
+                (*removedPerTerm.tryEmplace(entry.first, 0).first)++;
+            }
+            setBit(removedRows, row, true);
+            removedCount++;
+        }
+        rowCount--;
+    }
+
+    // INDEXES row WITH THIS name AND manufacturer. THE ROW MUST NOT BE IN THE
+    // INDEX (removeRow() IT FIRST)
+    void addRow(uint32_t row, std::string_view name, std::string_view manufacturer) {
+        if (row >= MAX_ROWS - 1) {
+            return;
+        }
+        std::vector<std::pair<uint32_t, uint32_t>> found;
+        rowTerms(name, manufacturer, true, found);
+        for (const std::pair<uint32_t, uint32_t>& entry : found) {
+            std::pair<uint32_t*, bool> slot = addedSlot.tryEmplace(entry.first, static_cast<uint32_t>(addedPostings.size()));
+            if (slot.second) {
+                addedPostings.emplace_back();
+            }
+            std::vector<uint32_t>& list = addedPostings[*slot.first];
+            uint32_t posting = (row << 2) | entry.second;
+            list.insert(std::lower_bound(list.begin(), list.end(), posting), posting);
+        }
+        setBit(addedRows, row, true);
+        addedCount++;
+        rowCount++;
+    }
+
+    // ROWS REMOVED OR ADDED SINCE THE LAST build() / merge()
+    size_t pending() const { return removedCount + addedCount; }
+
+    // RE-ENCODES EVERY TERM WITH ITS REMOVED ROWS DROPPED AND ITS SIDE LIST
+    // MERGED IN, NO TEXT IS TOKENIZED AGAIN
+    void merge() {
+        if (pending() == 0) {
+            return;
+        }
+        Encoded merged;
+        mergeInto(merged);
+        install(merged);
+        dropChanges();
+    }
+
+    // ADDS THE ROW AND POSTING COUNTS, THE TERM TEXT (ONE BLOB AND ITS
+    // OFFSETS), terms, skips AND THE POSTING BYTES AS SNAPSHOT SECTIONS. PENDING
+    // CHANGES ARE MERGED INTO LISTS THE WRITER KEEPS
+    void save(SnapshotWriter& writer) const {
+        const Encoded* merged = nullptr;
+        if (pending() > 0) {
+            Encoded& encoded = writer.keep<Encoded>();
+            mergeInto(encoded);
+            merged = &encoded;
+        }
+        std::vector<uint64_t>& counts = writer.keep<std::vector<uint64_t>>();
+        counts.push_back(merged ? merged->postings : postingCount);
+        counts.push_back(rowCount);
+        std::string& text = writer.keep<std::string>();
+        std::vector<uint64_t>& offsets = writer.keep<std::vector<uint64_t>>(1, 0);
+        for (std::string_view name : dictionary->names) {
+            text += name;
+            offsets.push_back(text.size());
+        }
+        writer.addVector(counts);
+        writer.add(text.data(), text.size());
+        writer.addVector(offsets);
+        if (merged) {
+            writer.addVector(merged->terms);
+            writer.addVector(merged->skips);
+            writer.addVector(merged->bytes);
+        }
+        else {
+            writer.addVector(terms);
+            writer.addVector(skips);
+            writer.addVector(postingBytes);
+        }
+    }
+
+    // USES WHAT save() WROTE IN PLACE FROM THE MAPPING (WHICH MUST OUTLIVE THE
+    // INDEX) FOR A STORE OF rowLimit ROWS. THE DICTIONARY'S KEYS VIEW THE
+    // MAPPED TERM TEXT AND ONLY ITS HASH TABLE IS REBUILT. NOTHING CHANGES IF A
+    // SECTION DOES NOT FIT
+    bool attach(SnapshotReader& reader, size_t rowLimit) {
+        size_t countEntries, textBytes, offsetCount, termEntries, skipEntries, byteCount;
+        const uint64_t* counts = reader.next<uint64_t>(countEntries);
+        const char* text = reader.next<char>(textBytes);
+        const uint64_t* offsets = reader.next<uint64_t>(offsetCount);
+        const Term* termData = reader.next<Term>(termEntries);
+        const Skip* skipData = reader.next<Skip>(skipEntries);
+        const uint8_t* byteData = reader.next<uint8_t>(byteCount);
+        bool ok = counts && text && offsets && termData && skipData && byteData && countEntries == 2
+            && counts[1] <= rowLimit && counts[1] < MAX_ROWS && offsetCount > 0 && termEntries < offsetCount
+            && offsets[0] == 0 && offsets[offsetCount - 1] == textBytes && (byteCount == 0 || byteData[byteCount - 1] < 0x80);
+        for (size_t i = 0; ok && i + 1 < offsetCount; i++) {
+            ok = offsets[i] <= offsets[i + 1];
+        }
+        uint64_t total = 0;
+        for (size_t t = 0; ok && t < termEntries; t++) {
+            const Term& term = termData[t];
+            size_t blocks = (term.count + BLOCK - 1) / BLOCK;
+            ok = term.firstSkip <= skipEntries && blocks <= skipEntries - term.firstSkip && term.bytes <= byteCount;
+            for (size_t b = 0; ok && b < blocks; b++) {
+                const Skip& skip = skipData[term.firstSkip + b];
+                ok = skip.offset <= byteCount - term.bytes && (skip.first >> 2) < rowLimit;
+            }
+            total += term.count;
+        }
+        if (!ok || total != counts[0]) {
+            return false;
+        }
+
+        dictionary.reset(new Dictionary());
+        dictionary->names.reserve(offsetCount - 1);
+        for (size_t i = 0; i + 1 < offsetCount; i++) {
+            std::string_view name(text + offsets[i], static_cast<size_t>(offsets[i + 1] - offsets[i]));
+            dictionary->ids.insert(name, static_cast<uint32_t>(i));
+            dictionary->names.push_back(name);
+        }
+        terms.attach(termData, termEntries);
+        skips.attach(skipData, skipEntries);
+        postingBytes.attach(byteData, byteCount);
+        postingCount = counts[0];
+        rowCount = static_cast<uint32_t>(counts[1]);
+        dropChanges();
+        return true;
+    }
+
+    // THE TERM I.D. OF word AFTER THE SAME LOWER CASING AS THE INDEXED TEXT
+    bool findTerm(std::string_view word, uint32_t& id) const {
+        bool found = false;
+        size_t pieces = 0;
+        tokenize(word, [&](std::string_view term) {
+            pieces++;
+            found = dictionary->ids.find(term, id);
+        });
+        return pieces == 1 && found;
+    }
+
+    // TERMS OF query (SPLIT LIKE THE INDEXED TEXT). ALL OF THEM MUST MATCH
+    // (matchAll) OR ANY ONE. RESULTS ARE THE k BEST BY SCORE, THE SUM OVER
+    // MATCHED TERMS OF THEIR IDF, FULL WEIGHT IN THE NAME AND HALF IN THE
+    // MANUFACTURER; TIES GO TO THE LOWER ROW. totalMatches GETS EVERY MATCH
+    std::vector<Hit> search(std::string_view query, bool matchAll, size_t k, size_t& totalMatches) const {
+        std::vector<std::string> words;
+        tokenize(query, [&](std::string_view term) {
+            words.emplace_back(term);
+        });
+        std::sort(words.begin(), words.end());
+        words.erase(std::unique(words.begin(), words.end()), words.end());
+
+        // EACH TERM'S POSTINGS ABOVE, ITS SIDE LIST (NULL IF NONE) AND ITS IDF FROM
+        // THE LIVE COUNT. A TERM NO ROW HAS ANY MORE MATCHES NOTHING
+        struct QueryTerm {
+            Cursor cursor;
+            const std::vector<uint32_t>* added;
+            double idf;
+        };
+        totalMatches = 0;
+        std::vector<QueryTerm> matched;
+        for (const std::string& word : words) {
+            uint32_t id;
+            uint32_t count = dictionary->ids.find(std::string_view(word), id) ? liveCount(id) : 0;
+            if (count > 0) {
+                matched.push_back(QueryTerm{ Cursor(*this, id), addedList(id),
+                    std::log(1.0 + static_cast<double>(rowCount) / count) });
+            }
+            else if (matchAll) {
+                return std::vector<Hit>();
+            }
+        }
+        if (matched.empty()) {
+            return std::vector<Hit>();
+        }
+        // SHORTEST LIST FIRST, IT DRIVES THE INTERSECTION
+        std::sort(matched.begin(), matched.end(), [](const QueryTerm& a, const QueryTerm& b) {
+            return a.cursor.count() < b.cursor.count();
+        });
+
+        // MIN HEAP OF THE BEST k SO FAR, THE WORST ONE ON TOP
+        std::vector<Hit> best;
+        auto worse = [](const Hit& a, const Hit& b) {
+            return a.score > b.score || (a.score == b.score && a.row < b.row);
+        };
+        auto offer = [&](uint32_t row, double score) {
+            totalMatches++;
+            if (k == 0) {
+                return;
+            }
+            Hit hit{ row, score };
+            if (best.size() < k) {
+                best.push_back(hit);
+                std::push_heap(best.begin(), best.end(), worse);
+            }
+            else if (worse(hit, best.front())) {
+                std::pop_heap(best.begin(), best.end(), worse);
+                best.back() = hit;
+                std::push_heap(best.begin(), best.end(), worse);
+            }
+        };
+        auto weight = [](uint32_t fields) {
+            return (fields & IN_NAME) ? 1.0 : 0.5;
+        };
+        auto live = [&](uint32_t row) {
+            return removedCount == 0 || !hasBit(removedRows, row);
+        };
+
+        if (matchAll) {
+            // THE DRIVER PROPOSES A ROW, THE OTHERS GALLOP TO IT. THE FIRST ONE THAT
+            // OVERSHOOTS SENDS THE DRIVER AHEAD TO ITS ROW
+            Cursor& driver = matched[0].cursor;
+            bool exhausted = false;
+            while (!exhausted && !driver.atEnd()) {
+                uint32_t candidate = driver.row();
+                size_t i = 1;
+                for (; i < matched.size(); i++) {
+                    if (!matched[i].cursor.advanceTo(candidate)) {
+                        exhausted = true;
+                        break;
+                    }
+                    if (matched[i].cursor.row() != candidate) {
+                        break;
+                    }
+                }
+                if (exhausted) {
+                    break;
+                }
+                if (i < matched.size()) {
+                    driver.advanceTo(matched[i].cursor.row());
+                    continue;
+                }
+                if (live(candidate)) {
+                    double score = 0;
+                    for (const QueryTerm& term : matched) {
+                        score += term.idf * weight(term.cursor.fields());
+                    }
+                    offer(candidate, score);
+                }
+                driver.next();
+            }
+        }
+        else {
+            while (true) {
+                uint32_t row = UINT32_MAX;
+                bool any = false;
+                for (const QueryTerm& term : matched) {
+                    if (!term.cursor.atEnd() && (!any || term.cursor.row() < row)) {
+                        row = term.cursor.row();
+                        any = true;
+                    }
+                }
+                if (!any) {
+                    break;
+                }
+                double score = 0;
+                for (QueryTerm& term : matched) {
+                    if (!term.cursor.atEnd() && term.cursor.row() == row) {
+                        score += term.idf * weight(term.cursor.fields());
+                        term.cursor.next();
+                    }
+                }
+                if (live(row)) {
+                    offer(row, score);
+                }
+            }
+        }
+
+        // ROWS ADDED SINCE THE LAST MERGE ARE ONLY IN THE SIDE LISTS, WHICH ARE
+        // SHORT: EACH SIDE ROW OF ONE TERM IS LOOKED UP IN THE OTHERS' LISTS
+        if (addedCount > 0) {
+            auto fieldsIn = [](const std::vector<uint32_t>* list, uint32_t row, uint32_t& fields) {
+                if (!list) {
+                    return false;
+                }
+                std::vector<uint32_t>::const_iterator at = std::lower_bound(list->begin(), list->end(), row << 2);
+                if (at == list->end() || (*at >> 2) != row) {
+                    return false;
+                }
+                fields = *at & 3;
+                return true;
+            };
+            for (size_t t = 0; t < matched.size(); t++) {
+                if (!matched[t].added || (matchAll && t > 0)) {
+                    continue;
+                }
+                for (uint32_t posting : *matched[t].added) {
+                    uint32_t row = posting >> 2;
+                    double score = 0;
+                    bool counted = true;
+                    for (size_t other = 0; other < matched.size(); other++) {
+                        uint32_t fields;
+                        if (fieldsIn(matched[other].added, row, fields)) {
+                            // WITH ANY TERM, A ROW BELONGS TO THE FIRST TERM THAT HAS IT
+                            if (!matchAll && other < t) {
+                                counted = false;
+                                break;
+                            }
+                            score += matched[other].idf * weight(fields);
+                        }
+                        else if (matchAll) {
+                            counted = false;
+                            break;
+                        }
+                    }
+                    if (counted) {
+                        offer(row, score);
+                    }
+                }
+            }
+        }
+
+        std::sort_heap(best.begin(), best.end(), worse);
+        return best;
+    }
+
+    size_t termCount() const { return terms.size(); }
+    uint64_t postings() const { return postingCount; }
+    size_t postingBytesUsed() const { return postingBytes.size(); }
+    std::string_view termName(uint32_t id) const { return dictionary->names[id]; }
+
+    // BYTES HELD BY THE INDEX: COMPRESSED POSTINGS, SKIPS, THE TERM TABLE, THE
+    // TERM TEXT, THE DICTIONARY SLOTS AND THE PENDING CHANGES
+    size_t memoryUsage() const {
+        size_t added = addedPostings.capacity() * sizeof(std::vector<uint32_t>);
+        for (const std::vector<uint32_t>& list : addedPostings) {
+            added += list.capacity() * sizeof(uint32_t);
+        }
+        return postingBytes.capacity() + skips.capacity() * sizeof(Skip) + terms.capacity() * sizeof(Term)
+            + dictionary->names.capacity() * sizeof(std::string_view) + dictionary->text.bytesReserved()
+            + dictionary->ids.bucketCount() * (sizeof(std::pair<std::string_view, uint32_t>) + 1)
+            + (removedRows.capacity() + addedRows.capacity()) * sizeof(uint64_t) + added
+            + (addedSlot.bucketCount() + removedPerTerm.bucketCount()) * (2 * sizeof(uint32_t) + 1);
+    }
+};
+
+#endif // TEXTINDEX_H
@@ -0,0 +1,123 @@
+/************************************************************************
+* Programmer:              SURAKANTI SRISHANTH REDDY                    *
+* Class:                   CPTS 223                                     *
+* Programming Assignment:  PA 3                                         *
+* Date:                    OCTOBER 24, 2025                             *
+*                                                                       *
+* Description: 			   FIXED SIZE THREAD POOL. TASKS ARE QUEUED    *
+*                          WITH submit() AND wait() BLOCKS UNTIL ALL    *
+*                          OF THEM ARE DONE, RETHROWING THE FIRST       *
+*                          EXCEPTION A TASK THREW.                      *
+*                                                                       *
+************************************************************************/
+#pragma once
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+class ThreadPool {
+private:
+    std::vector<std::thread> workers;
+    std::queue<std::function<void()>> tasks;
+    std::mutex mutex;
+    std::condition_variable taskReady;
+    std::condition_variable allDone;
+    size_t pending;             // QUEUED + RUNNING TASKS
+    bool stopping;
+    std::exception_ptr firstError;
+
+    void workerLoop() {
+        while (true) {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                taskReady.wait(lock, [this] { return stopping || !tasks.empty(); });
+                if (tasks.empty()) {
+                    return;
+                }
+                task = std::move(tasks.front());
+                tasks.pop();
+            }
+
+            try {
+                task();
+            }
+            catch (...) {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (!firstError) {
+                    firstError = std::current_exception();
+                }
+            }
+
+            std::lock_guard<std::mutex> lock(mutex);
+            if (--pending == 0) {
+                allDone.notify_all();
+            }
+        }
+    }
+
+public:
+    explicit ThreadPool(size_t threads) : pending(0), stopping(false) {
+        if (threads == 0) {
+            threads = 1;
+        }
+        workers.reserve(threads);
+        for (size_t i = 0; i < threads; i++) {
+            workers.emplace_back(&ThreadPool::workerLoop, this);
+        }
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        taskReady.notify_all();
+        for (std::thread& worker : workers) {
+            worker.join();
+        }
+    }
+
+    void submit(std::function<void()> task) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            tasks.push(std::move(task));
+            pending++;
+        }
+        taskReady.notify_one();
+    }
+
+    void wait() {
+        std::unique_lock<std::mutex> lock(mutex);
+        allDone.wait(lock, [this] { return pending == 0; });
+        if (firstError) {
+            std::exception_ptr error = firstError;
+            firstError = nullptr;
+            std::rethrow_exception(error);
+        }
+    }
+
+    // RUNS body(0) .. body(count - 1) ON THE POOL AND WAITS FOR ALL OF THEM
+    void parallelFor(size_t count, const std::function<void(size_t)>& body) {
+        for (size_t i = 0; i < count; i++) {
+            submit([&body, i] { body(i); });
+        }
+        wait();
+    }
+
+    size_t size() const {
+        return workers.size();
+    }
+};
+
+#endif // THREADPOOL_H
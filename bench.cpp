@@ -0,0 +1,1126 @@
+/************************************************************************
+* Programmer:              SURAKANTI SRISHANTH REDDY                    *
+* Class:                   CPTS 223                                     *
+* Programming Assignment:  PA 3                                         *
+* Date:                    OCTOBER 24, 2025                             *
+*                                                                       *
+* Description: 			   BENCHMARKS FOR THE INVENTORY DATA STRUCTURES *
+*                          RUN WITH `make bench` OR PASS KEY COUNTS     *
+*                          ON THE COMMAND LINE, E.G.                    *
+*                          ./inventory_bench 1000000 10000000           *
+*                          --csv FILE AND --csv-bytes N SET THE SAMPLE  *
+*                          AND SIZE FOR THE CSV SCANNER THROUGHPUT RUN. *
+*                          --rows N SIZES THE GENERATED CATALOG FOR THE *
+*                          LOAD AND LATENCY RUNS (--catalog FILE USES   *
+*                          ONE ON DISK), --generate FILE ONLY WRITES IT *
+*                          --text-rows N SIZES THE REPLICATED SAMPLE    *
+*                          FOR THE TEXT STORE RUN AND --json FILE SAVES *
+*                          EVERY RESULT AS JSON.                        *
+*                                                                       *
+************************************************************************/
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "HashTable.h"
+#include "FlatHashTable.h"
+#include "ConcurrentHashTable.h"
+#include "Inventory.h"
+
+typedef std::chrono::steady_clock Clock;
+
+static double secondsSince(Clock::time_point start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+// --json FILE: EVERY NUMBER THE RUN PRINTS ALSO GOES TO FILE AS ONE JSON OBJECT
+// PER LINE, SO RESULTS CAN BE COMPARED ACROSS COMMITS
+static std::ofstream jsonOut;
+
+static std::string jsonString(const std::string& s) {
+    std::string quoted = "\"";
+    for (char c : s) {
+        if (c == '"' || c == '\\') {
+            quoted += '\\';
+        }
+        quoted += c;
+    }
+    return quoted + "\"";
+}
+
+static void report(const std::string& bench, const std::string& variant, size_t n,
+    const std::string& metric, double value, const std::string& unit) {
+    if (!jsonOut.is_open()) {
+        return;
+    }
+    char number[64];
+    std::snprintf(number, sizeof(number), "%.6g", value);
+    jsonOut << "{\"bench\": " << jsonString(bench) << ", \"case\": " << jsonString(variant)
+        << ", \"n\": " << n << ", \"metric\": " << jsonString(metric) << ", \"value\": " << number
+        << ", \"unit\": " << jsonString(unit) << "}\n";
+}
+
+// 32 CHARACTER HEX IDS, SAME SHAPE AS THE uniqId COLUMN
+static std::vector<std::string> makeIds(size_t count, uint64_t seed) {
+    std::mt19937_64 rng(seed);
+    std::vector<std::string> ids;
+    ids.reserve(count);
+    char buf[33];
+    for (size_t i = 0; i < count; i++) {
+        unsigned long long hi = rng();
+        unsigned long long lo = rng();
+        std::snprintf(buf, sizeof(buf), "%016llx%016llx", hi, lo);
+        ids.push_back(std::string(buf, 32));
+    }
+    return ids;
+}
+
+// makeIds() AS productById KEYS THEM
+static std::vector<ProductId> toProductIds(const std::vector<std::string>& ids) {
+    std::vector<ProductId> keys(ids.size());
+    for (size_t i = 0; i < ids.size(); i++) {
+        ProductId::parse(ids[i], keys[i]);
+    }
+    return keys;
+}
+
+// SHUFFLED 64 BIT KEYS, THE INTEGER COUNTERPART OF makeIds()
+static std::vector<uint64_t> makeIntKeys(size_t count, uint64_t seed) {
+    std::mt19937_64 rng(seed);
+    std::vector<uint64_t> keys(count);
+    for (uint64_t& key : keys) {
+        key = rng();
+    }
+    return keys;
+}
+
+// INSERT ALL KEYS INTO table AS THE CALLER SET IT UP (PRE-SIZED OR NOT), LOOK
+// UP EVERY HIT AND AS MANY MISSES, THEN REMOVE HALF. INSERTS ARE TIMED IN
+// BLOCKS OF 1024 SO THE WORST BLOCK SHOWS THE PAUSE OF A FULL REHASH
+template<typename Table, typename Key>
+static void benchTable(const char* name, const char* keyKind, Table& table,
+    const std::vector<Key>& keys, const std::vector<Key>& misses) {
+    const size_t BLOCK = 1024;
+    uint64_t value = 0;
+
+    double worstBlockSec = 0;
+    Clock::time_point start = Clock::now();
+    for (size_t first = 0; first < keys.size(); first += BLOCK) {
+        size_t last = std::min(first + BLOCK, keys.size());
+        Clock::time_point blockStart = Clock::now();
+        for (size_t i = first; i < last; i++) {
+            table.insert(keys[i], i + 1);
+        }
+        worstBlockSec = std::max(worstBlockSec, secondsSince(blockStart));
+    }
+    double insertSec = secondsSince(start);
+    double load = static_cast<double>(table.size()) / static_cast<double>(table.bucketCount());
+
+    size_t found = 0;
+    start = Clock::now();
+    for (const Key& key : keys) {
+        found += table.find(key, value);
+    }
+    double hitSec = secondsSince(start);
+
+    start = Clock::now();
+    for (const Key& key : misses) {
+        found += table.find(key, value);
+    }
+    double missSec = secondsSince(start);
+
+    start = Clock::now();
+    for (size_t i = 0; i < keys.size(); i += 2) {
+        table.remove(keys[i]);
+    }
+    double removeSec = secondsSince(start);
+
+    if (found != keys.size()) {
+        std::cerr << "BENCH ERROR: " << name << " FOUND " << found << " OF " << keys.size() << std::endl;
+        std::exit(1);
+    }
+
+    double n = static_cast<double>(keys.size());
+    double results[] = { insertSec * 1e9 / n, worstBlockSec * 1e6, hitSec * 1e9 / n,
+        missSec * 1e9 / static_cast<double>(misses.size()), removeSec * 1e9 / (n / 2) };
+    std::printf("%-20s %-6s %10zu  LOAD %4.2f  INSERT %6.1f ns (WORST 1K %8.1f us)  FIND HIT %6.1f ns  FIND MISS %6.1f ns  REMOVE %6.1f ns\n",
+        name, keyKind, keys.size(), load, results[0], results[1], results[2], results[3], results[4]);
+
+    std::string variant = std::string(name) + " " + keyKind;
+    const char* metrics[] = { "insert", "worst_insert_block", "find_hit", "find_miss", "remove" };
+    const char* units[] = { "ns", "us", "ns", "ns", "ns" };
+    for (int m = 0; m < 5; m++) {
+        report("hash_table", variant, keys.size(), metrics[m], results[m], units[m]);
+    }
+    report("hash_table", variant, keys.size(), "load_factor", load, "ratio");
+}
+
+// EVERY TABLE SET UP FOR ONE KEY TYPE: THE CHAINED TABLE GROWING FROM ITS
+// DEFAULT SIZE (STOP THE WORLD AND INCREMENTAL REHASH) AND PRE-SIZED TO A
+// FIXED LOAD FACTOR, AND THE FLAT TABLE GROWING UNDER THREE MAXIMUM LOADS
+template<typename Key, typename Hash = std::hash<Key>>
+static void benchHashTables(const char* keyKind, const std::vector<Key>& keys, const std::vector<Key>& misses) {
+    {
+        HashTable<Key, uint64_t, Hash> table;
+        benchTable("CHAINED GROWING", keyKind, table, keys, misses);
+    }
+    {
+        HashTable<Key, uint64_t, Hash> table;
+        table.setIncrementalRehash(true);
+        benchTable("CHAINED INCREMENTAL", keyKind, table, keys, misses);
+    }
+    const double chainedLoads[] = { 0.25, 0.5, 0.75 };
+    for (double load : chainedLoads) {
+        char name[32];
+        std::snprintf(name, sizeof(name), "CHAINED LOAD %.2f", load);
+        HashTable<Key, uint64_t, Hash> table(static_cast<size_t>(static_cast<double>(keys.size()) / load) + 1);
+        benchTable(name, keyKind, table, keys, misses);
+    }
+    const double flatLoads[] = { 0.5, 0.75, 0.875 };
+    for (double load : flatLoads) {
+        char name[32];
+        std::snprintf(name, sizeof(name), "FLAT MAX LOAD %.3g", load);
+        FlatHashTable<Key, uint64_t, Hash> table(16, load);
+        benchTable(name, keyKind, table, keys, misses);
+    }
+}
+
+// SUMS EVERY PRICE TWO WAYS: RE-PARSING EACH PRODUCT'S PRICE TEXT (THE OLD ROW
+// LAYOUT) AND SCANNING THE TYPED PRICE COLUMN WITH ITS NULL BITMAP
+static void benchPriceScan(size_t count) {
+    std::mt19937_64 rng(9);
+    ProductStore store;
+    Arena arena;
+    CategoryDictionary dict(&arena);
+    std::vector<Product*> products;
+    products.reserve(count);
+    char price[32];
+    for (size_t i = 0; i < count; i++) {
+        // ONE IN TEN PRODUCTS HAS NO PRICE
+        if (rng() % 10 == 0) {
+            price[0] = '\0';
+        }
+        else {
+            std::snprintf(price, sizeof(price), "$%llu.%02llu",
+                static_cast<unsigned long long>(rng() % 2000), static_cast<unsigned long long>(rng() % 100));
+        }
+        products.push_back(arena.create<Product>(store, arena, dict, std::to_string(i), "Name", "", price,
+            "", "", "", "Toys & Games"));
+    }
+
+    Clock::time_point start = Clock::now();
+    double rowSum = 0;
+    for (const Product* product : products) {
+        std::string text(product->getPrice());
+        if (!text.empty()) {
+            rowSum += std::strtod(text.c_str() + 1, nullptr);
+        }
+    }
+    double rowSec = secondsSince(start);
+
+    start = Clock::now();
+    double columnSum = 0;
+    const float* prices = store.floatColumn(ProductStore::PRICE);
+    const uint64_t* valid = store.floatValidBits(ProductStore::PRICE);
+    for (size_t i = 0; i < store.size(); i++) {
+        if ((valid[i >> 6] >> (i & 63)) & 1) {
+            columnSum += prices[i];
+        }
+    }
+    double columnSec = secondsSince(start);
+
+    double n = static_cast<double>(count);
+    std::printf("%-14s %10zu  ROW PARSE %7.2f ns  COLUMN %7.2f ns  (SUMS %.0f / %.0f)\n",
+        "PRICE SUM", count, rowSec * 1e9 / n, columnSec * 1e9 / n, rowSum, columnSum);
+    report("price_scan", "ROW PARSE", count, "per_product", rowSec * 1e9 / n, "ns");
+    report("price_scan", "COLUMN", count, "per_product", columnSec * 1e9 / n, "ns");
+}
+
+// productById AS THE INVENTORY BUILDS IT (ARENA NODES, KEYS VIEWING ONE BUFFER),
+// QUERIED IN A RANDOM ORDER ONE findPtr() AT A TIME AND THROUGH findBatch()
+static void benchBatchLookup(size_t count) {
+    std::vector<std::string> ids = makeIds(count, 42);
+    std::string keyBytes;
+    keyBytes.reserve(count * 32);
+    for (const std::string& id : ids) {
+        keyBytes += id;
+    }
+
+    Arena arena;
+    HashTable<std::string_view, Product*> table;
+    table.useArena(&arena);
+    table.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+        table.insert(std::string_view(keyBytes.data() + i * 32, 32), reinterpret_cast<Product*>(i + 1));
+    }
+
+    // QUERIES LIVE IN THEIR OWN BUFFER, LIKE IDS COMING IN FROM A REQUEST
+    std::mt19937_64 rng(3);
+    std::string queryBytes(keyBytes.size(), '\0');
+    std::vector<std::string_view> queries(count);
+    for (size_t i = 0; i < count; i++) {
+        size_t pick = rng() % count;
+        std::memcpy(&queryBytes[i * 32], keyBytes.data() + pick * 32, 32);
+        queries[i] = std::string_view(queryBytes.data() + i * 32, 32);
+    }
+
+    uintptr_t singleSum = 0;
+    Clock::time_point start = Clock::now();
+    for (const std::string_view& query : queries) {
+        Product* const* value = table.findPtr(query);
+        singleSum += value ? reinterpret_cast<uintptr_t>(*value) : 0;
+    }
+    double singleSec = secondsSince(start);
+
+    const size_t BATCH = 1024;
+    Product* const* results[BATCH];
+    uintptr_t batchSum = 0;
+    start = Clock::now();
+    for (size_t i = 0; i < count; i += BATCH) {
+        size_t n = count - i < BATCH ? count - i : BATCH;
+        table.findBatch(queries.data() + i, n, results);
+        for (size_t k = 0; k < n; k++) {
+            batchSum += results[k] ? reinterpret_cast<uintptr_t>(*results[k]) : 0;
+        }
+    }
+    double batchSec = secondsSince(start);
+
+    if (singleSum != batchSum) {
+        std::cerr << "BENCH ERROR: BATCH LOOKUP RESULTS DIFFER" << std::endl;
+        std::exit(1);
+    }
+
+    double n = static_cast<double>(count);
+    std::printf("%-14s %10zu  ONE AT A TIME %7.1f ns  BATCHED %7.1f ns  (%.2fx)\n",
+        "BATCH FIND", count, singleSec * 1e9 / n, batchSec * 1e9 / n, singleSec / batchSec);
+    report("batch_lookup", "ONE AT A TIME", count, "per_lookup", singleSec * 1e9 / n, "ns");
+    report("batch_lookup", "BATCHED", count, "per_lookup", batchSec * 1e9 / n, "ns");
+}
+
+// "UNDER $20 IN ONE CATEGORY" THREE WAYS: FILTERING THE CATEGORY'S POSTINGS ON
+// THE PRICE TEXT (WHAT A CALLER HAD TO DO BEFORE), THE SAME FILTER ON THE PRICE
+// COLUMN, AND rangeQuery() INTERSECTING THE PRICE INDEX WITH THE POSTINGS
+static void benchRangeQuery(size_t count) {
+    const char* categories[] = { "Toys & Games", "Sports & Outdoors", "Home & Kitchen",
+        "Toys & Games | Puzzles", "Arts & Crafts", "Baby Products", "Toys & Games | Learning & Education" };
+    const size_t categoryCount = sizeof(categories) / sizeof(categories[0]);
+    const char* path = "bench_range.csv";
+    {
+        std::mt19937_64 rng(11);
+        std::ofstream out(path);
+        out << "Uniq Id,Product Name,Brand Name,Asin,Category,Upc,List Price,Selling Price\n";
+        for (size_t i = 0; i < count; i++) {
+            out << i << ",Item " << i << ",Brand,,\"" << categories[rng() % categoryCount] << "\",,,$"
+                << rng() % 500 << "." << rng() % 100 << "\n";
+        }
+    }
+    InventoryManager manager;
+    std::streambuf* saved = std::cout.rdbuf(nullptr);
+    Clock::time_point start = Clock::now();
+    manager.loadFromCSV(path);
+    std::cout.rdbuf(saved);
+    std::remove(path);
+    double loadSec = secondsSince(start);
+
+    const int ROUNDS = 20;
+    const std::vector<Product*>& postings = manager.listInventoryByCategory("Toys & Games");
+    size_t textHits = 0;
+    start = Clock::now();
+    for (int r = 0; r < ROUNDS; r++) {
+        for (const Product* product : postings) {
+            std::string price(product->getPrice());
+            double value = price.empty() ? -1 : std::strtod(price.c_str() + 1, nullptr);
+            textHits += value >= 10 && value <= 20;
+        }
+    }
+    double textSec = secondsSince(start) / ROUNDS;
+
+    size_t columnHits = 0;
+    start = Clock::now();
+    for (int r = 0; r < ROUNDS; r++) {
+        for (const Product* product : postings) {
+            columnHits += product->hasPriceValue() && product->getPriceValue() >= 10 && product->getPriceValue() <= 20;
+        }
+    }
+    double columnSec = secondsSince(start) / ROUNDS;
+
+    size_t indexHits = 0;
+    start = Clock::now();
+    for (int r = 0; r < ROUNDS; r++) {
+        indexHits += manager.rangeQuery(ProductStore::PRICE, 10, 20, "Toys & Games").size();
+    }
+    double indexSec = secondsSince(start) / ROUNDS;
+
+    std::printf("%-14s %10zu  TEXT FILTER %8.3f ms  COLUMN FILTER %8.3f ms  INDEX %8.3f ms  (%zu HITS, %zu IN CATEGORY, LOAD + INDEX %.2f s)\n",
+        "RANGE QUERY", count, textSec * 1e3, columnSec * 1e3, indexSec * 1e3,
+        indexHits / ROUNDS, postings.size(), loadSec);
+    report("range_query", "TEXT FILTER", count, "per_query", textSec * 1e3, "ms");
+    report("range_query", "COLUMN FILTER", count, "per_query", columnSec * 1e3, "ms");
+    report("range_query", "INDEX", count, "per_query", indexSec * 1e3, "ms");
+    if (textHits != columnHits || columnHits != indexHits) {
+        std::cerr << "BENCH ERROR: RANGE QUERY COUNTS DIFFER" << std::endl;
+        std::exit(1);
+    }
+}
+
+// THE BASELINE FOR THE SCALING RUN: THE PLAIN HashTable BEHIND A READER / WRITER LOCK
+class LockedHashTable {
+private:
+    HashTable<std::string, uint64_t> table;
+    mutable std::shared_mutex mutex;
+
+public:
+    bool find(const std::string& key, uint64_t& value) const {
+        std::shared_lock<std::shared_mutex> lock(mutex);
+        return table.find(key, value);
+    }
+
+    void insert(const std::string& key, uint64_t value) {
+        std::unique_lock<std::shared_mutex> lock(mutex);
+        table.insert(key, value);
+    }
+};
+
+// threads READERS DO RANDOM FINDS WHILE ONE WRITER KEEPS UPDATING RANDOM KEYS
+template<typename Table>
+static void benchReadScaling(const char* name, Table& table, const std::vector<std::string>& ids,
+    size_t threads, size_t findsPerThread) {
+    std::atomic<bool> readersDone(false);
+    std::atomic<size_t> found(0);
+    size_t updates = 0;
+
+    Clock::time_point start = Clock::now();
+    std::thread writer([&] {
+        std::mt19937_64 rng(99);
+        while (!readersDone.load(std::memory_order_relaxed)) {
+            table.insert(ids[rng() % ids.size()], updates++);
+        }
+    });
+    std::vector<std::thread> readers;
+    for (size_t t = 0; t < threads; t++) {
+        readers.emplace_back([&, t] {
+            std::mt19937_64 rng(t + 1);
+            size_t hits = 0;
+            uint64_t value = 0;
+            for (size_t i = 0; i < findsPerThread; i++) {
+                hits += table.find(ids[rng() % ids.size()], value);
+            }
+            found.fetch_add(hits);
+        });
+    }
+    for (std::thread& reader : readers) {
+        reader.join();
+    }
+    double sec = secondsSince(start);
+    readersDone = true;
+    writer.join();
+
+    if (found.load() != threads * findsPerThread) {
+        std::cerr << "BENCH ERROR: " << name << " MISSED KEYS UNDER UPDATES" << std::endl;
+        std::exit(1);
+    }
+    std::printf("%-14s %10zu  READERS %3zu  FINDS %8.2f M/s  UPDATES %8.2f M/s\n",
+        name, ids.size(), threads, static_cast<double>(threads * findsPerThread) / sec / 1e6,
+        static_cast<double>(updates) / sec / 1e6);
+    std::string variant = std::string(name) + " READERS " + std::to_string(threads);
+    report("concurrent_reads", variant, ids.size(), "finds", static_cast<double>(threads * findsPerThread) / sec / 1e6, "M/s");
+    report("concurrent_reads", variant, ids.size(), "updates", static_cast<double>(updates) / sec / 1e6, "M/s");
+}
+
+// ROWS SHAPED LIKE THE AMAZON EXPORT, USED WHEN NO SAMPLE CSV IS GIVEN
+static const char* const SAMPLE_ROWS[] = {
+    "4c69b61db1fc16e7013b43fc926e502d,\"DB Longboards CoreFlex Crossbow 41\"\" Bamboo Fiberglass Longboard Complete\",,,"
+    "\"Sports & Outdoors | Outdoor Recreation | Skates, Skateboards & Scooters | Skateboarding\",\"\",,$237.68,,\"\","
+    "\"Make sure this fits by entering your model number. | RESPONSIVE FLEX: The Crossbow features a bamboo core\",,,"
+    "https://www.amazon.com/DB-Longboards-CoreFlex-Fiberglass-Longboard/dp/B07KMVJJK7,,,,,,,,,,,,,,,,\r\n",
+    "66d49bbed043f5be260fa9f7fbff5957,\"Electronic Snap Circuits Mini Kits Classpack, FM Radio, Motion Detector\",,,"
+    "Toys & Games | Learning & Education | Science Kits & Toys,,,$99.95,,55324,\"Make sure this fits by entering your "
+    "model number. | Snap circuits mini kits classpack provides basic electronic circuitry activities\",,,"
+    "https://www.amazon.com/Electronic-Snap-Circuits-Mini-Kits/dp/B004Z9L6LY,,,,,,,,,,,,,,,,\r\n",
+    "2c55cae269aebf53838484b0d7dd931a,\"3Doodler Create Flexy 3D Printing Filament Refill Bundle\r\n(X5 Pack)\",,,"
+    "Toys & Games | Arts & Crafts | Craft Kits,,,$34.99,,,\"Unleash your creativity, one strand at a time\",,,"
+    "https://www.amazon.com/3Doodler-Create-Filament-Refill-Bundle/dp/B07DZJRJR7,,,,,,,,,,,,,,,,\r\n",
+};
+
+// THE SAMPLE (A FILE, OR SAMPLE_ROWS) REPEATED UNTIL IT REACHES target BYTES
+static std::string replicateSample(const std::string& path, size_t target) {
+    std::string sample;
+    if (!path.empty()) {
+        MappedFile file;
+        if (!file.open(path)) {
+            std::cerr << "BENCH ERROR: CANNOT OPEN " << path << std::endl;
+            std::exit(1);
+        }
+        sample.assign(file.data(), file.size());
+        if (!sample.empty() && sample.back() != '\n') {
+            sample += '\n';
+        }
+    }
+    else {
+        for (const char* row : SAMPLE_ROWS) {
+            sample += row;
+        }
+    }
+    if (sample.empty()) {
+        std::cerr << "BENCH ERROR: EMPTY CSV SAMPLE" << std::endl;
+        std::exit(1);
+    }
+
+    std::string data;
+    data.reserve(target + sample.size());
+    while (data.size() < target) {
+        data += sample;
+    }
+    return data;
+}
+
+// SPLITS data INTO RECORDS AND FIELDS AT EVERY SIMD LEVEL THE CPU HAS, THE FIELD
+// COUNT AND TOTAL FIELD LENGTH MUST MATCH THE SCALAR RUN
+static void benchCSVScan(const std::string& data) {
+    const CSVStructural::Level levels[] = { CSVStructural::SCALAR, CSVStructural::SSE42, CSVStructural::AVX2 };
+    size_t scalarFields = 0;
+    size_t scalarBytes = 0;
+    for (CSVStructural::Level level : levels) {
+        if (!CSVStructural::supported(level)) continue;
+
+        Clock::time_point start = Clock::now();
+        CSVScanner scanner(data.data(), data.size(), 1, level);
+        std::vector<std::string_view> fields;
+        size_t records = 0;
+        size_t fieldCount = 0;
+        size_t fieldBytes = 0;
+        while (scanner.nextRecord(fields)) {
+            records++;
+            fieldCount += fields.size();
+            for (std::string_view field : fields) {
+                fieldBytes += field.size();
+            }
+        }
+        double sec = secondsSince(start);
+
+        if (level == CSVStructural::SCALAR) {
+            scalarFields = fieldCount;
+            scalarBytes = fieldBytes;
+        }
+        else if (fieldCount != scalarFields || fieldBytes != scalarBytes) {
+            std::cerr << "BENCH ERROR: " << CSVStructural::name(level) << " FIELDS DIFFER FROM SCALAR" << std::endl;
+            std::exit(1);
+        }
+        std::printf("%-14s %10zu  RECORDS %10zu  FIELDS %11zu  %6.2f GB/s\n",
+            CSVStructural::name(level), data.size(), records, fieldCount,
+            static_cast<double>(data.size()) / sec / 1e9);
+        report("csv_scan", CSVStructural::name(level), data.size(), "throughput", static_cast<double>(data.size()) / sec / 1e9, "GB/s");
+    }
+}
+
+// SYNTHETIC CATALOG IN THE EXPORT'S 28 COLUMN SCHEMA, ANY NUMBER OF ROWS (10M
+// AND UP). THE SAME SEED GIVES THE SAME FILE. CATEGORY PATHS ARE 2 TO 4 LEVELS
+// DRAWN FROM A FIXED TREE WITH A SKEW TOWARDS THE FIRST TOP LEVEL NAMES (LIKE
+// "Toys & Games" IN THE SAMPLE), ONE NAME IN 40 IS QUOTED WITH A COMMA OR AN
+// ESCAPED QUOTE, ONE IN 500 SPANS TWO LINES, ONE PRICE IN 12 IS MISSING
+class CatalogGenerator {
+private:
+    std::mt19937_64 rng;
+    std::vector<std::string> paths;
+
+    static const char* pick(const char* const* words, size_t count, uint64_t r) {
+        return words[r % count];
+    }
+
+public:
+    static const char* header() {
+        return "Uniq Id,Product Name,Brand Name,Asin,Category,Upc Ean Code,List Price,Selling Price,Quantity,"
+            "Model Number,About Product,Product Specification,Technical Details,Shipping Weight,"
+            "Product Dimensions,Image,Variants,Sku,Product Url,Stock,Product Details,Dimensions,Color,"
+            "Ingredients,Direction To Use,Is Amazon Seller,Size Quantity Variant,Product Description\n";
+    }
+
+    explicit CatalogGenerator(uint64_t seed) : rng(seed) {
+        static const char* const tops[] = { "Toys & Games", "Home & Kitchen", "Sports & Outdoors",
+            "Clothing, Shoes & Jewelry", "Arts, Crafts & Sewing", "Office Products", "Baby Products",
+            "Electronics", "Hobbies", "Health & Household" };
+        static const char* const areas[] = { "Learning", "Education", "Outdoor", "Play", "Party", "Kitchen",
+            "Dining", "Storage", "Fitness", "Camping", "Craft", "Building" };
+        static const char* const kinds[] = { "Kits", "Toys", "Games", "Sets", "Supplies", "Accessories",
+            "Puzzles", "Figures", "Tools", "Decor", "Gear", "Models", "Cards", "Books", "Vehicles" };
+        std::mt19937_64 shape(seed ^ 0x5eed);
+        for (const char* top : tops) {
+            for (size_t a = 0; a < 12; a++) {
+                std::string second = std::string(top) + " | " + areas[a] + " & " + areas[(a * 7 + 3) % 12];
+                paths.push_back(second);
+                for (size_t k = 0; k < 15; k++) {
+                    std::string third = second + " | " + areas[shape() % 12] + " " + kinds[k];
+                    paths.push_back(third);
+                    if (shape() % 4 == 0) {
+                        paths.push_back(third + " | " + kinds[shape() % 15]);
+                    }
+                }
+            }
+        }
+    }
+
+    // APPENDS ROW i (ENDED BY "\n") TO out
+    void row(std::string& out, size_t i) {
+        static const char* const brands[] = { "Melissa & Doug", "LEGO", "Hasbro", "Mattel", "Crayola",
+            "Funko", "Ravensburger", "Learning Resources", "Intex", "Coleman", "Nerf", "Playmobil",
+            "Fisher-Price", "VTech", "Schleich", "Spin Master", "Bandai", "Hot Wheels", "Razor", "Franklin" };
+        static const char* const adjectives[] = { "Wooden", "Deluxe", "Classic", "Mini", "Magnetic",
+            "Electronic", "Giant", "Glow", "Educational", "Remote Control", "Folding", "Waterproof",
+            "Portable", "Stackable", "Musical", "Inflatable", "Retro", "Foam", "Metal", "Plush" };
+        static const char* const nouns[] = { "Puzzle", "Train Set", "Board Game", "Kite", "Longboard",
+            "Science Kit", "Action Figure", "Building Blocks", "Doll House", "Drone", "Tent", "Backpack",
+            "Paint Set", "Card Game", "Skateboard", "Water Bottle", "Lunch Box", "Bike Helmet", "Robot",
+            "Marble Run", "Play Kitchen", "Tool Bench", "Art Easel", "Telescope", "Yo-Yo" };
+        static const char* const features[] = { "Make sure this fits by entering your model number.",
+            "Great gift for boys and girls ages 3 and up", "Durable construction for years of play",
+            "Encourages creativity and problem solving", "Batteries not included",
+            "Easy to assemble, no tools required", "Meets all safety standards" };
+        const size_t brandCount = sizeof(brands) / sizeof(brands[0]);
+        const size_t adjectiveCount = sizeof(adjectives) / sizeof(adjectives[0]);
+        const size_t nounCount = sizeof(nouns) / sizeof(nouns[0]);
+        const size_t featureCount = sizeof(features) / sizeof(features[0]);
+
+        char buf[256];
+        unsigned long long hi = rng();
+        unsigned long long lo = rng();
+        std::snprintf(buf, sizeof(buf), "%016llx%016llx,", hi, lo);
+        out += buf;
+
+        const char* brand = pick(brands, brandCount, rng());
+        const char* adjective = pick(adjectives, adjectiveCount, rng());
+        const char* noun = pick(nouns, nounCount, rng());
+        uint64_t shape = rng() % 1000;
+        if (shape < 2) {
+            std::snprintf(buf, sizeof(buf), "\"%s %s\n%s %zu\",", brand, adjective, noun, i);
+        }
+        else if (shape < 15) {
+            std::snprintf(buf, sizeof(buf), "\"%s %s %s, %zu Pieces\",", brand, adjective, noun, i % 500 + 10);
+        }
+        else if (shape < 25) {
+            std::snprintf(buf, sizeof(buf), "\"%s %s 12\"\" %s %zu\",", brand, adjective, noun, i);
+        }
+        else {
+            std::snprintf(buf, sizeof(buf), "%s %s %s %zu,", brand, adjective, noun, i);
+        }
+        out += buf;
+        out += rng() % 3 == 0 ? "" : brand;
+        out += ",,";
+
+        // SKEWED: THE FIRST PATHS (THE FIRST TOP LEVEL NAMES) COME UP MOST
+        double u = static_cast<double>(rng() >> 11) / 9007199254740992.0;
+        if (rng() % 50 != 0) {
+            out += '"';
+            out += paths[static_cast<size_t>(u * u * u * static_cast<double>(paths.size()))];
+            out += '"';
+        }
+        out += ",,,";
+
+        uint64_t cents = rng() % 50000 + 99;
+        uint64_t priceShape = rng() % 100;
+        if (priceShape < 8) {
+            buf[0] = '\0';
+        }
+        else if (priceShape < 11) {
+            std::snprintf(buf, sizeof(buf), "$%llu.%02llu - $%llu.%02llu", static_cast<unsigned long long>(cents / 100),
+                static_cast<unsigned long long>(cents % 100), static_cast<unsigned long long>(cents / 100 + 5),
+                static_cast<unsigned long long>(cents % 100));
+        }
+        else {
+            std::snprintf(buf, sizeof(buf), "$%llu.%02llu", static_cast<unsigned long long>(cents / 100),
+                static_cast<unsigned long long>(cents % 100));
+        }
+        out += buf;
+        std::snprintf(buf, sizeof(buf), ",,M%zu,\"", i);
+        out += buf;
+        for (size_t f = 0, n = rng() % 3 + 2; f < n; f++) {
+            if (f > 0) {
+                out += " | ";
+            }
+            out += pick(features, featureCount, rng());
+        }
+        std::snprintf(buf, sizeof(buf), "\",Shipping Weight: %llu.%llu pounds|ASIN: B0%08llX,,%llu.%llu pounds,,"
+            "https://images-na.ssl-images-amazon.com/images/I/%08llx.jpg,,,https://www.amazon.com/dp/B0%08llX,",
+            static_cast<unsigned long long>(rng() % 20), static_cast<unsigned long long>(rng() % 10),
+            static_cast<unsigned long long>(lo & 0xffffffff), static_cast<unsigned long long>(rng() % 20),
+            static_cast<unsigned long long>(rng() % 10), static_cast<unsigned long long>(hi & 0xffffffff),
+            static_cast<unsigned long long>(lo & 0xffffffff));
+        out += buf;
+        out += ",,,,,,Y,,\n";
+    }
+};
+
+// WRITES rows GENERATED ROWS (AND THE HEADER) TO path, RETURNS THE FILE SIZE
+static size_t writeCatalog(const std::string& path, size_t rows) {
+    std::FILE* file = std::fopen(path.c_str(), "wb");
+    if (!file) {
+        std::cerr << "BENCH ERROR: CANNOT WRITE " << path << std::endl;
+        std::exit(1);
+    }
+    CatalogGenerator generator(2020);
+    std::string buffer = CatalogGenerator::header();
+    size_t bytes = 0;
+    for (size_t i = 0; i < rows; i++) {
+        generator.row(buffer, i);
+        if (buffer.size() >= (size_t(1) << 20) || i + 1 == rows) {
+            bytes += std::fwrite(buffer.data(), 1, buffer.size(), file);
+            buffer.clear();
+        }
+    }
+    if (rows == 0) {
+        bytes += std::fwrite(buffer.data(), 1, buffer.size(), file);
+    }
+    std::fclose(file);
+    return bytes;
+}
+
+// InventoryManager::parseCSVLine() OVER GENERATED ONE LINE RECORDS
+static void benchParseLine(size_t count) {
+    CatalogGenerator generator(7);
+    std::vector<std::string> lines;
+    size_t distinct = std::min(count, size_t(100000));
+    std::string line;
+    while (lines.size() < distinct) {
+        line.clear();
+        generator.row(line, lines.size());
+        line.pop_back();
+        if (line.find('\n') == std::string::npos) {
+            lines.push_back(line);
+        }
+    }
+
+    size_t bytes = 0;
+    size_t fields = 0;
+    Clock::time_point start = Clock::now();
+    for (size_t i = 0; i < count; i++) {
+        const std::string& record = lines[i % distinct];
+        fields += InventoryManager::parseCSVLine(record).size();
+        bytes += record.size();
+    }
+    double sec = secondsSince(start);
+
+    double n = static_cast<double>(count);
+    std::printf("%-14s %10zu  %7.1f ns / RECORD  %8.2f MB/s  (%.1f FIELDS / RECORD)\n",
+        "PARSE LINE", count, sec * 1e9 / n, static_cast<double>(bytes) / sec / 1e6, static_cast<double>(fields) / n);
+    report("parse_csv_line", "parseCSVLine", count, "per_record", sec * 1e9 / n, "ns");
+    report("parse_csv_line", "parseCSVLine", count, "throughput", static_cast<double>(bytes) / sec / 1e6, "MB/s");
+}
+
+// THE WHOLE loadFromCSV() (PARSE, TABLES AND EVERY SECONDARY INDEX) ON threads
+static void benchLoad(const std::string& path, size_t bytes, size_t threads) {
+    InventoryManager manager;
+    std::streambuf* saved = std::cout.rdbuf(nullptr);
+    Clock::time_point start = Clock::now();
+    bool loaded = manager.loadFromCSV(path, threads);
+    double sec = secondsSince(start);
+    std::cout.rdbuf(saved);
+    if (!loaded) {
+        std::cerr << "BENCH ERROR: CANNOT LOAD " << path << std::endl;
+        std::exit(1);
+    }
+
+    size_t rows = manager.productCount();
+    std::string variant = "THREADS " + std::to_string(threads);
+    std::printf("%-14s %10zu  THREADS %2zu  %7.2f s  %9.0f ROWS/s  %7.1f MB/s\n",
+        "LOAD CSV", rows, threads, sec, static_cast<double>(rows) / sec, static_cast<double>(bytes) / sec / 1e6);
+    report("load_csv", variant, rows, "total", sec, "s");
+    report("load_csv", variant, rows, "rows", static_cast<double>(rows) / sec, "rows/s");
+    report("load_csv", variant, rows, "throughput", static_cast<double>(bytes) / sec / 1e6, "MB/s");
+}
+
+// SORTS nanos AND PRINTS / REPORTS P50, P90, P99, P99.9 AND THE MAXIMUM
+static void reportLatency(const char* bench, const char* name, size_t n, std::vector<double>& nanos) {
+    std::sort(nanos.begin(), nanos.end());
+    const double quantiles[] = { 0.5, 0.9, 0.99, 0.999 };
+    const char* metrics[] = { "p50", "p90", "p99", "p999" };
+    double values[5];
+    for (int q = 0; q < 4; q++) {
+        values[q] = nanos[static_cast<size_t>(quantiles[q] * static_cast<double>(nanos.size() - 1))];
+        report(bench, name, n, metrics[q], values[q], "ns");
+    }
+    values[4] = nanos.back();
+    report(bench, name, n, "max", values[4], "ns");
+    std::printf("%-20s %10zu  P50 %9.0f ns  P90 %9.0f ns  P99 %9.0f ns  P99.9 %9.0f ns  MAX %10.0f ns\n",
+        name, n, values[0], values[1], values[2], values[3], values[4]);
+}
+
+// PER CALL LATENCY OF find (HITS IN RANDOM ORDER, ONE IN TEN A MISS) AND OF
+// listInventory WITHOUT ITS OUTPUT: THE CATEGORY LOOKUP PLUS A WALK OVER EVERY
+// PRODUCT'S I.D. AND NAME, FOR ANY CATEGORY NAME AND FOR THE TOP LEVEL ONES
+static void benchLatency(const std::string& path) {
+    InventoryManager manager;
+    std::streambuf* saved = std::cout.rdbuf(nullptr);
+    manager.loadFromCSV(path);
+    std::cout.rdbuf(saved);
+    const std::vector<Product*>& all = manager.getAllProducts();
+    if (all.empty()) {
+        return;
+    }
+
+    // WHAT TWO BACK TO BACK CLOCK READS COST, INCLUDED IN EVERY SAMPLE BELOW
+    std::vector<double> overhead(10000);
+    for (double& sample : overhead) {
+        Clock::time_point start = Clock::now();
+        sample = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+    }
+    std::sort(overhead.begin(), overhead.end());
+    std::printf("%-20s %10s  %.0f ns PER SAMPLE (INCLUDED)\n", "TIMER", "", overhead[overhead.size() / 2]);
+    report("latency", "TIMER", 0, "p50", overhead[overhead.size() / 2], "ns");
+
+    std::mt19937_64 rng(5);
+    std::vector<std::string> misses = makeIds(1000, 77);
+    const size_t FINDS = 200000;
+    std::vector<double> nanos(FINDS);
+    size_t hits = 0;
+    for (size_t i = 0; i < FINDS; i++) {
+        std::string_view id = rng() % 10 == 0 ? std::string_view(misses[i % misses.size()]) : all[rng() % all.size()]->idView();
+        Clock::time_point start = Clock::now();
+        hits += manager.findProduct(id) != nullptr;
+        nanos[i] = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+    }
+    reportLatency("latency", "FIND", all.size(), nanos);
+
+    const CategoryDictionary& dictionary = manager.getCategoryDictionary();
+    const CategoryTree& tree = manager.getCategoryTree();
+    std::vector<uint32_t> topLevel = tree.children(CategoryTree::ROOT);
+    const size_t LISTS = 2000;
+    size_t walked = 0;
+    std::string nameText;
+    for (int topOnly = 0; topOnly < 2; topOnly++) {
+        nanos.assign(LISTS, 0);
+        for (size_t i = 0; i < LISTS; i++) {
+            std::string_view name = topOnly ? dictionary.name(tree.name(topLevel[rng() % topLevel.size()]))
+                : dictionary.name(static_cast<uint32_t>(rng() % dictionary.size()));
+            Clock::time_point start = Clock::now();
+            InventoryManager::ProductList products;
+            if (manager.findCategoryProducts(name, products)) {
+                // EACH NAME IS DECODED INTO ONE REUSED BUFFER, LIKE A LISTING PRINTS IT
+                for (Product* product : products) {
+                    nameText.clear();
+                    manager.getStore().appendText(ProductStore::NAME, product->getRow(), nameText);
+                    walked += product->idView().size() + nameText.size();
+                }
+            }
+            nanos[i] = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+        }
+        reportLatency("latency", topOnly ? "LIST TOP LEVEL" : "LIST ANY CATEGORY", all.size(), nanos);
+    }
+    if (hits == 0 || walked == 0) {
+        std::cerr << "BENCH ERROR: LATENCY RUN FOUND NOTHING" << std::endl;
+        std::exit(1);
+    }
+}
+
+// agg sum price OVER THE CATALOG, OVERALL AND PER GROUP. THE FIRST GROUPED CALL
+// ALSO BUILDS THE ROW GROUPS, THE SCANS AFTER IT ARE THE BEST OF FIVE. BANDWIDTH
+// COUNTS THE PRICE COLUMN AND ITS BITMAP
+static void benchAggregate(const std::string& path) {
+    InventoryManager manager;
+    std::streambuf* saved = std::cout.rdbuf(nullptr);
+    manager.loadFromCSV(path);
+    std::cout.rdbuf(saved);
+    size_t rows = manager.productCount();
+    if (rows == 0) {
+        return;
+    }
+
+    std::vector<size_t> threadCounts = { 1 };
+    if (std::thread::hardware_concurrency() > 1) {
+        threadCounts.push_back(std::thread::hardware_concurrency());
+    }
+    const InventoryManager::AggregateDimension dimensions[] = {
+        InventoryManager::BY_NOTHING, InventoryManager::BY_CATEGORY, InventoryManager::BY_MANUFACTURER };
+    const char* names[] = { "AGG ALL", "AGG BY CATEGORY", "AGG BY MANUFACTURER" };
+    double columnBytes = static_cast<double>(rows) * (sizeof(float) + 1.0 / 8);
+    uint64_t checksum = 0;
+    for (int d = 0; d < 3; d++) {
+        Clock::time_point start = Clock::now();
+        checksum += manager.aggregate(InventoryManager::AGGREGATE_PRICE, dimensions[d], 1).size();
+        double firstSec = secondsSince(start);
+
+        for (size_t threads : threadCounts) {
+            double bestSec = 1e30;
+            for (int run = 0; run < 5; run++) {
+                start = Clock::now();
+                std::vector<Aggregation::Group> groups = manager.aggregate(InventoryManager::AGGREGATE_PRICE, dimensions[d], threads);
+                bestSec = std::min(bestSec, secondsSince(start));
+                checksum += groups.empty() ? 0 : groups[0].count;
+            }
+            std::string variant = std::string(names[d]) + " " + std::to_string(threads) + "T";
+            std::printf("%-20s %10zu  %2zu THREADS  FIRST CALL %8.2f ms  SCAN %8.2f ms  %6.2f GB/S\n",
+                names[d], rows, threads, firstSec * 1e3, bestSec * 1e3, columnBytes / bestSec / 1e9);
+            report("aggregate", variant, rows, "first_call", firstSec * 1e3, "ms");
+            report("aggregate", variant, rows, "scan", bestSec * 1e3, "ms");
+            report("aggregate", variant, rows, "bandwidth", columnBytes / bestSec / 1e9, "GB/s");
+        }
+    }
+    if (checksum == 0) {
+        std::cerr << "BENCH ERROR: AGGREGATION FOUND NOTHING" << std::endl;
+        std::exit(1);
+    }
+}
+
+// THE SAMPLE (A FILE WITHOUT ITS HEADER, OR SAMPLE_ROWS) REPEATED INTO A
+// ProductStore UNTIL IT HAS rows ROWS, THE I.D. GETS THE COPY NUMBER. PRINTS
+// EACH TEXT COLUMN'S BYTES WITH AND WITHOUT ITS DICTIONARY (THE NAME'S WITH
+// AND WITHOUT ITS WORD CODES), THEN THE ns PER READ ON RANDOM ROWS: A
+// DICTIONARY COLUMN, THE SAME TEXT HELD AS ONE string_view PER ROW (WHAT A
+// PLAIN COLUMN COSTS), THE NAME AS A PLAIN COPY OF EVERY ROW'S TEXT, THE NAME
+// DECODED FROM ITS WORD CODES INTO A REUSED BUFFER AND A WHOLE ROW (EVERY
+// COLUMN THROUGH visitText()). EVERY READ ALSO TOUCHES THE TEXT'S FIRST BYTE
+static void benchTextStore(const std::string& path, size_t rows) {
+    std::string sample = replicateSample(path, 1);
+    CSVScanner scanner(sample.data(), sample.size(), 0);
+    std::vector<std::string_view> fields;
+    if (!path.empty()) {
+        scanner.nextRecord(fields);
+    }
+    std::vector<std::vector<std::string>> records;
+    while (scanner.nextRecord(fields)) {
+        if (fields.size() >= 8) {
+            records.push_back({ CSVScanner::unescape(fields[0]), CSVScanner::unescape(fields[1]),
+                CSVScanner::unescape(fields[2]), CSVScanner::unescape(fields[7]), CSVScanner::unescape(fields[4]) });
+        }
+    }
+    if (records.empty() || rows == 0) {
+        std::cerr << "BENCH ERROR: NO ROWS IN THE CSV SAMPLE" << std::endl;
+        std::exit(1);
+    }
+
+    ProductStore store;
+    store.reserve(rows);
+    Clock::time_point start = Clock::now();
+    for (size_t i = 0; i < rows; i++) {
+        const std::vector<std::string>& r = records[i % records.size()];
+        std::string id = r[0] + std::to_string(i / records.size());
+        store.appendRow(id, r[1], r[2], r[3], "", "", "", r[4]);
+    }
+    double appendSec = secondsSince(start);
+    std::printf("%-20s %10zu  %zu DISTINCT SAMPLE ROWS  APPEND %.1f ns / ROW\n", "REPLICATED", rows, records.size(),
+        appendSec * 1e9 / static_cast<double>(rows));
+    report("text_store", "APPEND", rows, "per_row", appendSec * 1e9 / static_cast<double>(rows), "ns");
+
+    const char* names[] = { "ID", "NAME", "MANUFACTURER", "PRICE_TEXT", "REVIEWS_TEXT", "QUESTIONS_TEXT",
+        "RATING_TEXT", "CATEGORY_TEXT" };
+    size_t plainTotal = 0, storedTotal = 0;
+    for (int c = 0; c < ProductStore::TEXT_COLUMNS; c++) {
+        ProductStore::TextUsage usage = store.textUsage(static_cast<ProductStore::TextColumn>(c));
+        plainTotal += usage.plainBytes;
+        storedTotal += usage.storedBytes;
+        std::printf("%-20s %10zu VALUES  PLAIN %8.1f MB  STORED %8.1f MB\n", names[c], usage.values,
+            usage.plainBytes / 1e6, usage.storedBytes / 1e6);
+        report("text_store", names[c], rows, "plain", usage.plainBytes / 1e6, "MB");
+        report("text_store", names[c], rows, "stored", usage.storedBytes / 1e6, "MB");
+    }
+    std::printf("%-20s %10s         PLAIN %8.1f MB  STORED %8.1f MB  (%.1f%% SAVED)\n", "ALL TEXT", "",
+        plainTotal / 1e6, storedTotal / 1e6, 100.0 * (1.0 - static_cast<double>(storedTotal) / plainTotal));
+    report("text_store", "ALL TEXT", rows, "plain", plainTotal / 1e6, "MB");
+    report("text_store", "ALL TEXT", rows, "stored", storedTotal / 1e6, "MB");
+
+    std::vector<std::string_view> plainCategory(rows);
+    for (uint32_t row = 0; row < rows; row++) {
+        plainCategory[row] = store.textAt(ProductStore::CATEGORY_TEXT, row);
+    }
+    // WHAT THE NAME COLUMN WAS BEFORE IT WAS CODED: EVERY ROW'S TEXT IN A POOL
+    StringPool plainNamePool;
+    std::vector<std::string_view> plainName(rows);
+    std::string nameText;
+    for (uint32_t row = 0; row < rows; row++) {
+        nameText.clear();
+        store.appendText(ProductStore::NAME, row, nameText);
+        plainName[row] = plainNamePool.view(plainNamePool.append(nameText), static_cast<uint32_t>(nameText.size()));
+    }
+    std::mt19937_64 rng(11);
+    const size_t READS = 2000000;
+    std::vector<uint32_t> order(READS);
+    for (uint32_t& row : order) {
+        row = static_cast<uint32_t>(rng() % rows);
+    }
+
+    const char* variants[] = { "CATEGORY DICTIONARY", "CATEGORY PLAIN VIEW", "NAME PLAIN VIEW", "NAME DECODED",
+        "WHOLE ROW" };
+    uint64_t checksum = 0;
+    for (int v = 0; v < 5; v++) {
+        start = Clock::now();
+        for (uint32_t row : order) {
+            std::string_view s;
+            switch (v) {
+            case 0: s = store.textAt(ProductStore::CATEGORY_TEXT, row); break;
+            case 1: s = plainCategory[row]; break;
+            case 2: s = plainName[row]; break;
+            case 3:
+                nameText.clear();
+                store.appendText(ProductStore::NAME, row, nameText);
+                s = nameText;
+                break;
+            default:
+                for (int c = 0; c < ProductStore::TEXT_COLUMNS; c++) {
+                    store.visitText(static_cast<ProductStore::TextColumn>(c), row, [&checksum](std::string_view piece) {
+                        checksum += piece.size() + (piece.empty() ? 0 : static_cast<unsigned char>(piece[0]));
+                    });
+                }
+                continue;
+            }
+            checksum += s.size() + (s.empty() ? 0 : static_cast<unsigned char>(s[0]));
+        }
+        double sec = secondsSince(start);
+        std::printf("%-20s %10zu  %7.1f ns / READ\n", variants[v], rows, sec * 1e9 / READS);
+        report("text_store", variants[v], rows, "per_read", sec * 1e9 / READS, "ns");
+    }
+    if (checksum == 0) {
+        std::cerr << "BENCH ERROR: TEXT STORE READ NOTHING" << std::endl;
+        std::exit(1);
+    }
+}
+
+int main(int argc, char* argv[]) {
+    std::vector<size_t> sizes;
+    std::string csvPath;
+    size_t csvBytes = size_t(1) << 30;
+    std::string jsonPath;
+    std::string catalogPath;
+    std::string generatePath;
+    size_t catalogRows = 200000;
+    size_t textRows = 2000000;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--csv" && i + 1 < argc) {
+            csvPath = argv[++i];
+        }
+        else if (arg == "--csv-bytes" && i + 1 < argc) {
+            csvBytes = static_cast<size_t>(std::strtoull(argv[++i], nullptr, 10));
+        }
+        else if (arg == "--json" && i + 1 < argc) {
+            jsonPath = argv[++i];
+        }
+        else if (arg == "--rows" && i + 1 < argc) {
+            catalogRows = static_cast<size_t>(std::strtoull(argv[++i], nullptr, 10));
+        }
+        else if (arg == "--text-rows" && i + 1 < argc) {
+            textRows = static_cast<size_t>(std::strtoull(argv[++i], nullptr, 10));
+        }
+        else if (arg == "--catalog" && i + 1 < argc) {
+            catalogPath = argv[++i];
+        }
+        else if (arg == "--generate" && i + 1 < argc) {
+            generatePath = argv[++i];
+        }
+        else {
+            sizes.push_back(static_cast<size_t>(std::strtoull(argv[i], nullptr, 10)));
+        }
+    }
+    if (sizes.empty()) {
+        sizes.push_back(100000);
+        sizes.push_back(1000000);
+    }
+
+    // --generate ONLY WRITES THE CATALOG, E.G. TO LOAD INTO ./inventory
+    if (!generatePath.empty()) {
+        Clock::time_point start = Clock::now();
+        size_t bytes = writeCatalog(generatePath, catalogRows);
+        std::printf("WROTE %zu ROWS (%zu BYTES) TO %s IN %.2f s\n", catalogRows, bytes, generatePath.c_str(), secondsSince(start));
+        return 0;
+    }
+
+    if (!jsonPath.empty()) {
+        jsonOut.open(jsonPath);
+        if (!jsonOut) {
+            std::cerr << "BENCH ERROR: CANNOT WRITE " << jsonPath << std::endl;
+            return 1;
+        }
+        report("run", __VERSION__, 0, "hardware_threads", std::thread::hardware_concurrency(), "threads");
+    }
+
+    std::cout << "----*** HASH TABLES: INT, STRING AND 128 BIT I.D. KEYS, SIZES AND LOAD FACTORS ***----" << std::endl;
+    for (size_t n : sizes) {
+        std::vector<uint64_t> keys = makeIntKeys(n, 42);
+        std::vector<uint64_t> intMisses = makeIntKeys(n < 1000000 ? n : 1000000, 7);
+        benchHashTables("INT", keys, intMisses);
+    }
+    for (size_t n : sizes) {
+        std::vector<std::string> ids = makeIds(n, 42);
+        std::vector<std::string> misses = makeIds(n < 1000000 ? n : 1000000, 7);
+        benchHashTables("STRING", ids, misses);
+        benchHashTables<ProductId, ProductIdHash>("HEX128", toProductIds(ids), toProductIds(misses));
+    }
+
+    std::cout << "----*** BULK I.D. LOOKUP: findPtr VS findBatch ***----" << std::endl;
+    for (size_t n : sizes) {
+        benchBatchLookup(n);
+    }
+
+    std::cout << "----*** PRICE SCAN: ROW TEXT VS COLUMN ***----" << std::endl;
+    for (size_t n : sizes) {
+        benchPriceScan(n);
+    }
+
+    std::cout << "----*** RANGE QUERY: CATEGORY FILTER VS SORTED INDEX ***----" << std::endl;
+    for (size_t n : sizes) {
+        benchRangeQuery(n);
+    }
+
+    std::cout << "----*** CONCURRENT READS: ConcurrentHashTable VS LOCKED HashTable ***----" << std::endl;
+    {
+        std::vector<std::string> ids = makeIds(sizes[0] < 1000000 ? sizes[0] : 1000000, 42);
+        ConcurrentHashTable<std::string, uint64_t> concurrent(ids.size());
+        LockedHashTable locked;
+        for (size_t i = 0; i < ids.size(); i++) {
+            concurrent.insert(ids[i], i);
+            locked.insert(ids[i], i);
+        }
+        for (size_t threads = 1; threads <= 32; threads *= 2) {
+            benchReadScaling("CONCURRENT", concurrent, ids, threads, 2000000 / threads);
+            benchReadScaling("SHARED MUTEX", locked, ids, threads, 2000000 / threads);
+        }
+    }
+
+    std::cout << "----*** parseCSVLine THROUGHPUT ***----" << std::endl;
+    benchParseLine(1000000);
+
+    // A GENERATED CATALOG UNLESS --catalog NAMES ONE, REMOVED AFTERWARDS
+    bool generated = catalogPath.empty();
+    if (generated) {
+        catalogPath = "bench_catalog.csv";
+        writeCatalog(catalogPath, catalogRows);
+    }
+    size_t catalogBytes = 0;
+    {
+        MappedFile file;
+        if (file.open(catalogPath)) {
+            catalogBytes = file.size();
+        }
+    }
+
+    std::cout << "----*** END TO END loadFromCSV ***----" << std::endl;
+    benchLoad(catalogPath, catalogBytes, 1);
+    size_t hardwareThreads = std::thread::hardware_concurrency();
+    if (hardwareThreads > 1) {
+        benchLoad(catalogPath, catalogBytes, hardwareThreads);
+    }
+
+    std::cout << "----*** find AND listInventory LATENCY ***----" << std::endl;
+    benchLatency(catalogPath);
+
+    std::cout << "----*** agg SCANS ***----" << std::endl;
+    benchAggregate(catalogPath);
+    if (generated) {
+        std::remove(catalogPath.c_str());
+    }
+
+    std::cout << "----*** TEXT STORE: DICTIONARY COLUMNS OVER THE REPLICATED SAMPLE ***----" << std::endl;
+    benchTextStore(csvPath, textRows);
+
+    std::cout << "----*** CSV SCANNER THROUGHPUT ***----" << std::endl;
+    benchCSVScan(replicateSample(csvPath, csvBytes));
+    return 0;
+}
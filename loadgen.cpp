@@ -0,0 +1,142 @@
+/************************************************************************
+* Programmer:              SURAKANTI SRISHANTH REDDY                    *
+* Class:                   CPTS 223                                     *
+* Programming Assignment:  PA 3                                         *
+* Date:                    OCTOBER 24, 2025                             *
+*                                                                       *
+* Description: 			   LOAD GENERATOR FOR ./inventory --serve. EACH *
+*                          CONNECTION IS A THREAD THAT SENDS ONE        *
+*                          REQUEST FROM THE COMMAND FILE, WAITS FOR THE *
+*                          REPLY AND SENDS THE NEXT. PRINTS REQUESTS/S  *
+*                          AND THE p50 / p99 / p99.9 / MAX LATENCY.     *
+*                          ./inventory_loadgen SOCKET --commands FILE   *
+*                          [--connections N] [--requests N] [--wait S]  *
+*                                                                       *
+************************************************************************/
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include "CommandIO.h"
+#include "Server.h"
+
+typedef std::chrono::steady_clock Clock;
+
+static int usage(const char* program) {
+    std::cerr << "USAGE: " << program << " SOCKET --commands FILE [--connections N] [--requests N] [--wait SECONDS]"
+        << std::endl;
+    return 1;
+}
+
+int main(int argc, char* argv[]) {
+    std::string socketPath;
+    std::string commandFile;
+    size_t connections = 4;
+    size_t requests = 100000;
+    double waitSeconds = 60;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--commands" && i + 1 < argc) {
+            commandFile = argv[++i];
+        }
+        else if (arg == "--connections" && i + 1 < argc) {
+            connections = static_cast<size_t>(std::strtoull(argv[++i], nullptr, 10));
+        }
+        else if (arg == "--requests" && i + 1 < argc) {
+            requests = static_cast<size_t>(std::strtoull(argv[++i], nullptr, 10));
+        }
+        else if (arg == "--wait" && i + 1 < argc) {
+            waitSeconds = std::strtod(argv[++i], nullptr);
+        }
+        else if (socketPath.empty() && arg.compare(0, 2, "--") != 0) {
+            socketPath = arg;
+        }
+        else {
+            return usage(argv[0]);
+        }
+    }
+    if (socketPath.empty() || commandFile.empty() || connections == 0 || requests == 0) {
+        return usage(argv[0]);
+    }
+
+    std::vector<std::string> commands;
+    CommandReader reader(-1);
+    if (!reader.open(commandFile)) {
+        std::cerr << "CANNOT OPEN COMMAND FILE: " << commandFile << std::endl;
+        return 1;
+    }
+    std::string_view line;
+    while (reader.nextLine(line)) {
+        if (!line.empty()) {
+            commands.emplace_back(line);
+        }
+    }
+    if (commands.empty()) {
+        std::cerr << "NO COMMANDS IN " << commandFile << std::endl;
+        return 1;
+    }
+
+    // EVERY CONNECTION IS OPEN BEFORE THE CLOCK STARTS, THE FIRST ONE WAITS FOR
+    // THE SERVER TO FINISH LOADING
+    std::vector<std::unique_ptr<QueryClient>> clients;
+    for (size_t c = 0; c < connections; c++) {
+        clients.emplace_back(new QueryClient());
+        if (!clients.back()->connect(socketPath, c == 0 ? waitSeconds : 0)) {
+            std::cerr << "CANNOT CONNECT TO " << socketPath << std::endl;
+            return 1;
+        }
+    }
+
+    // CONNECTION c SENDS REQUESTS c, c + connections, ... CYCLING THROUGH THE FILE
+    std::vector<std::vector<double>> nanos(connections);
+    std::vector<size_t> replyBytes(connections, 0);
+    std::atomic<bool> failed(false);
+    std::vector<std::thread> threads;
+    Clock::time_point start = Clock::now();
+    for (size_t c = 0; c < connections; c++) {
+        threads.emplace_back([&, c] {
+            std::string reply;
+            nanos[c].reserve(requests / connections + 1);
+            for (size_t r = c; r < requests && !failed.load(std::memory_order_relaxed); r += connections) {
+                Clock::time_point sent = Clock::now();
+                if (!clients[c]->send(commands[r % commands.size()]) || !clients[c]->receive(reply)) {
+                    failed = true;
+                    return;
+                }
+                nanos[c].push_back(std::chrono::duration<double, std::nano>(Clock::now() - sent).count());
+                replyBytes[c] += reply.size();
+            }
+        });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    if (failed) {
+        std::cerr << "THE SERVER CLOSED A CONNECTION" << std::endl;
+        return 1;
+    }
+
+    std::vector<double> all;
+    all.reserve(requests);
+    size_t bytes = 0;
+    for (size_t c = 0; c < connections; c++) {
+        all.insert(all.end(), nanos[c].begin(), nanos[c].end());
+        bytes += replyBytes[c];
+    }
+    std::sort(all.begin(), all.end());
+    double n = static_cast<double>(all.size());
+    std::printf("%zu REQUESTS OVER %zu CONNECTIONS IN %.2f s: %.0f REQUESTS/S, %.1f MB/S OF REPLIES\n",
+        all.size(), connections, seconds, n / seconds, static_cast<double>(bytes) / seconds / 1e6);
+    std::printf("LATENCY  p50 %.1f us  p99 %.1f us  p99.9 %.1f us  MAX %.1f us\n",
+        all[static_cast<size_t>(n * 0.5)] / 1e3, all[static_cast<size_t>(n * 0.99)] / 1e3,
+        all[static_cast<size_t>(n * 0.999)] / 1e3, all.back() / 1e3);
+    return 0;
+}
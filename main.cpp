@@ -18,10 +18,27 @@
 #include <string>
 #include <sstream>
 #include <cassert>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
 #include "HashTable.h"
+#include "FlatHashTable.h"
+#include "ConcurrentHashTable.h"
 #include "Inventory.h"
+#include "CommandIO.h"
+#include "Server.h"
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <charconv>
+#include <chrono>
+#include <csignal>
+#include <iterator>
+#include <thread>
 
-// TEST FUNCTIONS 
+// TEST FUNCTIONS, LEFT OUT OF BUILDS WITH -DINVENTORY_NO_TESTS (THE -DNDEBUG
+// REPLAY BUILD, WHERE THE assert()s WOULD BE EMPTY)
+#ifndef INVENTORY_NO_TESTS
 void testHashTableBasic() {
     std::cout << "RUNNING HashTable BASIC TESTS..." << std::endl;
 
@@ -104,6 +121,1875 @@ void testHashTableRehash() {
     std::cout << "ALL HashTable REHASHING TESTS PASSED !\n" << std::endl;
 }
 
+void testHashTableIncrementalRehash() {
+    std::cout << "RUNNING HashTable INCREMENTAL REHASH TESTS..." << std::endl;
+
+    HashTable<int, int> ht(4);
+    ht.setIncrementalRehash(true, 1); //ONE BUCKET PER OPERATION TO KEEP A MIGRATION IN FLIGHT
+
+    int* first = nullptr;
+    bool sawRehash = false;
+    for (int i = 0; i < 200; i++) {
+        ht.insert(i, i * 10);
+        if (i == 0) {
+            first = ht.findPtr(0);
+        }
+        sawRehash = sawRehash || ht.isRehashing();
+
+        // EVERY KEY MUST BE VISIBLE WHETHER IT IS IN THE OLD OR THE NEW BUCKETS
+        int value;
+        for (int j = 0; j <= i; j += 17) {
+            assert(ht.find(j, value) == true);
+            assert(value == j * 10);
+        }
+    }
+    assert(sawRehash == true);
+    assert(ht.size() == 200);
+
+    // NODES ARE RELINKED, NOT REALLOCATED, SO VALUE POINTERS SURVIVE
+    assert(ht.findPtr(0) == first);
+
+    // REMOVE MUST ALSO FIND KEYS THAT HAVE NOT MIGRATED YET
+    for (int i = 0; i < 200; i += 2) {
+        assert(ht.remove(i) == true);
+    }
+    assert(ht.size() == 100);
+    assert(ht.getAllKeys().size() == 100);
+
+    HashTable<int, int> reserved(4);
+    reserved.reserve(1000);
+    size_t buckets = reserved.bucketCount();
+    for (int i = 0; i < 1000; i++) {
+        reserved.insert(i, i);
+    }
+    assert(reserved.bucketCount() == buckets);
+
+    std::cout << "ALL HashTable INCREMENTAL REHASH TESTS PASSED !\n" << std::endl;
+}
+
+void testHashTableInPlace() {
+    std::cout << "RUNNING HashTable IN PLACE TESTS..." << std::endl;
+
+    HashTable<std::string, std::vector<int>> ht(2);
+
+    // findOrInsert DEFAULT CONSTRUCTS ONCE, THEN APPENDS GO STRAIGHT INTO THE STORED VECTOR
+    ht.findOrInsert("EVENS").push_back(0);
+    ht.findOrInsert("EVENS").push_back(2);
+    ht.findOrInsert("ODDS").push_back(1);
+    assert(ht.size() == 2);
+    assert(ht.findPtr("EVENS") != nullptr);
+    assert(ht.findPtr("EVENS")->size() == 2);
+    assert(ht.findPtr("MISSING") == nullptr);
+
+    std::pair<std::vector<int>*, bool> result = ht.tryEmplace("TENS", 3, 10);
+    assert(result.second == true);
+    assert(result.first->size() == 3);
+    result = ht.tryEmplace("TENS", 1, 99);
+    assert(result.second == false);
+    assert((*result.first)[0] == 10);
+
+    std::string key = "MOVED";
+    std::vector<int> moved(100, 7);
+    ht.insert(std::move(key), std::move(moved));
+    assert(ht.findPtr("MOVED")->size() == 100);
+
+    FlatHashTable<std::string, std::vector<int>> flat;
+    flat.findOrInsert("A").push_back(1);
+    flat.findOrInsert("A").push_back(2);
+    assert(flat.findPtr("A")->size() == 2);
+    assert(flat.tryEmplace("A").second == false);
+
+    std::cout << "ALL HashTable IN PLACE TESTS PASSED !\n" << std::endl;
+}
+
+void testHashTableBatch() {
+    std::cout << "RUNNING HashTable BATCH LOOKUP TESTS..." << std::endl;
+
+    HashTable<std::string, int> ht(8);
+    for (int i = 0; i < 500; i++) {
+        ht.insert("KEY" + std::to_string(i), i);
+    }
+
+    // MORE THAN ONE BLOCK OF KEYS, EVERY THIRD ONE MISSING
+    std::vector<std::string> keys;
+    for (int i = 0; i < 300; i++) {
+        keys.push_back(i % 3 == 0 ? "MISSING" + std::to_string(i) : "KEY" + std::to_string(i * 7 % 500));
+    }
+    std::vector<const int*> results(keys.size());
+    ht.findBatch(keys.data(), keys.size(), results.data());
+    for (size_t i = 0; i < keys.size(); i++) {
+        assert(results[i] == ht.findPtr(keys[i]));
+    }
+    assert(results[0] == nullptr);
+    assert(*results[1] == 7);
+
+    // THE SAME ANSWERS WHILE A MIGRATION IS IN FLIGHT
+    HashTable<int, int> migrating(4);
+    migrating.setIncrementalRehash(true, 1);
+    for (int i = 0; i < 100; i++) {
+        migrating.insert(i, i * 2);
+    }
+    assert(migrating.isRehashing() == true);
+    int ints[] = { 0, 99, 50, 1000, 7 };
+    const int* found[5];
+    migrating.findBatch(ints, 5, found);
+    assert(*found[0] == 0 && *found[1] == 198 && *found[2] == 100);
+    assert(found[3] == nullptr);
+    assert(*found[4] == 14);
+
+    ht.findBatch(keys.data(), 0, results.data());
+
+    std::cout << "ALL HashTable BATCH LOOKUP TESTS PASSED !\n" << std::endl;
+}
+
+void testProductId() {
+    std::cout << "RUNNING PRODUCT I.D. TESTS..." << std::endl;
+
+    ProductId id, same, other;
+    assert(ProductId::parse("4c69b61db1fc16e7013b43fc926e502d", id));
+    assert(id.high == 0x4c69b61db1fc16e7ULL && id.low == 0x013b43fc926e502dULL);
+    assert(ProductId::parse("4c69b61db1fc16e7013b43fc926e502d", same) && id == same);
+    assert(ProductId::parse("4c69b61db1fc16e7013b43fc926e502e", other) && id != other);
+    assert(ProductIdHash()(id) == ProductIdHash()(same) && ProductIdHash()(id) != ProductIdHash()(other));
+
+    // ONLY EXACTLY 32 LOWER CASE HEX DIGITS PARSE
+    assert(!ProductId::parse("4c69b61db1fc16e7013b43fc926e502", other));
+    assert(!ProductId::parse("4c69b61db1fc16e7013b43fc926e502d0", other));
+    assert(!ProductId::parse("4C69B61DB1FC16E7013B43FC926E502D", other));
+    assert(!ProductId::parse("4c69b61db1fc16e7013b43fc926e502g", other));
+    assert(!ProductId::parse("4c69b61db1fc16e7013b43fc926e502:", other));
+    assert(!ProductId::parse("", other));
+
+    HashTable<ProductId, int, ProductIdHash> table(4);
+    FlatHashTable<ProductId, int, ProductIdHash> flat;
+    for (int i = 0; i < 100; i++) {
+        ProductId key = { static_cast<uint64_t>(i) * 7, static_cast<uint64_t>(i) };
+        table.insert(key, i);
+        flat.insert(key, i);
+    }
+    int value;
+    ProductId key = { 42 * 7, 42 };
+    assert(table.find(key, value) && value == 42 && flat.find(key, value) && value == 42);
+    key.high = 0;
+    assert(!table.find(key, value) && !flat.find(key, value));
+
+    // HEX I.D.s AND ANY OTHER I.D.s LIVE SIDE BY SIDE, THE UPPER CASE SPELLING
+    // OF A HEX I.D. IS A DIFFERENT PRODUCT
+    const char* path = "product_id_test.csv";
+    {
+        std::ofstream out(path);
+        out << "Uniq Id,Product Name,Brand Name,Asin,Category,Upc,List Price,Selling Price\n";
+        out << "4c69b61db1fc16e7013b43fc926e502d,Lower,,,Toys,,,$1.00\n";
+        out << "4C69B61DB1FC16E7013B43FC926E502D,Upper,,,Toys,,,$1.00\n";
+        out << "short-id,Short,,,Toys,,,$1.00\n";
+    }
+    InventoryManager manager;
+    std::streambuf* saved = std::cout.rdbuf(nullptr);
+    manager.loadFromCSV(path);
+    std::cout.rdbuf(saved);
+    std::remove(path);
+
+    assert(manager.findProduct("4c69b61db1fc16e7013b43fc926e502d")->getProductName() == "Lower");
+    assert(manager.findProduct("4C69B61DB1FC16E7013B43FC926E502D")->getProductName() == "Upper");
+    assert(manager.findProduct("short-id")->getProductName() == "Short");
+    assert(manager.findProduct("4c69b61db1fc16e7013b43fc926e502e") == nullptr);
+    assert(manager.findProduct("4c69b61db1fc16e7013b43fc926e502") == nullptr);
+
+    std::vector<Product*> found = manager.findProducts({ "short-id", "4c69b61db1fc16e7013b43fc926e502d",
+        "missing", "4C69B61DB1FC16E7013B43FC926E502D", "00000000000000000000000000000000" });
+    assert(found.size() == 5 && found[0]->getProductName() == "Short" && found[1]->getProductName() == "Lower");
+    assert(found[2] == nullptr && found[3]->getProductName() == "Upper" && found[4] == nullptr);
+
+    std::cout << "ALL PRODUCT I.D. TESTS PASSED !\n" << std::endl;
+}
+
+void testFlatHashTable() {
+    std::cout << "RUNNING FlatHashTable TESTS..." << std::endl;
+
+    FlatHashTable<int, int> ht(4, 0.5); //SMALL TABLE AND LOW LOAD FACTOR TO FORCE GROWTH
+
+    for (int i = 0; i < 1000; i++) {
+        ht.insert(i, i * 10);
+    }
+    assert(ht.size() == 1000);
+    assert(ht.loadFactor() <= 0.5);
+
+    int value;
+    for (int i = 0; i < 1000; i++) {
+        assert(ht.find(i, value) == true);
+        assert(value == i * 10);
+    }
+
+    // REMOVING LEAVES TOMBSTONES, LOOKUPS PAST THEM MUST STILL WORK
+    for (int i = 0; i < 1000; i += 2) {
+        assert(ht.remove(i) == true);
+    }
+    assert(ht.remove(0) == false);
+    assert(ht.size() == 500);
+    for (int i = 0; i < 1000; i++) {
+        assert(ht.contains(i) == (i % 2 == 1));
+    }
+
+    // REINSERTING REUSES TOMBSTONES AND UPDATES EXISTING KEYS
+    for (int i = 0; i < 1000; i++) {
+        ht.insert(i, -i);
+    }
+    assert(ht.size() == 1000);
+    assert(ht.find(7, value) == true);
+    assert(value == -7);
+    assert(ht.getAllKeys().size() == 1000);
+
+    FlatHashTable<std::string, int> strings;
+    strings.insert("ONE", 1);
+    strings.insert("", 0);
+    assert(strings.find("ONE", value) == true);
+    assert(value == 1);
+    assert(strings.contains("") == true);
+    strings.clear();
+    assert(strings.empty() == true);
+
+    std::cout << "ALL FlatHashTable TESTS PASSED !\n" << std::endl;
+}
+
+void testConcurrentHashTable() {
+    std::cout << "RUNNING ConcurrentHashTable TESTS..." << std::endl;
+
+    // TESTING (SINGLE THREADED BASICS)
+    ConcurrentHashTable<std::string, int> basic(4);
+    assert(basic.insert("apple", 1) == true);
+    assert(basic.insert("apple", 2) == false);
+    int value = 0;
+    assert(basic.find("apple", value) && value == 2);
+    assert(basic.remove("apple") == true && basic.remove("apple") == false);
+    assert(basic.empty() && !basic.contains("apple"));
+
+    // TESTING (3 READERS, 2 WRITERS). VALUES ARE (KEY << 32 | VERSION) AND EACH
+    // WRITER OWNS HALF THE KEYS, SO A READER MUST NEVER SEE ANOTHER KEY'S VALUE,
+    // A VERSION GOING BACKWARDS OR A GROWN KEY DISAPPEARING AGAIN
+    const uint64_t STABLE = 512;
+    const uint64_t GROWN = 4096;
+    const uint64_t CHURN = 64;
+    const int ROUNDS = 20;
+    const int WRITERS = 2;
+    const int READERS = 3;
+
+    ConcurrentHashTable<uint64_t, uint64_t> table(64);
+    for (uint64_t k = 0; k < STABLE; k++) {
+        table.insert(k, k << 32);
+    }
+
+    std::atomic<int> writersLeft(WRITERS);
+    std::atomic<bool> failed(false);
+    std::vector<std::thread> threads;
+    for (int w = 0; w < WRITERS; w++) {
+        threads.emplace_back([&, w] {
+            for (int round = 1; round <= ROUNDS; round++) {
+                for (uint64_t k = w; k < STABLE; k += WRITERS) {
+                    table.insert(k, k << 32 | static_cast<uint64_t>(round));
+                }
+                // NEW KEYS FORCE RESIZES WHILE READERS ARE INSIDE THE TABLE
+                for (uint64_t k = STABLE + w + (round - 1) * GROWN / ROUNDS; k < STABLE + round * GROWN / ROUNDS; k += WRITERS) {
+                    table.insert(k, k << 32);
+                }
+                for (uint64_t k = STABLE + GROWN + w; k < STABLE + GROWN + CHURN; k += WRITERS) {
+                    table.insert(k, k << 32);
+                    table.remove(k);
+                }
+            }
+            writersLeft.fetch_sub(1);
+        });
+    }
+    for (int r = 0; r < READERS; r++) {
+        threads.emplace_back([&, r] {
+            std::vector<uint64_t> lastVersion(STABLE, 0);
+            std::vector<bool> seen(GROWN, false);
+            uint64_t x = 88172645463325252ULL + r;
+            while (writersLeft.load() > 0) {
+                x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+                uint64_t k = x % (STABLE + GROWN + CHURN);
+                uint64_t v = 0;
+                bool found = table.find(k, v);
+                if (found && (v >> 32) != k) failed = true;
+                if (k < STABLE) {
+                    if (!found || (v & 0xFFFFFFFF) < lastVersion[k]) failed = true;
+                    lastVersion[k] = v & 0xFFFFFFFF;
+                }
+                else if (k < STABLE + GROWN) {
+                    if (seen[k - STABLE] && !found) failed = true;
+                    if (found) seen[k - STABLE] = true;
+                }
+            }
+        });
+    }
+    for (std::thread& t : threads) {
+        t.join();
+    }
+
+    assert(!failed.load());
+    assert(table.size() == STABLE + GROWN);
+    uint64_t v = 0;
+    for (uint64_t k = 0; k < STABLE; k++) {
+        assert(table.find(k, v) && v == (k << 32 | ROUNDS));
+    }
+    assert(!table.contains(STABLE + GROWN));
+    assert(table.bucketCount() / 4 * 3 >= STABLE + GROWN);
+
+    std::cout << "ALL ConcurrentHashTable TESTS PASSED !\n" << std::endl;
+}
+
+void testArena() {
+    std::cout << "RUNNING ARENA TESTS..." << std::endl;
+
+    Arena arena(256);
+    std::string_view copy = arena.copyString("Toys & Games");
+    assert(copy == "Toys & Games");
+
+    // SMALL OBJECTS SHARE A SLAB, A BIG ONE GETS ITS OWN
+    int* a = arena.create<int>(1);
+    double* b = arena.create<double>(2.5);
+    assert(*a == 1 && *b == 2.5);
+    assert(reinterpret_cast<uintptr_t>(b) % alignof(double) == 0);
+    size_t slabs = arena.slabCount();
+    arena.allocate(1000);
+    assert(arena.slabCount() == slabs + 1);
+
+    // HASH TABLE NODES FROM AN ARENA, REMOVED NODES ARE REUSED
+    HashTable<int, int> ht(8);
+    ht.useArena(&arena);
+    for (int i = 0; i < 100; i++) {
+        ht.insert(i, i);
+    }
+    size_t used = arena.bytesAllocated();
+    assert(ht.remove(5) == true);
+    ht.insert(500, 500);
+    assert(arena.bytesAllocated() == used);
+    int value;
+    assert(ht.find(500, value) == true && value == 500);
+
+    Arena other;
+    other.copyString("MOVED");
+    arena.adopt(other);
+    assert(other.slabCount() == 0);
+    assert(arena.bytesAllocated() > used);
+
+    std::cout << "ALL ARENA TESTS PASSED !\n" << std::endl;
+}
+
+void testCSVScanner() {
+    std::cout << "RUNNING CSV SCANNER TESTS..." << std::endl;
+
+    // QUOTED COMMAS, DOUBLED QUOTES, AN EMBEDDED NEWLINE AND A CRLF LINE ENDING
+    std::string csv =
+        "id,name,brand\r\n"
+        "abc, \"Crossbow 41\"\" Bamboo, Fiberglass\" ,DB\r\n"
+        "def,\"first line\nsecond line\",\"\"\n"
+        "\n"
+        "ghi,plain,last";
+
+    CSVScanner scanner(csv.data(), csv.size());
+    std::vector<std::string_view> fields;
+
+    assert(scanner.nextRecord(fields) == true);
+    assert(fields.size() == 3);
+    assert(fields[2] == "brand");
+
+    assert(scanner.nextRecord(fields) == true);
+    assert(fields.size() == 3);
+    assert(fields[0] == "abc");
+    assert(CSVScanner::unescape(fields[1]) == "Crossbow 41\" Bamboo, Fiberglass");
+    assert(fields[2] == "DB");
+
+    assert(scanner.nextRecord(fields) == true);
+    assert(scanner.recordLine() == 3);
+    assert(fields.size() == 3);
+    assert(fields[1] == "first line\nsecond line");
+    assert(fields[2].empty());
+
+    assert(scanner.nextRecord(fields) == true);   // BLANK LINE
+    assert(fields.size() == 1 && fields[0].empty());
+
+    assert(scanner.nextRecord(fields) == true);
+    assert(scanner.recordLine() == 6);
+    assert(fields[2] == "last");
+    assert(scanner.nextRecord(fields) == false);
+
+    std::vector<std::string> parsed = InventoryManager::parseCSVLine("a, \"b,c\" ,\"d\"\"e\"");
+    assert(parsed.size() == 3);
+    assert(parsed[1] == "b,c");
+    assert(parsed[2] == "d\"e");
+
+    std::cout << "ALL CSV SCANNER TESTS PASSED !\n" << std::endl;
+}
+
+// EVERY FIELD (POINTER AND LENGTH) AND RECORD LINE OF data AT ONE SIMD LEVEL
+static std::vector<std::pair<std::string_view, size_t>> scanAll(const std::string& data, CSVStructural::Level level) {
+    std::vector<std::pair<std::string_view, size_t>> out;
+    CSVScanner scanner(data.data(), data.size(), 1, level);
+    std::vector<std::string_view> fields;
+    while (scanner.nextRecord(fields)) {
+        for (std::string_view field : fields) {
+            out.push_back(std::make_pair(field, scanner.recordLine()));
+        }
+        out.push_back(std::make_pair(std::string_view(), scanner.currentLine()));
+    }
+    return out;
+}
+
+void testSimdScanner() {
+    std::cout << "RUNNING SIMD SCANNER TESTS (BEST LEVEL: "
+        << CSVStructural::name(CSVStructural::detect()) << ")..." << std::endl;
+
+    // TESTING (RANDOM QUOTES, COMMAS AND NEWLINES ACROSS 64 BYTE BLOCK EDGES)
+    const char alphabet[] = "ab,,\"\"\n\r ";
+    std::srand(223);
+    const CSVStructural::Level levels[] = { CSVStructural::SSE42, CSVStructural::AVX2 };
+    for (int round = 0; round < 300; round++) {
+        std::string data;
+        size_t length = static_cast<size_t>(std::rand() % 400);
+        for (size_t i = 0; i < length; i++) {
+            data += alphabet[std::rand() % (sizeof(alphabet) - 1)];
+        }
+
+        std::vector<std::pair<std::string_view, size_t>> expected = scanAll(data, CSVStructural::SCALAR);
+        for (CSVStructural::Level level : levels) {
+            if (!CSVStructural::supported(level)) continue;
+            std::vector<std::pair<std::string_view, size_t>> got = scanAll(data, level);
+            assert(got.size() == expected.size());
+            for (size_t i = 0; i < got.size(); i++) {
+                assert(got[i].first.data() == expected[i].first.data() || got[i].first.empty());
+                assert(got[i].first == expected[i].first);
+                assert(got[i].second == expected[i].second);
+            }
+        }
+    }
+
+    std::cout << "ALL SIMD SCANNER TESTS PASSED !\n" << std::endl;
+}
+
+void testCommandIO() {
+    std::cout << "RUNNING COMMAND I/O TESTS..." << std::endl;
+
+    // AN 8 BYTE BLOCK FORCES LINES ACROSS REFILLS AND ONE LINE LONGER THAN THE BUFFER
+    const char* path = "command_io_test.txt";
+    {
+        std::ofstream out(path, std::ios::binary);
+        out << "find abc\r\n\nlistInventory Toys & Games\nx\nlast line, no newline";
+    }
+    std::vector<std::string> lines;
+    {
+        CommandReader reader(-1, 8);
+        assert(reader.open(path) == true);
+        std::string_view line;
+        while (reader.nextLine(line)) {
+            lines.emplace_back(line);
+        }
+        assert(reader.nextLine(line) == false);
+    }
+    assert(lines.size() == 5);
+    assert(lines[0] == "find abc");
+    assert(lines[1].empty());
+    assert(lines[2] == "listInventory Toys & Games");
+    assert(lines[3] == "x");
+    assert(lines[4] == "last line, no newline");
+
+    CommandReader missing(-1);
+    assert(missing.open("no_such_command_file.txt") == false);
+
+    // NOTHING REACHES THE FILE UNTIL THE 16 BYTE BUFFER FILLS OR IS FLUSHED
+    int fd = ::open(path, O_WRONLY | O_TRUNC);
+    assert(fd >= 0);
+    {
+        BufferedWriter writer(fd, 16);
+        std::ostream out(&writer);
+        out << "TOTAL: " << 42;
+        struct stat st;
+        assert(fstat(fd, &st) == 0 && st.st_size == 0);
+        out << '\n' << std::string(40, 'x') << "\nEND\n";
+        out.flush();
+        assert(writer.hasFailed() == false);
+    }
+    ::close(fd);
+    std::ifstream in(path, std::ios::binary);
+    std::string written((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    in.close();
+    std::remove(path);
+    assert(written == "TOTAL: 42\n" + std::string(40, 'x') + "\nEND\n");
+
+    std::cout << "ALL COMMAND I/O TESTS PASSED !\n" << std::endl;
+}
+
+void testQueryServer() {
+    std::cout << "RUNNING QUERY SERVER TESTS..." << std::endl;
+
+    // TESTING (PIPELINED REQUESTS ON TWO CONNECTIONS COME BACK IN ORDER, A REPLY
+    // BIGGER THAN THE SOCKET BUFFER, A LAST LINE WITH NO NEWLINE)
+    const char* path = "server_test.sock";
+    {
+        QueryServer server([](std::string_view request, std::ostream& out) {
+            if (request == "big") {
+                out << std::string(3 << 20, 'x');
+                return;
+            }
+            if (request == "wide") {
+                out << std::string(5000, 'w');
+                return;
+            }
+            out << "ECHO " << request << '\n';
+        }, 3);
+        std::string error;
+        assert(server.listen(path, error));
+        std::thread loop([&server] { server.run(); });
+
+        QueryClient clients[2];
+        for (QueryClient& client : clients) {
+            assert(client.connect(path, 5));
+        }
+        for (int i = 0; i < 300; i++) {
+            assert(clients[i % 2].send("r" + std::to_string(i)));
+        }
+        assert(clients[0].send("big") && clients[0].send(""));
+        std::string reply;
+        for (int i = 0; i < 300; i++) {
+            assert(clients[i % 2].receive(reply) && reply == "ECHO r" + std::to_string(i) + "\n");
+        }
+        assert(clients[0].receive(reply) && reply == std::string(3 << 20, 'x'));
+        assert(clients[0].receive(reply) && reply == "ECHO \n");
+
+        int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        sockaddr_un address;
+        std::memset(&address, 0, sizeof(address));
+        address.sun_family = AF_UNIX;
+        std::strcpy(address.sun_path, path);
+        assert(connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0);
+        assert(::write(fd, "tail", 4) == 4 && shutdown(fd, SHUT_WR) == 0);
+        std::string raw;
+        char block[64];
+        for (ssize_t n; (n = ::read(fd, block, sizeof(block))) > 0; ) {
+            raw.append(block, static_cast<size_t>(n));
+        }
+        ::close(fd);
+        assert(raw == "10\nECHO tail\n");
+
+        // TESTING (A PEER THAT SENDS MORE THAN MAX_LINE AND ASKS FOR MORE THAN
+        // MAX_UNSENT BEFORE IT READS ANYTHING IS HELD BACK, AND STILL GETS EVERY
+        // REPLY IN ORDER)
+        QueryClient flood;
+        assert(flood.connect(path, 5));
+        std::thread sender([&flood] {
+            for (int i = 0; i < 100000; i++) {
+                assert(flood.send(i % 50 == 0 ? "wide" : "flood " + std::to_string(i)));
+            }
+        });
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+        for (int i = 0; i < 100000; i++) {
+            assert(flood.receive(reply));
+            assert(reply == (i % 50 == 0 ? std::string(5000, 'w') : "ECHO flood " + std::to_string(i) + "\n"));
+        }
+        sender.join();
+
+        server.stop();
+        loop.join();
+        assert(server.requestCount() == 100303 && server.connectionCount() == 4);
+    }
+    struct stat st;
+    assert(::stat(path, &st) != 0);
+
+    std::cout << "ALL QUERY SERVER TESTS PASSED !\n" << std::endl;
+}
+
+void testParallelLoad() {
+    std::cout << "RUNNING PARALLEL LOAD TESTS..." << std::endl;
+
+    // DUPLICATE IDS, A MULTI LINE RECORD, A SHORT ROW AND A BLANK LINE
+    const char* path = "parallel_load_test.csv";
+    {
+        std::ofstream out(path);
+        out << "Uniq Id,Product Name,Brand Name,Asin,Category,Upc,List Price,Selling Price\n";
+        for (int i = 0; i < 300; i++) {
+            out << "id" << (i % 250) << ",\"Item " << i << "\nsecond, line\",Brand,,\""
+                << (i % 3 == 0 ? "Toys & Games | Puzzles" : "Sports & Outdoors | Toys & Games")
+                << "\",,,$" << i << ".99\n";
+            if (i == 120) out << "short,row\n\n";
+        }
+    }
+
+    InventoryManager serial;
+    InventoryManager parallel;
+    std::streambuf* saved = std::cout.rdbuf(nullptr);
+    std::streambuf* savedErr = std::cerr.rdbuf(nullptr);
+    serial.loadFromCSV(path, 1);
+    parallel.loadFromCSV(path, 4);
+    std::cout.rdbuf(saved);
+    std::cerr.rdbuf(savedErr);
+    std::remove(path);
+
+    assert(serial.productCount() == 300);
+    assert(parallel.productCount() == serial.productCount());
+    for (size_t i = 0; i < serial.productCount(); i++) {
+        assert(parallel.getAllProducts()[i]->getUniqId() == serial.getAllProducts()[i]->getUniqId());
+        assert(parallel.getAllProducts()[i]->getProductName() == serial.getAllProducts()[i]->getProductName());
+    }
+
+    // THE LAST DUPLICATE WINS IN BOTH
+    assert(parallel.findProduct("id5")->getProductName() == serial.findProduct("id5")->getProductName());
+    assert(serial.findProduct("id5")->getProductName() == "Item 255\nsecond, line");
+
+    std::vector<Product*> batch = parallel.findProducts({ "id5", "nope", "id249", "id0" });
+    assert(batch.size() == 4);
+    assert(batch[0] == parallel.findProduct("id5"));
+    assert(batch[1] == nullptr);
+    assert(batch[2] == parallel.findProduct("id249"));
+    assert(batch[3] == parallel.findProduct("id0"));
+
+    // SAME CATEGORY I.D.s IN THE SAME ORDER
+    assert(serial.getCategoryDictionary().size() == parallel.getCategoryDictionary().size());
+    for (uint32_t id = 0; id < serial.getCategoryDictionary().size(); id++) {
+        assert(serial.getCategoryDictionary().name(id) == parallel.getCategoryDictionary().name(id));
+    }
+
+    const char* categories[] = { "Toys & Games", "Puzzles", "Sports & Outdoors" };
+    for (const char* category : categories) {
+        const std::vector<Product*>& a = serial.listInventoryByCategory(category);
+        const std::vector<Product*>& b = parallel.listInventoryByCategory(category);
+        assert(a.size() == b.size());
+        for (size_t i = 0; i < a.size(); i++) {
+            assert(a[i]->getProductName() == b[i]->getProductName());
+        }
+    }
+
+    // A FILE SMALLER THAN THE CHUNK COUNT (THE FIRST CHUNKS ARE EMPTY), THE HEADER
+    // IS STILL NOT LOADED AS A PRODUCT
+    {
+        std::ofstream out(path);
+        out << "Uniq Id,Product Name,Brand Name,Asin,Category,Upc,List Price,Selling Price\n"
+            << "a1,Kite,Acme,,Toys,,,$1.00\n"
+            << "a2,Ball,Acme,,Toys,,,$2.00\n";
+    }
+    InventoryManager tinySerial;
+    InventoryManager tinyParallel;
+    std::cout.rdbuf(nullptr);
+    tinySerial.loadFromCSV(path, 1);
+    tinyParallel.loadFromCSV(path, 64);
+    std::cout.rdbuf(saved);
+    std::remove(path);
+    assert(tinySerial.productCount() == 2 && tinyParallel.productCount() == 2);
+    assert(tinyParallel.findProduct("Uniq Id") == nullptr);
+    assert(tinyParallel.getAllProducts()[0]->getUniqId() == "a1" && tinyParallel.getAllProducts()[1]->getUniqId() == "a2");
+
+    std::cout << "ALL PARALLEL LOAD TESTS PASSED !\n" << std::endl;
+}
+
+// TWO INVENTORIES WITH THE SAME ROWS ANSWER EVERY INDEX THE SAME, WHETHER
+// THEIR INDEXES WERE BUILT, MAPPED FROM A SNAPSHOT OR CHANGED BY A DELTA
+void assertSameIndexes(const InventoryManager& a, const InventoryManager& b) {
+    for (ProductStore::FloatColumn column : { ProductStore::PRICE, ProductStore::AVERAGE_RATING }) {
+        std::vector<uint32_t> x, y;
+        a.getSortedIndex(column).visitRange(-HUGE_VALF, HUGE_VALF, [&](float, uint32_t row) { x.push_back(row); return true; });
+        b.getSortedIndex(column).visitRange(-HUGE_VALF, HUGE_VALF, [&](float, uint32_t row) { y.push_back(row); return true; });
+        assert(x == y && a.getSortedIndex(column).size() == b.getSortedIndex(column).size());
+    }
+
+    for (const char* query : { "item", "item 15", "brand3", "item brand2", "updated" }) {
+        for (bool matchAll : { true, false }) {
+            size_t xTotal = 0, yTotal = 0;
+            std::vector<TextIndex::Hit> x = a.getTextIndex().search(query, matchAll, a.productCount() + 1, xTotal);
+            std::vector<TextIndex::Hit> y = b.getTextIndex().search(query, matchAll, b.productCount() + 1, yTotal);
+            assert(xTotal == yTotal && x.size() == y.size());
+            auto byRow = [](const TextIndex::Hit& u, const TextIndex::Hit& v) { return u.row < v.row; };
+            std::sort(x.begin(), x.end(), byRow);
+            std::sort(y.begin(), y.end(), byRow);
+            for (size_t i = 0; i < x.size(); i++) {
+                assert(x[i].row == y[i].row && std::fabs(x[i].score - y[i].score) < 1e-9);
+            }
+        }
+    }
+
+    for (const char* path : { "", "Toys & Games", "Toys & Games | Puzzles", "Hobbies", "Hobbies | Models", "NA" }) {
+        uint32_t xNode, yNode;
+        bool found = a.findCategoryNode(path, xNode);
+        assert(found == b.findCategoryNode(path, yNode));
+        if (!found) {
+            continue;
+        }
+        assert(a.getCategoryTree().children(xNode).size() == b.getCategoryTree().children(yNode).size());
+        assert(a.getCategoryTree().ownCount(xNode) == b.getCategoryTree().ownCount(yNode));
+        InventoryManager::ProductList x = a.listInventoryBySubtree(xNode);
+        InventoryManager::ProductList y = b.listInventoryBySubtree(yNode);
+        assert(x.size() == y.size());
+        for (size_t i = 0; i < x.size(); i++) {
+            assert(x[i]->getRow() == y[i]->getRow());
+        }
+    }
+
+    // matches() COUNTS A REPEATED I.D. ONCE, size() NOT WHILE A DELTA IS PENDING
+    for (const char* prefix : { "", "id", "id1", "id14", "0000", "x" }) {
+        PrefixIndex<ProductIdKeys>::Matches x = a.getIdPrefixes().matches(prefix, 5);
+        PrefixIndex<ProductIdKeys>::Matches y = b.getIdPrefixes().matches(prefix, 5);
+        assert(x.count == y.count && x.keys == y.keys && x.common == y.common);
+    }
+    for (const char* prefix : { "", "T", "H", "P", "Z" }) {
+        PrefixIndex<CategoryNameKeys>::Matches x = a.getCategoryPrefixes().matches(prefix, 5);
+        PrefixIndex<CategoryNameKeys>::Matches y = b.getCategoryPrefixes().matches(prefix, 5);
+        assert(x.count == y.count && x.keys == y.keys && x.common == y.common);
+    }
+    assert(a.getCategoryPrefixes().size() == b.getCategoryPrefixes().size());
+}
+
+void testSnapshot() {
+    std::cout << "RUNNING SNAPSHOT TESTS..." << std::endl;
+
+    // EVERY TENTH ROW HAS A 32 HEX DIGIT I.D. (READ IN PLACE FROM THE SNAPSHOT),
+    // ROWS 150 TO 199 REPEAT THE I.D.s OF ROWS 0 TO 49
+    auto hexId = [](int n) {
+        char text[33];
+        std::snprintf(text, sizeof(text), "%032x", n);
+        return std::string(text);
+    };
+    const char* csvPath = "snapshot_test.csv";
+    const char* snapPath = "snapshot_test.snap";
+    {
+        std::ofstream out(csvPath);
+        out << "Uniq Id,Product Name,Brand Name,Asin,Category,Upc,List Price,Selling Price\n";
+        for (int i = 0; i < 200; i++) {
+            out << (i % 10 == 0 ? hexId(i % 150) : "id" + std::to_string(i % 150)) << ",\"Item " << i << "\",Brand" << i % 7 << ",,\""
+                << (i % 4 == 0 ? "" : i % 2 ? "Toys & Games | Puzzles" : "Hobbies")
+                << "\",,," << (i % 5 == 0 ? "" : "$" + std::to_string(i) + ".50") << "\n";
+        }
+    }
+
+    InventoryManager original;
+    InventoryManager restored;
+    InventoryManager stale;
+    InventoryManager damaged;
+    std::streambuf* saved = std::cout.rdbuf(nullptr);
+    std::streambuf* savedErr = std::cerr.rdbuf(nullptr);
+    original.loadFromCSV(csvPath);
+    bool wrote = original.saveSnapshot(snapPath, csvPath);
+    bool loaded = restored.loadSnapshot(snapPath, csvPath);
+
+    // TESTING (A MAPPED INVENTORY SAVES TO THE SAME BYTES, AND AFTER A DELTA
+    // APPENDS TO ITS POOLS THE SAVE STILL LOADS)
+    const char* copyPath = "snapshot_test_copy.snap";
+    const char* deltaPath = "snapshot_test_delta.csv";
+    bool copied = restored.saveSnapshot(copyPath, csvPath);
+    std::ifstream first(snapPath, std::ios::binary);
+    std::ifstream second(copyPath, std::ios::binary);
+    std::string firstBytes((std::istreambuf_iterator<char>(first)), std::istreambuf_iterator<char>());
+    std::string secondBytes((std::istreambuf_iterator<char>(second)), std::istreambuf_iterator<char>());
+    {
+        std::ofstream out(deltaPath);
+        out << "Uniq Id,Product Name,Brand Name,Asin,Category,Upc,List Price,Selling Price\n";
+        out << "idNew,\"Delta Item\",New Brand,,\"Hobbies | Models\",,,$3.25\n";
+        out << "-" << hexId(20) << "\n";
+        out << hexId(30) << ",\"Updated Item\",Brand2,,\"Hobbies\",,,$9.75\n";
+    }
+    InventoryManager grown;
+    InventoryManager regrown;
+    InventoryManager::DeltaCounts counts;
+    bool grewLoaded = grown.loadSnapshot(snapPath, csvPath) && grown.applyDelta(deltaPath, counts)
+        && grown.saveSnapshot(copyPath, csvPath) && regrown.loadSnapshot(copyPath, csvPath);
+    std::remove(copyPath);
+    std::remove(deltaPath);
+
+    // TESTING (SOURCE CHANGED -> STALE, FLIPPED BYTE -> CHECKSUM)
+    {
+        std::ofstream out(csvPath, std::ios::app);
+        out << "id999,Late,Brand,,Hobbies,,,$1\n";
+    }
+    bool staleLoaded = stale.loadSnapshot(snapPath, csvPath);
+    original.saveSnapshot(snapPath, csvPath);
+    {
+        std::fstream file(snapPath, std::ios::in | std::ios::out | std::ios::binary);
+        file.seekp(-3, std::ios::end);
+        file.put('\x7f');
+    }
+    bool damagedLoaded = damaged.loadSnapshot(snapPath, csvPath);
+    std::cout.rdbuf(saved);
+    std::cerr.rdbuf(savedErr);
+    std::remove(csvPath);
+    std::remove(snapPath);
+
+    assert(wrote && loaded);
+    assert(copied && !firstBytes.empty() && firstBytes == secondBytes);
+    assert(grewLoaded && counts.inserted == 1 && counts.updated == 1 && counts.deleted == 1);
+    assert(regrown.productCount() == original.productCount());
+    assert(regrown.findProduct("idNew")->getProductName() == "Delta Item");
+    assert(regrown.findProduct("idNew")->getManufacturer() == "New Brand");
+    assert(regrown.findProduct("id7")->getProductName() == "Item 157");
+    for (const InventoryManager* manager : { &grown, &regrown }) {
+        assert(manager->findProduct(hexId(20)) == nullptr);
+        assert(manager->findProduct(hexId(30))->getProductName() == "Updated Item");
+        assert(manager->findProduct(hexId(40))->getProductName() == "Item 190");
+    }
+    assertSameIndexes(grown, regrown);
+    assert(!staleLoaded && stale.productCount() == 0);
+    assert(!damagedLoaded && damaged.productCount() == 0);
+
+    assert(restored.productCount() == original.productCount());
+    for (size_t i = 0; i < original.productCount(); i++) {
+        const Product* a = original.getAllProducts()[i];
+        const Product* b = restored.getAllProducts()[i];
+        assert(a->getUniqId() == b->getUniqId());
+        assert(a->getProductName() == b->getProductName());
+        assert(a->getManufacturer() == b->getManufacturer());
+        assert(a->getPrice() == b->getPrice());
+        assert(a->getCategoryString() == b->getCategoryString());
+        assert(a->hasPriceValue() == b->hasPriceValue() && a->getPriceValue() == b->getPriceValue());
+        assert(a->getCategories().size() == b->getCategories().size());
+        for (size_t c = 0; c < a->getCategories().size(); c++) {
+            assert(a->getCategories()[c] == b->getCategories()[c]);
+        }
+    }
+    assert(restored.findProduct("id7")->getProductName() == "Item 157");
+    assert(restored.findProduct("id999") == nullptr);
+
+    // TESTING (THE I.D. TABLE AND THE INDEXES ARE USED IN PLACE AND ANSWER LIKE
+    // THE ONES BUILT FROM THE CSV)
+    assert(restored.snapshotIdCount() == 15);
+    std::vector<std::string> ids;
+    for (int i = 0; i < 160; i += 5) {
+        ids.push_back(i % 10 == 0 ? hexId(i) : "id" + std::to_string(i));
+    }
+    std::vector<std::string_view> views(ids.begin(), ids.end());
+    std::vector<Product*> expected = original.findProducts(views);
+    std::vector<Product*> actual = restored.findProducts(views);
+    for (size_t i = 0; i < ids.size(); i++) {
+        assert((expected[i] == nullptr) == (actual[i] == nullptr) && (i < 30) == (actual[i] != nullptr));
+        assert(!actual[i] || (actual[i]->getRow() == expected[i]->getRow() && restored.findProduct(ids[i]) == actual[i]));
+    }
+    assertSameIndexes(original, restored);
+
+    const char* categories[] = { "Toys & Games", "Puzzles", "Hobbies", "NA" };
+    for (const char* category : categories) {
+        const std::vector<Product*>& a = original.listInventoryByCategory(category);
+        const std::vector<Product*>& b = restored.listInventoryByCategory(category);
+        assert(!a.empty() && a.size() == b.size());
+        for (size_t i = 0; i < a.size(); i++) {
+            assert(a[i]->getUniqId() == b[i]->getUniqId());
+        }
+    }
+
+    std::cout << "ALL SNAPSHOT TESTS PASSED !\n" << std::endl;
+}
+
+void testCategoryDictionary() {
+    std::cout << "RUNNING CATEGORY DICTIONARY TESTS..." << std::endl;
+
+    CategoryDictionary dict;
+    assert(dict.intern("Toys & Games") == 0);
+    assert(dict.intern("Puzzles") == 1);
+    assert(dict.intern("Toys & Games") == 0);
+    assert(dict.size() == 2);
+
+    uint32_t id;
+    assert(dict.find("Puzzles", id) == true && id == 1);
+    assert(dict.find("Hobbies", id) == false);
+    assert(dict.name(0) == "Toys & Games");
+
+    // TWO PRODUCTS SHARING A DICTIONARY SHARE I.D.s
+    Arena arena;
+    ProductStore store;
+    Product a(store, arena, dict, "1", "A", "", "", "", "", "", "Toys & Games | Hobbies");
+    Product b(store, arena, dict, "2", "B", "", "", "", "", "", " Hobbies|Toys & Games ");
+    assert(a.getCategories().ids()[0] == b.getCategories().ids()[1]);
+    assert(a.getCategories().ids()[1] == b.getCategories().ids()[0]);
+    assert(b.getCategories()[0] == "Hobbies");
+    assert(dict.size() == 3);
+
+    std::cout << "ALL CATEGORY DICTIONARY TESTS PASSED !\n" << std::endl;
+}
+
+void testProductStore() {
+    std::cout << "RUNNING PRODUCT STORE TESTS..." << std::endl;
+
+    auto name = [](const ProductStore& from, uint32_t row) {
+        std::string text;
+        from.appendText(ProductStore::NAME, row, text);
+        return text;
+    };
+
+    // TESTING (NUMERIC PARSING, NULLS, TEXT ROUND TRIP)
+    ProductStore store;
+    assert(store.appendRow("a", "Kite", "Acme", "$1,299.50", "12", "3", "4.5 out of 5 stars", "Toys") == 0);
+    assert(store.appendRow("b", "", "", "", "n/a", "", "", "") == 1);
+    assert(store.appendRow("c", "Set", "", "$12.99 - $15.99", "", "", "", "") == 2);
+    assert(store.size() == 3);
+
+    assert(store.hasFloat(ProductStore::PRICE, 0) && store.floatAt(ProductStore::PRICE, 0) == 1299.5f);
+    assert(store.hasFloat(ProductStore::AVERAGE_RATING, 0) && store.floatAt(ProductStore::AVERAGE_RATING, 0) == 4.5f);
+    assert(store.hasCount(ProductStore::REVIEW_COUNT, 0) && store.countAt(ProductStore::REVIEW_COUNT, 0) == 12);
+    assert(store.countAt(ProductStore::ANSWERED_QUESTIONS, 0) == 3);
+    assert(!store.hasFloat(ProductStore::PRICE, 1) && store.floatAt(ProductStore::PRICE, 1) == 0.0f);
+    assert(!store.hasCount(ProductStore::REVIEW_COUNT, 1));
+    assert(store.floatAt(ProductStore::PRICE, 2) == 12.99f);
+
+    assert(name(store, 0) == "Kite");
+    assert(store.textAt(ProductStore::PRICE_TEXT, 0) == "$1,299.50");
+    assert(store.textAt(ProductStore::CATEGORY_TEXT, 0) == "Toys");
+    assert(store.textAt(ProductStore::REVIEWS_TEXT, 1) == "n/a");
+    assert(name(store, 1).empty() && store.textAt(ProductStore::NAME, 1).empty());
+
+    // ADOPTED ROWS KEEP THEIR VALUES AND NULL BITS
+    ProductStore other;
+    for (int i = 0; i < 100; i++) {
+        std::string price = i % 3 == 0 ? "" : "$" + std::to_string(i);
+        other.appendRow(std::to_string(i), "Name" + std::to_string(i), "", price, "", "", "", "");
+    }
+    std::string_view before = other.textAt(ProductStore::ID, 42);
+    assert(store.adopt(other) == 3);
+    assert(store.size() == 103 && other.size() == 0);
+    assert(name(store, 45) == "Name42");
+    assert(store.textAt(ProductStore::ID, 45).data() == before.data());
+    for (uint32_t i = 0; i < 100; i++) {
+        assert(store.hasFloat(ProductStore::PRICE, 3 + i) == (i % 3 != 0));
+        if (i % 3 != 0) assert(store.floatAt(ProductStore::PRICE, 3 + i) == static_cast<float>(i));
+    }
+    assert(store.textAt(ProductStore::ID, 0) == "a");
+
+    // TESTING (DICTIONARY COLUMNS KEEP ONE COPY PER DISTINCT VALUE, ALSO ACROSS adopt())
+    ProductStore dict;
+    for (int i = 0; i < 50; i++) {
+        dict.appendRow(std::to_string(i), "Name" + std::to_string(i), i % 2 ? "Acme" : "Hasbro", "$5.00", "", "", "",
+            "Toys > Kites");
+    }
+    assert(dict.textAt(ProductStore::MANUFACTURER, 1).data() == dict.textAt(ProductStore::MANUFACTURER, 49).data());
+    assert(dict.textAt(ProductStore::MANUFACTURER, 0) == "Hasbro" && dict.textAt(ProductStore::MANUFACTURER, 1) == "Acme");
+    ProductStore::TextUsage usage = dict.textUsage(ProductStore::MANUFACTURER);
+    assert(usage.values == 2 && usage.storedBytes < usage.plainBytes);
+    assert(dict.textUsage(ProductStore::NAME).values == 50);
+    ProductStore more;
+    more.appendRow("x", "X", "Lego", "", "", "", "", "Toys > Kites");
+    more.appendRow("y", "Y", "Acme", "$5.00", "", "", "", "");
+    assert(dict.adopt(more) == 50);
+    assert(dict.textUsage(ProductStore::MANUFACTURER).values == 3);
+    assert(dict.textAt(ProductStore::MANUFACTURER, 51).data() == dict.textAt(ProductStore::MANUFACTURER, 1).data());
+    assert(dict.textAt(ProductStore::CATEGORY_TEXT, 50).data() == dict.textAt(ProductStore::CATEGORY_TEXT, 0).data());
+    assert(dict.textAt(ProductStore::MANUFACTURER, 50) == "Lego" && dict.textAt(ProductStore::CATEGORY_TEXT, 51).empty());
+    dict.setRow(0, "0", "Name0", "Lego", "$5.00", "", "", "", "Toys > Kites");
+    assert(dict.textAt(ProductStore::MANUFACTURER, 0).data() == dict.textAt(ProductStore::MANUFACTURER, 50).data());
+    dict.moveRow(51, 2);
+    dict.popRow();
+    assert(dict.size() == 51 && dict.textAt(ProductStore::PRICE_TEXT, 2) == "$5.00");
+    assert(dict.textAt(ProductStore::MANUFACTURER, 2) == "Acme" && name(dict, 2) == "Y");
+
+    // A STRING LONGER THAN ONE POOL CHUNK
+    std::string huge(StringPool::CHUNK_SIZE + 10, 'x');
+    uint32_t row = store.appendRow("h", huge, "", "", "", "", "", "");
+    assert(name(store, row) == huge);
+    assert(name(store, 45) == "Name42");
+
+    // TESTING (A NAME IS ITS WORDS, EACH KEPT ONCE: SPACES ANYWHERE SURVIVE THE
+    // ROUND TRIP, THE WORDS ARE SHARED ACROSS ROWS, setRow() AND adopt())
+    ProductStore coded;
+    const char* names[] = { "Red Toy Car", "Red Toy Truck", " Red  Toy ", "Toy", "Red Toy Car Red Toy Car" };
+    for (int i = 0; i < 5; i++) {
+        coded.appendRow(std::to_string(i), names[i], "", "", "", "", "", "");
+    }
+    for (uint32_t i = 0; i < 5; i++) {
+        assert(name(coded, i) == names[i]);
+    }
+    ProductStore::TextUsage words = coded.textUsage(ProductStore::NAME);
+    assert(words.values == 7);             // "Red ", "Toy ", "Car", "Truck", " ", "Toy", "Car "
+    std::string pieces;
+    coded.visitText(ProductStore::NAME, 1, [&pieces](std::string_view word) { pieces += "[" + std::string(word) + "]"; });
+    assert(pieces == "[Red ][Toy ][Truck]");
+    assert(coded.textAt(ProductStore::NAME, 4).size() == 6);
+    coded.setRow(3, "3", "Blue Toy", "", "", "", "", "", "");
+    assert(name(coded, 3) == "Blue Toy" && coded.textUsage(ProductStore::NAME).values == 8);
+    ProductStore extra;
+    extra.appendRow("x", "Car Red Kite", "", "", "", "", "", "");
+    assert(coded.adopt(extra) == 5 && name(coded, 5) == "Car Red Kite" && name(coded, 0) == "Red Toy Car");
+    assert(coded.textUsage(ProductStore::NAME).values == 9);
+    ProductStore repeated;
+    for (int i = 0; i < 1000; i++) {
+        repeated.appendRow(std::to_string(i), "Deluxe Wooden Toy Train Set With Tracks " + std::to_string(i % 10), "", "", "",
+            "", "", "");
+    }
+    usage = repeated.textUsage(ProductStore::NAME);
+    assert(usage.values == 17 && usage.storedBytes * 2 < usage.plainBytes);
+
+    std::cout << "ALL PRODUCT STORE TESTS PASSED !\n" << std::endl;
+}
+
+void testSortedIndex() {
+    std::cout << "RUNNING SORTED INDEX TESTS..." << std::endl;
+
+    // TIES, ROWS WITHOUT A VALUE AND SEVERAL FENCE BLOCKS
+    std::vector<float> values;
+    std::vector<uint64_t> valid(8, 0);
+    for (uint32_t row = 0; row < 500; row++) {
+        values.push_back(static_cast<float>((row * 37) % 101));
+        if (row % 7 != 0) {
+            valid[row >> 6] |= uint64_t(1) << (row & 63);
+        }
+    }
+    SortedIndex index;
+    index.build(values.data(), valid.data(), values.size());
+    assert(index.size() == 500 - 72);
+    for (size_t i = 1; i < index.size(); i++) {
+        assert(index.keyAt(i - 1) < index.keyAt(i)
+            || (index.keyAt(i - 1) == index.keyAt(i) && index.rowAt(i - 1) < index.rowAt(i)));
+        assert(index.rowAt(i) % 7 != 0);
+    }
+    for (float probe = -1.0f; probe <= 102.0f; probe += 0.5f) {
+        size_t lower = 0;
+        size_t upper = 0;
+        for (size_t i = 0; i < index.size(); i++) {
+            lower += index.keyAt(i) < probe;
+            upper += index.keyAt(i) <= probe;
+        }
+        assert(index.lowerBound(probe) == lower);
+        assert(index.upperBound(probe) == upper);
+    }
+
+    SortedIndex none;
+    none.build(nullptr, nullptr, 0);
+    assert(none.empty() && none.lowerBound(1.0f) == 0 && none.upperBound(1.0f) == 0);
+
+    // RANGE AND TOP QUERIES AGAINST A BRUTE FORCE FILTER, WITH A SMALL CATEGORY
+    // (POSTINGS WALKED) AND A LARGE ONE (INDEX RANGE WALKED)
+    const char* path = "sorted_index_test.csv";
+    {
+        std::ofstream out(path);
+        out << "Uniq Id,Product Name,Brand Name,Asin,Category,Upc,List Price,Selling Price\n";
+        for (int i = 0; i < 400; i++) {
+            out << "p" << i << ",Item " << i << ",,," << (i % 50 == 0 ? "Big | Small" : "Big") << ",,,";
+            if (i % 13 != 0) {
+                out << "$" << (i * 31) % 97 << ".50";
+            }
+            out << "\n";
+        }
+    }
+    InventoryManager manager;
+    std::streambuf* saved = std::cout.rdbuf(nullptr);
+    manager.loadFromCSV(path);
+    std::cout.rdbuf(saved);
+    std::remove(path);
+
+    const char* categories[] = { "", "Big", "Small" };
+    for (const char* category : categories) {
+        std::vector<Product*> expected;
+        for (Product* p : manager.getAllProducts()) {
+            bool member = std::string(category).empty() || p->getCategoryString().find(category) != std::string::npos;
+            if (member && p->hasPriceValue() && p->getPriceValue() >= 10.0f && p->getPriceValue() <= 40.5f) {
+                expected.push_back(p);
+            }
+        }
+        std::stable_sort(expected.begin(), expected.end(), [](const Product* a, const Product* b) {
+            return a->getPriceValue() < b->getPriceValue();
+        });
+        assert(manager.rangeQuery(ProductStore::PRICE, 10.0f, 40.5f, category) == expected);
+
+        std::vector<Product*> top = manager.topQuery(ProductStore::PRICE, 5, category);
+        std::vector<Product*> all = manager.rangeQuery(ProductStore::PRICE, -1.0f, 1000.0f, category);
+        std::reverse(all.begin(), all.end());
+        all.resize(std::min<size_t>(5, all.size()));
+        assert(top == all);
+    }
+    assert(manager.rangeQuery(ProductStore::PRICE, 20.0f, 10.0f).empty());
+    assert(manager.rangeQuery(ProductStore::PRICE, 0.0f, 100.0f, "Nope").empty());
+    assert(manager.topQuery(ProductStore::AVERAGE_RATING, 3).empty());
+    assert(manager.topQuery(ProductStore::PRICE, 1000).size() == manager.getSortedIndex(ProductStore::PRICE).size());
+
+    std::cout << "ALL SORTED INDEX TESTS PASSED !\n" << std::endl;
+}
+
+// ROWS WHOSE NAME OR MANUFACTURER HOLDS EVERY (matchAll) OR ANY ONE OF words,
+// FOUND BY SPLITTING THE TEXT AGAIN INSTEAD OF USING THE INDEX
+std::vector<uint32_t> bruteForceSearch(const InventoryManager& manager, const std::vector<std::string>& words, bool matchAll) {
+    std::vector<uint32_t> rows;
+    for (size_t row = 0; row < manager.productCount(); row++) {
+        const Product* p = manager.getAllProducts()[row];
+        std::string text = std::string(p->getProductName()) + " " + std::string(p->getManufacturer());
+        for (char& c : text) {
+            c = std::isalnum(static_cast<unsigned char>(c)) ? static_cast<char>(std::tolower(static_cast<unsigned char>(c))) : ' ';
+        }
+        std::istringstream in(text);
+        std::vector<std::string> terms((std::istream_iterator<std::string>(in)), std::istream_iterator<std::string>());
+        size_t matched = 0;
+        for (const std::string& word : words) {
+            matched += std::find(terms.begin(), terms.end(), word) != terms.end();
+        }
+        if (matchAll ? matched == words.size() : matched > 0) {
+            rows.push_back(static_cast<uint32_t>(row));
+        }
+    }
+    return rows;
+}
+
+void testTextIndex() {
+    std::cout << "RUNNING TEXT INDEX TESTS..." << std::endl;
+
+    // "common" IS IN EVERY OTHER ROW AND "rare" IN EVERY 97TH, SO AN AND QUERY
+    // GALLOPS ACROSS MANY 128 POSTING BLOCKS. 3000 ROWS GIVE THE 4 THREAD BUILD
+    // SEVERAL CHUNKS TO MERGE
+    const char* path = "text_index_test.csv";
+    {
+        std::ofstream out(path);
+        out << "Uniq Id,Product Name,Brand Name,Asin,Category,Upc,List Price,Selling Price\n";
+        for (int i = 0; i < 3000; i++) {
+            out << "t" << i << ",\"" << (i % 2 == 0 ? "Common " : "") << (i % 97 == 0 ? "RARE-" : "")
+                << "Widget W" << i % 7 << (i % 5 == 0 ? " widget" : "") << "\","
+                << (i % 3 == 0 ? "Acme Common" : "Globex") << ",,Toys,,,$1.00\n";
+        }
+    }
+    InventoryManager serial;
+    InventoryManager parallel;
+    std::streambuf* saved = std::cout.rdbuf(nullptr);
+    serial.loadFromCSV(path, 1);
+    parallel.loadFromCSV(path, 4);
+    std::cout.rdbuf(saved);
+    std::remove(path);
+
+    const TextIndex& index = serial.getTextIndex();
+    uint32_t id;
+    assert(index.findTerm("WIDGET", id) && index.termName(id) == "widget");
+    assert(!index.findTerm("widgets", id) && !index.findTerm("rare-widget", id));
+
+    // THE PARALLEL BUILD NUMBERS AND STORES THE TERMS EXACTLY LIKE THE SERIAL ONE
+    const TextIndex& other = parallel.getTextIndex();
+    assert(other.termCount() == index.termCount() && other.postings() == index.postings());
+    assert(other.postingBytesUsed() == index.postingBytesUsed());
+    for (uint32_t t = 0; t < index.termCount(); t++) {
+        assert(other.termName(t) == index.termName(t));
+    }
+
+    const char* queries[] = { "common rare", "rare common w3", "widget", "globex rare", "acme w0 common", "rare nothing" };
+    for (const char* query : queries) {
+        std::vector<std::string> words;
+        std::istringstream in(query);
+        for (std::string word; in >> word;) {
+            words.push_back(word);
+        }
+        for (bool matchAll : { true, false }) {
+            std::vector<uint32_t> expected = bruteForceSearch(serial, words, matchAll);
+            size_t total = 0;
+            std::vector<TextIndex::Hit> hits = index.search(query, matchAll, 100000, total);
+            assert(total == expected.size() && hits.size() == expected.size());
+            std::vector<uint32_t> rows;
+            for (size_t i = 0; i < hits.size(); i++) {
+                rows.push_back(hits[i].row);
+                assert(i == 0 || hits[i - 1].score > hits[i].score
+                    || (hits[i - 1].score == hits[i].score && hits[i - 1].row < hits[i].row));
+            }
+            std::sort(rows.begin(), rows.end());
+            assert(rows == expected);
+
+            // THE TOP 5 ARE THE FIRST 5 OF THE FULL RANKING
+            size_t topTotal = 0;
+            std::vector<Product*> top = parallel.search(query, matchAll, 5, topTotal);
+            assert(topTotal == total && top.size() == std::min<size_t>(5, hits.size()));
+            for (size_t i = 0; i < top.size(); i++) {
+                assert(top[i] == parallel.getAllProducts()[hits[i].row]);
+            }
+        }
+    }
+
+    // A NAME MATCH OUTRANKS A MANUFACTURER ONLY MATCH OF THE SAME TERM
+    size_t total = 0;
+    std::vector<Product*> best = serial.search("common", true, 1, total);
+    assert(best.size() == 1 && best[0]->getUniqId() == "t0");
+    assert(serial.search("", true, 10, total).empty() && total == 0);
+
+    std::cout << "ALL TEXT INDEX TESTS PASSED !\n" << std::endl;
+}
+
+struct VectorKeys {
+    const std::vector<std::string>* keys;
+    std::string_view operator()(uint32_t i) const { return (*keys)[i]; }
+};
+
+void testPrefixIndex() {
+    std::cout << "RUNNING PREFIX INDEX TESTS..." << std::endl;
+
+    // SHORT KEYS THAT SHARE A ZERO PADDED HEAD, DUPLICATES, KEYS LONGER THAN 8
+    // BYTES WITH EQUAL HEADS AND TWO THAT SHARE MORE THAN 255 BYTES
+    std::vector<std::string> keys = { "toys", "to", "toy", "", "toys & games", "toys & games", "tools",
+        "b", "\xC3\xA9t\xC3\xA9", "toys & gadgets", "a", std::string(300, 'x') + "1", std::string(300, 'x') + "2", "t" };
+    for (int i = 0; i < 500; i++) {
+        keys.push_back("id" + std::to_string(i * 7919 % 1000));
+    }
+    PrefixIndex<VectorKeys> index(VectorKeys{ &keys });
+    index.build(static_cast<uint32_t>(keys.size()));
+
+    std::vector<std::string> distinct(keys);
+    std::sort(distinct.begin(), distinct.end());
+    distinct.erase(std::unique(distinct.begin(), distinct.end()), distinct.end());
+    assert(index.size() == distinct.size());
+    for (size_t i = 0; i < distinct.size(); i++) {
+        assert(index.keyAt(i) == distinct[i]);
+    }
+    assert(index.refAt(index.prefixRange("toys & games").first) == 4);    // THE FIRST OF THE TWO
+
+    const char* prefixes[] = { "", "t", "to", "toy", "toys", "toys ", "toys & ga", "toys & gam", "tz", "id1", "id99",
+        "id999", "id9999", "\xC3", "zzz", "a", "0" };
+    std::vector<std::string> probes(prefixes, prefixes + sizeof(prefixes) / sizeof(prefixes[0]));
+    probes.push_back(std::string(300, 'x'));
+    probes.push_back(std::string(299, 'x') + "y");
+    for (const std::string& prefix : probes) {
+        size_t first = 0;
+        while (first < distinct.size() && distinct[first] < prefix) {
+            first++;
+        }
+        size_t last = first;
+        while (last < distinct.size() && distinct[last].compare(0, prefix.size(), prefix) == 0) {
+            last++;
+        }
+        PrefixIndex<VectorKeys>::Range range = index.prefixRange(prefix);
+        assert(index.lowerBound(prefix) == first);
+        assert(range.size() == last - first && (range.empty() || range.first == first));
+    }
+    assert(index.commonPrefix(index.prefixRange("toys & ")) == "toys & ga");
+    assert(index.commonPrefix(index.prefixRange("x")) == std::string(300, 'x'));
+    assert(index.commonPrefix(index.prefixRange("q")).empty());
+    assert(index.longestMatch("toys & gizmos") == 8 && index.longestMatch("id5x") == 3);
+    assert(index.longestMatch("q") == 0);
+
+    PrefixIndex<VectorKeys> none(VectorKeys{ &keys });
+    none.build(0);
+    assert(none.empty() && none.prefixRange("t").empty() && none.longestMatch("t") == 0);
+
+    // CATEGORY SUGGESTIONS FOR A NAME THAT IS NOT THERE
+    const char* path = "prefix_index_test.csv";
+    {
+        std::ofstream out(path);
+        out << "Uniq Id,Product Name,Brand Name,Asin,Category,Upc,List Price,Selling Price\n";
+        out << "p1,One,,,Toys & Games | Puzzles,,,$1.00\n";
+        out << "p2,Two,,,Toys & Games | Board Games,,,$2.00\n";
+        out << "q3,Three,,,Sports & Outdoors,,,$3.00\n";
+    }
+    InventoryManager manager;
+    std::streambuf* saved = std::cout.rdbuf(nullptr);
+    manager.loadFromCSV(path);
+    std::cout.rdbuf(saved);
+    std::remove(path);
+    std::vector<std::string_view> suggestions = manager.suggestCategories("Toys & Games | Puz", 5);
+    assert(!suggestions.empty() && suggestions[0].substr(0, 12) == "Toys & Games");
+    assert(manager.suggestCategories("Xylophones", 5).empty());
+    assert(manager.getIdPrefixes().prefixRange("p").size() == 2);
+    assert(manager.getCategoryPrefixes().size() == manager.getCategoryDictionary().size());
+
+    std::cout << "ALL PREFIX INDEX TESTS PASSED !\n" << std::endl;
+}
+
+void testCategoryTree() {
+    std::cout << "RUNNING CATEGORY TREE TESTS..." << std::endl;
+
+    // "Outdoor" UNDER TWO PARENTS, A PRODUCT ENDING AT AN INNER NODE, ODD
+    // SPACING AND EMPTY SEGMENTS, A PRODUCT WITH NO CATEGORY
+    const char* paths[] = { "Sports | Outdoor | Bikes", "Toys | Outdoor", "Sports|Outdoor", "Sports | Fitness",
+        "Toys |  | Outdoor | Kites ", "", "Sports | Outdoor | Bikes", "Toys" };
+    const size_t pathCount = sizeof(paths) / sizeof(paths[0]);
+    const char* path = "category_tree_test.csv";
+    {
+        std::ofstream out(path);
+        out << "Uniq Id,Product Name,Brand Name,Asin,Category,Upc,List Price,Selling Price\n";
+        for (size_t i = 0; i < 3000; i++) {
+            out << "c" << i << ",Item,,,\"" << paths[(i * 5) % pathCount] << "\",,,$1.00\n";
+        }
+    }
+    InventoryManager serial;
+    InventoryManager parallel;
+    std::streambuf* saved = std::cout.rdbuf(nullptr);
+    serial.loadFromCSV(path, 1);
+    parallel.loadFromCSV(path, 4);
+    std::cout.rdbuf(saved);
+    std::remove(path);
+
+    const CategoryTree& tree = serial.getCategoryTree();
+    assert(tree.size() == 9);       // ROOT, NA, Sports (Outdoor (Bikes), Fitness), Toys (Outdoor (Kites))
+    assert(tree.subtreeCount(CategoryTree::ROOT) == 3000 && tree.subtreeEnd(CategoryTree::ROOT) == tree.size());
+
+    uint32_t sportsOutdoor, toysOutdoor, toys, kites;
+    assert(serial.findCategoryNode("Sports | Outdoor", sportsOutdoor));
+    assert(serial.findCategoryNode("  Toys|Outdoor ", toysOutdoor) && toysOutdoor != sportsOutdoor);
+    assert(serial.findCategoryNode("Toys", toys) && tree.depth(toys) == 1 && tree.parent(toysOutdoor) == toys);
+    assert(serial.findCategoryNode("Toys | Outdoor | Kites", kites) && tree.depth(kites) == 3);
+    assert(serial.categoryPath(kites) == "Toys | Outdoor | Kites");
+    assert(!serial.findCategoryNode("Outdoor", toys) && !serial.findCategoryNode("Toys | Bikes", toys));
+    serial.findCategoryNode("Toys", toys);
+
+    // EVERY SUBTREE AGAINST A BRUTE FORCE PREFIX MATCH ON THE PRODUCTS' PATHS
+    for (uint32_t node = 0; node < tree.size(); node++) {
+        std::vector<uint32_t> steps;
+        for (uint32_t n = node; n != CategoryTree::ROOT; n = tree.parent(n)) {
+            steps.insert(steps.begin(), tree.name(n));
+        }
+        std::vector<Product*> expected;
+        size_t own = 0;
+        for (Product* p : serial.getAllProducts()) {
+            Product::CategoryList categories = p->getCategories();
+            if (categories.size() >= steps.size() && std::equal(steps.begin(), steps.end(), categories.ids())) {
+                expected.push_back(p);
+                own += categories.size() == steps.size();
+            }
+        }
+        std::vector<Product*> products;
+        for (Product* p : serial.listInventoryBySubtree(node)) {
+            products.push_back(p);
+        }
+        assert(tree.subtreeCount(node) == expected.size() && tree.ownCount(node) == own);
+        std::sort(products.begin(), products.end());
+        std::sort(expected.begin(), expected.end());
+        assert(products == expected);
+
+        // THE SUBTREE'S NODES ARE THE INTERVAL [node, end) AND CHILDREN ARE IN NAME ORDER
+        for (uint32_t n = node + 1; n < tree.subtreeEnd(node); n++) {
+            assert(tree.depth(n) > tree.depth(node));
+        }
+        std::vector<uint32_t> children = tree.children(node);
+        for (size_t i = 1; i < children.size(); i++) {
+            assert(serial.getCategoryDictionary().name(tree.name(children[i - 1]))
+                < serial.getCategoryDictionary().name(tree.name(children[i])));
+        }
+    }
+    assert(tree.children(toys).size() == 1 && tree.ownCount(toys) > 0);
+
+    // WITHIN ONE NODE THE PRODUCTS STAY IN FILE ORDER, THE PARALLEL LOAD GIVES THE SAME TREE
+    InventoryManager::ProductList bikes = serial.listInventoryBySubtree(sportsOutdoor + 1);
+    assert(bikes.size() > 1 && bikes[0]->getUniqId() == "c0" && bikes[1]->getUniqId() == "c6");
+    const CategoryTree& other = parallel.getCategoryTree();
+    assert(other.size() == tree.size());
+    for (uint32_t node = 0; node < tree.size(); node++) {
+        assert(parallel.categoryPath(node) == serial.categoryPath(node));
+        assert(other.subtreeCount(node) == tree.subtreeCount(node));
+    }
+
+    std::cout << "ALL CATEGORY TREE TESTS PASSED !\n" << std::endl;
+}
+
+void testProductList() {
+    std::cout << "RUNNING PRODUCT LIST TESTS..." << std::endl;
+
+    const char* path = "product_list_test.csv";
+    {
+        std::ofstream out(path);
+        out << "Uniq Id,Product Name,Brand Name,Asin,Category,Upc,List Price,Selling Price\n";
+        for (int i = 0; i < 50; i++) {
+            out << "l" << i << ",Item " << i << ",,," << (i % 2 == 0 ? "Toys | Games" : "Toys | Puzzles | Games") << ",,,$1.00\n";
+        }
+    }
+    InventoryManager manager;
+    std::streambuf* saved = std::cout.rdbuf(nullptr);
+    manager.loadFromCSV(path);
+    std::cout.rdbuf(saved);
+    std::remove(path);
+
+    // A TOP LEVEL NAME IS ITS SUBTREE, "Games" (AT TWO LEVELS) IS THE FLAT POSTINGS
+    InventoryManager::ProductList toys, games, missing;
+    assert(manager.findCategoryProducts("Toys", toys) && toys.size() == 50);
+    assert(manager.findCategoryProducts("Games", games) && games.size() == 50);
+    assert(!manager.findCategoryProducts("Kites", missing) && missing.empty());
+    assert(games[0] == manager.listInventoryByCategory("Games")[0]);
+    InventoryManager::ProductList puzzles;
+    assert(manager.findCategoryProducts("Toys | Puzzles", puzzles) && puzzles.size() == 25);
+
+    // PAGES ARE VIEWS OF THE SAME PRODUCTS, CLAMPED AT THE END
+    for (const InventoryManager::ProductList* list : { &toys, &games }) {
+        InventoryManager::ProductList page = list->slice(10, 5);
+        assert(page.size() == 5);
+        size_t i = 10;
+        for (Product* p : page) {
+            assert(p == (*list)[i++]);
+        }
+        assert(list->slice(48, 5).size() == 2 && list->slice(50, 5).empty() && list->slice(500, 5).empty());
+        assert(list->slice(0, SIZE_MAX).size() == 50);
+    }
+
+    // THE GETTERS ARE VIEWS INTO THE STORE, NOT COPIES (THE CODED NAME IS
+    // DECODED FOR EVERY CALL)
+    Product* first = toys[0];
+    assert(first->getUniqId().data() == first->idView().data());
+    assert(first->getCategoryString().data() == toys[1]->getCategoryString().data());
+    assert(first->getProductName() == "Item 0" && first->getCategoryString() == "Toys | Games");
+    std::ostringstream printed;
+    first->printName(printed);
+    assert(printed.str() == "Item 0");
+
+    std::cout << "ALL PRODUCT LIST TESTS PASSED !\n" << std::endl;
+}
+
+// EVERY SECONDARY INDEX applyDelta() KEPT UP TO DATE ANSWERS LIKE ONE BUILT
+// FROM SCRATCH OVER THE SAME ROWS
+void assertIndexesMatchRebuild(const InventoryManager& manager) {
+    const ProductStore& rows = manager.getStore();
+    const std::vector<Product*>& all = manager.getAllProducts();
+
+    SortedIndex price;
+    price.build(rows.floatColumn(ProductStore::PRICE), rows.floatValidBits(ProductStore::PRICE), rows.size());
+    std::vector<uint32_t> expected, actual;
+    price.visitRange(-HUGE_VALF, HUGE_VALF, [&](float, uint32_t row) { expected.push_back(row); return true; });
+    manager.getSortedIndex(ProductStore::PRICE).visitRange(-HUGE_VALF, HUGE_VALF, [&](float, uint32_t row) {
+        actual.push_back(row);
+        return true;
+    });
+    assert(expected == actual && price.size() == manager.getSortedIndex(ProductStore::PRICE).size());
+
+    // EVERY MATCH IS RETURNED, SCORES MAY DIFFER IN THE LAST BIT (TERMS ARE SUMMED IN ANOTHER ORDER)
+    TextIndex text;
+    text.build(rows);
+    for (const char* query : { "widget", "gadget", "widget thirty", "loop widget", "bulk 7" }) {
+        for (bool matchAll : { true, false }) {
+            size_t freshTotal = 0, total = 0;
+            std::vector<TextIndex::Hit> x = text.search(query, matchAll, all.size() + 1, freshTotal);
+            std::vector<TextIndex::Hit> y = manager.getTextIndex().search(query, matchAll, all.size() + 1, total);
+            assert(freshTotal == total && x.size() == y.size());
+            auto byRow = [](const TextIndex::Hit& a, const TextIndex::Hit& b) { return a.row < b.row; };
+            std::sort(x.begin(), x.end(), byRow);
+            std::sort(y.begin(), y.end(), byRow);
+            for (size_t i = 0; i < x.size(); i++) {
+                assert(x[i].row == y[i].row && std::fabs(x[i].score - y[i].score) < 1e-9);
+            }
+        }
+    }
+
+    CategoryTree tree;
+    tree.build(static_cast<uint32_t>(all.size()), [&](uint32_t row) { return all[row]->getCategories(); },
+        manager.getCategoryDictionary());
+    for (const char* path : { "", "Tools", "Tools | Saws", "Tools | Loops", "Tools | Bulk", "Garden" }) {
+        uint32_t freshNode, node;
+        bool found = tree.findPath(path, manager.getCategoryDictionary(), freshNode);
+        assert(found == manager.findCategoryNode(path, node));
+        if (!found) {
+            continue;
+        }
+        assert(tree.children(freshNode).size() == manager.getCategoryTree().children(node).size());
+        assert(tree.ownCount(freshNode) == manager.getCategoryTree().ownCount(node));
+        InventoryManager::ProductList list = manager.listInventoryBySubtree(node);
+        assert(list.size() == tree.subtreeCount(freshNode));
+        for (size_t i = 0; i < list.size(); i++) {
+            assert(list[i]->getRow() == tree.rowData()[tree.subtreeFirst(freshNode) + i]);
+        }
+    }
+
+    PrefixIndex<ProductIdKeys> ids(ProductIdKeys{ &rows });
+    ids.build(static_cast<uint32_t>(rows.size()));
+    for (const char* prefix : { "d", "d2", "d3", "b1", "x" }) {
+        PrefixIndex<ProductIdKeys>::Matches x = ids.matches(prefix, 5);
+        PrefixIndex<ProductIdKeys>::Matches y = manager.getIdPrefixes().matches(prefix, 5);
+        assert(x.count == y.count && x.keys == y.keys && x.common == y.common);
+        assert(ids.longestMatch(std::string(prefix) + "zz") == manager.getIdPrefixes().longestMatch(std::string(prefix) + "zz"));
+    }
+    assert(ids.size() == manager.getIdPrefixes().size());
+}
+
+void testApplyDelta() {
+    std::cout << "RUNNING DELTA TESTS..." << std::endl;
+
+    const char* basePath = "delta_base_test.csv";
+    const char* deltaPath = "delta_change_test.csv";
+    const char* header = "Uniq Id,Product Name,Brand Name,Asin,Category,Upc,List Price,Selling Price\n";
+    {
+        std::ofstream out(basePath);
+        out << header;
+        for (int i = 0; i < 20; i++) {
+            out << "d" << i << ",Widget " << i << ",,," << (i % 2 == 0 ? "Tools | Saws" : "Tools | Drills") << ",,,$" << i << ".00\n";
+        }
+    }
+    {
+        // UPDATE d2 (NEW CATEGORY), DELETE d0 AND d5, INSERT d20 AND d21, ONE
+        // DELETE OF AN I.D. THAT IS NOT THERE AND ONE PATH NAMING A CATEGORY TWICE
+        std::ofstream out(deltaPath);
+        out << header;
+        out << "d2,Gadget Two,,,Garden | Hoses,,,$50.00\n";
+        out << "-d0\n";
+        out << "-d5,,,,,,,\n";
+        out << "-nope\n";
+        out << "d20,Widget Twenty,,,Tools | Saws,,,$20.00\n";
+        out << "d21,Widget Loop,,,Tools | Loops | Tools,,,$21.00\n";
+    }
+    InventoryManager manager;
+    std::streambuf* saved = std::cout.rdbuf(nullptr);
+    manager.loadFromCSV(basePath);
+    std::cout.rdbuf(saved);
+
+    Product* kept = manager.findProduct("d2");
+    Product* deleted = manager.findProduct("d0");
+    Product* five = manager.findProduct("d5");
+    InventoryManager::DeltaCounts counts;
+    {
+        // A DELETED Product READS EMPTY AND, WITH A GUARD HELD, IS NOT REUSED
+        InventoryManager::ReadGuard guard(manager);
+        assert(manager.applyDelta(deltaPath, counts));
+        assert(deleted->isDeleted() && deleted->getUniqId().empty() && deleted->getProductName().empty());
+        assert(deleted->getCategories().size() == 0 && !deleted->hasPriceValue());
+        assert(manager.findProduct("d20") != deleted && manager.findProduct("d21") != deleted);
+    }
+    assert(counts.inserted == 2 && counts.updated == 1 && counts.deleted == 2 && counts.missing == 1);
+    assert(manager.productCount() == 20);
+
+    // AN UPDATE KEEPS THE SAME Product
+    assert(manager.findProduct("d2") == kept && kept->getProductName() == "Gadget Two" && !kept->isDeleted());
+    assert(kept->getPriceValue() == 50.0f && kept->getCategoryString() == "Garden | Hoses");
+    assert(!manager.findProduct("d0") && !manager.findProduct("d5"));
+
+    // ROWS STAY DENSE AND EVERY POSTINGS LIST MATCHES A SCAN OF THE PRODUCTS
+    const std::vector<Product*>& all = manager.getAllProducts();
+    for (size_t r = 0; r < all.size(); r++) {
+        assert(all[r]->getRow() == r && manager.findProduct(all[r]->getUniqId()) == all[r]);
+    }
+    for (const char* name : { "Tools", "Saws", "Drills", "Garden", "Hoses", "Loops" }) {
+        std::vector<std::string_view> expected, actual;
+        for (Product* p : all) {
+            for (std::string_view category : p->getCategories()) {
+                if (category == name) {
+                    expected.push_back(p->getUniqId());
+                }
+            }
+        }
+        for (Product* p : manager.listInventoryByCategory(name)) {
+            actual.push_back(p->getUniqId());
+        }
+        std::sort(expected.begin(), expected.end());
+        std::sort(actual.begin(), actual.end());
+        assert(expected == actual);
+    }
+    assert(manager.listInventoryByCategory("Saws").size() == 9);
+    assert(manager.listInventoryByCategory("Tools").size() == 20);
+
+    // THE SECONDARY INDEXES ARE ALREADY UP TO DATE: THE CHANGES WAIT IN THEIR
+    // SIDE BUFFERS, NOTHING WAS OR WILL BE REBUILT FOR A QUERY
+    assert(manager.getTextIndex().pending() > 0 && manager.getSortedIndex(ProductStore::PRICE).pending() > 0);
+    assert(!manager.getCategoryTree().unchanged(CategoryTree::ROOT) && manager.getIdPrefixes().pending() > 0);
+    assertIndexesMatchRebuild(manager);
+    size_t total = 0;
+    assert(manager.search("gadget", true, 10, total).size() == 1 && total == 1);
+    assert(manager.search("widget", true, 10, total).size() == 10 && total == 19);
+    assert(manager.rangeQuery(ProductStore::PRICE, 0.0f, 1.0f).size() == 1);
+    assert(manager.topQuery(ProductStore::PRICE, 1)[0] == kept);
+    InventoryManager::ProductList tools, garden;
+    assert(manager.findCategoryProducts("Tools", tools) && tools.size() == 19);
+    assert(manager.findCategoryProducts("Garden", garden) && garden.size() == 1 && garden[0] == kept);
+    assert(manager.getIdPrefixes().matches("d2", 10).count == 3);
+
+    // A SECOND DELTA: WITH NO GUARD LEFT THE PRODUCTS THE FIRST ONE DELETED ARE REUSED
+    {
+        std::ofstream out(deltaPath);
+        out << header;
+        out << "-d2\n";
+        out << "d30,Widget Thirty,,,Garden | Hoses,,,$30.00\n";
+    }
+    InventoryManager::DeltaCounts again;
+    assert(manager.applyDelta(deltaPath, again) && again.inserted == 1 && again.deleted == 1);
+    Product* thirty = manager.findProduct("d30");
+    assert((thirty == deleted || thirty == five) && !thirty->isDeleted() && thirty->getUniqId() == "d30");
+    assert(kept->isDeleted());
+    assert(manager.findCategoryProducts("Garden", garden) && garden.size() == 1 && garden[0]->getUniqId() == "d30");
+
+    // DELETING A CATEGORY'S LAST PRODUCT DELETES THE CATEGORY, ITS NAME IS NO
+    // LONGER LISTED, COMPLETED OR SUGGESTED
+    // A GUARD TAKEN AFTER d2 WAS DELETED STILL HOLDS ITS Product BACK: ONE
+    // INSERT GETS THE LAST FREE Product, THE OTHER A NEW ONE
+    {
+        std::ofstream out(deltaPath);
+        out << header;
+        out << "-d30\n";
+        out << "d31,Widget Thirty One,,,Tools | Saws,,,$31.00\n";
+        out << "d32,Widget Thirty Two,,,Tools | Saws,,,$32.00\n";
+    }
+    {
+        InventoryManager::ReadGuard guard(manager);
+        assert(manager.applyDelta(deltaPath, again) && again.deleted == 2 && again.inserted == 3);
+        assert(manager.findProduct("d31") != kept && manager.findProduct("d32") != kept && kept->isDeleted());
+        assert(thirty->isDeleted());
+    }
+    assert(!manager.categoryExists("Garden") && !manager.categoryExists("Hoses") && manager.categoryExists("Tools"));
+    assert(!manager.findCategoryProducts("Garden", garden) && !manager.findCategoryProducts("Hoses", garden));
+    assert(!manager.findCategoryProducts("Garden | Hoses", garden));
+    assert(manager.getCategoryPrefixes().matches("Ga", 5).count == 0 && manager.getCategoryPrefixes().matches("Ho", 5).count == 0);
+    assert(manager.getCategoryPrefixes().size() == 4);
+    assert(manager.suggestCategories("Gardens", 5).empty());
+    assertIndexesMatchRebuild(manager);
+
+    // ONCE THE GUARD IS GONE THE NEXT INSERT REUSES ONE OF THEM
+    {
+        std::ofstream out(deltaPath);
+        out << header;
+        out << "d33,Widget Thirty Three,,,Tools | Saws,,,$33.00\n";
+    }
+    assert(manager.applyDelta(deltaPath, again));
+    assert(manager.findProduct("d33") == kept || manager.findProduct("d33") == thirty);
+    assert(manager.findProduct("d33")->getUniqId() == "d33" && !manager.findProduct("d33")->isDeleted());
+
+    // A DELTA WITH ENOUGH CHANGES MAKES THE INDEXES MERGE THEM IN
+    {
+        std::ofstream out(deltaPath);
+        out << header;
+        for (int i = 0; i < 1500; i++) {
+            out << "b" << i << ",Bulk Widget " << i << ",,," << (i % 3 == 0 ? "Tools | Bulk" : "Tools | Saws")
+                << ",,,$" << (i % 97) << ".50\n";
+        }
+        out << "-d31\n";
+    }
+    InventoryManager::DeltaCounts bulk;
+    assert(manager.applyDelta(deltaPath, bulk) && bulk.inserted == 1500 && bulk.deleted == 1);
+    assert(manager.getTextIndex().pending() == 0 && manager.getSortedIndex(ProductStore::PRICE).pending() == 0);
+    assert(manager.getCategoryTree().pending() == 0 && manager.getIdPrefixes().pending() == 0);
+    assertIndexesMatchRebuild(manager);
+    std::remove(basePath);
+    std::remove(deltaPath);
+    saved = std::cerr.rdbuf(nullptr);
+    assert(!manager.applyDelta(deltaPath, again));
+    std::cerr.rdbuf(saved);
+
+    std::cout << "ALL DELTA TESTS PASSED !\n" << std::endl;
+}
+
+void testConcurrentDelta() {
+    std::cout << "RUNNING CONCURRENT DELTA TESTS..." << std::endl;
+
+    // TESTING (READERS UNDER A ReadLock NEVER SEE HALF A DELTA: EVERY DELTA
+    // MOVES THE SAME 200 PRODUCTS OUT OF ONE CATEGORY AND INTO ANOTHER, SO A
+    // READER ALWAYS FINDS ALL 200 IN ONE OF THEM AND NONE IN THE OTHER)
+    const char* basePath = "concurrent_base_test.csv";
+    const char* deltaPaths[2] = { "concurrent_out_test.csv", "concurrent_back_test.csv" };
+    const char* header = "Uniq Id,Product Name,Brand Name,Asin,Category,Upc,List Price,Selling Price\n";
+    {
+        std::ofstream out(basePath);
+        out << header;
+        for (int i = 0; i < 2000; i++) {
+            out << "c" << i << ",Widget " << i << ",,," << (i % 2 == 0 ? "Tools | Saws" : "Tools | Drills") << ",,,$" << i << ".00\n";
+        }
+    }
+    {
+        std::ofstream out(deltaPaths[0]);
+        std::ofstream back(deltaPaths[1]);
+        out << header;
+        back << header;
+        for (int i = 0; i < 200; i++) {
+            out << "-c" << i << "\nn" << i << ",Hose " << i << ",,,Garden | Hoses,,,$" << i << ".00\n";
+            back << "-n" << i << "\nc" << i << ",Widget " << i << ",,," << (i % 2 == 0 ? "Tools | Saws" : "Tools | Drills")
+                << ",,,$" << i << ".00\n";
+        }
+    }
+    InventoryManager manager;
+    std::streambuf* saved = std::cout.rdbuf(nullptr);
+    manager.loadFromCSV(basePath);
+    std::cout.rdbuf(saved);
+
+    // A STATS BUILD COUNTS LOOKUPS IN PLAIN INTEGERS, SO THERE ONE READER RUNS
+    // BESIDE THE WRITER (THE LOCK KEEPS THE TWO APART)
+    std::atomic<bool> done(false);
+    std::atomic<size_t> reads(0);
+    std::vector<std::thread> readers;
+    for (int t = 0; t < (Stats::ENABLED ? 1 : 3); t++) {
+        readers.emplace_back([&manager, &done, &reads, t] {
+            for (int i = t; !done.load(); i = (i + 7) % 200) {
+                InventoryManager::ReadLock lock(manager);
+                assert(manager.productCount() == 2000);
+                const std::vector<Product*>& hoses = manager.listInventoryByCategory("Hoses");
+                assert(hoses.size() == 0 || hoses.size() == 200);
+                for (const Product* product : hoses) {
+                    assert(!product->isDeleted() && product->getCategoryString() == "Garden | Hoses");
+                }
+                Product* moved = manager.findProduct("c" + std::to_string(i));
+                Product* hose = manager.findProduct("n" + std::to_string(i));
+                assert((moved == nullptr) == (hose != nullptr) && (hose != nullptr) == !hoses.empty());
+                if (moved) {
+                    assert(moved->getProductName() == "Widget " + std::to_string(i));
+                }
+                reads++;
+            }
+        });
+    }
+    for (int round = 0; round < 20; round++) {
+        // EVERY DELTA WAITS FOR A READ SINCE THE LAST ONE, SO THE TWO INTERLEAVE
+        for (size_t seen = reads.load(); reads.load() == seen; ) {
+            std::this_thread::yield();
+        }
+        InventoryManager::DeltaCounts counts;
+        assert(manager.applyDelta(deltaPaths[round % 2], counts));
+        assert(counts.inserted == 200 && counts.deleted == 200 && counts.products == 2000);
+    }
+    done = true;
+    for (std::thread& reader : readers) {
+        reader.join();
+    }
+    assert(manager.listInventoryByCategory("Hoses").empty() && manager.findProduct("c0"));
+    assertIndexesMatchRebuild(manager);
+
+    std::remove(basePath);
+    std::remove(deltaPaths[0]);
+    std::remove(deltaPaths[1]);
+    std::cout << "ALL CONCURRENT DELTA TESTS PASSED !\n" << std::endl;
+}
+
+void testStats() {
+    std::cout << "RUNNING STATS TESTS..." << std::endl;
+
+    // OCCUPANCY COMES FROM A SCAN, SO IT IS THERE IN EVERY BUILD
+    HashTable<int, int> ht(8);
+    for (int i = 0; i < 100; i++) {
+        ht.insert(i, i);
+    }
+    HashTableStats table = ht.stats();
+    assert(table.size == 100 && table.buckets == ht.bucketCount());
+    assert(table.chainLengths.samples == table.buckets && table.chainLengths.sum == 100);
+    assert(table.chainLengths.counts[0] == table.emptyBuckets && table.longestChain >= 1);
+
+    int value;
+    assert(ht.find(5, value) && !ht.find(500, value));
+    table = ht.stats();
+    if (Stats::ENABLED) {
+        // 100 INSERT LOOKUPS, THEN ONE HIT AND ONE MISS
+        assert(table.finds == 102 && table.hits == 1 && table.probes.samples == 102);
+        assert(table.rehashes > 0 && table.migratedBuckets > 0);
+        ht.resetStats();
+        assert(ht.stats().finds == 0 && ht.stats().size == 100);
+    }
+    else {
+        assert(table.finds == 0 && table.rehashes == 0 && table.probes.samples == 0);
+    }
+
+    const char* path = "stats_test.csv";
+    {
+        std::ofstream out(path);
+        out << "Uniq Id,Product Name,Brand Name,Asin,Category,Upc,List Price,Selling Price\n";
+        for (int i = 0; i < 30; i++) {
+            // A THIRD OF THE I.D.s ARE 32 HEX DIGITS, THE REST GO TO THE STRING TABLE
+            std::string id = i < 10 ? std::string(30, 'a') + std::to_string(10 + i) : "s" + std::to_string(i);
+            out << id << ",Item " << i << ",,,Toys | Games,,,$1.00\n";
+        }
+    }
+    InventoryManager manager;
+    std::streambuf* saved = std::cout.rdbuf(nullptr);
+    manager.loadFromCSV(path);
+    std::cout.rdbuf(saved);
+    std::remove(path);
+
+    const LoadStats& load = manager.getLoadStats();
+    assert(load.rows == 30 && load.bytes > 0 && load.arenaBytes > 0);
+    assert(manager.productIdStats().size == 10 && manager.otherIdCount() == 20);
+    if (Stats::ENABLED) {
+        assert(load.totalNanos > 0 && load.parseNanos + load.indexNanos <= load.totalNanos);
+    }
+    else {
+        assert(load.totalNanos == 0);
+    }
+
+    std::cout << "ALL STATS TESTS PASSED !\n" << std::endl;
+}
+
+void testAggregate() {
+    std::cout << "RUNNING AGGREGATION TESTS..." << std::endl;
+
+    // ENOUGH ROWS FOR TWO THREADS, NOT A MULTIPLE OF 64, WHOLE NUMBERS SO THE
+    // SUMS ARE EXACT IN ANY ORDER. EVERY 3RD ROW IS NULL, ROW r IS IN GROUP r % 7
+    // AND, FOR THE MULTI GROUP CASE, ALSO IN GROUP 7 WHEN EVEN
+    const size_t rows = 2 * Aggregation::ROWS_PER_THREAD + 1000;
+    std::vector<float> values(rows);
+    std::vector<uint64_t> valid((rows + 63) / 64, 0);
+    Aggregation::RowGroups single, multi;
+    single.count = 7;
+    multi.count = 8;
+    multi.offsets.push_back(0);
+    std::vector<Aggregation::Group> expected(8);
+    for (uint32_t g = 0; g < 8; g++) {
+        expected[g] = Aggregation::Group{ g, 0, 0.0, 1e30, -1e30 };
+    }
+    for (size_t r = 0; r < rows; r++) {
+        values[r] = static_cast<float>((r * 37) % 1000);
+        single.ids.push_back(static_cast<uint32_t>(r % 7));
+        multi.ids.push_back(static_cast<uint32_t>(r % 7));
+        if (r % 2 == 0) {
+            multi.ids.push_back(7);
+        }
+        multi.offsets.push_back(multi.ids.size());
+        if (r % 3 == 0) {
+            continue;
+        }
+        valid[r / 64] |= 1ULL << (r % 64);
+        for (uint64_t k = multi.offsets[r]; k < multi.offsets[r + 1]; k++) {
+            Aggregation::Group& group = expected[multi.ids[k]];
+            group.count++;
+            group.sum += values[r];
+            group.min = std::min(group.min, static_cast<double>(values[r]));
+            group.max = std::max(group.max, static_cast<double>(values[r]));
+        }
+    }
+
+    for (size_t threads : { 1, 3 }) {
+        std::vector<Aggregation::Group> grouped = Aggregation::run(values.data(), valid.data(), rows, &multi, threads);
+        assert(grouped.size() == 8);
+        for (const Aggregation::Group& group : grouped) {
+            const Aggregation::Group& want = expected[group.id];
+            assert(group.count == want.count && group.sum == want.sum && group.min == want.min && group.max == want.max);
+        }
+
+        std::vector<Aggregation::Group> bySingle = Aggregation::run(values.data(), valid.data(), rows, &single, threads);
+        uint64_t count = 0;
+        for (const Aggregation::Group& group : bySingle) {
+            assert(group.count == expected[group.id].count && group.sum == expected[group.id].sum);
+            count += group.count;
+        }
+
+        std::vector<Aggregation::Group> all = Aggregation::run(values.data(), valid.data(), rows, nullptr, threads);
+        assert(all.size() == 1 && all[0].count == count && all[0].min == 0.0 && all[0].max == 999.0);
+        std::vector<Aggregation::Group> dense = Aggregation::run(values.data(), nullptr, rows, nullptr, threads);
+        assert(dense[0].count == rows && dense[0].min == 0.0);
+        std::vector<Aggregation::Group> counted = Aggregation::run<float>(nullptr, nullptr, rows, &single, threads);
+        assert(counted.size() == 7 && counted[0].count == (rows + 6) / 7);
+    }
+
+    const char* path = "aggregate_test.csv";
+    {
+        std::ofstream out(path);
+        out << "Uniq Id,Product Name,Brand Name,Asin,Category,Upc,List Price,Selling Price\n";
+        out << "a1,Car,Acme,,Toys | Cars,,,$10.00\n";
+        out << "a2,Truck,Acme,,Toys | Cars,,,$30.00\n";
+        out << "a3,Kite,Sky,,Toys | Outdoor,,,$5.00\n";
+        out << "a4,Ball,Sky,,Toys | Outdoor,,,\n";
+    }
+    InventoryManager manager;
+    std::streambuf* saved = std::cout.rdbuf(nullptr);
+    manager.loadFromCSV(path);
+    std::cout.rdbuf(saved);
+    std::remove(path);
+
+    std::vector<Aggregation::Group> byMaker = manager.aggregate(InventoryManager::AGGREGATE_PRICE, InventoryManager::BY_MANUFACTURER);
+    assert(byMaker.size() == 2);
+    for (const Aggregation::Group& group : byMaker) {
+        std::string_view maker = manager.groupName(InventoryManager::BY_MANUFACTURER, group.id);
+        if (maker == "Acme") {
+            assert(group.value(Aggregation::AVG) == 20.0 && group.value(Aggregation::MIN) == 10.0);
+        }
+        else {
+            assert(maker == "Sky" && group.value(Aggregation::COUNT) == 1.0 && group.value(Aggregation::SUM) == 5.0);
+        }
+    }
+
+    // A PRODUCT COUNTS IN EVERY ONE OF ITS CATEGORIES
+    std::vector<Aggregation::Group> byCategory = manager.aggregate(InventoryManager::AGGREGATE_ROWS, InventoryManager::BY_CATEGORY);
+    assert(byCategory.size() == 3);
+    for (const Aggregation::Group& group : byCategory) {
+        std::string_view name = manager.groupName(InventoryManager::BY_CATEGORY, group.id);
+        assert(group.count == (name == "Toys" ? 4u : 2u));
+    }
+    std::vector<Aggregation::Group> total = manager.aggregate(InventoryManager::AGGREGATE_PRICE, InventoryManager::BY_NOTHING);
+    assert(total.size() == 1 && total[0].count == 3 && total[0].max == 30.0);
+    assert(manager.aggregate(InventoryManager::AGGREGATE_RATING, InventoryManager::BY_NOTHING).empty());
+
+    // A DELTA DROPS THE CACHED GROUPS WITH THE OTHER INDEXES
+    const char* deltaPath = "aggregate_delta.csv";
+    {
+        std::ofstream out(deltaPath);
+        out << "Uniq Id,Product Name,Brand Name,Asin,Category,Upc,List Price,Selling Price\n";
+        out << "a5,Glider,Wind,,Toys | Outdoor,,,$50.00\n";
+        out << "-a1\n";
+    }
+    InventoryManager::DeltaCounts counts;
+    assert(manager.applyDelta(deltaPath, counts) && counts.inserted == 1 && counts.deleted == 1);
+    std::remove(deltaPath);
+    byMaker = manager.aggregate(InventoryManager::AGGREGATE_PRICE, InventoryManager::BY_MANUFACTURER, 2);
+    assert(byMaker.size() == 3);
+    for (const Aggregation::Group& group : byMaker) {
+        std::string_view maker = manager.groupName(InventoryManager::BY_MANUFACTURER, group.id);
+        assert(maker == "Wind" ? group.max == 50.0 : maker == "Acme" ? group.sum == 30.0 : group.sum == 5.0);
+    }
+
+    std::cout << "ALL AGGREGATION TESTS PASSED !\n" << std::endl;
+}
+
 void testProductClass() {
     std::cout << "RUNNING PRODUCT CLASS TESTS..." << std::endl;
 
@@ -115,6 +2001,9 @@ void testProductClass() {
     assert(p1.getProductName() == "Test Product");
     assert(p1.getCategories().size() == 3);
     assert(p1.getCategories()[0] == "Electronics");
+    assert(p1.getPrice() == "$19.99");
+    assert(p1.hasPriceValue() && p1.getPriceValue() == 19.99f);
+    assert(p1.hasRatingValue() && p1.getRatingValue() == 4.5f);
 
     Product p2("67890", "Mouse", "Input device", "$29.99",
         "50", "5", "4.0", "");
@@ -130,130 +2019,873 @@ void runAllTests() {
     testHashTableBasic();
     testHashTableString();
     testHashTableRehash();
+    testHashTableIncrementalRehash();
+    testHashTableInPlace();
+    testHashTableBatch();
+    testFlatHashTable();
+    testProductId();
+    testConcurrentHashTable();
+    testArena();
+    testCSVScanner();
+    testSimdScanner();
+    testCommandIO();
+    testQueryServer();
+    testParallelLoad();
+    testSnapshot();
+    testCategoryDictionary();
+    testProductStore();
+    testSortedIndex();
+    testTextIndex();
+    testPrefixIndex();
+    testCategoryTree();
+    testProductList();
+    testApplyDelta();
+    testConcurrentDelta();
+    testStats();
+    testAggregate();
     testProductClass();
     std::cout << "\n----*** ALL THE TESTS PASSED ***----\n" << std::endl;
 }
+#endif
 
-void displayHelp() {
-    std::cout << "\nALL AVAILABLE COMMANDS:" << std::endl;
-    std::cout << "  find <UNIQUE I.D.>        - FINDS THE PRODUCT GIVEN THE UNIQUE I.D." << std::endl;
-    std::cout << "  listInventory <CATEGORY>  - LISTS ALL THE PRODUCTS IN THE CATEGORY" << std::endl;
-    std::cout << "  help                      - TAKES TO THE HELP PAGE" << std::endl;           //DISPLAYS THE SAME PAGE FOR NOW
-    std::cout << "  exit                      - TO EXIT THE APPLICATION" << std::endl;
-    std::cout << std::endl;
+void displayHelp(std::ostream& out = std::cout) {
+    out << "\nALL AVAILABLE COMMANDS:" << '\n';
+    out << "  find <UNIQUE I.D.>        - FINDS THE PRODUCT GIVEN THE UNIQUE I.D." << '\n';
+    out << "  findBatch [I.D. ...]      - FINDS MANY PRODUCTS AT ONCE, WITH NO I.D.s READS" << '\n';
+    out << "                              ONE PER LINE UNTIL AN EMPTY LINE" << '\n';
+    out << "  listInventory <CATEGORY> [--limit N] [--offset M]" << '\n';
+    out << "                            - LISTS ALL THE PRODUCTS IN THE CATEGORY (OR N FROM THE" << '\n';
+    out << "                              M-TH), A TOP LEVEL NAME OR AN \"A | B\" PATH LISTS ITS" << '\n';
+    out << "                              WHOLE SUBTREE" << '\n';
+    out << "  count <CATEGORY>          - NUMBER OF PRODUCTS listInventory WOULD LIST" << '\n';
+    out << "  categories [PATH]         - SUBCATEGORIES OF THE PATH (OR THE TOP LEVEL) WITH THEIR" << '\n';
+    out << "                              PRODUCT COUNTS" << '\n';
+    out << "  range <price|rating> <LOW> <HIGH> [CATEGORY]" << '\n';
+    out << "                            - PRODUCTS WITH LOW <= VALUE <= HIGH, CHEAPEST / LOWEST FIRST" << '\n';
+    out << "  top <price|rating> <N> [CATEGORY]" << '\n';
+    out << "                            - THE N HIGHEST PRICED / RATED PRODUCTS" << '\n';
+    out << "  search [--any] [--top K] <TERMS...>" << '\n';
+    out << "                            - BEST K (10) PRODUCTS WHOSE NAME OR MANUFACTURER HAS ALL" << '\n';
+    out << "                              (--any: ANY) OF THE TERMS" << '\n';
+    out << "  complete <PREFIX>         - CATEGORIES AND I.D.s STARTING WITH THE PREFIX (UP TO 10" << '\n';
+    out << "                              OF EACH)" << '\n';
+    out << "  agg <count|sum|min|max|avg> <price|rating|reviews|questions|*> [by <category|manufacturer>]" << '\n';
+    out << "      [--top N]             - THE AGGREGATE OVER ALL PRODUCTS OR PER GROUP, LARGEST N (20)" << '\n';
+    out << "                              GROUPS FIRST. * COUNTS PRODUCTS, A FIELD ITS NON EMPTY VALUES" << '\n';
+    out << "  applyDelta <FILE>         - APPLIES A CHANGE FILE (CSV, \"-<I.D.>\" DELETES) TO THE" << '\n';
+    out << "                              LOADED INVENTORY WITHOUT RELOADING IT" << '\n';
+    out << "  stats [--json [FILE] | reset]" << '\n';
+    out << "                            - LOAD PHASE TIMES AND I.D. TABLE OCCUPANCY, PROBE AND" << '\n';
+    out << "                              REHASH COUNTERS (BUILD WITH make STATS=1 FOR THE TIMES" << '\n';
+    out << "                              AND COUNTERS), AS TEXT OR JSON" << '\n';
+    out << "  help                      - TAKES TO THE HELP PAGE" << '\n';           //DISPLAYS THE SAME PAGE FOR NOW
+    out << "  exit                      - TO EXIT THE APPLICATION" << '\n';
+    out << '\n';
 }
 //SURAKANTI SRISHANTH REDDY
 
-void processCommand(InventoryManager& manager, const std::string& command) {
-    std::stringstream ss(command);
-    std::string cmd;
-    ss >> cmd;
+// THE NEXT WHITE SPACE SEPARATED WORD OF rest, WHICH IS ADVANCED PAST IT
+static std::string_view nextToken(std::string_view& rest) {
+    size_t start = rest.find_first_not_of(" \t\r");
+    if (start == std::string_view::npos) {
+        rest = std::string_view();
+        return rest;
+    }
+    size_t stop = rest.find_first_of(" \t\r", start);
+    if (stop == std::string_view::npos) {
+        stop = rest.size();
+    }
+    std::string_view token = rest.substr(start, stop - start);
+    rest.remove_prefix(stop);
+    return token;
+}
+
+// "price" OR "rating" TO ITS COLUMN
+static bool parseIndexedField(std::string_view name, ProductStore::FloatColumn& column) {
+    if (name == "price") {
+        column = ProductStore::PRICE;
+        return true;
+    }
+    if (name == "rating") {
+        column = ProductStore::AVERAGE_RATING;
+        return true;
+    }
+    return false;
+}
+
+template<typename T>
+static bool parseNumber(std::string_view token, T& value) {
+    const char* end = token.data() + token.size();
+    std::from_chars_result parsed = std::from_chars(token.data(), end, value);
+    return !token.empty() && parsed.ec == std::errc() && parsed.ptr == end;
+}
+
+// agg <FUNCTION> <FIELD> [by <DIMENSION>], EACH PARSE FAILS ON AN UNKNOWN WORD
+static bool parseAggregateFunction(std::string_view name, Aggregation::Function& function) {
+    const char* names[] = { "count", "sum", "min", "max", "avg" };
+    for (int f = Aggregation::COUNT; f <= Aggregation::AVG; f++) {
+        if (name == names[f]) {
+            function = static_cast<Aggregation::Function>(f);
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool parseAggregateField(std::string_view name, InventoryManager::AggregateField& field) {
+    const char* names[] = { "price", "rating", "reviews", "questions", "*" };
+    for (int f = InventoryManager::AGGREGATE_PRICE; f <= InventoryManager::AGGREGATE_ROWS; f++) {
+        if (name == names[f]) {
+            field = static_cast<InventoryManager::AggregateField>(f);
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool parseAggregateDimension(std::string_view name, InventoryManager::AggregateDimension& by) {
+    if (name == "category") {
+        by = InventoryManager::BY_CATEGORY;
+        return true;
+    }
+    if (name == "manufacturer") {
+        by = InventoryManager::BY_MANUFACTURER;
+        return true;
+    }
+    return false;
+}
+
+// LEADING WHITE SPACE REMOVED
+static std::string_view trimLeft(std::string_view s) {
+    size_t start = s.find_first_not_of(" \t");
+    return start != std::string_view::npos ? s.substr(start) : std::string_view();
+}
+
+// TRAILING WHITE SPACE REMOVED
+static std::string_view trimRight(std::string_view s) {
+    size_t end = s.find_last_not_of(" \t");
+    return end != std::string_view::npos ? s.substr(0, end + 1) : std::string_view();
+}
+
+static void printIndexedProducts(std::ostream& out, const std::vector<Product*>& products,
+    ProductStore::FloatColumn column) {
+    out << "----------------------------------------\n";
+    for (Product* p : products) {
+        out << "UNIQUE I.D.: " << p->idView();
+        if (column == ProductStore::PRICE) {
+            out << " | PRICE: " << p->getPrice();
+        }
+        else {
+            out << " | RATING: " << p->getAverageReviewRating();
+        }
+        out << " | PRODUCT NAME: ";
+        p->printName(out);
+        out << '\n';
+    }
+    out << "TOTAL: " << products.size() << " PRODUCTS\n";
+    out << "----------------------------------------\n";
+}
+
+// AN UNKNOWN CATEGORY, WITH THE CLOSEST NAMES BY PREFIX WHEN THERE ARE ANY
+static void printInvalidCategory(std::ostream& out, const InventoryManager& manager, std::string_view category) {
+    out << "INVALID \n";
+    std::vector<std::string_view> suggestions = manager.suggestCategories(category, 5);
+    if (!suggestions.empty()) {
+        out << "DID YOU MEAN:\n";
+        for (std::string_view name : suggestions) {
+            out << "  " << name << '\n';
+        }
+    }
+}
+
+// products IS ONE PAGE (FROM offset) OF total, WHEN paged THE FOOTER SAYS WHICH
+static void printCategoryProducts(std::ostream& out, std::string_view category,
+    const InventoryManager::ProductList& products, bool paged, size_t offset, size_t total) {
+    out << "\nPRODUCTS IN CATEGORY '" << category << "':\n";
+    out << "----------------------------------------\n";
+    for (Product* p : products) {
+        out << "UNIQUE I.D.: " << p->getUniqId() << " | PRODUCT NAME: ";
+        p->printName(out);
+        out << '\n';
+    }
+    if (paged) {
+        out << "SHOWING " << products.size() << " FROM OFFSET " << offset << " OF " << total << " PRODUCTS\n";
+    }
+    else {
+        out << "TOTAL: " << products.size() << " PRODUCTS\n";
+    }
+    out << "----------------------------------------\n";
+}
+
+static double millis(uint64_t nanos) {
+    return static_cast<double>(nanos) / 1e6;
+}
+
+// THE NON ZERO BUCKETS AS "LENGTH:COUNT", THE LAST ONE IS "15+"
+static void printHistogram(std::ostream& out, const Histogram& histogram) {
+    for (size_t i = 0; i < Histogram::BUCKETS; i++) {
+        if (histogram.counts[i] != 0) {
+            out << ' ' << i << (i + 1 == Histogram::BUCKETS ? "+" : "") << ':' << histogram.counts[i];
+        }
+    }
+    out << '\n';
+}
+
+static void printStats(std::ostream& out, const InventoryManager& manager) {
+    const LoadStats& load = manager.getLoadStats();
+    HashTableStats table = manager.productIdStats();
+
+    out << "\nINVENTORY STATS (COUNTERS AND TIMERS " << (table.enabled ? "ON" : "OFF, BUILD WITH make STATS=1") << "):\n";
+    out << "----------------------------------------\n";
+    out << "LAST LOAD: " << load.rows << " ROWS, " << load.bytes << " BYTES, " << load.threads << " THREADS, "
+        << load.arenaBytes << " ARENA BYTES\n";
+    if (load.enabled) {
+        out << "  READ " << millis(load.readNanos) << " MS | ALLOCATE " << millis(load.allocateNanos)
+            << " MS | PARSE " << millis(load.parseNanos) << " MS | INDEX " << millis(load.indexNanos)
+            << " MS | TOTAL " << millis(load.totalNanos) << " MS\n";
+    }
+    out << "PRODUCT I.D. TABLE: " << table.size << " KEYS IN " << table.buckets << " BUCKETS, LOAD FACTOR "
+        << table.loadFactor << ", " << table.emptyBuckets << " EMPTY, LONGEST CHAIN " << table.longestChain
+        << (table.rehashing ? ", REHASHING" : "") << '\n';
+    out << "  OTHER I.D.s (NOT 32 HEX DIGITS, KEPT AS STRINGS): " << manager.otherIdCount() << '\n';
+    out << "  HEX I.D.s READ IN PLACE FROM THE SNAPSHOT: " << manager.snapshotIdCount() << '\n';
+    out << "  CHAIN LENGTHS:";
+    printHistogram(out, table.chainLengths);
+    if (table.enabled) {
+        out << "  FINDS: " << table.finds << " (" << table.hits << " HITS), MEAN PROBES " << table.probes.mean() << '\n';
+        out << "  PROBES:";
+        printHistogram(out, table.probes);
+        out << "  REHASHES: " << table.rehashes << ", " << millis(table.rehashNanos) << " MS TOTAL, "
+            << millis(table.longestRehashNanos) << " MS LONGEST, " << table.migratedBuckets << " BUCKETS MIGRATED\n";
+    }
+    out << "----------------------------------------\n";
+}
+
+static void printHistogramJson(std::ostream& out, const Histogram& histogram) {
+    out << '[';
+    for (size_t i = 0; i < Histogram::BUCKETS; i++) {
+        out << (i ? "," : "") << histogram.counts[i];
+    }
+    out << ']';
+}
+
+// THE SAME FIGURES AS printStats() AS ONE JSON OBJECT, TIMES IN NANOSECONDS
+static void printStatsJson(std::ostream& out, const InventoryManager& manager) {
+    const LoadStats& load = manager.getLoadStats();
+    HashTableStats table = manager.productIdStats();
+
+    out << "{\"enabled\":" << (table.enabled ? "true" : "false")
+        << ",\"load\":{\"threads\":" << load.threads << ",\"rows\":" << load.rows << ",\"bytes\":" << load.bytes
+        << ",\"arena_bytes\":" << load.arenaBytes << ",\"read_ns\":" << load.readNanos
+        << ",\"allocate_ns\":" << load.allocateNanos << ",\"parse_ns\":" << load.parseNanos
+        << ",\"index_ns\":" << load.indexNanos << ",\"total_ns\":" << load.totalNanos << '}'
+        << ",\"product_id_table\":{\"size\":" << table.size << ",\"buckets\":" << table.buckets
+        << ",\"load_factor\":" << table.loadFactor << ",\"empty_buckets\":" << table.emptyBuckets
+        << ",\"longest_chain\":" << table.longestChain << ",\"rehashing\":" << (table.rehashing ? "true" : "false")
+        << ",\"chain_lengths\":";
+    printHistogramJson(out, table.chainLengths);
+    out << ",\"finds\":" << table.finds << ",\"hits\":" << table.hits << ",\"mean_probes\":" << table.probes.mean()
+        << ",\"probes\":";
+    printHistogramJson(out, table.probes);
+    out << ",\"rehashes\":" << table.rehashes << ",\"rehash_ns\":" << table.rehashNanos
+        << ",\"longest_rehash_ns\":" << table.longestRehashNanos
+        << ",\"migrated_buckets\":" << table.migratedBuckets << "},\"other_ids\":" << manager.otherIdCount()
+        << ",\"snapshot_ids\":" << manager.snapshotIdCount() << "}\n";
+}
+
+// RUNS ONE COMMAND LINE, WRITING EVERYTHING TO out. input SUPPLIES THE EXTRA
+// LINES OF A findBatch WITH NO I.D.s. NO std::endl HERE, out IS FLUSHED BY ITS
+// OWNER (BEFORE THE NEXT PROMPT, OR WHEN A BATCH BUFFER FILLS)
+void processCommand(InventoryManager& manager, std::string_view command, CommandReader& input, std::ostream& out) {
+    std::string_view rest = command;
+    std::string_view cmd = nextToken(rest);
 
     if (cmd == "find") {
-        std::string inventoryId;
-        ss >> inventoryId;
+        std::string_view inventoryId = nextToken(rest);
 
         if (inventoryId.empty()) {
-            std::cout << "USAGE: find <UNIQUE I.D.>" << std::endl;
+            out << "USAGE: find <UNIQUE I.D.>\n";
             return;
         }
 
         Product* product = manager.findProduct(inventoryId);
         if (product) {
-            std::cout << "\nPRODUCT FOUND :" << std::endl;
-            std::cout << "----------------------------------------" << std::endl;
-            product->print();
-            std::cout << "----------------------------------------" << std::endl;
+            out << "\nPRODUCT FOUND :\n";
+            out << "----------------------------------------\n";
+            product->print(out);
+            out << "----------------------------------------\n";
         }
         else {
-            std::cout << "PRODUCT NOT FOUND" << std::endl;
+            out << "PRODUCT NOT FOUND\n";
+        }
+    }
+    else if (cmd == "findBatch") {
+        // THE VIEWS POINT INTO command OR INTO lines, THE COPIES OF LATER INPUT LINES
+        std::vector<std::string_view> ids;
+        std::vector<std::string> lines;
+        for (std::string_view id = nextToken(rest); !id.empty(); id = nextToken(rest)) {
+            ids.push_back(id);
+        }
+        if (ids.empty()) {
+            std::string_view line;
+            while (input.nextLine(line)) {
+                std::string_view id = nextToken(line);
+                if (id.empty()) {
+                    break;
+                }
+                lines.emplace_back(id);
+            }
+            ids.assign(lines.begin(), lines.end());
+        }
+        if (ids.empty()) {
+            out << "USAGE: findBatch <UNIQUE I.D.> [UNIQUE I.D. ...]\n";
+            return;
+        }
+
+        std::vector<Product*> products = manager.findProducts(ids);
+        size_t found = 0;
+        for (size_t i = 0; i < ids.size(); i++) {
+            if (products[i]) {
+                out << "FOUND: " << ids[i] << " - ";
+                products[i]->printName(out);
+                out << '\n';
+                found++;
+            }
+            else {
+                out << "NOT FOUND: " << ids[i] << '\n';
+            }
         }
+        out << "FOUND " << found << " OF " << ids.size() << " PRODUCTS.\n";
     }
     else if (cmd == "listInventory") {
-        std::string category;
-        std::getline(ss, category);
+        // THE CATEGORY RUNS UP TO THE FIRST WORD STARTING WITH "--"
+        std::string_view category = rest;
+        std::string_view options;
+        for (size_t at = rest.find("--"); at != std::string_view::npos; at = rest.find("--", at + 2)) {
+            if (at == 0 || rest[at - 1] == ' ' || rest[at - 1] == '\t') {
+                category = rest.substr(0, at);
+                options = rest.substr(at);
+                break;
+            }
+        }
+        category = trimRight(trimLeft(category));
 
-        // TRIM WHITE SPACES 
-        size_t start = category.find_first_not_of(" \t");
-        if (start != std::string::npos) {
-            category = category.substr(start);
+        size_t offset = 0;
+        size_t limit = SIZE_MAX;
+        bool paged = false;
+        for (std::string_view word = nextToken(options); !word.empty(); word = nextToken(options)) {
+            std::string_view value = nextToken(options);
+            if (!(word == "--limit" && parseNumber(value, limit)) && !(word == "--offset" && parseNumber(value, offset))) {
+                category = std::string_view();      // AN UNKNOWN OPTION OR A BAD NUMBER
+                break;
+            }
+            paged = true;
         }
-        else {
-            category = "";
+
+        if (category.empty()) {
+            out << "USAGE: listInventory <CATEGORY> [--limit N] [--offset M]\n";
+            return;
+        }
+
+        InventoryManager::ProductList products;
+        if (!manager.findCategoryProducts(category, products)) {
+            printInvalidCategory(out, manager, category);
+            return;
         }
+        uint32_t node;
+        std::string path = manager.findCategoryNode(category, node) ? manager.categoryPath(node) : std::string(category);
 
+        printCategoryProducts(out, path, products.slice(offset, limit), paged, offset, products.size());
+    }
+    else if (cmd == "count") {
+        std::string_view category = trimLeft(rest);
         if (category.empty()) {
-            std::cout << "USAGE: listInventory <CATEGORY>" << std::endl;
+            out << "USAGE: count <CATEGORY>\n";
+            return;
+        }
+        InventoryManager::ProductList products;
+        if (!manager.findCategoryProducts(category, products)) {
+            printInvalidCategory(out, manager, category);
+            return;
+        }
+        out << "COUNT: " << products.size() << " PRODUCTS IN '" << category << "'\n";
+    }
+    else if (cmd == "categories") {
+        std::string_view path = trimLeft(rest);
+        uint32_t node;
+        if (!manager.findCategoryNode(path, node)) {
+            printInvalidCategory(out, manager, path);
+            return;
+        }
+
+        const CategoryTree& tree = manager.getCategoryTree();
+        std::vector<uint32_t> children = tree.children(node);
+        out << "\nCATEGORIES UNDER '" << (node == CategoryTree::ROOT ? std::string("ALL") : manager.categoryPath(node))
+            << "' (" << tree.subtreeCount(node) << " PRODUCTS):\n";
+        out << "----------------------------------------\n";
+        for (uint32_t child : children) {
+            out << manager.getCategoryDictionary().name(tree.name(child)) << " - " << tree.subtreeCount(child)
+                << " PRODUCTS, " << tree.children(child).size() << " SUBCATEGORIES\n";
+        }
+        if (node != CategoryTree::ROOT && tree.ownCount(node) > 0) {
+            out << "(NO SUBCATEGORY) - " << tree.ownCount(node) << " PRODUCTS\n";
+        }
+        out << "TOTAL: " << children.size() << " SUBCATEGORIES\n";
+        out << "----------------------------------------\n";
+    }
+    else if (cmd == "range") {
+        ProductStore::FloatColumn column;
+        float lo, hi;
+        std::string_view field = nextToken(rest);
+        std::string_view low = nextToken(rest);
+        std::string_view high = nextToken(rest);
+        std::string_view category = trimLeft(rest);
+        if (!parseIndexedField(field, column) || !parseNumber(low, lo) || !parseNumber(high, hi)) {
+            out << "USAGE: range <price|rating> <LOW> <HIGH> [CATEGORY]\n";
+            return;
+        }
+        if (!category.empty() && !manager.categoryExists(category)) {
+            printInvalidCategory(out, manager, category);
             return;
         }
 
-        if (!manager.categoryExists(category)) {
-            std::cout << "INVALID " << std::endl;
+        out << "\nPRODUCTS WITH " << (column == ProductStore::PRICE ? "PRICE" : "RATING")
+            << " FROM " << low << " TO " << high;
+        if (!category.empty()) {
+            out << " IN '" << category << "'";
+        }
+        out << ":\n";
+        printIndexedProducts(out, manager.rangeQuery(column, lo, hi, category), column);
+    }
+    else if (cmd == "top") {
+        ProductStore::FloatColumn column;
+        size_t count;
+        std::string_view field = nextToken(rest);
+        std::string_view number = nextToken(rest);
+        std::string_view category = trimLeft(rest);
+        if (!parseIndexedField(field, column) || !parseNumber(number, count)) {
+            out << "USAGE: top <price|rating> <N> [CATEGORY]\n";
+            return;
+        }
+        if (!category.empty() && !manager.categoryExists(category)) {
+            printInvalidCategory(out, manager, category);
             return;
         }
 
-        std::vector<Product*> products = manager.listInventoryByCategory(category);
+        out << "\nTOP " << count << " BY " << (column == ProductStore::PRICE ? "PRICE" : "RATING");
+        if (!category.empty()) {
+            out << " IN '" << category << "'";
+        }
+        out << ":\n";
+        printIndexedProducts(out, manager.topQuery(column, count, category), column);
+    }
+    else if (cmd == "search") {
+        // OPTIONS FIRST: --any MATCHES ANY TERM INSTEAD OF ALL, --top K KEEPS K RESULTS
+        bool matchAll = true;
+        size_t k = 10;
+        std::string_view terms = rest;
+        std::string_view word = nextToken(rest);
+        while (word == "--any" || word == "--top") {
+            if (word == "--any") {
+                matchAll = false;
+            }
+            else if (!parseNumber(nextToken(rest), k)) {
+                out << "USAGE: search [--any] [--top K] <TERMS...>\n";
+                return;
+            }
+            terms = rest;
+            word = nextToken(rest);
+        }
+        terms = trimLeft(terms);
+        if (terms.empty()) {
+            out << "USAGE: search [--any] [--top K] <TERMS...>\n";
+            return;
+        }
 
-        std::cout << "\nPRODUCTS IN CATEGORY '" << category << "':" << std::endl;
-        std::cout << "----------------------------------------" << std::endl;
+        size_t total = 0;
+        std::vector<Product*> products = manager.search(terms, matchAll, k, total);
+        out << "\nSEARCH RESULTS FOR '" << terms << "' (" << (matchAll ? "ALL" : "ANY") << " TERMS):\n";
+        out << "----------------------------------------\n";
         for (Product* p : products) {
-            std::cout << "UNIQUE I.D.: " << p->getUniqId()
-                << " | PRODUCT NAME: " << p->getProductName() << std::endl;
+            out << "UNIQUE I.D.: " << p->idView() << " | PRODUCT NAME: ";
+            p->printName(out);
+            out << '\n';
+        }
+        out << "SHOWING " << products.size() << " OF " << total << " MATCHES\n";
+        out << "----------------------------------------\n";
+    }
+    else if (cmd == "complete") {
+        // THE PREFIX IS THE REST OF THE LINE, CATEGORY NAMES HOLD SPACES
+        std::string_view prefix = trimLeft(rest);
+        if (prefix.empty()) {
+            out << "USAGE: complete <PREFIX>\n";
+            return;
+        }
+
+        const size_t shown = 10;
+        PrefixIndex<CategoryNameKeys>::Matches categories = manager.getCategoryPrefixes().matches(prefix, shown);
+        PrefixIndex<ProductIdKeys>::Matches ids = manager.getIdPrefixes().matches(prefix, shown);
+
+        out << "\nCOMPLETIONS FOR '" << prefix << "':\n";
+        out << "----------------------------------------\n";
+        for (std::string_view key : categories.keys) {
+            out << "CATEGORY: " << key << '\n';
+        }
+        for (std::string_view key : ids.keys) {
+            out << "UNIQUE I.D.: " << key << '\n';
+        }
+
+        // WHAT EVERY MATCH STARTS WITH, ACROSS BOTH KINDS
+        std::string_view common = categories.count == 0 ? ids.common : categories.common;
+        if (categories.count > 0 && ids.count > 0) {
+            size_t length = 0;
+            while (length < common.size() && length < ids.common.size() && common[length] == ids.common[length]) {
+                length++;
+            }
+            common = common.substr(0, length);
+        }
+        out << categories.count << " CATEGORIES, " << ids.count << " I.D.s";
+        if (categories.count > 0 || ids.count > 0) {
+            out << ", ALL START WITH '" << common << "'";
+        }
+        out << '\n';
+        out << "----------------------------------------\n";
+    }
+    else if (cmd == "agg") {
+        Aggregation::Function function;
+        InventoryManager::AggregateField field;
+        InventoryManager::AggregateDimension by = InventoryManager::BY_NOTHING;
+        size_t shown = 20;
+        std::string_view functionName = nextToken(rest);
+        std::string_view fieldName = nextToken(rest);
+        bool ok = parseAggregateFunction(functionName, function) && parseAggregateField(fieldName, field)
+            && (field != InventoryManager::AGGREGATE_ROWS || function == Aggregation::COUNT);
+        for (std::string_view word = nextToken(rest); ok && !word.empty(); word = nextToken(rest)) {
+            if (word == "by") {
+                ok = parseAggregateDimension(nextToken(rest), by);
+            }
+            else {
+                ok = word == "--top" && parseNumber(nextToken(rest), shown);
+            }
+        }
+        if (!ok) {
+            out << "USAGE: agg <count|sum|min|max|avg> <price|rating|reviews|questions|*> [by <category|manufacturer>] [--top N]\n";
+            out << "       (* ONLY WITH count)\n";
+            return;
+        }
+
+        // LARGEST VALUE FIRST, GROUPS IN FIRST APPEARANCE ORDER ON A TIE
+        std::vector<Aggregation::Group> groups = manager.aggregate(field, by);
+        size_t kept = std::min(shown, groups.size());
+        std::partial_sort(groups.begin(), groups.begin() + kept, groups.end(),
+            [function](const Aggregation::Group& a, const Aggregation::Group& b) {
+                double x = a.value(function), y = b.value(function);
+                return x != y ? x > y : a.id < b.id;
+            });
+
+        const char* functionLabels[] = { "COUNT", "SUM", "MIN", "MAX", "AVG" };
+        const char* fieldLabels[] = { "PRICE", "RATING", "REVIEWS", "QUESTIONS", "PRODUCTS" };
+        out << "\n" << functionLabels[function] << " OF " << fieldLabels[field];
+        if (by != InventoryManager::BY_NOTHING) {
+            out << " BY " << (by == InventoryManager::BY_CATEGORY ? "CATEGORY" : "MANUFACTURER");
+        }
+        out << ":\n";
+        out << "----------------------------------------\n";
+        for (size_t i = 0; i < kept; i++) {
+            const Aggregation::Group& group = groups[i];
+            if (by == InventoryManager::BY_NOTHING) {
+                out << "ALL PRODUCTS";
+            }
+            else {
+                std::string_view name = manager.groupName(by, group.id);
+                out << (name.empty() ? std::string_view("(NONE)") : name);
+            }
+            out << " | " << group.value(function) << " | " << group.count << " VALUES\n";
+        }
+        if (groups.empty()) {
+            out << "NO VALUES\n";
+        }
+        else if (by != InventoryManager::BY_NOTHING) {
+            out << "SHOWING " << kept << " OF " << groups.size() << " GROUPS\n";
+        }
+        out << "----------------------------------------\n";
+    }
+    else if (cmd == "applyDelta") {
+        // THE FILE NAME IS THE REST OF THE LINE, IT MAY HOLD SPACES
+        std::string path(trimRight(trimLeft(rest)));
+        if (path.empty()) {
+            out << "USAGE: applyDelta <FILE>\n";
+            return;
+        }
+        InventoryManager::DeltaCounts counts;
+        if (!manager.applyDelta(path, counts)) {
+            out << "DELTA NOT APPLIED\n";
+            return;
+        }
+        out << "DELTA APPLIED: " << counts.inserted << " INSERTED, " << counts.updated << " UPDATED, "
+            << counts.deleted << " DELETED";
+        if (counts.missing > 0) {
+            out << ", " << counts.missing << " DELETES NOT FOUND";
+        }
+        out << '\n';
+        out << "INVENTORY NOW HAS " << counts.products << " PRODUCTS\n";
+    }
+    else if (cmd == "stats") {
+        std::string_view option = nextToken(rest);
+        if (option.empty()) {
+            printStats(out, manager);
+        }
+        else if (option == "reset") {
+            manager.resetStats();
+            out << "STATS RESET\n";
+        }
+        else if (option == "--json") {
+            // THE FILE NAME IS THE REST OF THE LINE, WITHOUT ONE THE JSON GOES TO out
+            std::string path(trimRight(trimLeft(rest)));
+            if (path.empty()) {
+                printStatsJson(out, manager);
+                return;
+            }
+            std::ofstream file(path);
+            printStatsJson(file, manager);
+            if (!file) {
+                out << "ERROR CANNOT WRITE " << path << '\n';
+                return;
+            }
+            out << "STATS WRITTEN TO " << path << '\n';
+        }
+        else {
+            out << "USAGE: stats [--json [FILE] | reset]\n";
         }
-        std::cout << "TOTAL: " << products.size() << " PRODUCTS" << std::endl;
-        std::cout << "----------------------------------------" << std::endl;
     }
     else if (cmd == "help") {
-        displayHelp();
+        displayHelp(out);
     }
     else if (cmd == "exit") {
-        std::cout << "EXITING..." << std::endl;
+        out << "EXITING...\n";
     }
     else if (cmd.empty()) {
       
     }
     else {
-        std::cout << "UNKNOWN COMMAND: " << cmd << std::endl;
-        std::cout << "TYPE 'help' FOR AVAILABLE COMMANDS" << std::endl;
+        out << "UNKNOWN COMMAND: " << cmd << '\n';
+        out << "TYPE 'help' FOR AVAILABLE COMMANDS\n";
+    }
+}
+
+static int usage(const char* program) {
+    std::cerr << "USAGE: " << program << " [CSV FILE] [--threads N] [--snapshot FILE] [--batch] [--commands FILE]"
+        << " [--serve SOCKET] [--workers N]" << std::endl;
+    return 1;
+}
+
+// --batch: COMMANDS COME FROM STDIN (OR --commands FILE) IN 1 MB BLOCKS, OUTPUT
+// GOES THROUGH A 1 MB BUFFER, NO TESTS, BANNER OR PROMPTS, AND THE LOAD
+// MESSAGES GO TO STDERR SO STDOUT HOLDS ONLY COMMAND OUTPUT
+static int runBatch(InventoryManager& manager, CommandReader& input) {
+    BufferedWriter writer(STDOUT_FILENO);
+    std::ostream out(&writer);
+
+    size_t commands = 0;
+    std::string_view command;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    while (input.nextLine(command) && command != "exit") {
+        processCommand(manager, command, input, out);
+        commands++;
+    }
+    out.flush();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cerr << "BATCH: " << commands << " COMMANDS IN " << seconds << " S ("
+        << static_cast<uint64_t>(seconds > 0 ? commands / seconds : 0) << " COMMANDS/S)" << std::endl;
+    return writer.hasFailed() ? 1 : 0;
+}
+
+static QueryServer* activeServer = nullptr;
+
+static void stopServer(int) {
+    if (activeServer) {
+        activeServer->stop();
+    }
+}
+
+// ONE --serve REQUEST. find AND listInventory RUN UNDER A ReadLock, SO ANY
+// NUMBER OF THEM RUN SIDE BY SIDE, applyDelta TAKES THE INVENTORY ALONE
+// (main() ALLOWS ONLY ONE WORKER IN A STATS BUILD, THE COUNTERS ARE PLAIN)
+static void serveRequest(InventoryManager& manager, std::string_view request, std::ostream& out) {
+    std::string_view rest = request;
+    std::string_view cmd = nextToken(rest);
+    CommandReader noInput(-1, 1);
+    if (cmd == "applyDelta") {
+        processCommand(manager, request, noInput, out);
+        return;
+    }
+    if (cmd != "find" && cmd != "listInventory") {
+        out << "ONLY find, listInventory AND applyDelta ARE SERVED\n";
+        return;
+    }
+    InventoryManager::ReadLock lock(manager);
+    processCommand(manager, request, noInput, out);
+}
+
+// --serve: serveRequest() FOR EVERY LINE, OVER A UNIX SOCKET UNTIL SIGINT / SIGTERM
+static int runServer(InventoryManager& manager, const std::string& path, size_t workers) {
+    QueryServer server([&manager](std::string_view request, std::ostream& out) {
+        serveRequest(manager, request, out);
+    }, workers);
+
+    std::string error;
+    if (!server.listen(path, error)) {
+        std::cerr << "CANNOT SERVE ON " << path << ": " << error << std::endl;
+        return 1;
     }
+    activeServer = &server;
+    std::signal(SIGINT, stopServer);
+    std::signal(SIGTERM, stopServer);
+    std::cerr << "SERVING ON " << path << " WITH " << workers << " WORKERS" << std::endl;
+    server.run();
+    std::signal(SIGINT, SIG_DFL);
+    std::signal(SIGTERM, SIG_DFL);
+    activeServer = nullptr;
+    std::cerr << "SERVED " << server.requestCount() << " REQUESTS ON " << server.connectionCount()
+        << " CONNECTIONS" << std::endl;
+    return 0;
 }
 
 int main(int argc, char* argv[]) {
-    std::cout << "**********************************" << std::endl;
-    std::cout << "AMAZON INVENTORY MANAGEMENT SYSTEM" << std::endl;
-    std::cout << "**********************************" << std::endl;
+    std::string filename = "Amazon Marketing Sample Jan 2020.csv";
+    std::string snapshotFile;
+    std::string commandFile;
+    std::string servePath;
+    bool batch = false;
+    size_t threads = 1;
+    size_t workers = Stats::ENABLED ? 1 : std::max(1u, std::thread::hardware_concurrency());
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--threads") {
+            long count = (i + 1 < argc) ? std::strtol(argv[++i], nullptr, 10) : 0;
+            if (count < 1) {
+                return usage(argv[0]);
+            }
+            threads = static_cast<size_t>(count);
+        }
+        else if (arg == "--snapshot") {
+            if (i + 1 >= argc) {
+                return usage(argv[0]);
+            }
+            snapshotFile = argv[++i];
+        }
+        else if (arg == "--batch") {
+            batch = true;
+        }
+        else if (arg == "--commands") {
+            if (i + 1 >= argc) {
+                return usage(argv[0]);
+            }
+            commandFile = argv[++i];
+            batch = true;
+        }
+        else if (arg == "--serve") {
+            if (i + 1 >= argc) {
+                return usage(argv[0]);
+            }
+            servePath = argv[++i];
+            batch = true;               // STARTS LIKE --batch: NO TESTS, LOAD MESSAGES ON STDERR
+        }
+        else if (arg == "--workers") {
+            long count = (i + 1 < argc) ? std::strtol(argv[++i], nullptr, 10) : 0;
+            if (count < 1) {
+                return usage(argv[0]);
+            }
+            workers = static_cast<size_t>(count);
+        }
+        else {
+            filename = arg;
+        }
+    }
+    // THE HashTable COUNTERS OF A STATS BUILD ARE PLAIN INTEGERS, SO THERE ONE
+    // WORKER AT MOST LOOKS THINGS UP AT A TIME
+    if (Stats::ENABLED && !servePath.empty() && workers > 1) {
+        std::cerr << "--serve NEEDS --workers 1 IN A STATS=1 BUILD, THE HASH TABLE COUNTERS ARE NOT THREAD SAFE"
+            << std::endl;
+        return 1;
+    }
+
+    CommandReader input(STDIN_FILENO, batch ? CommandReader::DEFAULT_BLOCK : 4096, batch ? nullptr : &std::cout);
+    if (!commandFile.empty() && !input.open(commandFile)) {
+        std::cerr << "CANNOT OPEN COMMAND FILE: " << commandFile << std::endl;
+        return 1;
+    }
 
-    // RUNNING TESTS
-    runAllTests();
+    std::streambuf* savedOut = nullptr;
+    if (batch) {
+        savedOut = std::cout.rdbuf(std::cerr.rdbuf());
+    }
+    else {
+        std::cout << "**********************************" << std::endl;
+        std::cout << "AMAZON INVENTORY MANAGEMENT SYSTEM" << std::endl;
+        std::cout << "**********************************" << std::endl;
+
+        // RUNNING TESTS
+#ifndef INVENTORY_NO_TESTS
+        runAllTests();
+#endif
+    }
 
     // LOAD INVENTORY
     InventoryManager manager;
 
-    std::string filename = "Amazon Marketing Sample Jan 2020.csv";
-    if (argc > 1) {
-        filename = argv[1];
+    // A SNAPSHOT THAT MATCHES THE CSV'S SIZE AND MTIME SKIPS PARSING ENTIRELY,
+    // OTHERWISE THE CSV IS LOADED AND THE SNAPSHOT REWRITTEN FOR NEXT TIME
+    if (!snapshotFile.empty()) {
+        std::cout << "LOADING THE INVENTORY FROM SNAPSHOT: " << snapshotFile << std::endl;
+    }
+    if (snapshotFile.empty() || !manager.loadSnapshot(snapshotFile, filename, threads)) {
+        std::cout << "LOADING THE INVENTORY FROM: " << filename << std::endl;
+        if (!manager.loadFromCSV(filename, threads)) {
+            std::cerr << "FAILED TO LOAD. EXITING." << std::endl;
+            return 1;
+        }
+        if (!snapshotFile.empty() && manager.saveSnapshot(snapshotFile, filename)) {
+            std::cout << "SNAPSHOT SAVED TO: " << snapshotFile << std::endl;
+        }
     }
 
-    std::cout << "LOADING THE INVENTORY FROM: " << filename << std::endl;
-    if (!manager.loadFromCSV(filename)) {
-        std::cerr << "FAILED TO LOAD. EXITING." << std::endl;
-        return 1;
+    const TextIndex& textIndex = manager.getTextIndex();
+    std::cout << "SEARCH INDEX: " << textIndex.termCount() << " TERMS, " << textIndex.postings() << " POSTINGS IN "
+        << textIndex.postingBytesUsed() << " BYTES, " << (textIndex.memoryUsage() + (1 << 19)) / (1 << 20)
+        << " MB IN TOTAL" << std::endl;
+    std::cout << "PREFIX INDEX: " << manager.getIdPrefixes().size() << " I.D.s, " << manager.getCategoryPrefixes().size()
+        << " CATEGORIES IN " << (manager.getIdPrefixes().memoryUsage() + manager.getCategoryPrefixes().memoryUsage()) / 1024
+        << " KB" << std::endl;
+    size_t plainText = 0, storedText = 0;
+    for (int c = 0; c < ProductStore::TEXT_COLUMNS; c++) {
+        ProductStore::TextUsage usage = manager.getStore().textUsage(static_cast<ProductStore::TextColumn>(c));
+        plainText += usage.plainBytes;
+        storedText += usage.storedBytes;
     }
+    std::cout << "TEXT STORE: " << (storedText + (1 << 19)) / (1 << 20) << " MB ("
+        << (plainText + (1 << 19)) / (1 << 20) << " MB WITHOUT DICTIONARIES)" << std::endl;
 
     std::cout << "\nINVENTORY LOADED SUCCESSFULLY!" << std::endl;
+    if (batch) {
+        std::cout.rdbuf(savedOut);
+        if (!servePath.empty()) {
+            return runServer(manager, servePath, workers);
+        }
+        return runBatch(manager, input);
+    }
     displayHelp();
 
-    // REPL LOOP
-    std::string command;
+    // REPL LOOP, input FLUSHES THE PROMPT BEFORE IT WAITS
+    std::string_view command;
     while (true) {
         std::cout << "> ";
-        std::getline(std::cin, command);
-
-        if (command == "exit") {
+        if (!input.nextLine(command) || command == "exit") {
             break;
         }
 
-        processCommand(manager, command);
+        processCommand(manager, command, input, std::cout);
     }
 
     std::cout << "THANK YOU FOR USING OUR SERVICES ! (IF IT DOESNT WORK THAT MEANS THERE WAS AN AWS OUTAGE !! )" << std::endl;